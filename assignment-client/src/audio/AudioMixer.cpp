@@ -57,6 +57,7 @@ QStringList AudioMixer::_codecPreferenceOrder{};
 vector<AudioMixer::ZoneDescription> AudioMixer::_audioZones;
 vector<AudioMixer::ZoneSettings> AudioMixer::_zoneSettings;
 vector<AudioMixer::ReverbSettings> AudioMixer::_zoneReverbSettings;
+vector<AudioMixer::SharedMixSettings> AudioMixer::_zoneSharedMixSettings;
 
 AudioMixer::AudioMixer(ReceivedMessage& message) :
     ThreadedAssignment(message)
@@ -288,6 +289,8 @@ void AudioMixer::sendStatsPacket() {
     statsObject["avg_streams_per_frame"] = (float)_stats.sumStreams / (float)_numStatFrames;
     statsObject["avg_listeners_per_frame"] = (float)_stats.sumListeners / (float)_numStatFrames;
     statsObject["avg_listeners_(silent)_per_frame"] = (float)_stats.sumListenersSilent / (float)_numStatFrames;
+    statsObject["avg_listeners_(shared)_per_frame"] = (float)_stats.sumListenersShared / (float)_numStatFrames;
+    statsObject["avg_shared_mixes_per_frame"] = (float)_stats.sharedMixes / (float)_numStatFrames;
 
     statsObject["silent_packets_per_frame"] = (float)_numSilentPackets / (float)_numStatFrames;
 
@@ -306,6 +309,7 @@ void AudioMixer::sendStatsPacket() {
     addTiming(_sleepTiming, "sleep");
     addTiming(_frameTiming, "frame");
     addTiming(_packetsTiming, "packets");
+    addTiming(_prepareTiming, "prepare");
     addTiming(_mixTiming, "mix");
     addTiming(_eventsTiming, "events");
 
@@ -396,6 +400,147 @@ AudioMixerClientData* AudioMixer::getOrCreateClientData(Node* node) {
     return clientData;
 }
 
+// everything besides position that goes into a listener's mix
+struct SharedMixKey {
+    int zone;
+    QString codecName;
+    float masterAvatarGain;
+    float masterInjectorGain;
+    bool isAdmin;
+    bool isIgnoreBoxEnabled;
+    Node::IgnoredNodeIDs ignoredNodeIDs;
+    Node::IgnoredNodeIDs ignoringNodeIDs;
+
+    bool operator==(const SharedMixKey& other) const {
+        return zone == other.zone && codecName == other.codecName &&
+            masterAvatarGain == other.masterAvatarGain && masterInjectorGain == other.masterInjectorGain &&
+            isAdmin == other.isAdmin && isIgnoreBoxEnabled == other.isIgnoreBoxEnabled &&
+            ignoredNodeIDs == other.ignoredNodeIDs && ignoringNodeIDs == other.ignoringNodeIDs;
+    }
+};
+
+static Node::IgnoredNodeIDs sortedNodeIDs(Node::IgnoredNodeIDs nodeIDs) {
+    sort(nodeIDs.begin(), nodeIDs.end());
+    return nodeIDs;
+}
+
+// whether the stream puts any sound into this frame's mixes: a stream that failed to pop is repeated with a fade,
+// unless it is an injector, so its last popped frame counts for as long as it is repeated (see AudioMixerSlave::addStream)
+static bool isAudibleThisFrame(const PositionalAudioStream& stream) {
+    if (stream.lastPopSucceeded()) {
+        return stream.getLastPopOutputLoudness() != 0.0f;
+    }
+    if (stream.getLastPopOutput().isNull() || stream.getType() == PositionalAudioStream::Injector) {
+        return false;
+    }
+    return calculateRepeatedFrameFadeFactor(stream.getConsecutiveNotMixedCount() - 1) > 0.0f &&
+        stream.getLastPopOutputLoudness() != 0.0f;
+}
+
+// whether the listener has turned any source up or down, which only its own mix can reflect
+static bool hasGainAdjustments(AudioMixerClientData& data) {
+    auto isAdjusted = [](const AudioMixerClientData::MixableStream& stream) {
+        return stream.hrtf->getGainAdjustment() != HRTF_GAIN;
+    };
+    auto& streams = data.getStreams();
+    return any_of(begin(streams.active), end(streams.active), isAdjusted) ||
+        any_of(begin(streams.inactive), end(streams.inactive), isAdjusted) ||
+        any_of(begin(streams.skipped), end(streams.skipped), isAdjusted);
+}
+
+// whether every frame the codec encodes decodes on its own, so a listener can switch between its own encoder
+// and another listener's without throwing off its decoder (no codec sends raw PCM)
+static bool isCodecShareable(const QString& codecName) {
+    return codecName.isEmpty() || codecName == "pcm" || codecName == "zlib" || codecName == "adpcm";
+}
+
+void AudioMixer::prepareSharedMixes(NodeList::const_iterator cbegin, NodeList::const_iterator cend) {
+    auto& sharedMixes = _workerSharedData.sharedMixes;
+    auto& listenerSharedMixes = _workerSharedData.listenerSharedMixes;
+    sharedMixes.clear();
+    listenerSharedMixes.clear();
+
+    if (_zoneSharedMixSettings.empty()) {
+        return;
+    }
+
+    struct Group {
+        SharedMixKey key;
+        int minListeners;
+        vector<SharedNodePointer> listeners;
+    };
+    vector<Group> groups;
+
+    for_each(cbegin, cend, [&](const SharedNodePointer& node) {
+        AudioMixerClientData* data = static_cast<AudioMixerClientData*>(node->getLinkedData());
+        if (!data || node->isUpstream() || node->getType() != NodeType::Agent || !node->getActiveSocket()) {
+            return;
+        }
+
+        AvatarAudioStream* avatarStream = data->getAvatarAudioStream();
+        if (!avatarStream || !data->getSoloedNodes().empty() || hasGainAdjustments(*data) ||
+            !isCodecShareable(data->getCodecName())) {
+            return;
+        }
+
+        // a listener that is making sound can't be sent a mix with its own voice in it,
+        // so it is mixed on its own until it goes quiet again
+        for (const auto& stream : data->getAudioStreams()) {
+            if (stream->shouldLoopbackForNode() || isAudibleThisFrame(*stream)) {
+                return;
+            }
+        }
+
+        glm::vec3 position = avatarStream->getPosition();
+        auto settings = find_if(begin(_zoneSharedMixSettings), end(_zoneSharedMixSettings),
+                                [&](const SharedMixSettings& zoneSettings) {
+            return _audioZones[zoneSettings.zone].area.contains(position);
+        });
+        if (settings == end(_zoneSharedMixSettings)) {
+            return;
+        }
+
+        SharedMixKey key {
+            settings->zone,
+            data->getCodecName(),
+            data->getMasterAvatarGain(),
+            data->getMasterInjectorGain(),
+            data->getRequestsDomainListData() && node->getCanKick(),
+            avatarStream->isIgnoreBoxEnabled(),
+            sortedNodeIDs(node->getIgnoredNodeIDs()),
+            sortedNodeIDs(data->getIgnoringNodeIDs())
+        };
+
+        auto group = find_if(begin(groups), end(groups), [&](const Group& other) {
+            return other.key == key;
+        });
+        if (group == end(groups)) {
+            groups.push_back({ move(key), settings->minListeners, {} });
+            group = prev(end(groups));
+        }
+        group->listeners.push_back(node);
+    });
+
+    for (const auto& group : groups) {
+        if ((int)group.listeners.size() < group.minListeners) {
+            continue;
+        }
+
+        // the lowest ID leads, so the same listener keeps preparing the mix for as long as the group holds
+        auto leader = min_element(begin(group.listeners), end(group.listeners),
+                                  [](const SharedNodePointer& a, const SharedNodePointer& b) {
+            return a->getLocalID() < b->getLocalID();
+        });
+
+        unique_ptr<AudioMixerSlave::SharedMix> sharedMix { new AudioMixerSlave::SharedMix() };
+        sharedMix->leader = *leader;
+        for (const auto& listener : group.listeners) {
+            listenerSharedMixes[listener->getLocalID()] = sharedMix.get();
+        }
+        sharedMixes.push_back(move(sharedMix));
+    }
+}
+
 void AudioMixer::start() {
     auto nodeList = DependencyManager::get<NodeList>();
 
@@ -459,6 +604,11 @@ void AudioMixer::start() {
             numToRetain = nodeList->size() * (1.0f - _throttlingRatio);
         }
         nodeList->nestedEach([&](NodeList::const_iterator cbegin, NodeList::const_iterator cend) {
+            {
+                auto prepareTimer = _prepareTiming.timer();
+                prepareSharedMixes(cbegin, cend);
+            }
+
             // mix across slave threads
             auto mixTimer = _mixTiming.timer();
             _slavePool.mix(cbegin, cend, frame, numToRetain);
@@ -553,6 +703,7 @@ void AudioMixer::clearDomainSettings() {
     _audioZones.clear();
     _zoneSettings.clear();
     _zoneReverbSettings.clear();
+    _zoneSharedMixSettings.clear();
 }
 
 void AudioMixer::parseSettingsObject(const QJsonObject& settingsObject) {
@@ -804,6 +955,41 @@ void AudioMixer::parseSettingsObject(const QJsonObject& settingsObject) {
                 }
             }
         }
+
+        const QString SHARED_MIX = "shared_mix";
+        if (audioEnvGroupObject[SHARED_MIX].isArray()) {
+            const QJsonArray& sharedMix = audioEnvGroupObject[SHARED_MIX].toArray();
+
+            const QString ZONE = "zone";
+            const QString MIN_LISTENERS = "min_listeners";
+            for (int i = 0; i < sharedMix.count(); ++i) {
+                QJsonObject sharedMixObject = sharedMix[i].toObject();
+
+                if (sharedMixObject.contains(ZONE)) {
+                    auto itZone = find_if(begin(_audioZones), end(_audioZones), [&](const ZoneDescription& description) {
+                        return description.name == sharedMixObject.value(ZONE).toString();
+                    });
+
+                    // without a minimum, any two listeners can share
+                    bool ok = true;
+                    int minListeners = 2;
+                    QString minListenersString = sharedMixObject.value(MIN_LISTENERS).toString();
+                    if (!minListenersString.isEmpty()) {
+                        minListeners = max(minListenersString.toInt(&ok), 2);
+                    }
+
+                    if (ok && itZone != end(_audioZones)) {
+                        SharedMixSettings settings;
+                        settings.zone = itZone - begin(_audioZones);
+                        settings.minListeners = minListeners;
+
+                        _zoneSharedMixSettings.push_back(settings);
+
+                        qCDebug(audio) << "Added Shared Mix:" << itZone->name << minListeners;
+                    }
+                }
+            }
+        }
     }
 }
 
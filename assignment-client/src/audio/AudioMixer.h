@@ -49,6 +49,10 @@ public:
         float reverbTime;
         float wetLevel;
     };
+    struct SharedMixSettings {
+        int zone;
+        int minListeners;
+    };
 
     static int getStaticJitterFrames() { return _numStaticJitterFrames; }
     static bool shouldMute(float quietestFrame) { return quietestFrame > _noiseMutingThreshold; }
@@ -56,6 +60,7 @@ public:
     static const std::vector<ZoneDescription>& getAudioZones() { return _audioZones; }
     static const std::vector<ZoneSettings>& getZoneSettings() { return _zoneSettings; }
     static const std::vector<ReverbSettings>& getReverbSettings() { return _zoneReverbSettings; }
+    static const std::vector<SharedMixSettings>& getSharedMixSettings() { return _zoneSharedMixSettings; }
     static const std::pair<QString, CodecPluginPointer> negotiateCodec(std::vector<QString> codecs);
 
     static bool shouldReplicateTo(const Node& from, const Node& to) {
@@ -89,6 +94,9 @@ private:
 
     AudioMixerClientData* getOrCreateClientData(Node* node);
 
+    // group the listeners in shared mix zones that can be sent the same mix
+    void prepareSharedMixes(NodeList::const_iterator begin, NodeList::const_iterator end);
+
     QString percentageForMixStats(int counter);
 
     void parseSettingsObject(const QJsonObject& settingsObject);
@@ -147,6 +155,7 @@ private:
     static std::vector<ZoneDescription> _audioZones;
     static std::vector<ZoneSettings> _zoneSettings;
     static std::vector<ReverbSettings> _zoneReverbSettings;
+    static std::vector<SharedMixSettings> _zoneSharedMixSettings;
 
     float _throttleStartTarget = 0.9f;
     float _throttleBackoffTarget = 0.44f;
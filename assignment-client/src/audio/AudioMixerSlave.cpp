@@ -43,7 +43,8 @@ using MixableStreamsVector = AudioMixerClientData::MixableStreamsVector;
 
 // packet helpers
 std::unique_ptr<NLPacket> createAudioPacket(PacketType type, int size, quint16 sequence, QString codec);
-void sendMixPacket(const SharedNodePointer& node, AudioMixerClientData& data, QByteArray& buffer);
+bool encodeMix(AudioMixerClientData& data, bool mixHasAudio, const int16_t* samples, QByteArray& encodedBuffer);
+void sendMixPacket(const SharedNodePointer& node, AudioMixerClientData& data, const QByteArray& buffer);
 void sendSilentPacket(const SharedNodePointer& node, AudioMixerClientData& data);
 void sendMutePacket(const SharedNodePointer& node, AudioMixerClientData&);
 void sendEnvironmentPacket(const SharedNodePointer& node, AudioMixerClientData& data);
@@ -96,25 +97,22 @@ void AudioMixerSlave::mix(const SharedNodePointer& node) {
     if (node->getType() == NodeType::Agent && node->getActiveSocket()) {
         ++stats.sumListeners;
 
-        // mix the audio
-        bool mixHasAudio = prepareMix(node);
+        auto sharedMix = _sharedData.listenerSharedMixes.find(node->getLocalID());
+        if (sharedMix != _sharedData.listenerSharedMixes.end()) {
+            ++stats.sumListenersShared;
+            sendSharedMix(node, *data, *sharedMix->second);
+        } else {
+            // mix the audio
+            bool mixHasAudio = prepareMix(node);
 
-        // send audio packet
-        if (mixHasAudio || data->shouldFlushEncoder()) {
+            // send audio packet
             QByteArray encodedBuffer;
-            if (mixHasAudio) {
-                // encode the audio
-                QByteArray decodedBuffer(reinterpret_cast<char*>(_bufferSamples), AudioConstants::NETWORK_FRAME_BYTES_STEREO);
-                data->encode(decodedBuffer, encodedBuffer);
+            if (encodeMix(*data, mixHasAudio, _bufferSamples, encodedBuffer)) {
+                sendMixPacket(node, *data, encodedBuffer);
             } else {
-                // time to flush (resets shouldFlush until the next encode)
-                data->encodeFrameOfZeros(encodedBuffer);
+                ++stats.sumListenersSilent;
+                sendSilentPacket(node, *data);
             }
-
-            sendMixPacket(node, *data, encodedBuffer);
-        } else {
-            ++stats.sumListenersSilent;
-            sendSilentPacket(node, *data);
         }
 
         // send environment packet
@@ -128,6 +126,31 @@ void AudioMixerSlave::mix(const SharedNodePointer& node) {
     }
 }
 
+void AudioMixerSlave::sendSharedMix(const SharedNodePointer& listener, AudioMixerClientData& listenerData,
+                                   SharedMix& sharedMix) {
+    {
+        std::lock_guard<std::mutex> lock(sharedMix.mutex);
+        if (!sharedMix.isPrepared) {
+            // the leader is only ever mixed here, under the lock, so any slave can prepare it
+            auto leaderData = static_cast<AudioMixerClientData*>(sharedMix.leader->getLinkedData());
+            bool mixHasAudio = prepareMix(sharedMix.leader);
+            sharedMix.isSilent = !encodeMix(*leaderData, mixHasAudio, _bufferSamples, sharedMix.encodedBuffer);
+            sharedMix.isPrepared = true;
+            ++stats.sharedMixes;
+        }
+    }
+
+    if (listener != sharedMix.leader) {
+        updateStreams(listener);
+    }
+
+    if (sharedMix.isSilent) {
+        ++stats.sumListenersSilent;
+        sendSilentPacket(listener, listenerData);
+    } else {
+        sendMixPacket(listener, listenerData, sharedMix.encodedBuffer);
+    }
+}
 
 template <class Container, class Predicate>
 void erase_if(Container& cont, Predicate&& pred) {
@@ -239,14 +262,7 @@ bool shouldBeInactive(MixableStream& stream) {
             stream.positionalStream->getLastPopOutputLoudness() == 0.0f);
 };
 
-bool shouldBeSkipped(MixableStream& stream, const Node& listener,
-                     const AvatarAudioStream& listenerAudioStream,
-                     const AudioMixerClientData& listenerData) {
-
-    if (stream.nodeStreamID.nodeLocalID == listener.getLocalID()) {
-        return !stream.positionalStream->shouldLoopbackForNode();
-    }
-
+void updateIgnoreFlags(MixableStream& stream, const AudioMixerClientData& listenerData) {
     // grab the unprocessed ignores and unignores from and for this listener
     const auto& nodesIgnoredByListener = listenerData.getNewIgnoredNodeIDs();
     const auto& nodesUnignoredByListener = listenerData.getNewUnignoredNodeIDs();
@@ -266,6 +282,17 @@ bool shouldBeSkipped(MixableStream& stream, const Node& listener,
     } else {
         stream.ignoringListener = contains(nodesIgnoringListener, stream.nodeStreamID.nodeID);
     }
+}
+
+bool shouldBeSkipped(MixableStream& stream, const Node& listener,
+                     const AvatarAudioStream& listenerAudioStream,
+                     const AudioMixerClientData& listenerData) {
+
+    if (stream.nodeStreamID.nodeLocalID == listener.getLocalID()) {
+        return !stream.positionalStream->shouldLoopbackForNode();
+    }
+
+    updateIgnoreFlags(stream, listenerData);
 
     bool listenerIsAdmin = listenerData.getRequestsDomainListData() && listener.getCanKick();
     if (stream.ignoredByListener || (stream.ignoringListener && !listenerIsAdmin)) {
@@ -489,6 +516,29 @@ bool AudioMixerSlave::prepareMix(const SharedNodePointer& listener) {
     return hasAudio;
 }
 
+void AudioMixerSlave::updateStreams(const SharedNodePointer& listener) {
+    AudioMixerClientData* listenerData = static_cast<AudioMixerClientData*>(listener->getLinkedData());
+
+    addStreams(*listener, *listenerData);
+
+    // the streams stay where they are until this listener is mixed on its own again,
+    // but removed streams have to go now and ignores can't be left staged
+    auto update = [&](MixableStream& stream) {
+        if (shouldBeRemoved(stream, _sharedData)) {
+            return true;
+        }
+        updateIgnoreFlags(stream, *listenerData);
+        return false;
+    };
+
+    auto& streams = listenerData->getStreams();
+    erase_if(streams.skipped, update);
+    erase_if(streams.inactive, update);
+    erase_if(streams.active, update);
+
+    listenerData->clearStagedIgnoreChanges();
+}
+
 void AudioMixerSlave::addStream(AudioMixerClientData::MixableStream& mixableStream,
                                 AvatarAudioStream& listeningNodeStream,
                                 float masterAvatarGain,
@@ -608,7 +658,21 @@ std::unique_ptr<NLPacket> createAudioPacket(PacketType type, int size, quint16 s
     return audioPacket;
 }
 
-void sendMixPacket(const SharedNodePointer& node, AudioMixerClientData& data, QByteArray& buffer) {
+bool encodeMix(AudioMixerClientData& data, bool mixHasAudio, const int16_t* samples, QByteArray& encodedBuffer) {
+    if (mixHasAudio) {
+        // encode the audio
+        QByteArray decodedBuffer(reinterpret_cast<const char*>(samples), AudioConstants::NETWORK_FRAME_BYTES_STEREO);
+        data.encode(decodedBuffer, encodedBuffer);
+        return true;
+    } else if (data.shouldFlushEncoder()) {
+        // time to flush (resets shouldFlush until the next encode)
+        data.encodeFrameOfZeros(encodedBuffer);
+        return true;
+    }
+    return false;
+}
+
+void sendMixPacket(const SharedNodePointer& node, AudioMixerClientData& data, const QByteArray& buffer) {
     const int MIX_PACKET_SIZE =
         sizeof(quint16) + AudioConstants::MAX_CODEC_NAME_LENGTH_ON_WIRE + AudioConstants::NETWORK_FRAME_BYTES_STEREO;
     quint16 sequence = data.getOutgoingSequenceNumber();
@@ -619,7 +683,7 @@ void sendMixPacket(const SharedNodePointer& node, AudioMixerClientData& data, QB
     mixPacket->write(buffer.constData(), buffer.size());
 
     // send packet
-    DependencyManager::get<NodeList>()->sendPacket(std::move(mixPacket), *node);
+    DependencyManager::ref<NodeList>()->sendPacket(std::move(mixPacket), *node);
     data.incrementOutgoingMixedAudioSequenceNumber();
 }
 
@@ -634,13 +698,13 @@ void sendSilentPacket(const SharedNodePointer& node, AudioMixerClientData& data)
     mixPacket->writePrimitive(AudioConstants::NETWORK_FRAME_SAMPLES_STEREO);
 
     // send packet
-    DependencyManager::get<NodeList>()->sendPacket(std::move(mixPacket), *node);
+    DependencyManager::ref<NodeList>()->sendPacket(std::move(mixPacket), *node);
     data.incrementOutgoingMixedAudioSequenceNumber();
 }
 
 void sendMutePacket(const SharedNodePointer& node, AudioMixerClientData& data) {
     auto mutePacket = NLPacket::create(PacketType::NoisyMute, 0);
-    DependencyManager::get<NodeList>()->sendPacket(std::move(mutePacket), *node);
+    DependencyManager::ref<NodeList>()->sendPacket(std::move(mutePacket), *node);
 
     // probably now we just reset the flag, once should do it (?)
     data.setShouldMuteClient(false);
@@ -703,7 +767,7 @@ void sendEnvironmentPacket(const SharedNodePointer& node, AudioMixerClientData&
         }
 
         // send the packet
-        DependencyManager::get<NodeList>()->sendPacket(std::move(envPacket), *node);
+        DependencyManager::ref<NodeList>()->sendPacket(std::move(envPacket), *node);
     }
 }
 
@@ -12,6 +12,9 @@
 #ifndef hifi_AudioMixerSlave_h
 #define hifi_AudioMixerSlave_h
 
+#include <mutex>
+#include <unordered_map>
+
 #include <tbb/concurrent_vector.h>
 
 #include <AABox.h>
@@ -31,11 +34,25 @@ class AudioHRTF;
 class AudioMixerSlave {
 public:
     using ConstIter = NodeList::const_iterator;
+
+    // a mix that is prepared and encoded once a frame, for the first of its listeners to be mixed,
+    // and sent as is to the rest of them
+    struct SharedMix {
+        SharedNodePointer leader; // the listener the mix is prepared for
+        std::mutex mutex;
+        bool isPrepared { false }; // guarded by mutex
+        bool isSilent { false };
+        QByteArray encodedBuffer;
+    };
     
     struct SharedData {
         AudioMixerClientData::ConcurrentAddedStreams addedStreams;
         std::vector<Node::LocalID> removedNodes;
         std::vector<NodeIDStreamID> removedStreams;
+
+        // set up before each round of mixing, read-only while mixing
+        std::vector<std::unique_ptr<SharedMix>> sharedMixes;
+        std::unordered_map<Node::LocalID, SharedMix*> listenerSharedMixes;
     };
 
     AudioMixerSlave(SharedData& sharedData) : _sharedData(sharedData) {};
@@ -55,6 +72,10 @@ public:
 private:
     // create mix, returns true if mix has audio
     bool prepareMix(const SharedNodePointer& listener);
+    // send the shared mix, preparing it first if no other listener has this frame
+    void sendSharedMix(const SharedNodePointer& listener, AudioMixerClientData& listenerData, SharedMix& sharedMix);
+    // keep the streams of a listener that is sent a shared mix up to date, without mixing them
+    void updateStreams(const SharedNodePointer& listener);
     void addStream(AudioMixerClientData::MixableStream& mixableStream,
                    AvatarAudioStream& listeningNodeStream,
                    float masterAvatarGain,
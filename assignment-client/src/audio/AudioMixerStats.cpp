@@ -15,6 +15,9 @@ void AudioMixerStats::reset() {
     sumStreams = 0;
     sumListeners = 0;
     sumListenersSilent = 0;
+    sumListenersShared = 0;
+
+    sharedMixes = 0;
 
     totalMixes = 0;
 
@@ -45,6 +48,9 @@ void AudioMixerStats::accumulate(const AudioMixerStats& otherStats) {
     sumStreams += otherStats.sumStreams;
     sumListeners += otherStats.sumListeners;
     sumListenersSilent += otherStats.sumListenersSilent;
+    sumListenersShared += otherStats.sumListenersShared;
+
+    sharedMixes += otherStats.sharedMixes;
 
     totalMixes += otherStats.totalMixes;
 
@@ -20,6 +20,9 @@ struct AudioMixerStats {
     int sumStreams { 0 };
     int sumListeners { 0 };
     int sumListenersSilent { 0 };
+    int sumListenersShared { 0 };
+
+    int sharedMixes { 0 };
 
     int totalMixes { 0 };
 
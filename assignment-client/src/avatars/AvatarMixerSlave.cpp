@@ -251,7 +251,7 @@ int AvatarMixerSlave::sendReplicatedIdentityPacket(const Node& agentNode, const
         individualData.replace(0, NUM_BYTES_RFC4122_UUID, nodeData->getNodeID().toRfc4122()); // FIXME, this looks suspicious
         auto identityPacket = NLPacketList::create(PacketType::ReplicatedAvatarIdentity, QByteArray(), true, true);
         identityPacket->write(individualData);
-        DependencyManager::get<NodeList>()->sendPacketList(std::move(identityPacket), destinationNode);
+        DependencyManager::ref<NodeList>()->sendPacketList(std::move(identityPacket), destinationNode);
         _stats.numIdentityPacketsSent++;
         _stats.numIdentityBytesSent += individualData.size();
         return individualData.size();
@@ -314,7 +314,7 @@ namespace {
 void AvatarMixerSlave::broadcastAvatarDataToAgent(const SharedNodePointer& node) {
     const Node* destinationNode = node.data();
 
-    auto nodeList = DependencyManager::get<NodeList>();
+    auto nodeList = DependencyManager::ref<NodeList>();
 
     // setup for distributed random floating point values
     std::random_device randomDevice;
@@ -796,7 +796,7 @@ void AvatarMixerSlave::broadcastAvatarDataToDownstreamMixer(const SharedNodePoin
         _stats.numDataBytesSent += numAvatarDataBytes;
 
         // send the replicated bulk avatar data
-        auto nodeList = DependencyManager::get<NodeList>();
+        auto nodeList = DependencyManager::ref<NodeList>();
         nodeList->sendPacketList(std::move(avatarPacketList), node->getPublicSocket());
 
         // record the bytes sent for other avatar data in the AvatarMixerClientData
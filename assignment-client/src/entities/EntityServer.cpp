@@ -29,6 +29,7 @@
 #include "EntityNodeData.h"
 #include "EntityServerConsts.h"
 #include "EntityTreeSendThread.h"
+#include "ServerPhysicsSimulation.h"
 
 const char* MODEL_SERVER_NAME = "Entity";
 const char* MODEL_SERVER_LOGGING_TARGET_NAME = "entity-server";
@@ -75,6 +76,11 @@ EntityServer::~EntityServer() {
 }
 
 void EntityServer::aboutToFinish() {
+    if (_serverPhysics) {
+        _serverPhysics->stop();
+        _serverPhysics.reset();
+    }
+
     DependencyManager::get<ResourceManager>()->cleanup();
 
     DependencyManager::destroy<AssignmentDynamicFactory>();
@@ -354,6 +360,27 @@ void EntityServer::readAdditionalConfiguration(const QJsonObject& settingsSectio
         
         entityEditFilters->addFilter(EntityItemID(), filterURL);
     }
+
+    QString serverPhysicsZones;
+    if (readOptionString("serverPhysicsZones", settingsSectionObject, serverPhysicsZones) && !serverPhysicsZones.isEmpty()) {
+        QVector<QUuid> zoneIDs;
+        for (const auto& zoneString : serverPhysicsZones.split(',', QString::SkipEmptyParts)) {
+            QUuid zoneID(zoneString.trimmed());
+            if (zoneID.isNull()) {
+                qWarning() << "Ignoring invalid server physics zone" << zoneString;
+            } else {
+                zoneIDs.push_back(zoneID);
+            }
+        }
+
+        int maxUpdatesPerSecond = ServerPhysicsSimulation::DEFAULT_MAX_UPDATES_PER_SECOND;
+        readOptionInt("serverPhysicsMaxUpdatesPerSecond", settingsSectionObject, maxUpdatesPerSecond);
+
+        if (!zoneIDs.isEmpty() && !_serverPhysics) {
+            _serverPhysics.reset(new ServerPhysicsSimulation(tree, zoneIDs, maxUpdatesPerSecond));
+            _serverPhysics->start();
+        }
+    }
 }
 
 void EntityServer::entityFilterAdded(EntityItemID id, bool success) {
@@ -413,6 +440,10 @@ QString EntityServer::serverSubclassStats() {
     statsString += QString().sprintf("       EntityItem size... %ld bytes\r\n", sizeof(EntityItem));
     statsString += "\r\n\r\n";
 
+    if (_serverPhysics) {
+        statsString += _serverPhysics->getStatsString();
+    }
+
     statsString += "<b>Entity Server Sending to Viewer Statistics</b>\r\n";
     statsString += "----- Viewer Node ID -----------------    ----- Entity ID ----------------------    "
                    "---------- Last Sent To ----------    ---------- Last Edited -----------\r\n";
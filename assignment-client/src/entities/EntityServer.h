@@ -29,6 +29,7 @@ struct ViewerSendingStats {
 
 class SimpleEntitySimulation;
 using SimpleEntitySimulationPointer = std::shared_ptr<SimpleEntitySimulation>;
+class ServerPhysicsSimulation;
 
 class EntityServer : public OctreeServer, public NewlyCreatedEntityHook {
     Q_OBJECT
@@ -76,6 +77,7 @@ private slots:
 
 private:
     SimpleEntitySimulationPointer _entitySimulation;
+    std::unique_ptr<ServerPhysicsSimulation> _serverPhysics;
     QTimer* _pruneDeletedEntitiesTimer = nullptr;
 
     QReadWriteLock _viewerSendingStatsLock;
@@ -0,0 +1,209 @@
+//
+//  ServerEntityMotionState.cpp
+//  assignment-client/src/entities
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "ServerEntityMotionState.h"
+
+#include <glm/gtx/norm.hpp>
+
+#include <BulletUtil.h>
+#include <NumericalConstants.h>
+#include <PhysicsHelpers.h>
+
+// the largest extrapolation errors observers may accumulate before we publish a correction
+const float MAX_PUBLISH_POSITION_ERROR = 0.01f; // meters
+const float MAX_PUBLISH_ROTATION_DOT_ERROR = 0.0002f; // ~2 degrees
+
+// below these deltas an incoming change is considered an echo of what we already know
+const float KNOWN_POSITION_TOLERANCE_SQUARED = 1.0e-8f;
+const float KNOWN_VELOCITY_TOLERANCE_SQUARED = 1.0e-8f;
+const float KNOWN_ROTATION_DOT_TOLERANCE = 0.99999f;
+
+// a body accelerating at close to gravity for this many substeps is published as ballistic
+const uint8_t STEPS_TO_DECIDE_BALLISTIC = 4;
+const float ACCELERATION_EQUIVALENT_EPSILON_RATIO = 0.1f;
+
+ServerEntityMotionState::ServerEntityMotionState(const btCollisionShape* shape, EntityItemPointer entity, const QUuid& serverID) :
+    ObjectMotionState(nullptr),
+    _entity(entity),
+    _serverID(serverID)
+{
+    _type = MOTIONSTATE_TYPE_ENTITY;
+    assert(_entity);
+    setShape(shape);
+    setMass(_entity->computeMass());
+    syncWithEntity();
+    _bodyPosition = _knownPosition;
+    _bodyRotation = _knownRotation;
+    _bodyVelocity = _knownVelocity;
+    _bodyAngularVelocity = _knownAngularVelocity;
+}
+
+ServerEntityMotionState::~ServerEntityMotionState() {
+    _entity.reset();
+}
+
+bool ServerEntityMotionState::isServerSimulated() const {
+    QUuid simulatorID = _entity->getSimulatorID();
+    return simulatorID.isNull() || simulatorID == _serverID;
+}
+
+PhysicsMotionType ServerEntityMotionState::computePhysicsMotionType() const {
+    if (_entity->getLocked()) {
+        return _entity->isMoving() ? MOTION_TYPE_KINEMATIC : MOTION_TYPE_STATIC;
+    }
+    if (_entity->getDynamic()) {
+        if (!_entity->getParentID().isNull() || !isServerSimulated()) {
+            // someone else is simulating it (or it is attached to something) --> follow their results
+            return MOTION_TYPE_KINEMATIC;
+        }
+        return MOTION_TYPE_DYNAMIC;
+    }
+    if (_entity->hasActions() || _entity->isMovingRelativeToParent()) {
+        return MOTION_TYPE_KINEMATIC;
+    }
+    return MOTION_TYPE_STATIC;
+}
+
+bool ServerEntityMotionState::isMoving() const {
+    return _entity->isMovingRelativeToParent();
+}
+
+// This callback is invoked by Bullet when the body is first added to the world
+// and at the beginning of each substep for KINEMATIC bodies.
+void ServerEntityMotionState::getWorldTransform(btTransform& worldTrans) const {
+    worldTrans.setOrigin(glmToBullet(getObjectPosition()));
+    worldTrans.setRotation(glmToBullet(getObjectRotation()));
+}
+
+// This callback is invoked by Bullet at the end of each substep for DYNAMIC and ACTIVE bodies.
+void ServerEntityMotionState::setWorldTransform(const btTransform& worldTrans) {
+    glm::vec3 velocity = getBodyLinearVelocity();
+
+    uint32_t thisStep = ObjectMotionState::getWorldSimulationStep();
+    uint32_t numSubsteps = thisStep - _lastMeasureStep;
+    if (numSubsteps > 0 && numSubsteps <= (uint32_t)PHYSICS_ENGINE_MAX_NUM_SUBSTEPS) {
+        // undo the damping to measure the acceleration: v1 = (v0 + a * dt) * (1 - D)^dt
+        float dt = (float)numSubsteps * PHYSICS_ENGINE_FIXED_SUBSTEP;
+        const float MIN_DAMPING_FACTOR = 0.01f;
+        float invDampingAttenuationFactor = 1.0f / glm::max(powf(1.0f - _body->getLinearDamping(), dt), MIN_DAMPING_FACTOR);
+        glm::vec3 acceleration = (velocity * invDampingAttenuationFactor - _bodyVelocity) / dt;
+
+        float gravityLength = glm::length(_entity->getGravity());
+        if (glm::abs(glm::length(acceleration) - gravityLength) < ACCELERATION_EQUIVALENT_EPSILON_RATIO * gravityLength) {
+            if (_accelerationNearlyGravityCount < (uint8_t)(-2)) {
+                ++_accelerationNearlyGravityCount;
+            }
+        } else {
+            _accelerationNearlyGravityCount = 0;
+        }
+    } else {
+        // the body has just become active
+        _accelerationNearlyGravityCount = 0;
+    }
+    _lastMeasureStep = thisStep;
+
+    _bodyPosition = bulletToGLM(worldTrans.getOrigin()) + ObjectMotionState::getWorldOffset();
+    _bodyRotation = bulletToGLM(worldTrans.getRotation());
+    _bodyVelocity = velocity;
+    _bodyAngularVelocity = getBodyAngularVelocity();
+    _hasUnpublishedResults = true;
+}
+
+glm::vec3 ServerEntityMotionState::getBodyAcceleration() const {
+    if (_body && _body->isActive() && _accelerationNearlyGravityCount >= STEPS_TO_DECIDE_BALLISTIC) {
+        return _entity->getGravity();
+    }
+    return Vectors::ZERO;
+}
+
+uint32_t ServerEntityMotionState::getIncomingDirtyFlags() const {
+    uint32_t flags = 0;
+    if (!_body) {
+        return flags;
+    }
+
+    if (!isLocallyOwned()) {
+        // while we own it nobody else can move it (the entity-server squashes their physical edits)
+        // so transform and velocity changes only matter when someone else is the simulator
+        if (glm::distance2(_entity->getWorldPosition(), _knownPosition) > KNOWN_POSITION_TOLERANCE_SQUARED) {
+            flags |= Simulation::DIRTY_POSITION;
+        }
+        if (fabsf(glm::dot(_entity->getWorldOrientation(), _knownRotation)) < KNOWN_ROTATION_DOT_TOLERANCE) {
+            flags |= Simulation::DIRTY_ROTATION;
+        }
+        if (glm::distance2(_entity->getWorldVelocity(), _knownVelocity) > KNOWN_VELOCITY_TOLERANCE_SQUARED) {
+            flags |= Simulation::DIRTY_LINEAR_VELOCITY;
+        }
+        if (glm::distance2(_entity->getWorldAngularVelocity(), _knownAngularVelocity) > KNOWN_VELOCITY_TOLERANCE_SQUARED) {
+            flags |= Simulation::DIRTY_ANGULAR_VELOCITY;
+        }
+    }
+
+    if (_entity->getScaledDimensions() != _knownDimensions) {
+        flags |= Simulation::DIRTY_SHAPE | Simulation::DIRTY_MASS;
+    }
+    if (_entity->getSimulatorID() != _knownSimulatorID) {
+        flags |= Simulation::DIRTY_SIMULATOR_ID;
+    }
+    if (_entity->getDynamic() != _knownDynamic || computePhysicsMotionType() != _motionType) {
+        flags |= Simulation::DIRTY_MOTION_TYPE;
+    }
+    if (_entity->getCollisionless() != _knownCollisionless || _entity->getCollisionMask() != _knownCollisionMask) {
+        flags |= Simulation::DIRTY_COLLISION_GROUP;
+    }
+    return flags;
+}
+
+void ServerEntityMotionState::clearIncomingDirtyFlags(uint32_t mask) {
+    if (_body) {
+        syncWithEntity();
+    }
+}
+
+void ServerEntityMotionState::computeCollisionGroupAndMask(int32_t& group, int32_t& mask) const {
+    _entity->computeCollisionGroupAndFinalMask(group, mask);
+}
+
+void ServerEntityMotionState::syncWithEntity() {
+    _knownPosition = _entity->getWorldPosition();
+    _knownRotation = _entity->getWorldOrientation();
+    _knownVelocity = _entity->getWorldVelocity();
+    _knownAngularVelocity = _entity->getWorldAngularVelocity();
+    _knownAcceleration = _entity->getAcceleration();
+    _knownDimensions = _entity->getScaledDimensions();
+    _knownSimulatorID = _entity->getSimulatorID();
+    _knownDynamic = _entity->getDynamic();
+    _knownCollisionless = _entity->getCollisionless();
+    _knownCollisionMask = _entity->getCollisionMask();
+}
+
+float ServerEntityMotionState::computePublishError(uint64_t now) const {
+    if (!_hasUnpublishedResults) {
+        return 0.0f;
+    }
+    // observers extrapolate from the last published state
+    float dt = (float)(now - _lastPublished) / (float)USECS_PER_SECOND;
+    glm::vec3 extrapolatedPosition = _knownPosition + dt * _knownVelocity + (0.5f * dt * dt) * _knownAcceleration;
+    float positionError = glm::distance2(extrapolatedPosition, _bodyPosition) /
+        (MAX_PUBLISH_POSITION_ERROR * MAX_PUBLISH_POSITION_ERROR);
+
+    float rotationError = (1.0f - fabsf(glm::dot(_knownRotation, _bodyRotation))) / MAX_PUBLISH_ROTATION_DOT_ERROR;
+
+    // coming to rest must be published promptly or observers will extrapolate forever
+    bool stopped = glm::length2(_bodyVelocity) == 0.0f && glm::length2(_knownVelocity) > 0.0f;
+
+    return stopped ? 1.0f : glm::max(positionError, rotationError);
+}
+
+void ServerEntityMotionState::markPublished(uint64_t now) {
+    _lastPublished = now;
+    _hasUnpublishedResults = false;
+    syncWithEntity();
+}
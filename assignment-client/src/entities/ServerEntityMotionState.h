@@ -0,0 +1,119 @@
+//
+//  ServerEntityMotionState.h
+//  assignment-client/src/entities
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ServerEntityMotionState_h
+#define hifi_ServerEntityMotionState_h
+
+#include <EntityItem.h>
+#include <ObjectMotionState.h>
+
+// The entity-server's MotionState for an entity simulated by the ServerPhysicsSimulation.
+//
+// Unlike the client's EntityMotionState it never writes into the EntityItem directly: the tree is owned by the
+// entity-server and its edits must go through EntityTree::updateEntity() like everyone else's.  Instead the results
+// of each step are held here until the ServerPhysicsSimulation decides they are worth publishing.
+//
+// The entity-server clears the entity's dirty flags as soon as its SimpleEntitySimulation has seen them, so incoming
+// changes (network edits from other simulators) are detected by comparing the entity against the last state we knew.
+
+class ServerEntityMotionState : public ObjectMotionState {
+public:
+    ServerEntityMotionState() = delete;
+    ServerEntityMotionState(const btCollisionShape* shape, EntityItemPointer entity, const QUuid& serverID);
+    virtual ~ServerEntityMotionState();
+
+    // ObjectMotionState overrides
+    virtual PhysicsMotionType computePhysicsMotionType() const override;
+    virtual bool isMoving() const override;
+
+    virtual void getWorldTransform(btTransform& worldTrans) const override;
+    virtual void setWorldTransform(const btTransform& worldTrans) override;
+
+    virtual uint32_t getIncomingDirtyFlags() const override;
+    virtual void clearIncomingDirtyFlags(uint32_t mask = DIRTY_PHYSICS_FLAGS) override;
+
+    virtual float getObjectRestitution() const override { return _entity->getRestitution(); }
+    virtual float getObjectFriction() const override { return _entity->getFriction(); }
+    virtual float getObjectLinearDamping() const override { return _entity->getDamping(); }
+    virtual float getObjectAngularDamping() const override { return _entity->getAngularDamping(); }
+
+    virtual glm::vec3 getObjectPosition() const override { return _entity->getWorldPosition() - ObjectMotionState::getWorldOffset(); }
+    virtual glm::quat getObjectRotation() const override { return _entity->getWorldOrientation(); }
+    virtual glm::vec3 getObjectLinearVelocity() const override { return _entity->getWorldVelocity(); }
+    virtual glm::vec3 getObjectAngularVelocity() const override { return _entity->getWorldAngularVelocity(); }
+    virtual glm::vec3 getObjectGravity() const override { return _entity->getGravity(); }
+
+    virtual const QUuid getObjectID() const override { return _entity->getID(); }
+    virtual uint8_t getSimulationPriority() const override { return _entity->getSimulationPriority(); }
+    virtual QUuid getSimulatorID() const override { return _entity->getSimulatorID(); }
+    virtual QString getName() const override { return _entity->getName(); }
+    virtual ShapeType getShapeType() const override { return _entity->getShapeType(); }
+
+    virtual void computeCollisionGroupAndMask(int32_t& group, int32_t& mask) const override;
+
+    virtual bool isLocallyOwned() const override { return _entity->getSimulatorID() == _serverID; }
+
+    const EntityItemPointer& getEntity() const { return _entity; }
+
+    void replaceShape(const btCollisionShape* shape) { setShape(shape); }
+
+    /// the entity is dynamic and nobody else simulates it, so the server may
+    bool isServerSimulated() const;
+
+    /// copy the entity's current state into our record of what the rest of the world knows
+    void syncWithEntity();
+
+    /// \return squared distance between where remote observers extrapolate the entity and where the body really is
+    float computePublishError(uint64_t now) const;
+
+    /// record that the body state was just published
+    void markPublished(uint64_t now);
+
+    bool hasUnpublishedResults() const { return _hasUnpublishedResults; }
+    const glm::vec3& getBodyPosition() const { return _bodyPosition; }
+    const glm::quat& getBodyRotation() const { return _bodyRotation; }
+    const glm::vec3& getBodyVelocity() const { return _bodyVelocity; }
+    const glm::vec3& getBodyAngularVelocity() const { return _bodyAngularVelocity; }
+
+    /// \return gravity once the body has been falling freely for a few substeps, else zero
+    glm::vec3 getBodyAcceleration() const;
+    uint64_t getLastPublished() const { return _lastPublished; }
+
+protected:
+    EntityItemPointer _entity;
+    const QUuid _serverID;
+
+    // what we last knew of the entity (either because we published it or because we synced from it)
+    glm::vec3 _knownPosition;
+    glm::quat _knownRotation;
+    glm::vec3 _knownVelocity;
+    glm::vec3 _knownAngularVelocity;
+    glm::vec3 _knownAcceleration;
+    glm::vec3 _knownDimensions;
+    QUuid _knownSimulatorID;
+    bool _knownDynamic { false };
+    bool _knownCollisionless { false };
+    uint8_t _knownCollisionMask { 0 };
+
+    // the most recent simulation results
+    glm::vec3 _bodyPosition;
+    glm::quat _bodyRotation;
+    glm::vec3 _bodyVelocity;
+    glm::vec3 _bodyAngularVelocity;
+
+    // for deciding whether the body is ballistic, as EntityMotionState::measureBodyAcceleration() does
+    uint32_t _lastMeasureStep { 0 };
+    uint8_t _accelerationNearlyGravityCount { 0 };
+
+    uint64_t _lastPublished { 0 };
+    bool _hasUnpublishedResults { false };
+};
+
+#endif // hifi_ServerEntityMotionState_h
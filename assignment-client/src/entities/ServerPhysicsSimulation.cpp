@@ -0,0 +1,401 @@
+//
+//  ServerPhysicsSimulation.cpp
+//  assignment-client/src/entities
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "ServerPhysicsSimulation.h"
+
+#include <algorithm>
+
+#include <NodeList.h>
+#include <PhysicsHelpers.h>
+#include <PickFilter.h>
+#include <SharedUtil.h>
+#include <SimulationOwner.h>
+#include <ZoneEntityItem.h>
+
+#include "ServerEntityMotionState.h"
+
+const int ServerPhysicsSimulation::DEFAULT_MAX_UPDATES_PER_SECOND = 600;
+
+// how often we look for entities entering or leaving the simulated zones
+const uint64_t MEMBERSHIP_UPDATE_PERIOD = USECS_PER_SECOND / 2;
+
+// the budget may accumulate for this long so that a burst of collisions needn't wait a full second
+const float MAX_UPDATE_BUDGET_PERIOD = 0.25f; // seconds
+
+// the entity-server has no model geometry, so model shapes collide as their bounding box here:
+// the same fallback RenderableModelEntityItem uses for models too big to mesh
+static void computeServerShapeInfo(const EntityItemPointer& entity, ShapeInfo& shapeInfo) {
+    ShapeType shapeType = entity->getShapeType();
+    if (shapeType == SHAPE_TYPE_STATIC_MESH || shapeType == SHAPE_TYPE_COMPOUND ||
+            shapeType == SHAPE_TYPE_SIMPLE_COMPOUND || shapeType == SHAPE_TYPE_SIMPLE_HULL) {
+        shapeInfo.setParams(SHAPE_TYPE_BOX, 0.5f * entity->getScaledDimensions());
+        entity->adjustShapeInfoByRegistration(shapeInfo);
+    } else {
+        entity->computeShapeInfo(shapeInfo);
+    }
+}
+
+// the queryAACube must enclose the entity (and its descendants) where the body is,
+// otherwise the octree keeps it in the element it started from and viewers cull it
+static AACube computeQueryAACube(const EntityItemPointer& entity, const glm::vec3& bodyPosition) {
+    bool success;
+    AACube cube = entity->getMaximumAACube(success);
+    if (!success) {
+        return AACube(bodyPosition, 0.0f);
+    }
+    glm::vec3 offset = bodyPosition - entity->getWorldPosition();
+    cube = AACube(cube.getCorner() + offset, cube.getScale());
+    entity->forEachDescendant([&](const SpatiallyNestablePointer& descendant) {
+        bool childSuccess;
+        AACube descendantCube = descendant->getQueryAACube(childSuccess);
+        if (childSuccess) {
+            cube += descendantCube.getMinimumPoint() + offset;
+            cube += descendantCube.getMaximumPoint() + offset;
+        }
+    });
+    return cube;
+}
+
+ServerPhysicsSimulation::ServerPhysicsSimulation(EntityTreePointer tree, const QVector<QUuid>& zoneIDs, int maxUpdatesPerSecond) :
+    _tree(tree),
+    _zoneIDs(zoneIDs),
+    _maxUpdatesPerSecond(std::max(1, maxUpdatesPerSecond))
+{
+    _thread.setObjectName("Server Physics");
+}
+
+ServerPhysicsSimulation::~ServerPhysicsSimulation() {
+    stop();
+}
+
+void ServerPhysicsSimulation::start() {
+    if (_thread.isRunning()) {
+        return;
+    }
+    moveToThread(&_thread);
+    connect(&_thread, &QThread::started, this, &ServerPhysicsSimulation::init);
+    _thread.start();
+}
+
+void ServerPhysicsSimulation::stop() {
+    if (!_thread.isRunning()) {
+        return;
+    }
+    // the engine, its shapes and the motionStates all live on our thread --> tear them down there
+    QMetaObject::invokeMethod(this, "shutdown", Qt::BlockingQueuedConnection);
+    _thread.quit();
+    _thread.wait();
+}
+
+void ServerPhysicsSimulation::init() {
+    _shapeManager.reset(new ShapeManager());
+    ObjectMotionState::setShapeManager(_shapeManager.get());
+
+    _physicsEngine.reset(new PhysicsEngine(Vectors::ZERO));
+    _physicsEngine->init();
+
+    _stepTimer = new QTimer(this);
+    _stepTimer->setTimerType(Qt::PreciseTimer);
+    connect(_stepTimer, &QTimer::timeout, this, &ServerPhysicsSimulation::update);
+    _stepTimer->start((int)(PHYSICS_ENGINE_FIXED_SUBSTEP * (float)MSECS_PER_SECOND));
+
+    qDebug() << "Server physics simulating" << _zoneIDs.size() << "zone(s) with at most"
+        << _maxUpdatesPerSecond << "updates per second";
+}
+
+void ServerPhysicsSimulation::shutdown() {
+    if (_stepTimer) {
+        _stepTimer->stop();
+        _stepTimer->deleteLater();
+        _stepTimer = nullptr;
+    }
+    if (!_physicsEngine) {
+        return;
+    }
+
+    uint64_t now = usecTimestampNow();
+    _tree->withWriteLock([&] {
+        foreach (ServerEntityMotionState* motionState, _motionStates) {
+            releaseOwnership(motionState, now);
+        }
+    });
+
+    _transaction.clear();
+    foreach (ServerEntityMotionState* motionState, _motionStates) {
+        _transaction.objectsToRemove.push_back(motionState);
+    }
+    _physicsEngine->processTransaction(_transaction);
+    for (auto object : _transaction.objectsToRemove) {
+        delete object;
+    }
+    _transaction.clear();
+    _motionStates.clear();
+
+    _physicsEngine.reset();
+    _shapeManager->collectGarbage();
+    _shapeManager.reset();
+}
+
+void ServerPhysicsSimulation::update() {
+    QUuid serverID = DependencyManager::get<NodeList>()->getSessionUUID();
+    if (serverID.isNull()) {
+        // not yet connected to a domain --> nobody to publish to
+        return;
+    }
+
+    uint64_t now = usecTimestampNow();
+    if (now - _lastMembershipUpdate > MEMBERSHIP_UPDATE_PERIOD) {
+        updateMembership(serverID);
+        _lastMembershipUpdate = now;
+    }
+
+    _tree->withReadLock([&] {
+        processIncomingChanges();
+        _physicsEngine->stepSimulation();
+    });
+    ++_numSteps;
+
+    // we don't report collisions but the engine prunes its contact map as they are harvested
+    _physicsEngine->getCollisionEvents();
+
+    float dt = _lastStep == 0 ? PHYSICS_ENGINE_FIXED_SUBSTEP : (float)(now - _lastStep) / (float)USECS_PER_SECOND;
+    _lastStep = now;
+    _updateBudget = std::min(_updateBudget + dt * (float)_maxUpdatesPerSecond,
+        MAX_UPDATE_BUDGET_PERIOD * (float)_maxUpdatesPerSecond);
+
+    if (_physicsEngine->hasOutgoingChanges()) {
+        // results are harvested by scanning our own motionStates, but this also puts active static bodies back to sleep
+        _physicsEngine->getChangedMotionStates();
+        publishResults(serverID, now);
+    }
+}
+
+void ServerPhysicsSimulation::updateMembership(const QUuid& serverID) {
+    QVector<EntityItemPointer> entitiesToAdd;
+    QVector<ServerEntityMotionState*> statesToRemove;
+
+    _tree->withReadLock([&] {
+        QSet<QUuid> inside;
+        for (const auto& zoneID : _zoneIDs) {
+            auto zone = std::dynamic_pointer_cast<ZoneEntityItem>(_tree->findEntityByID(zoneID));
+            if (!zone) {
+                continue;
+            }
+            bool success;
+            AABox box = zone->getAABox(success);
+            if (!success) {
+                continue;
+            }
+            QVector<QUuid> candidates;
+            unsigned int searchFilter = PickFilter::getBitMask(PickFilter::FlagBit::DOMAIN_ENTITIES);
+            _tree->evalEntitiesInBox(box, PickFilter(searchFilter), candidates);
+            for (const auto& id : candidates) {
+                EntityItemPointer entity = _tree->findEntityByID(id);
+                if (!entity || !entity->shouldBePhysical() || !entity->isReadyToComputeShape() ||
+                        !zone->contains(entity->getWorldPosition())) {
+                    continue;
+                }
+                inside.insert(id);
+                if (!_motionStates.contains(id)) {
+                    entitiesToAdd.push_back(entity);
+                }
+            }
+        }
+
+        foreach (ServerEntityMotionState* motionState, _motionStates) {
+            const EntityItemPointer& entity = motionState->getEntity();
+            if (entity->isDead() || !inside.contains(entity->getID())) {
+                statesToRemove.push_back(motionState);
+            }
+        }
+
+        _transaction.clear();
+        for (const auto& entity : entitiesToAdd) {
+            addEntity(entity, serverID);
+        }
+    });
+
+    if (!statesToRemove.isEmpty()) {
+        uint64_t now = usecTimestampNow();
+        _tree->withWriteLock([&] {
+            for (auto motionState : statesToRemove) {
+                if (!motionState->getEntity()->isDead()) {
+                    releaseOwnership(motionState, now);
+                }
+            }
+        });
+        for (auto motionState : statesToRemove) {
+            removeEntity(motionState);
+        }
+    }
+
+    if (!_transaction.objectsToAdd.empty() || !_transaction.objectsToRemove.empty()) {
+        _physicsEngine->processTransaction(_transaction);
+        for (auto object : _transaction.objectsToRemove) {
+            delete object;
+        }
+        _transaction.clear();
+    }
+    _numSimulated = _motionStates.size();
+}
+
+void ServerPhysicsSimulation::addEntity(const EntityItemPointer& entity, const QUuid& serverID) {
+    ShapeInfo shapeInfo;
+    computeServerShapeInfo(entity, shapeInfo);
+    const btCollisionShape* shape = ObjectMotionState::getShapeManager()->getShape(shapeInfo);
+    if (!shape) {
+        // failed to build shape --> will try again on the next membership update
+        return;
+    }
+    ServerEntityMotionState* motionState = new ServerEntityMotionState(shape, entity, serverID);
+    _motionStates.insert(entity->getID(), motionState);
+    _transaction.objectsToAdd.push_back(motionState);
+}
+
+void ServerPhysicsSimulation::removeEntity(ServerEntityMotionState* motionState) {
+    _motionStates.remove(motionState->getObjectID());
+    _transaction.objectsToRemove.push_back(motionState);
+}
+
+void ServerPhysicsSimulation::processIncomingChanges() {
+    _transaction.clear();
+    foreach (ServerEntityMotionState* motionState, _motionStates) {
+        uint32_t flags = motionState->getIncomingDirtyFlags();
+        if (flags == 0) {
+            continue;
+        }
+        if (flags & Simulation::DIRTY_SHAPE) {
+            ShapeInfo shapeInfo;
+            computeServerShapeInfo(motionState->getEntity(), shapeInfo);
+            const btCollisionShape* shape = ObjectMotionState::getShapeManager()->getShape(shapeInfo);
+            if (shape) {
+                motionState->replaceShape(shape);
+                motionState->setMass(motionState->getEntity()->computeMass());
+            }
+        }
+        if (flags & EASY_DIRTY_PHYSICS_FLAGS) {
+            motionState->handleEasyChanges(flags);
+        }
+        if (flags & (Simulation::DIRTY_MOTION_TYPE | Simulation::DIRTY_COLLISION_GROUP | Simulation::DIRTY_SHAPE)) {
+            _transaction.objectsToReinsert.push_back(motionState);
+        } else if (flags & Simulation::DIRTY_PHYSICS_ACTIVATION && motionState->getRigidBody()->isStaticObject()) {
+            _transaction.activeStaticObjects.push_back(motionState);
+        }
+        motionState->clearIncomingDirtyFlags();
+    }
+    if (!_transaction.objectsToReinsert.empty() || !_transaction.activeStaticObjects.empty()) {
+        _physicsEngine->processTransaction(_transaction);
+    }
+    _transaction.clear();
+}
+
+void ServerPhysicsSimulation::publishResults(const QUuid& serverID, uint64_t now) {
+    // rank candidates by how far viewers' extrapolations have drifted
+    std::vector<std::pair<float, ServerEntityMotionState*>> candidates;
+    int numActive = 0;
+    foreach (ServerEntityMotionState* motionState, _motionStates) {
+        if (motionState->getMotionType() != MOTION_TYPE_DYNAMIC || !motionState->isServerSimulated()) {
+            continue;
+        }
+        if (motionState->isActive()) {
+            ++numActive;
+        }
+        float error = motionState->computePublishError(now);
+        if (error < 1.0f && motionState->isLocallyOwned() &&
+                now - motionState->getLastPublished() > MAX_OUTGOING_SIMULATION_UPDATE_PERIOD) {
+            // heartbeat: keep the ownership from expiring while the body moves within tolerance
+            error = motionState->hasUnpublishedResults() ? 1.0f : 0.0f;
+        }
+        if (error >= 1.0f) {
+            candidates.push_back({ error, motionState });
+        }
+    }
+    _numActive = numActive;
+
+    // bodies that just fell asleep are published regardless of budget: otherwise they'd drift forever
+    const VectorOfMotionStates& deactivations = _physicsEngine->getDeactivatedMotionStates();
+
+    if (candidates.empty() && deactivations.empty()) {
+        return;
+    }
+
+    std::sort(candidates.begin(), candidates.end(),
+        [](const std::pair<float, ServerEntityMotionState*>& a, const std::pair<float, ServerEntityMotionState*>& b) {
+            return a.first > b.first;
+        });
+    size_t numToPublish = std::min(candidates.size(), (size_t)std::max(0.0f, _updateBudget));
+    _numDeferred += candidates.size() - numToPublish;
+
+    _tree->withWriteLock([&] {
+        for (size_t i = 0; i < numToPublish; ++i) {
+            ServerEntityMotionState* motionState = candidates[i].second;
+            EntityItemProperties properties;
+            properties.setPosition(motionState->getBodyPosition());
+            properties.setRotation(motionState->getBodyRotation());
+            properties.setVelocity(motionState->getBodyVelocity());
+            properties.setAngularVelocity(motionState->getBodyAngularVelocity());
+            properties.setAcceleration(motionState->getBodyAcceleration());
+            properties.setQueryAACube(computeQueryAACube(motionState->getEntity(), motionState->getBodyPosition()));
+            properties.setLastEdited(now);
+            properties.setSimulationOwner(serverID, SCRIPT_POKE_SIMULATION_PRIORITY);
+            if (_tree->updateEntity(motionState->getObjectID(), properties)) {
+                ++_numPublished;
+            }
+            motionState->markPublished(now);
+        }
+        _updateBudget -= (float)numToPublish;
+
+        for (auto object : deactivations) {
+            ServerEntityMotionState* motionState = static_cast<ServerEntityMotionState*>(object);
+            if (motionState->isLocallyOwned()) {
+                releaseOwnership(motionState, now);
+            }
+        }
+    });
+}
+
+void ServerPhysicsSimulation::releaseOwnership(ServerEntityMotionState* motionState, uint64_t now) {
+    if (!motionState->isLocallyOwned()) {
+        return;
+    }
+    // leave the entity where the body is, at rest if the body is asleep, and let anyone else take it
+    EntityItemProperties properties;
+    properties.setPosition(motionState->getBodyPosition());
+    properties.setRotation(motionState->getBodyRotation());
+    if (motionState->isActive()) {
+        properties.setVelocity(motionState->getBodyVelocity());
+        properties.setAngularVelocity(motionState->getBodyAngularVelocity());
+        properties.setAcceleration(motionState->getBodyAcceleration());
+    } else {
+        properties.setVelocity(Vectors::ZERO);
+        properties.setAngularVelocity(Vectors::ZERO);
+        properties.setAcceleration(Vectors::ZERO);
+    }
+    properties.setQueryAACube(computeQueryAACube(motionState->getEntity(), motionState->getBodyPosition()));
+    properties.setLastEdited(now);
+    properties.clearSimulationOwner();
+    if (_tree->updateEntity(motionState->getObjectID(), properties)) {
+        ++_numPublished;
+    }
+    motionState->markPublished(now);
+}
+
+QString ServerPhysicsSimulation::getStatsString() const {
+    QString statsString;
+    statsString += "<b>Entity Server Physics Statistics</b>\r\n";
+    statsString += QString("Simulated zones ......... %1\r\n").arg(_zoneIDs.size());
+    statsString += QString("Simulated entities ...... %1\r\n").arg(_numSimulated.load());
+    statsString += QString("Active entities ......... %1\r\n").arg(_numActive.load());
+    statsString += QString("Steps ................... %1\r\n").arg(_numSteps.load());
+    statsString += QString("Published updates ....... %1\r\n").arg(_numPublished.load());
+    statsString += QString("Deferred updates ........ %1\r\n").arg(_numDeferred.load());
+    statsString += "\r\n\r\n";
+    return statsString;
+}
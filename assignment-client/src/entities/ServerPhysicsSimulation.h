@@ -0,0 +1,91 @@
+//
+//  ServerPhysicsSimulation.h
+//  assignment-client/src/entities
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ServerPhysicsSimulation_h
+#define hifi_ServerPhysicsSimulation_h
+
+#include <atomic>
+#include <memory>
+
+#include <QHash>
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QUuid>
+#include <QVector>
+
+#include <EntityTree.h>
+#include <PhysicsEngine.h>
+#include <ShapeManager.h>
+
+class ServerEntityMotionState;
+
+// Authoritative physics for the entity-server.
+//
+// Dynamic entities inside the configured zones are simulated here, on a dedicated thread, instead of by whichever
+// interface happens to volunteer.  The server claims simulation ownership at SCRIPT_POKE priority so ordinary
+// client bids can't steal it back, while a grab (which bids higher) still takes over until it is released.
+//
+// Results are published through EntityTree::updateEntity() so they reach the viewers exactly like edits from any
+// other simulator.  Entities are only published when the error between the body and what viewers would extrapolate
+// from the last update becomes noticeable, and the total number of updates per second is capped: when over budget
+// the entities with the largest errors go first.
+
+class ServerPhysicsSimulation : public QObject {
+    Q_OBJECT
+public:
+    static const int DEFAULT_MAX_UPDATES_PER_SECOND;
+
+    ServerPhysicsSimulation(EntityTreePointer tree, const QVector<QUuid>& zoneIDs, int maxUpdatesPerSecond);
+    ~ServerPhysicsSimulation();
+
+    void start();
+    void stop();
+
+    QString getStatsString() const;
+
+private slots:
+    void init();
+    void update();
+    void shutdown();
+
+private:
+    void updateMembership(const QUuid& serverID);
+    void addEntity(const EntityItemPointer& entity, const QUuid& serverID);
+    void removeEntity(ServerEntityMotionState* motionState);
+    void processIncomingChanges();
+    void publishResults(const QUuid& serverID, uint64_t now);
+    void releaseOwnership(ServerEntityMotionState* motionState, uint64_t now);
+
+    EntityTreePointer _tree;
+    QVector<QUuid> _zoneIDs;
+    int _maxUpdatesPerSecond;
+
+    QThread _thread;
+    QTimer* _stepTimer { nullptr };
+
+    std::unique_ptr<ShapeManager> _shapeManager;
+    std::unique_ptr<PhysicsEngine> _physicsEngine;
+    PhysicsEngine::Transaction _transaction;
+
+    QHash<QUuid, ServerEntityMotionState*> _motionStates;
+
+    uint64_t _lastMembershipUpdate { 0 };
+    uint64_t _lastStep { 0 };
+    float _updateBudget { 0.0f };
+
+    std::atomic<int> _numSimulated { 0 };
+    std::atomic<int> _numActive { 0 };
+    std::atomic<uint64_t> _numSteps { 0 };
+    std::atomic<uint64_t> _numPublished { 0 };
+    std::atomic<uint64_t> _numDeferred { 0 };
+};
+
+#endif // hifi_ServerPhysicsSimulation_h
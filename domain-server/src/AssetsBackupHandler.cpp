@@ -10,6 +10,7 @@
 //
 
 #include "AssetsBackupHandler.h"
+#include "BackupArchiveWriter.h"
 
 #include <QJsonDocument>
 #include <QDate>
@@ -36,6 +37,7 @@
 using namespace std;
 
 static const QString ASSETS_DIR { "/assets/" };
+static const QString DEFLATED_ASSETS_DIR { "deflated/" };
 static const QString MAPPINGS_FILE { "mappings.json" };
 static const QString ZIP_ASSETS_FOLDER { "files" };
 static const chrono::minutes MAX_REFRESH_TIME { 5 };
@@ -49,6 +51,7 @@ AssetsBackupHandler::AssetsBackupHandler(const QString& backupDirectory, bool as
 {
     // Make sure the asset directory exists.
     QDir(_assetsDirectory).mkpath(".");
+    QDir(_assetsDirectory + DEFLATED_ASSETS_DIR).mkpath(".");
 
     refreshAssetsOnDisk();
 
@@ -84,6 +87,13 @@ void AssetsBackupHandler::refreshAssetsOnDisk() {
             inserter(_assetsOnDisk, begin(_assetsOnDisk)),
             AssetUtils::isValidHash);
 
+    // drop compressed copies of assets that are gone
+    QDir deflatedAssetsDir { _assetsDirectory + DEFLATED_ASSETS_DIR };
+    for (const auto& deflatedAssetName : deflatedAssetsDir.entryList(QDir::Files)) {
+        if (_assetsOnDisk.find(deflatedAssetName) == end(_assetsOnDisk)) {
+            deflatedAssetsDir.remove(deflatedAssetName);
+        }
+    }
 }
 
 void AssetsBackupHandler::refreshAssetsInBackups() {
@@ -120,6 +130,7 @@ void AssetsBackupHandler::checkForAssetsToDelete() {
             for (const auto& hash : deprecatedAssets) {
                 auto success = QFile::remove(_assetsDirectory + hash);
                 if (success) {
+                    QFile::remove(_assetsDirectory + DEFLATED_ASSETS_DIR + hash);
                     _assetsOnDisk.erase(hash);
                 } else {
                     qCWarning(asset_backup) << "Could not delete asset:" << hash;
@@ -236,7 +247,7 @@ void AssetsBackupHandler::loadingComplete() {
     checkForAssetsToDelete();
 }
 
-void AssetsBackupHandler::createBackup(const QString& backupName, QuaZip& zip) {
+void AssetsBackupHandler::createBackup(const QString& backupName, BackupArchiveWriter& writer) {
     Q_ASSERT(QThread::currentThread() == thread());
 
     if (operationInProgress()) {
@@ -264,17 +275,7 @@ void AssetsBackupHandler::createBackup(const QString& backupName, QuaZip& zip) {
     }
     QJsonDocument document(jsonObject);
 
-    QuaZipFile zipFile { &zip };
-    if (!zipFile.open(QIODevice::WriteOnly, QuaZipNewInfo(MAPPINGS_FILE))) {
-        qCDebug(asset_backup) << "Could not open zip file:" << zipFile.getZipError();
-        return;
-    }
-    zipFile.write(document.toJson());
-    zipFile.close();
-    if (zipFile.getZipError() != UNZ_OK) {
-        qCDebug(asset_backup) << "Could not close zip file: " << zipFile.getZipError();
-        return;
-    }
+    writer.addEntry(MAPPINGS_FILE, document.toJson());
     _backups.emplace_back(backupName, mappings, false);
 }
 
@@ -378,7 +379,7 @@ void AssetsBackupHandler::deleteBackup(const QString& backupName) {
     qDebug() << "Deleted asset backup:" << backupName;
 }
 
-void AssetsBackupHandler::consolidateBackup(const QString& backupName, QuaZip& zip) {
+void AssetsBackupHandler::consolidateBackup(const QString& backupName, BackupArchiveWriter& writer) {
     Q_ASSERT(QThread::currentThread() == thread());
 
     if (operationInProgress()) {
@@ -394,29 +395,20 @@ void AssetsBackupHandler::consolidateBackup(const QString& backupName, QuaZip& z
         return;
     }
 
+    // assets are named by their hash, so several mappings can share one, and their compressed form
+    // from an earlier consolidation still holds
+    QDir assetsDir { _assetsDirectory };
+    QDir deflatedAssetsDir { _assetsDirectory + DEFLATED_ASSETS_DIR };
+    set<AssetUtils::AssetHash> consolidatedAssets;
     for (const auto& mapping : it->mappings) {
         const auto& hash = mapping.second;
-
-        QDir assetsDir { _assetsDirectory };
-        QFile file { assetsDir.filePath(hash) };
-        if (!file.open(QFile::ReadOnly)) {
-            qCCritical(asset_backup) << "Could not open asset file" << file.fileName();
+        if (!consolidatedAssets.insert(hash).second) {
             continue;
         }
 
-        QuaZipFile zipFile { &zip };
-        if (!zipFile.open(QIODevice::WriteOnly, QuaZipNewInfo(ZIP_ASSETS_FOLDER + "/" + hash))) {
-            qCDebug(asset_backup) << "Could not open zip file:" << zipFile.getZipError();
-            continue;
-        }
-        zipFile.write(file.readAll());
-        zipFile.close();
-        if (zipFile.getZipError() != UNZ_OK) {
-            qCDebug(asset_backup) << "Could not close zip file: " << zipFile.getZipError();
-            continue;
-        }
+        writer.addFile(ZIP_ASSETS_FOLDER + "/" + hash, assetsDir.filePath(hash), BackupArchiveWriter::Deflate,
+                       deflatedAssetsDir.filePath(hash));
     }
-
 }
 
 void AssetsBackupHandler::refreshMappings() {
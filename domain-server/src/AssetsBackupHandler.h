@@ -37,10 +37,10 @@ public:
 
     void loadBackup(const QString& backupName, QuaZip& zip) override;
     void loadingComplete() override;
-    void createBackup(const QString& backupName, QuaZip& zip) override;
+    void createBackup(const QString& backupName, BackupArchiveWriter& writer) override;
     std::pair<bool, QString> recoverBackup(const QString& backupName, QuaZip& zip, const QString& username, const QString& sourceFilename) override;
     void deleteBackup(const QString& backupName) override;
-    void consolidateBackup(const QString& backupName, QuaZip& zip) override;
+    void consolidateBackup(const QString& backupName, BackupArchiveWriter& writer) override;
     bool isCorruptedBackup(const QString& backupName) override;
 
     bool operationInProgress() { return getRecoveryStatus().first; }
@@ -0,0 +1,251 @@
+//
+//  BackupArchiveWriter.cpp
+//  domain-server/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "BackupArchiveWriter.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <zlib.h>
+
+#if !defined(__clang__) && defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsuggest-override"
+#endif
+
+#include <quazip5/quazip.h>
+#include <quazip5/quazipfile.h>
+
+#if !defined(__clang__) && defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+#include <NumericalConstants.h>
+
+// how many entries to keep compressing for each pool thread while the zip is written
+static const int PENDING_ENTRIES_PER_THREAD = 2;
+
+QVariantMap BackupArchiveWriter::Stats::toVariantMap() const {
+    float seconds = (float)durationMsecs / MSECS_PER_SECOND;
+    return {
+        { "entries", numEntries },
+        { "reusedEntries", numReusedEntries },
+        { "uncompressedBytes", uncompressedBytes },
+        { "compressedBytes", compressedBytes },
+        { "durationMillis", durationMsecs },
+        { "bytesPerSecond", seconds > 0.0f ? (qint64)(uncompressedBytes / seconds) : 0 }
+    };
+}
+
+BackupArchiveWriter::BackupArchiveWriter(QuaZip& zip) :
+    _zip(zip)
+{
+    _maxPendingEntries = PENDING_ENTRIES_PER_THREAD * _threadPool.maxThreadCount();
+    _timer.start();
+}
+
+void BackupArchiveWriter::addEntry(const QString& name, QByteArray data, Compression compression) {
+    auto dateTime = QDateTime::currentDateTime();
+    queueEntry(QtConcurrent::run(&_threadPool, [name, data, dateTime, compression] {
+        return compressEntry(name, data, dateTime, compression);
+    }));
+}
+
+void BackupArchiveWriter::addFile(const QString& name, const QString& filePath, Compression compression,
+                                  const QString& deflatedCachePath) {
+    queueEntry(QtConcurrent::run(&_threadPool, [name, filePath, compression, deflatedCachePath] {
+        return compressFile(name, filePath, compression, deflatedCachePath);
+    }));
+}
+
+bool BackupArchiveWriter::finish() {
+    while (!_pendingEntries.empty()) {
+        writeNextEntry();
+    }
+
+    _stats.durationMsecs = _timer.elapsed();
+    return !_hasError;
+}
+
+BackupArchiveWriter::Entry BackupArchiveWriter::compressEntry(const QString& name, const QByteArray& data,
+                                                              const QDateTime& dateTime, Compression compression) {
+    Entry entry;
+    entry.name = name;
+    entry.dateTime = dateTime;
+    entry.uncompressedSize = data.size();
+    entry.crc = crc32(crc32(0L, Z_NULL, 0), reinterpret_cast<const Bytef*>(data.constData()), data.size());
+
+    if (compression == Deflate) {
+        // zip entries are raw deflate streams, without a zlib header
+        z_stream stream {};
+        if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK) {
+            QByteArray deflated(deflateBound(&stream, data.size()), 0);
+            stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()));
+            stream.avail_in = data.size();
+            stream.next_out = reinterpret_cast<Bytef*>(deflated.data());
+            stream.avail_out = deflated.size();
+
+            int result = deflate(&stream, Z_FINISH);
+            deflated.resize(stream.total_out);
+            deflateEnd(&stream);
+
+            // a lot of assets are compressed already, and are stored as they are when deflate doesn't help
+            if (result == Z_STREAM_END && deflated.size() < data.size()) {
+                entry.data = deflated;
+                entry.method = Z_DEFLATED;
+                return entry;
+            }
+        }
+    }
+
+    entry.data = data;
+    entry.method = 0;
+    return entry;
+}
+
+BackupArchiveWriter::Entry BackupArchiveWriter::compressFile(const QString& name, const QString& filePath,
+                                                             Compression compression, const QString& deflatedCachePath) {
+    Entry entry;
+    QDateTime dateTime = QFileInfo(filePath).lastModified();
+
+    if (!deflatedCachePath.isEmpty() && readCachedEntry(deflatedCachePath, filePath, entry)) {
+        entry.name = name;
+        entry.dateTime = dateTime;
+        entry.isReused = true;
+        return entry;
+    }
+
+    QFile file { filePath };
+    if (!file.open(QIODevice::ReadOnly)) {
+        entry.name = name;
+        entry.error = "Could not open file " + filePath;
+        return entry;
+    }
+
+    entry = compressEntry(name, file.readAll(), dateTime, compression);
+
+    if (!deflatedCachePath.isEmpty()) {
+        writeCachedEntry(deflatedCachePath, entry);
+    }
+    return entry;
+}
+
+// A cached entry is its method, CRC and uncompressed size, followed by the deflated data.  Stored entries are read
+// from their file again, since they are the same bytes.
+bool BackupArchiveWriter::readCachedEntry(const QString& cachePath, const QString& filePath, Entry& entry) {
+    QFile cacheFile { cachePath };
+    if (!cacheFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream cacheStream(&cacheFile);
+    quint8 method;
+    quint32 crc;
+    qint64 uncompressedSize;
+    cacheStream >> method >> crc >> uncompressedSize;
+    if (cacheStream.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    QByteArray data;
+    if (method == Z_DEFLATED) {
+        data = cacheFile.readAll();
+    } else {
+        QFile file { filePath };
+        if (!file.open(QIODevice::ReadOnly)) {
+            return false;
+        }
+        data = file.readAll();
+        if (data.size() != uncompressedSize) {
+            return false;
+        }
+    }
+
+    entry.data = data;
+    entry.method = method;
+    entry.crc = crc;
+    entry.uncompressedSize = uncompressedSize;
+    return true;
+}
+
+void BackupArchiveWriter::writeCachedEntry(const QString& cachePath, const Entry& entry) {
+    // the whole entry or nothing, so a half written one is never mistaken for a good one
+    QSaveFile cacheFile { cachePath };
+    if (!cacheFile.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not open" << cachePath << "to cache the compressed" << entry.name;
+        return;
+    }
+
+    QDataStream cacheStream(&cacheFile);
+    cacheStream << (quint8)entry.method << entry.crc << entry.uncompressedSize;
+    if (entry.method == Z_DEFLATED) {
+        cacheFile.write(entry.data);
+    }
+
+    if (!cacheFile.commit()) {
+        qWarning() << "Could not cache the compressed" << entry.name << "at" << cachePath;
+    }
+}
+
+void BackupArchiveWriter::queueEntry(QFuture<Entry> entry) {
+    _pendingEntries.push_back(entry);
+
+    while ((int)_pendingEntries.size() > _maxPendingEntries) {
+        writeNextEntry();
+    }
+}
+
+void BackupArchiveWriter::writeNextEntry() {
+    Entry entry = _pendingEntries.front().result();
+    _pendingEntries.pop_front();
+
+    if (!entry.error.isEmpty()) {
+        // like a missing asset, this leaves the entry out but the archive is still good
+        qCritical() << "Could not add" << entry.name << "to backup:" << entry.error;
+        return;
+    }
+
+    QuaZipNewInfo info { entry.name };
+    if (entry.dateTime.isValid()) {
+        info.dateTime = entry.dateTime;
+    }
+    info.uncompressedSize = entry.uncompressedSize;
+
+    // the entry is compressed already, so it goes in raw
+    QuaZipFile zipFile { &_zip };
+    if (!zipFile.open(QIODevice::WriteOnly, info, nullptr, entry.crc, entry.method, Z_DEFAULT_COMPRESSION, true)) {
+        qCritical() << "Could not open" << entry.name << "for writing in zip:" << zipFile.getZipError();
+        _hasError = true;
+        return;
+    }
+
+    if (zipFile.write(entry.data) != entry.data.size()) {
+        qCritical() << "Could not write" << entry.name << "to zip:" << zipFile.getZipError();
+        _hasError = true;
+    }
+
+    zipFile.close();
+    if (zipFile.getZipError() != UNZ_OK) {
+        qCritical() << "Could not close" << entry.name << "in zip:" << zipFile.getZipError();
+        _hasError = true;
+        return;
+    }
+
+    ++_stats.numEntries;
+    if (entry.isReused) {
+        ++_stats.numReusedEntries;
+    }
+    _stats.uncompressedBytes += entry.uncompressedSize;
+    _stats.compressedBytes += entry.data.size();
+}
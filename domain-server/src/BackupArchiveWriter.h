@@ -0,0 +1,90 @@
+//
+//  BackupArchiveWriter.h
+//  domain-server/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_BackupArchiveWriter_h
+#define hifi_BackupArchiveWriter_h
+
+#include <deque>
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QString>
+#include <QThreadPool>
+#include <QVariantMap>
+
+class QuaZip;
+
+// Adds entries to a backup zip, compressing them on a pool of threads.  Entries go into the zip in the order they
+// were added, each as soon as it and the ones before it are compressed, so only a few are held in memory at once.
+class BackupArchiveWriter {
+public:
+    enum Compression {
+        Deflate,
+        Store // for data that is already compressed
+    };
+
+    struct Stats {
+        int numEntries { 0 };
+        int numReusedEntries { 0 };
+        qint64 uncompressedBytes { 0 };
+        qint64 compressedBytes { 0 };
+        qint64 durationMsecs { 0 };
+
+        QVariantMap toVariantMap() const;
+    };
+
+    BackupArchiveWriter(QuaZip& zip);
+
+    void addEntry(const QString& name, QByteArray data, Compression compression = Deflate);
+
+    // The file is read on the pool.  Files that never change for a given deflatedCachePath, like assets named by their
+    // hash, can keep their compressed form there, so the next archive they go into doesn't compress them again.
+    void addFile(const QString& name, const QString& filePath, Compression compression = Deflate,
+                 const QString& deflatedCachePath = QString());
+
+    // Waits for every entry to go into the zip, returns false if the zip couldn't be written
+    bool finish();
+
+    const Stats& getStats() const { return _stats; }
+
+private:
+    struct Entry {
+        QString name;
+        QDateTime dateTime;
+        QByteArray data;
+        quint32 crc { 0 };
+        qint64 uncompressedSize { 0 };
+        int method { 0 };
+        bool isReused { false };
+        QString error;
+    };
+
+    static Entry compressEntry(const QString& name, const QByteArray& data, const QDateTime& dateTime,
+                               Compression compression);
+    static Entry compressFile(const QString& name, const QString& filePath, Compression compression,
+                              const QString& deflatedCachePath);
+    static bool readCachedEntry(const QString& cachePath, const QString& filePath, Entry& entry);
+    static void writeCachedEntry(const QString& cachePath, const Entry& entry);
+
+    void queueEntry(QFuture<Entry> entry);
+    void writeNextEntry();
+
+    QuaZip& _zip;
+    QThreadPool _threadPool;
+    std::deque<QFuture<Entry>> _pendingEntries;
+    int _maxPendingEntries;
+
+    QElapsedTimer _timer;
+    Stats _stats;
+    bool _hasError { false };
+};
+
+#endif // hifi_BackupArchiveWriter_h
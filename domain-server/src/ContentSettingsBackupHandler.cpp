@@ -10,6 +10,7 @@
 //
 
 #include "ContentSettingsBackupHandler.h"
+#include "BackupArchiveWriter.h"
 #include "DomainContentBackupManager.h"
 
 #if !defined(__clang__) && defined(__GNUC__)
@@ -34,7 +35,7 @@ ContentSettingsBackupHandler::ContentSettingsBackupHandler(DomainServerSettingsM
 
 static const QString CONTENT_SETTINGS_BACKUP_FILENAME = "content-settings.json";
 
-void ContentSettingsBackupHandler::createBackup(const QString& backupName, QuaZip& zip) {
+void ContentSettingsBackupHandler::createBackup(const QString& backupName, BackupArchiveWriter& writer) {
 
     // grab the content settings as JSON, excluding default values and values hidden from backup
     QJsonObject contentSettingsJSON = _settingsManager.settingsResponseObjectForType(
@@ -67,21 +68,7 @@ void ContentSettingsBackupHandler::createBackup(const QString& backupName, QuaZi
     // make a QJsonDocument using the object
     QJsonDocument contentSettingsDocument { contentSettingsJSON };
 
-    QuaZipFile zipFile { &zip };
-
-    if (zipFile.open(QIODevice::WriteOnly, QuaZipNewInfo(CONTENT_SETTINGS_BACKUP_FILENAME))) {
-        if (zipFile.write(contentSettingsDocument.toJson()) == -1) {
-            qCritical().nospace() << "Failed to write to " << CONTENT_SETTINGS_BACKUP_FILENAME << ": " << zipFile.getZipError();
-        }
-
-        zipFile.close();
-
-        if (zipFile.getZipError() != UNZ_OK) {
-            qCritical().nospace() << "Failed to zip " << CONTENT_SETTINGS_BACKUP_FILENAME << ": " << zipFile.getZipError();
-        }
-    } else {
-        qCritical().nospace() << "Failed to open " << CONTENT_SETTINGS_BACKUP_FILENAME << ": " << zipFile.getZipError();
-    }
+    writer.addEntry(CONTENT_SETTINGS_BACKUP_FILENAME, contentSettingsDocument.toJson());
 }
 
 std::pair<bool, QString> ContentSettingsBackupHandler::recoverBackup(const QString& backupName, QuaZip& zip, const QString& username, const QString& sourceFilename) {
@@ -26,13 +26,13 @@ public:
 
     void loadingComplete() override {}
 
-    void createBackup(const QString& backupName, QuaZip& zip) override;
+    void createBackup(const QString& backupName, BackupArchiveWriter& writer) override;
 
     std::pair<bool, QString> recoverBackup(const QString& backupName, QuaZip& zip, const QString& username, const QString& sourceFilename) override;
 
     void deleteBackup(const QString& backupName) override {}
 
-    void consolidateBackup(const QString& backupName, QuaZip& zip) override {}
+    void consolidateBackup(const QString& backupName, BackupArchiveWriter& writer) override {}
 
     bool isCorruptedBackup(const QString& backupName) override { return false; }
 
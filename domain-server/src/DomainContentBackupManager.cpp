@@ -36,6 +36,7 @@
 #include <PathUtils.h>
 #include <shared/QtHelpers.h>
 
+#include "BackupArchiveWriter.h"
 #include "DomainServer.h"
 
 const std::chrono::seconds DomainContentBackupManager::DEFAULT_PERSIST_INTERVAL { 30 };
@@ -491,6 +492,14 @@ void DomainContentBackupManager::getAllBackupsAndStatus(MiniPromise::Promise pro
         status["recoveryError"] = _recoveryError;
     }
 
+    // how long the last archives took to write, and how big they came out
+    if (_lastBackupStats.numEntries > 0) {
+        status["lastBackup"] = _lastBackupStats.toVariantMap();
+    }
+    if (_lastConsolidationStats.numEntries > 0) {
+        status["lastConsolidation"] = _lastConsolidationStats.toVariantMap();
+    }
+
 
     QString filename = _settingsManager.valueForKeyPath(CONTENT_SETTINGS_INSTALLED_CONTENT_FILENAME).toString();
     QString name = _settingsManager.valueForKeyPath(CONTENT_SETTINGS_INSTALLED_CONTENT_NAME).toString();
@@ -675,13 +684,18 @@ void DomainContentBackupManager::consolidateBackupInternal(QString fileName) {
         return;
     }
 
+    BackupArchiveWriter writer { zip };
     for (auto& handler : _backupHandlers) {
-        handler->consolidateBackup(fileName, zip);
+        handler->consolidateBackup(fileName, writer);
     }
+    bool wroteArchive = writer.finish();
 
     zip.close();
 
-    if (zip.getZipError() != UNZ_OK) {
+    _lastConsolidationStats = writer.getStats();
+    qCDebug(domain_server) << "Consolidated backup" << fileName << "-" << _lastConsolidationStats.toVariantMap();
+
+    if (!wroteArchive || zip.getZipError() != UNZ_OK) {
         qCritical() << "Failed to consolidate backup: " << zip.getZipError();
         markFailure("Failed to consolidate backup");
         return;
@@ -731,11 +745,27 @@ std::pair<bool, QString> DomainContentBackupManager::createBackup(const QString&
         return { false, path };
     }
 
+    // the handlers add their parts, which are compressed in parallel as they go into the zip
+    BackupArchiveWriter writer { zip };
     for (auto& handler : _backupHandlers) {
-        handler->createBackup(fileName, zip);
+        handler->createBackup(fileName, writer);
     }
+    bool wroteArchive = writer.finish();
 
     zip.close();
 
+    _lastBackupStats = writer.getStats();
+
+    if (!wroteArchive || zip.getZipError() != UNZ_OK) {
+        qCWarning(domain_server) << "Failed to write backup at " << path;
+        qCWarning(domain_server) << "    ERROR:" << zip.getZipError();
+
+        // don't leave a partial archive around to be listed, recovered from, or rotated in place of a good one
+        QFile::remove(path);
+        return { false, path };
+    }
+
+    qCDebug(domain_server) << "Created backup" << fileName << "-" << _lastBackupStats.toVariantMap();
+
     return { true, path };
 }
@@ -27,6 +27,7 @@
 
 #include <GenericThread.h>
 
+#include "BackupArchiveWriter.h"
 #include "BackupHandler.h"
 #include "DomainServerSettingsManager.h"
 
@@ -144,6 +145,9 @@ private:
 
     p_high_resolution_clock::time_point _lastCheck;
     std::vector<BackupRule> _backupRules;
+
+    BackupArchiveWriter::Stats _lastBackupStats;
+    BackupArchiveWriter::Stats _lastConsolidationStats;
 };
 
 #endif  // hifi_DomainContentBackupManager_h
@@ -312,6 +312,10 @@ void DomainGatekeeper::updateNodePermissions() {
             userPerms = setPermissionsForUser(isLocalUser, verifiedUsername, connectingAddr.getAddress(), hardwareAddress, machineFingerprint);
         }
 
+        if (node->getPermissions().permissions != userPerms.permissions) {
+            // other nodes are sent the permission bits in their domain lists
+            _server->markNodeListChanged(node);
+        }
         node->setPermissions(userPerms);
 
         if (!userPerms.can(NodePermissions::Permission::canConnectToDomain)) {
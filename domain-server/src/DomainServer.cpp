@@ -20,6 +20,7 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QMessageAuthenticationCode>
 #include <QProcess>
 #include <QSharedMemory>
 #include <QRegularExpression>
@@ -172,6 +173,9 @@ DomainServer::DomainServer(int argc, char* argv[]) :
     DependencyManager::set<tracing::Tracer>();
     DependencyManager::set<StatTracker>();
 
+    // the request handler only lets authenticated requests through to /metrics
+    _httpManager.setMetricsEnabled(true);
+
     LogUtils::init();
 
     qDebug() << "Setting up domain-server";
@@ -1052,8 +1056,12 @@ void DomainServer::processListRequestPacket(QSharedPointer<ReceivedMessage> mess
     NodeConnectionData nodeRequestData = NodeConnectionData::fromDataStream(packetStream, message->getSenderSockAddr(), false);
 
     // update this node's sockets in case they have changed
-    sendingNode->setPublicSocket(nodeRequestData.publicSockAddr);
-    sendingNode->setLocalSocket(nodeRequestData.localSockAddr);
+    if (sendingNode->getPublicSocket() != nodeRequestData.publicSockAddr
+        || sendingNode->getLocalSocket() != nodeRequestData.localSockAddr) {
+        sendingNode->setPublicSocket(nodeRequestData.publicSockAddr);
+        sendingNode->setLocalSocket(nodeRequestData.localSockAddr);
+        markNodeListChanged(sendingNode);
+    }
 
     DomainServerNodeData* nodeData = static_cast<DomainServerNodeData*>(sendingNode->getLinkedData());
 
@@ -1070,8 +1078,11 @@ void DomainServer::processListRequestPacket(QSharedPointer<ReceivedMessage> mess
         safeInterestSet.remove(NodeType::Agent);
     }
 
-    // update the NodeInterestSet in case there have been any changes
-    nodeData->setNodeInterestSet(safeInterestSet);
+    // update the NodeInterestSet in case there have been any changes, the nodes of new types need a full list
+    if (safeInterestSet != nodeData->getNodeInterestSet()) {
+        nodeData->setNodeInterestSet(safeInterestSet);
+        nodeData->setLastFullDomainListTime(0);
+    }
 
     // update the connecting hostname in case it has changed
     nodeData->setPlaceName(nodeRequestData.placeName);
@@ -1079,7 +1090,8 @@ void DomainServer::processListRequestPacket(QSharedPointer<ReceivedMessage> mess
     // client-side send time of last connect/domain list request
     nodeData->setLastDomainCheckinTimestamp(nodeRequestData.lastPingTimestamp);
 
-    sendDomainListToNode(sendingNode, message->getFirstPacketReceiveTime(), message->getSenderSockAddr(), false);
+    sendDomainListToNode(sendingNode, message->getFirstPacketReceiveTime(), message->getSenderSockAddr(), false,
+                         nodeRequestData.domainListEpoch);
 }
 
 bool DomainServer::isInInterestSet(const SharedNodePointer& nodeA, const SharedNodePointer& nodeB) {
@@ -1157,38 +1169,88 @@ void DomainServer::handleConnectedNode(SharedNodePointer newNode, quint64 reques
         newNode->setIsReplicated(true);
     }
 
-    // send out this node to our other connected nodes
+    // send out this node to our other connected nodes, now and in the next domain list deltas
+    markNodeListChanged(newNode);
     broadcastNewNode(newNode);
 }
 
-void DomainServer::sendDomainListToNode(const SharedNodePointer& node, quint64 requestPacketReceiveTime, const HifiSockAddr &senderSockAddr, bool newConnection) {
-    const int NUM_DOMAIN_LIST_EXTENDED_HEADER_BYTES = NUM_BYTES_RFC4122_UUID + NLPacket::NUM_BYTES_LOCALID +
-        NUM_BYTES_RFC4122_UUID + NLPacket::NUM_BYTES_LOCALID + 4;
+const size_t MAX_NODE_LIST_CHANGES = 1024;
 
-    // setup the extended header for the domain list packets
-    // this data is at the beginning of each of the domain list packets
-    QByteArray extendedHeader(NUM_DOMAIN_LIST_EXTENDED_HEADER_BYTES, 0);
-    QDataStream extendedHeaderStream(&extendedHeader, QIODevice::WriteOnly);
+// full lists are sent unreliably over as many packets as they need, so one is sent every so often even to nodes
+// that get deltas, to fill in whatever a lost packet left out
+const quint64 FULL_DOMAIN_LIST_INTERVAL_USECS = 10 * USECS_PER_SECOND;
+
+void DomainServer::sendDomainListToNode(const SharedNodePointer& node, quint64 requestPacketReceiveTime, const HifiSockAddr &senderSockAddr,
+                                        bool newConnection, quint64 knownEpoch) {
     DomainServerNodeData* nodeData = static_cast<DomainServerNodeData*>(node->getLinkedData());
     auto limitedNodeList = DependencyManager::get<LimitedNodeList>();
 
-    extendedHeaderStream << limitedNodeList->getSessionUUID();
-    extendedHeaderStream << limitedNodeList->getSessionLocalID();
-    extendedHeaderStream << node->getUUID();
-    extendedHeaderStream << node->getLocalID();
-    extendedHeaderStream << node->getPermissions();
-    extendedHeaderStream << limitedNodeList->getAuthenticatePackets();
-    extendedHeaderStream << nodeData->getLastDomainCheckinTimestamp();
-    extendedHeaderStream << quint64(duration_cast<microseconds>(system_clock::now().time_since_epoch()).count());
-    extendedHeaderStream << quint64(duration_cast<microseconds>(p_high_resolution_clock::now().time_since_epoch()).count()) - requestPacketReceiveTime;
-    extendedHeaderStream << newConnection;
-    auto domainListPackets = NLPacketList::create(PacketType::DomainList, extendedHeader);
-
-    // always send the node their own UUID back
-    QDataStream domainListStream(domainListPackets.get());
+    auto createDomainListPackets = [&](bool isDelta) {
+        const int NUM_DOMAIN_LIST_EXTENDED_HEADER_BYTES = NUM_BYTES_RFC4122_UUID + NLPacket::NUM_BYTES_LOCALID +
+            NUM_BYTES_RFC4122_UUID + NLPacket::NUM_BYTES_LOCALID + 4;
+
+        // setup the extended header for the domain list packets
+        // this data is at the beginning of each of the domain list packets
+        QByteArray extendedHeader(NUM_DOMAIN_LIST_EXTENDED_HEADER_BYTES, 0);
+        QDataStream extendedHeaderStream(&extendedHeader, QIODevice::WriteOnly);
+
+        extendedHeaderStream << limitedNodeList->getSessionUUID();
+        extendedHeaderStream << limitedNodeList->getSessionLocalID();
+        extendedHeaderStream << node->getUUID();
+        extendedHeaderStream << node->getLocalID();
+        extendedHeaderStream << node->getPermissions();
+        extendedHeaderStream << limitedNodeList->getAuthenticatePackets();
+        extendedHeaderStream << nodeData->getLastDomainCheckinTimestamp();
+        extendedHeaderStream << quint64(duration_cast<microseconds>(system_clock::now().time_since_epoch()).count());
+        extendedHeaderStream << quint64(duration_cast<microseconds>(p_high_resolution_clock::now().time_since_epoch()).count()) - requestPacketReceiveTime;
+        extendedHeaderStream << newConnection;
+        extendedHeaderStream << _nodeListEpoch << (isDelta ? knownEpoch : quint64(0)) << isDelta;
+        return NLPacketList::create(PacketType::DomainList, extendedHeader);
+    };
 
     // store the nodeInterestSet on this DomainServerNodeData, in case it has changed
     auto& nodeInterestSet = nodeData->getNodeInterestSet();
+    quint64 now = usecTimestampNow();
+
+    if (!newConnection && nodeInterestSet.size() > 0 && nodeData->isAuthenticated() && isNodeListEpochKnown(knownEpoch)
+        && now - nodeData->getLastFullDomainListTime() < FULL_DOMAIN_LIST_INTERVAL_USECS) {
+
+        auto domainListPackets = createDomainListPackets(true);
+        QDataStream domainListStream(domainListPackets.get());
+
+        // the last change to each node since the known epoch
+        QSet<QUuid> changedNodes;
+        for (auto it = _nodeListChanges.rbegin(); it != _nodeListChanges.rend() && it->epoch > knownEpoch; ++it) {
+            if (it->nodeUUID == node->getUUID() || !nodeInterestSet.contains(it->nodeType)
+                || changedNodes.contains(it->nodeUUID)) {
+                continue;
+            }
+            changedNodes.insert(it->nodeUUID);
+
+            SharedNodePointer otherNode = it->isRemoved ? SharedNodePointer() : limitedNodeList->nodeWithUUID(it->nodeUUID);
+
+            domainListPackets->startSegment();
+            if (otherNode) {
+                domainListStream << false << *otherNode.data();
+                domainListStream << connectionSecretForNodes(node, otherNode);
+            } else {
+                domainListStream << true << it->nodeUUID;
+            }
+            domainListPackets->endSegment();
+        }
+
+        // a delta has to arrive whole, or the node would skip the changes in the lost packets
+        if (domainListPackets->getNumPackets() <= 1) {
+            domainListPackets->closeCurrentPacket(true);
+            limitedNodeList->sendPacketList(std::move(domainListPackets), *node);
+            return;
+        }
+    }
+
+    auto domainListPackets = createDomainListPackets(false);
+
+    // always send the node their own UUID back
+    QDataStream domainListStream(domainListPackets.get());
 
     if (nodeInterestSet.size() > 0) {
 
@@ -1210,6 +1272,8 @@ void DomainServer::sendDomainListToNode(const SharedNodePointer& node, quint64 r
                     domainListPackets->endSegment();
                 }
             });
+
+            nodeData->setLastFullDomainListTime(now);
         }
     }
 
@@ -1220,25 +1284,28 @@ void DomainServer::sendDomainListToNode(const SharedNodePointer& node, quint64 r
     limitedNodeList->sendPacketList(std::move(domainListPackets), *node);
 }
 
-QUuid DomainServer::connectionSecretForNodes(const SharedNodePointer& nodeA, const SharedNodePointer& nodeB) {
-    DomainServerNodeData* nodeAData = static_cast<DomainServerNodeData*>(nodeA->getLinkedData());
-    DomainServerNodeData* nodeBData = static_cast<DomainServerNodeData*>(nodeB->getLinkedData());
-
-    if (nodeAData && nodeBData) {
-        QUuid& secretUUID = nodeAData->getSessionSecretHash()[nodeB->getUUID()];
-
-        if (secretUUID.isNull()) {
-            // generate a new secret UUID these two nodes can use
-            secretUUID = QUuid::createUuid();
+void DomainServer::markNodeListChanged(const SharedNodePointer& node, bool isRemoved) {
+    _nodeListChanges.push_back({ ++_nodeListEpoch, node->getUUID(), node->getType(), isRemoved });
+    if (_nodeListChanges.size() > MAX_NODE_LIST_CHANGES) {
+        _nodeListChanges.pop_front();
+    }
+}
 
-            // set it on the other Node's sessionSecretHash
-            static_cast<DomainServerNodeData*>(nodeBData)->getSessionSecretHash().insert(nodeA->getUUID(), secretUUID);
-        }
+bool DomainServer::isNodeListEpochKnown(quint64 epoch) const {
+    // every epoch after the first starts with a change, so the log covers this one if it holds the next
+    return epoch != 0 && epoch <= _nodeListEpoch
+        && (_nodeListChanges.empty() || _nodeListChanges.front().epoch <= epoch + 1);
+}
 
-        return secretUUID;
-    }
+QUuid DomainServer::connectionSecretForNodes(const SharedNodePointer& nodeA, const SharedNodePointer& nodeB) {
+    // derived from the pair rather than generated and stored for it, so nothing is kept per pair of nodes and
+    // both nodes get the same secret in whatever order they are asked for
+    QByteArray rfcUUIDA = nodeA->getUUID().toRfc4122();
+    QByteArray rfcUUIDB = nodeB->getUUID().toRfc4122();
+    QByteArray pair = rfcUUIDA < rfcUUIDB ? rfcUUIDA + rfcUUIDB : rfcUUIDB + rfcUUIDA;
 
-    return QUuid();
+    auto hash = QMessageAuthenticationCode::hash(pair, _connectionSecretKey, QCryptographicHash::Sha256);
+    return QUuid::fromRfc4122(hash.left(NUM_BYTES_RFC4122_UUID));
 }
 
 void DomainServer::broadcastNewNode(const SharedNodePointer& addedNode) {
@@ -3041,7 +3108,10 @@ void DomainServer::updateReplicatedNodes() {
                 qDebug() << "Setting node to replicated:"
                     << otherNode->getPermissions().getVerifiedUserName() << otherNode->getUUID();
             }
-            otherNode->setIsReplicated(shouldReplicate);
+            if (isReplicated != shouldReplicate) {
+                otherNode->setIsReplicated(shouldReplicate);
+                markNodeListChanged(otherNode);
+            }
         }
     );
 }
@@ -3074,6 +3144,8 @@ void DomainServer::nodeKilled(SharedNodePointer node) {
     // if this peer connected via ICE then remove them from our ICE peers hash
     _gatekeeper.cleanupICEPeerForNode(node->getUUID());
 
+    markNodeListChanged(node, true);
+
     DomainServerNodeData* nodeData = static_cast<DomainServerNodeData*>(node->getLinkedData());
 
     if (nodeData) {
@@ -3086,14 +3158,6 @@ void DomainServer::nodeKilled(SharedNodePointer node) {
             }
         }
 
-        // cleanup the connection secrets that we set up for this node (on the other nodes)
-        foreach (const QUuid& otherNodeSessionUUID, nodeData->getSessionSecretHash().keys()) {
-            SharedNodePointer otherNode = DependencyManager::get<LimitedNodeList>()->nodeWithUUID(otherNodeSessionUUID);
-            if (otherNode) {
-                static_cast<DomainServerNodeData*>(otherNode->getLinkedData())->getSessionSecretHash().remove(node->getUUID());
-            }
-        }
-
         if (node->getType() == NodeType::Agent) {
             // if this node was an Agent ask DomainServerNodeData to remove the interpolation we potentially stored
             nodeData->removeOverrideForKey(USERNAME_UUID_REPLACEMENT_STATS_KEY,
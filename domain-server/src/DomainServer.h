@@ -12,6 +12,8 @@
 #ifndef hifi_DomainServer_h
 #define hifi_DomainServer_h
 
+#include <deque>
+
 #include <QtCore/QCoreApplication>
 #include <QtCore/QHash>
 #include <QtCore/QJsonObject>
@@ -173,7 +175,12 @@ private:
     void handleKillNode(SharedNodePointer nodeToKill);
     void broadcastNodeDisconnect(const SharedNodePointer& disconnnectedNode);
 
-    void sendDomainListToNode(const SharedNodePointer& node, quint64 requestPacketReceiveTime, const HifiSockAddr& senderSockAddr, bool newConnection);
+    void sendDomainListToNode(const SharedNodePointer& node, quint64 requestPacketReceiveTime, const HifiSockAddr& senderSockAddr,
+                              bool newConnection, quint64 knownEpoch = 0);
+
+    // Starts a new node list epoch in which the node was added, removed or changed what other nodes are told about it
+    void markNodeListChanged(const SharedNodePointer& node, bool isRemoved = false);
+    bool isNodeListEpochKnown(quint64 epoch) const;
 
     bool isInInterestSet(const SharedNodePointer& nodeA, const SharedNodePointer& nodeB);
 
@@ -291,6 +298,20 @@ private:
     std::unordered_map<int, std::unique_ptr<QTemporaryFile>> _pendingContentFiles;
 
     QThread _assetClientThread;
+
+    struct NodeListChange {
+        quint64 epoch;
+        QUuid nodeUUID;
+        NodeType_t nodeType;
+        bool isRemoved;
+    };
+
+    // the changes of the last MAX_NODE_LIST_CHANGES epochs, nodes that acknowledged an older one get a full list
+    quint64 _nodeListEpoch { 1 };
+    std::deque<NodeListChange> _nodeListChanges;
+
+    // connection secrets are keyed hashes of the node pair, random per run
+    const QByteArray _connectionSecretKey { QUuid::createUuid().toRfc4122() + QUuid::createUuid().toRfc4122() };
 };
 
 
@@ -47,8 +47,6 @@ public:
     void setIsAuthenticated(bool isAuthenticated) { _isAuthenticated = isAuthenticated; }
     bool isAuthenticated() const { return _isAuthenticated; }
 
-    QHash<QUuid, QUuid>& getSessionSecretHash() { return _sessionSecretHash; }
-
     const NodeSet& getNodeInterestSet() const { return _nodeInterestSet; }
     void setNodeInterestSet(const NodeSet& nodeInterestSet) { _nodeInterestSet = nodeInterestSet; }
     
@@ -75,12 +73,15 @@ public:
 
     bool hasCheckedIn() const { return _hasCheckedIn; }
     void setHasCheckedIn(bool hasCheckedIn) { _hasCheckedIn = hasCheckedIn; }
+
+    // when this node was last sent every node it is interested in, 0 to send the full list next
+    quint64 getLastFullDomainListTime() const { return _lastFullDomainListTime; }
+    void setLastFullDomainListTime(quint64 lastFullDomainListTime) { _lastFullDomainListTime = lastFullDomainListTime; }
     
 private:
     QJsonObject overrideValuesIfNeeded(const QJsonObject& newStats);
     QJsonArray overrideValuesIfNeeded(const QJsonArray& newStats);
     
-    QHash<QUuid, QUuid> _sessionSecretHash;
     QUuid _assignmentUUID;
     QUuid _walletUUID;
     QString _username;
@@ -102,6 +103,8 @@ private:
     bool _wasAssigned { false };
 
     bool _hasCheckedIn { false };
+
+    quint64 _lastFullDomainListTime { 0 };
 };
 
 #endif // hifi_DomainServerNodeData_h
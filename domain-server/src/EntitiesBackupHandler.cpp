@@ -10,6 +10,7 @@
 //
 
 #include "EntitiesBackupHandler.h"
+#include "BackupArchiveWriter.h"
 
 #include <QDebug>
 
@@ -35,25 +36,10 @@ EntitiesBackupHandler::EntitiesBackupHandler(QString entitiesFilePath, QString e
 
 static const QString ENTITIES_BACKUP_FILENAME = "models.json.gz";
 
-void EntitiesBackupHandler::createBackup(const QString& backupName, QuaZip& zip) {
-    QFile entitiesFile { _entitiesFilePath };
-
-    if (entitiesFile.open(QIODevice::ReadOnly)) {
-        QuaZipFile zipFile { &zip };
-        if (!zipFile.open(QIODevice::WriteOnly, QuaZipNewInfo(ENTITIES_BACKUP_FILENAME, _entitiesFilePath))) {
-            qCritical().nospace() << "Failed to open " << ENTITIES_BACKUP_FILENAME << " for writing in zip";
-            return;
-        }
-        auto entityData = entitiesFile.readAll();
-        if (zipFile.write(entityData) != entityData.size()) {
-            qCritical() << "Failed to write entities file to backup";
-            zipFile.close();
-            return;
-        }
-        zipFile.close();
-        if (zipFile.getZipError() != UNZ_OK) {
-            qCritical().nospace() << "Failed to zip " << ENTITIES_BACKUP_FILENAME << ": " << zipFile.getZipError();
-        }
+void EntitiesBackupHandler::createBackup(const QString& backupName, BackupArchiveWriter& writer) {
+    if (QFile::exists(_entitiesFilePath)) {
+        // the entities are gzipped already
+        writer.addFile(ENTITIES_BACKUP_FILENAME, _entitiesFilePath, BackupArchiveWriter::Store);
     }
 }
 
@@ -26,7 +26,7 @@ public:
     void loadingComplete() override {}
 
     // Create a skeleton backup
-    void createBackup(const QString& backupName, QuaZip& zip) override;
+    void createBackup(const QString& backupName, BackupArchiveWriter& writer) override;
 
     // Recover from a full backup
     std::pair<bool, QString> recoverBackup(const QString& backupName, QuaZip& zip, const QString& username, const QString& sourceFilename) override;
@@ -35,7 +35,7 @@ public:
     void deleteBackup(const QString& backupName) override {}
 
     // Create a full backup
-    void consolidateBackup(const QString& backupName, QuaZip& zip) override {}
+    void consolidateBackup(const QString& backupName, BackupArchiveWriter& writer) override {}
 
     bool isCorruptedBackup(const QString& backupName) override { return false; }
 
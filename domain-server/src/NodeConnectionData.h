@@ -29,6 +29,7 @@ public:
     HifiSockAddr senderSockAddr;
     QList<NodeType_t> interestList;
     QString placeName;
+    quint64 domainListEpoch { 0 }; // node list epoch of the last domain list the node applied, list requests only
     QString hardwareAddress;
     QUuid machineFingerprint;
     QString SystemInfo;
@@ -0,0 +1,297 @@
+//
+//  IcePeerShard.cpp
+//  ice-server/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "IcePeerShard.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include <openssl/x509.h>
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+
+#include <NumericalConstants.h>
+#include <SharedUtil.h>
+#include <udt/PacketHeaders.h>
+
+static const uint64_t PEER_SILENCE_THRESHOLD_SECS = 5;
+static const int EXPIRY_CHECK_INTERVAL_MSECS = 250;
+
+const int IcePeerShard::EXPIRY_WHEEL_SLOTS;
+
+IcePeerShard::IcePeerShard(udt::Socket& serverSocket) :
+    _serverSocket(serverSocket),
+    _ackPacket(NLPacket::create(PacketType::ICEServerHeartbeatACK)),
+    _deniedPacket(NLPacket::create(PacketType::ICEServerHeartbeatDenied))
+{
+}
+
+void IcePeerShard::queuePacket(std::unique_ptr<NLPacket> packet) {
+    {
+        Lock lock(_mutex);
+        _queuedPackets.push_back(std::move(packet));
+    }
+    _condition.notify_one();
+}
+
+void IcePeerShard::queuePublicKey(const QUuid& domainID, RSAUniquePtr publicKey) {
+    {
+        Lock lock(_mutex);
+        _queuedPublicKeys.emplace_back(domainID, std::move(publicKey));
+    }
+    _condition.notify_one();
+}
+
+void IcePeerShard::stop() {
+    {
+        Lock lock(_mutex);
+        _isStopping = true;
+    }
+    _condition.notify_one();
+    wait();
+}
+
+void IcePeerShard::run() {
+    // a peer is due at most PEER_SILENCE_THRESHOLD_SECS + 1 seconds out, which has to be a slot other than the current one
+    static_assert(PEER_SILENCE_THRESHOLD_SECS + 2 <= EXPIRY_WHEEL_SLOTS, "the expiry wheel is too small");
+
+    _expirySecond = usecTimestampNow() / USECS_PER_SECOND;
+
+    std::vector<std::unique_ptr<NLPacket>> packets;
+    std::vector<std::pair<QUuid, RSAUniquePtr>> publicKeys;
+
+    while (true) {
+        {
+            Lock lock(_mutex);
+            _condition.wait_for(lock, std::chrono::milliseconds(EXPIRY_CHECK_INTERVAL_MSECS), [&] {
+                return _isStopping || !_queuedPackets.empty() || !_queuedPublicKeys.empty();
+            });
+
+            if (_isStopping) {
+                return;
+            }
+
+            // take everything that queued up while the last batch was being handled
+            packets.swap(_queuedPackets);
+            publicKeys.swap(_queuedPublicKeys);
+        }
+
+        for (auto& publicKey : publicKeys) {
+            _pendingPublicKeyRequests.remove(publicKey.first);
+
+            if (publicKey.second) {
+                auto& domainPublicKey = _domainPublicKeys[publicKey.first];
+                domainPublicKey.key = std::move(publicKey.second);
+                domainPublicKey.verifiedPlaintext.clear();
+                domainPublicKey.verifiedSignature.clear();
+            }
+        }
+        publicKeys.clear();
+
+        for (auto& packet : packets) {
+            processPacket(*packet);
+        }
+        packets.clear();
+
+        expireInactivePeers(usecTimestampNow() / USECS_PER_SECOND);
+    }
+}
+
+void IcePeerShard::processPacket(NLPacket& packet) {
+    if (packet.getType() == PacketType::ICEServerHeartbeat) {
+        SharedNetworkPeer peer = addOrUpdateHeartbeatingPeer(packet);
+        if (peer) {
+            // so that we can send packets to the heartbeating peer when we need, we need to activate a socket now
+            peer->activateMatchingOrNewSymmetricSocket(packet.getSenderSockAddr());
+
+            // we have an active and verified heartbeating peer
+            // send them an ACK packet so they know that they are being heard and ready for ICE
+            _serverSocket.writePacket(*_ackPacket, packet.getSenderSockAddr());
+        } else {
+            // we couldn't verify this peer - respond back to them so they know they may need to perform keypair re-generation
+            _serverSocket.writePacket(*_deniedPacket, packet.getSenderSockAddr());
+        }
+    } else if (packet.getType() == PacketType::ICEServerQuery) {
+        QDataStream heartbeatStream(&packet);
+
+        // this is a node hoping to connect to a heartbeating peer - do we have the heartbeating peer?
+        QUuid senderUUID;
+        heartbeatStream >> senderUUID;
+
+        // pull the public and private sock addrs for this peer
+        HifiSockAddr publicSocket, localSocket;
+        heartbeatStream >> publicSocket >> localSocket;
+
+        // check if this node also included a UUID that they would like to connect to
+        QUuid connectRequestID;
+        heartbeatStream >> connectRequestID;
+
+        auto matchingPeer = _peers.find(connectRequestID);
+
+        if (matchingPeer != _peers.end()) {
+            const NetworkPeer& peer = *matchingPeer->second.peer;
+
+            qDebug() << "Sending information for peer" << connectRequestID << "to peer" << senderUUID;
+
+            // we have the peer they want to connect to - send them pack the information for that peer
+            sendPeerInformationPacket(peer, &packet.getSenderSockAddr());
+
+            // we also need to send them to the active peer they are hoping to connect to
+            // create a dummy peer object we can pass to sendPeerInformationPacket
+
+            NetworkPeer dummyPeer(senderUUID, publicSocket, localSocket);
+            sendPeerInformationPacket(dummyPeer, peer.getActiveSocket());
+        } else {
+            qDebug() << "Peer" << senderUUID << "asked for" << connectRequestID << "but no matching peer found";
+        }
+    }
+}
+
+SharedNetworkPeer IcePeerShard::addOrUpdateHeartbeatingPeer(NLPacket& packet) {
+
+    // pull the UUID, public and private sock addrs for this peer
+    QUuid senderUUID;
+    HifiSockAddr publicSocket, localSocket;
+    QByteArray signature;
+
+    QDataStream heartbeatStream(&packet);
+    heartbeatStream >> senderUUID >> publicSocket >> localSocket;
+
+    auto signedPlaintext = QByteArray::fromRawData(packet.getPayload(), heartbeatStream.device()->pos());
+    heartbeatStream >> signature;
+
+    // make sure this is a verified heartbeat before performing any more processing
+    if (!isVerifiedHeartbeat(senderUUID, signedPlaintext, signature)) {
+        // not verified, return the empty peer object
+        return SharedNetworkPeer();
+    }
+
+    quint64 now = usecTimestampNow();
+    uint64_t expirySecond = now / USECS_PER_SECOND + PEER_SILENCE_THRESHOLD_SECS + 1;
+
+    // make sure we have this sender in our peer hash
+    auto matchingPeer = _peers.find(senderUUID);
+
+    if (matchingPeer == _peers.end()) {
+        // if we don't have this sender we need to create them now
+        auto peer = QSharedPointer<NetworkPeer>::create(senderUUID, publicSocket, localSocket);
+        matchingPeer = _peers.insert({ senderUUID, { peer, expirySecond } }).first;
+        _expiryWheel[expirySecond % EXPIRY_WHEEL_SLOTS].push_back(senderUUID);
+
+        qDebug() << "Added a new network peer" << *peer;
+    } else {
+        // we already had the peer so just potentially update their sockets
+        matchingPeer->second.peer->setPublicSocket(publicSocket);
+        matchingPeer->second.peer->setLocalSocket(localSocket);
+
+        // it moves to its new slot in the expiry wheel when its current one comes up
+        matchingPeer->second.expirySecond = expirySecond;
+    }
+
+    // update our last heard microstamp for this network peer to now
+    matchingPeer->second.peer->setLastHeardMicrostamp(now);
+
+    return matchingPeer->second.peer;
+}
+
+bool IcePeerShard::isVerifiedHeartbeat(const QUuid& domainID, const QByteArray& plaintext, const QByteArray& signature) {
+    // make sure we're not already waiting for a public key for this domain-server
+    if (_pendingPublicKeyRequests.contains(domainID)) {
+        return false;
+    }
+
+    // check if we have a public key for this domain ID - if we do not then fire off the request for it
+    auto it = _domainPublicKeys.find(domainID);
+    if (it != _domainPublicKeys.end()) {
+        auto& domainPublicKey = it->second;
+
+        // domain-servers only re-sign their heartbeat when their sockets change,
+        // so most heartbeats are the same bytes as one this key has already verified
+        if (!domainPublicKey.verifiedSignature.isEmpty() && signature == domainPublicKey.verifiedSignature &&
+            plaintext == domainPublicKey.verifiedPlaintext) {
+            return true;
+        }
+
+        // attempt to verify the signature for this heartbeat
+        auto hashedPlaintext = QCryptographicHash::hash(plaintext, QCryptographicHash::Sha256);
+        int verificationResult = RSA_verify(NID_sha256,
+                                            reinterpret_cast<const unsigned char*>(hashedPlaintext.constData()),
+                                            hashedPlaintext.size(),
+                                            reinterpret_cast<const unsigned char*>(signature.constData()),
+                                            signature.size(),
+                                            domainPublicKey.key.get());
+
+        if (verificationResult == 1) {
+            // this is the only success case - hold on to a copy of what was verified, the plaintext is in the packet
+            domainPublicKey.verifiedPlaintext = QByteArray(plaintext.constData(), plaintext.size());
+            domainPublicKey.verifiedSignature = signature;
+            return true;
+        } else {
+            qDebug() << "Failed to verify heartbeat for" << domainID << "- re-requesting public key from API.";
+        }
+    }
+
+    // we could not verify this heartbeat (missing public key, could not load public key, bad actor)
+    // ask the metaverse API for the right public key and return false to indicate that this is not verified
+    requestDomainPublicKey(domainID);
+
+    return false;
+}
+
+void IcePeerShard::requestDomainPublicKey(const QUuid& domainID) {
+    // the request goes out from the main thread, and the key comes back through queuePublicKey
+    _pendingPublicKeyRequests.insert(domainID);
+    emit publicKeyNeeded(domainID);
+}
+
+void IcePeerShard::sendPeerInformationPacket(const NetworkPeer& peer, const HifiSockAddr* destinationSockAddr) {
+    auto peerPacket = NLPacket::create(PacketType::ICEServerPeerInformation);
+
+    // get the byte array for this peer
+    peerPacket->write(peer.toByteArray());
+
+    // write the current packet
+    _serverSocket.writePacket(*peerPacket, *destinationSockAddr);
+}
+
+void IcePeerShard::expireInactivePeers(uint64_t currentSecond) {
+    // after a stall every slot is due, and going around the wheel once covers them all
+    uint64_t second = std::max(_expirySecond, currentSecond - std::min<uint64_t>(currentSecond, EXPIRY_WHEEL_SLOTS));
+
+    std::vector<QUuid> duePeerIDs;
+    while (second < currentSecond) {
+        ++second;
+        duePeerIDs.swap(_expiryWheel[second % EXPIRY_WHEEL_SLOTS]);
+
+        for (const auto& peerID : duePeerIDs) {
+            auto peer = _peers.find(peerID);
+            if (peer == _peers.end()) {
+                continue;
+            }
+
+            if (peer->second.expirySecond <= currentSecond) {
+                qDebug() << "Removing peer from memory for inactivity -" << *peer->second.peer;
+
+                // if we had a public key for this domain, remove it now
+                _domainPublicKeys.erase(peerID);
+
+                // remove the peer object
+                _peers.erase(peer);
+            } else {
+                // heard from since it was put in this slot
+                _expiryWheel[peer->second.expirySecond % EXPIRY_WHEEL_SLOTS].push_back(peerID);
+            }
+        }
+        duePeerIDs.clear();
+    }
+
+    _expirySecond = std::max(_expirySecond, currentSecond);
+}
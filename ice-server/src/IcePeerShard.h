@@ -0,0 +1,105 @@
+//
+//  IcePeerShard.h
+//  ice-server/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_IcePeerShard_h
+#define hifi_IcePeerShard_h
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <QtCore/QSet>
+#include <QtCore/QThread>
+
+#include <openssl/rsa.h>
+
+#include <UUIDHasher.h>
+
+#include <NetworkPeer.h>
+#include <NLPacket.h>
+#include <udt/Socket.h>
+
+// The heartbeating peers whose IDs hash to one shard, and the public keys of their domains.
+// Everything a shard owns is only touched from its own thread, so packets for different domains
+// are handled in parallel and a domain's packets are handled in the order they came in.
+class IcePeerShard : public QThread {
+    Q_OBJECT
+public:
+    using RSAUniquePtr = std::unique_ptr<RSA, std::function<void(RSA*)>>;
+
+    IcePeerShard(udt::Socket& serverSocket);
+
+    // thread-safe, from the socket thread
+    void queuePacket(std::unique_ptr<NLPacket> packet);
+    // thread-safe, publicKey is null when the key couldn't be had
+    void queuePublicKey(const QUuid& domainID, RSAUniquePtr publicKey);
+
+    void stop();
+
+signals:
+    void publicKeyNeeded(QUuid domainID);
+
+protected:
+    void run() override;
+
+private:
+    using Mutex = std::mutex;
+    using Lock = std::unique_lock<Mutex>;
+
+    struct Peer {
+        SharedNetworkPeer peer;
+        uint64_t expirySecond;
+    };
+
+    struct DomainPublicKey {
+        RSAUniquePtr key;
+
+        // the last heartbeat this key verified
+        QByteArray verifiedPlaintext;
+        QByteArray verifiedSignature;
+    };
+
+    void processPacket(NLPacket& packet);
+    SharedNetworkPeer addOrUpdateHeartbeatingPeer(NLPacket& packet);
+    void sendPeerInformationPacket(const NetworkPeer& peer, const HifiSockAddr* destinationSockAddr);
+
+    bool isVerifiedHeartbeat(const QUuid& domainID, const QByteArray& plaintext, const QByteArray& signature);
+    void requestDomainPublicKey(const QUuid& domainID);
+
+    void expireInactivePeers(uint64_t currentSecond);
+
+    udt::Socket& _serverSocket;
+
+    // packets are written with sequence numbers, so each thread needs its own
+    std::unique_ptr<NLPacket> _ackPacket;
+    std::unique_ptr<NLPacket> _deniedPacket;
+
+    std::unordered_map<QUuid, Peer> _peers;
+    std::unordered_map<QUuid, DomainPublicKey> _domainPublicKeys;
+    QSet<QUuid> _pendingPublicKeyRequests;
+
+    // A timing wheel of one second slots, with each peer in the slot of the second it was due to expire in when
+    // last checked.  Heartbeats only push the expiry back, and a peer that was heard from is moved to its new
+    // slot when its old one comes up, so every peer is looked at about once per silence threshold.
+    static const int EXPIRY_WHEEL_SLOTS = 8;
+    std::vector<QUuid> _expiryWheel[EXPIRY_WHEEL_SLOTS];
+    uint64_t _expirySecond { 0 };
+
+    Mutex _mutex;
+    std::condition_variable _condition;
+    std::vector<std::unique_ptr<NLPacket>> _queuedPackets; // guarded by _mutex
+    std::vector<std::pair<QUuid, RSAUniquePtr>> _queuedPublicKeys; // guarded by _mutex
+    bool _isStopping { false }; // guarded by _mutex
+};
+
+#endif // hifi_IcePeerShard_h
@@ -16,46 +16,35 @@
 #include <QtCore/QSharedPointer>
 #include <QUdpSocket>
 
-#include <openssl/rsa.h>
-
-#include <UUIDHasher.h>
-
 #include <NetworkPeer.h>
 #include <HTTPConnection.h>
 #include <HTTPManager.h>
 #include <NLPacket.h>
 #include <udt/Socket.h>
 
+#include "IcePeerShard.h"
+
 class QNetworkReply;
 
 class IceServer : public QCoreApplication {
     Q_OBJECT
 public:
     IceServer(int argc, char* argv[]);
+    ~IceServer();
 private slots:
-    void clearInactivePeers();
+    void requestDomainPublicKey(QUuid domainID);
     void publicKeyReplyFinished(QNetworkReply* reply);
 private:
     bool packetVersionMatch(const udt::Packet& packet);
     void processPacket(std::unique_ptr<udt::Packet> packet);
-    
-    SharedNetworkPeer addOrUpdateHeartbeatingPeer(NLPacket& incomingPacket);
-    void sendPeerInformationPacket(const NetworkPeer& peer, const HifiSockAddr* destinationSockAddr);
 
-    bool isVerifiedHeartbeat(const QUuid& domainID, const QByteArray& plaintext, const QByteArray& signature);
-    void requestDomainPublicKey(const QUuid& domainID);
+    // the shard that owns the heartbeating peer with this ID
+    IcePeerShard& shardForPeer(const QUuid& peerID);
 
     QUuid _id;
     udt::Socket _serverSocket;
 
-    using NetworkPeerHash = QHash<QUuid, SharedNetworkPeer>;
-    NetworkPeerHash _activePeers;
-
-    using RSAUniquePtr = std::unique_ptr<RSA, std::function<void(RSA*)>>;
-    using DomainPublicKeyHash = std::unordered_map<QUuid, RSAUniquePtr>;
-    DomainPublicKeyHash _domainPublicKeys;
-
-    QSet<QUuid> _pendingPublicKeyRequests;
+    std::vector<std::unique_ptr<IcePeerShard>> _shards;
 };
 
 #endif // hifi_IceServer_h
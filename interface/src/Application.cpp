@@ -5612,6 +5612,11 @@ void Application::init() {
         return atan2(maxSize, distance);
     });
 
+    static const std::string SHAPE_CACHE_DIRNAME { "shape_cache" };
+    static const std::string SHAPE_CACHE_EXT { "shape" };
+    auto shapeCache = std::make_shared<ShapeCache>(SHAPE_CACHE_DIRNAME, SHAPE_CACHE_EXT);
+    shapeCache->initialize();
+    _shapeManager.setShapeCache(shapeCache);
     ObjectMotionState::setShapeManager(&_shapeManager);
     _physicsEngine->init();
 
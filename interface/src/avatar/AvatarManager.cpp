@@ -35,6 +35,7 @@
 #include <RegisteredMetaTypes.h>
 #include <Rig.h>
 #include <SettingHandle.h>
+#include <TBBHelpers.h>
 #include <UsersScriptingInterface.h>
 #include <UUID.h>
 #include <shared/ConicalViewFrustum.h>
@@ -286,23 +287,20 @@ void AvatarManager::updateOtherAvatars(float deltaTime) {
     // process in sorted order
     uint64_t startTime = usecTimestampNow();
 
-    const uint64_t MAX_UPDATE_HEROS_TIME_BUDGET = uint64_t(0.8 * MAX_UPDATE_AVATARS_TIME_BUDGET);
-
-    uint64_t updatePriorityExpiries[NumVariants] = { startTime + MAX_UPDATE_HEROS_TIME_BUDGET, startTime + MAX_UPDATE_AVATARS_TIME_BUDGET };
     int numHerosUpdated = 0;
     int numAvatarsUpdated = 0;
-    int numAvatarsNotUpdated = 0;
 
     render::Transaction renderTransaction;
     workload::Transaction workloadTransaction;
 
+    // (1) on the main thread: everything that touches the scene, physics or the avatar's position
+    std::vector<std::pair<OtherAvatarPointer, bool>> avatarsToSimulate;
+    avatarsToSimulate.reserve(avatarPriorityQueues[kHero].size() + avatarPriorityQueues[kNonHero].size());
     for (int p = kHero; p < NumVariants; p++) {
         auto& priorityQueue = avatarPriorityQueues[p];
         // Sorting the current queue HERE as part of the measured timing.
         const auto& sortedAvatarVector = priorityQueue.getSortedVector();
 
-        auto passExpiry = updatePriorityExpiries[p];
-
         for (auto it = sortedAvatarVector.begin(); it != sortedAvatarVector.end(); ++it) {
             const SortableAvatar& sortData = *it;
             const auto avatar = std::static_pointer_cast<OtherAvatar>(sortData.getAvatar());
@@ -327,58 +325,17 @@ void AvatarManager::updateOtherAvatars(float deltaTime) {
 
             avatar->animateScaleChanges(deltaTime);
 
-            uint64_t now = usecTimestampNow();
-            if (now < passExpiry) {
-                // we're within budget
-                bool inView = sortData.getPriority() > OUT_OF_VIEW_THRESHOLD;
-                if (inView && avatar->hasNewJointData()) {
-                    numAvatarsUpdated++;
-                }
-                auto transitStatus = avatar->_transit.update(deltaTime, avatar->_serverPosition, _transitConfig);
-                if (avatar->getIsNewAvatar() && (transitStatus == AvatarTransit::Status::START_TRANSIT ||
-                                                 transitStatus == AvatarTransit::Status::ABORT_TRANSIT)) {
-                    avatar->_transit.reset();
-                    avatar->setIsNewAvatar(false);
-                }
-                avatar->simulate(deltaTime, inView);
-                if (avatar->getSkeletonModel()->isLoaded() && avatar->getWorkloadRegion() == workload::Region::R1) {
-                    _myAvatar->addAvatarHandsToFlow(avatar);
-                }
-                if (_drawOtherAvatarSkeletons) {
-                    avatar->debugJointData();
-                }
-                avatar->setEnableMeshVisible(!_drawOtherAvatarSkeletons);
-                avatar->updateRenderItem(renderTransaction);
-                avatar->updateSpaceProxy(workloadTransaction);
-                avatar->setLastRenderUpdateTime(startTime);
-
-            } else {
-                // we've spent our time budget for this priority bucket
-                // let's deal with the reminding avatars if this pass and BREAK from the for loop
-
-                if (p == kHero) {
-                    // Hero,
-                    // --> put them back in the non hero queue
-
-                    auto& crowdQueue = avatarPriorityQueues[kNonHero];
-                    while (it != sortedAvatarVector.end()) {
-                        crowdQueue.push(SortableAvatar((*it).getAvatar()));
-                        ++it;
-                    }
-                } else {
-                    // Non Hero
-                    // --> bail on the rest of the avatar updates
-                    // --> more avatars may freeze until their priority trickles up
-                    // --> some scale animations may glitch
-                    // --> some avatar velocity measurements may be a little off
-
-                    // no time to simulate, but we take the time to count how many were tragically missed
-                    numAvatarsNotUpdated = sortedAvatarVector.end() - it;
-                }
-
-                // We had to cut short this pass, we must break out of the for loop here
-                break;
+            bool inView = sortData.getPriority() > OUT_OF_VIEW_THRESHOLD;
+            if (inView && avatar->hasNewJointData()) {
+                numAvatarsUpdated++;
+            }
+            auto transitStatus = avatar->_transit.update(deltaTime, avatar->_serverPosition, _transitConfig);
+            if (avatar->getIsNewAvatar() && (transitStatus == AvatarTransit::Status::START_TRANSIT ||
+                                             transitStatus == AvatarTransit::Status::ABORT_TRANSIT)) {
+                avatar->_transit.reset();
+                avatar->setIsNewAvatar(false);
             }
+            avatarsToSimulate.push_back({ avatar, inView });
         }
 
         if (p == kHero) {
@@ -386,6 +343,40 @@ void AvatarManager::updateOtherAvatars(float deltaTime) {
         }
     }
 
+    // (2) on the worker pool: the rigs, which are independent per avatar and are the bulk of the cost
+    std::vector<std::pair<OtherAvatarPointer, bool>> concurrentAvatars;
+    concurrentAvatars.reserve(avatarsToSimulate.size());
+    for (const auto& entry : avatarsToSimulate) {
+        if (entry.first->canSimulateJointsConcurrently()) {
+            entry.first->updateGlobalPosition();
+            concurrentAvatars.push_back(entry);
+        }
+    }
+    {
+        PROFILE_RANGE(simulation, "simulateJoints");
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, concurrentAvatars.size()), [&](const tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i != range.end(); ++i) {
+                concurrentAvatars[i].first->simulateJoints(deltaTime, concurrentAvatars[i].second);
+            }
+        });
+    }
+
+    // (3) back on the main thread: finish each avatar and collect its render and workload changes
+    for (const auto& entry : avatarsToSimulate) {
+        const auto& avatar = entry.first;
+        avatar->simulate(deltaTime, entry.second);
+        if (avatar->getSkeletonModel()->isLoaded() && avatar->getWorkloadRegion() == workload::Region::R1) {
+            _myAvatar->addAvatarHandsToFlow(avatar);
+        }
+        if (_drawOtherAvatarSkeletons) {
+            avatar->debugJointData();
+        }
+        avatar->setEnableMeshVisible(!_drawOtherAvatarSkeletons);
+        avatar->updateRenderItem(renderTransaction);
+        avatar->updateSpaceProxy(workloadTransaction);
+        avatar->setLastRenderUpdateTime(startTime);
+    }
+
     if (_shouldRender) {
         qApp->getMain3DScene()->enqueueTransaction(renderTransaction);
     }
@@ -393,7 +384,7 @@ void AvatarManager::updateOtherAvatars(float deltaTime) {
     _space->enqueueTransaction(workloadTransaction);
 
     _numAvatarsUpdated = numAvatarsUpdated;
-    _numAvatarsNotUpdated = numAvatarsNotUpdated;
+    _numAvatarsNotUpdated = 0;
     _numHeroAvatarsUpdated = numHerosUpdated;
 
     _avatarSimulationTime = (float)(usecTimestampNow() - startTime) / (float)USECS_PER_MSEC;
@@ -243,13 +243,52 @@ void OtherAvatar::setCollisionWithOtherAvatarsFlags() {
     }
 }
 
-void OtherAvatar::simulate(float deltaTime, bool inView) {
-    PROFILE_RANGE(simulation, "simulate");
-
+void OtherAvatar::updateGlobalPosition() {
     _globalPosition = _transit.isActive() ? _transit.getCurrentPosition() : _serverPosition;
     if (!hasParent()) {
         setLocalPosition(_globalPosition);
     }
+}
+
+bool OtherAvatar::canSimulateJointsConcurrently() const {
+    // the first full update of a model initializes its rig and emits signals: leave that to the main thread
+    return _skeletonModel->isLoaded() && _skeletonModel->isActive() && !_skeletonModel->getRig().jointStatesEmpty();
+}
+
+void OtherAvatar::simulateJoints(float deltaTime, bool inView) {
+    PROFILE_RANGE(simulation, "updateJoints");
+    _jointsSimulated = true;
+    _jointsChanged = false;
+    if (inView) {
+        Head* head = getHead();
+        if (_hasNewJointData || _transit.isActive()) {
+            _skeletonModel->getRig().copyJointsFromJointData(_jointData);
+            glm::mat4 rootTransform = glm::scale(_skeletonModel->getScale()) * glm::translate(_skeletonModel->getOffset());
+            _skeletonModel->getRig().computeExternalPoses(rootTransform);
+            _jointDataSimulationRate.increment();
+
+            _skeletonModel->simulateRig(deltaTime, true);
+
+            _jointsChanged = true;
+            _hasNewJointData = false;
+
+            glm::vec3 headPosition = getWorldPosition();
+            if (!_skeletonModel->getHeadPosition(headPosition)) {
+                headPosition = getWorldPosition();
+            }
+            head->setPosition(headPosition);
+        }
+        head->setScale(getModelScale());
+        head->simulate(deltaTime);
+    } else {
+        // a non-full update is still required so that the position, rotation, scale and bounds of the skeletonModel are updated.
+        _skeletonModel->simulateRig(deltaTime, false);
+    }
+    _skeletonModelSimulationRate.increment();
+}
+
+void OtherAvatar::simulate(float deltaTime, bool inView) {
+    PROFILE_RANGE(simulation, "simulate");
 
     _simulationRate.increment();
     if (inView) {
@@ -257,35 +296,19 @@ void OtherAvatar::simulate(float deltaTime, bool inView) {
     }
 
     PerformanceTimer perfTimer("simulate");
-    {
-        PROFILE_RANGE(simulation, "updateJoints");
-        if (inView) {
-            Head* head = getHead();
-            if (_hasNewJointData || _transit.isActive()) {
-                _skeletonModel->getRig().copyJointsFromJointData(_jointData);
-                glm::mat4 rootTransform = glm::scale(_skeletonModel->getScale()) * glm::translate(_skeletonModel->getOffset());
-                _skeletonModel->getRig().computeExternalPoses(rootTransform);
-                _jointDataSimulationRate.increment();
-
-                _skeletonModel->simulate(deltaTime, true);
-
-                locationChanged(); // joints changed, so if there are any children, update them.
-                _hasNewJointData = false;
-
-                glm::vec3 headPosition = getWorldPosition();
-                if (!_skeletonModel->getHeadPosition(headPosition)) {
-                    headPosition = getWorldPosition();
-                }
-                head->setPosition(headPosition);
-            }
-            head->setScale(getModelScale());
-            head->simulate(deltaTime);
-            relayJointDataToChildren();
-        } else {
-            // a non-full update is still required so that the position, rotation, scale and bounds of the skeletonModel are updated.
-            _skeletonModel->simulate(deltaTime, false);
-        }
-        _skeletonModelSimulationRate.increment();
+    if (!_jointsSimulated) {
+        updateGlobalPosition();
+        simulateJoints(deltaTime, inView);
+    }
+    _jointsSimulated = false;
+    // the render items may only be touched here, on the main thread
+    _skeletonModel->updateTexturesLoaded();
+    if (_jointsChanged) {
+        locationChanged(); // joints changed, so if there are any children, update them.
+        _jointsChanged = false;
+    }
+    if (inView) {
+        relayJointDataToChildren();
     }
 
     // update animation for display name fade in/out
@@ -63,6 +63,13 @@ public:
 
     void setCollisionWithOtherAvatarsFlags() override;
 
+    // The part of simulate() that only touches this avatar's own Rig, SkeletonModel transform and Head.
+    // When canSimulateJointsConcurrently() it may run on a worker thread alongside other avatars
+    // (after updateGlobalPosition() on the main thread), and simulate() then skips it and finishes the rest.
+    void updateGlobalPosition();
+    bool canSimulateJointsConcurrently() const;
+    void simulateJoints(float deltaTime, bool inView);
+
     void simulate(float deltaTime, bool inView) override;
     void debugJointData() const;
     friend AvatarManager;
@@ -91,6 +98,8 @@ protected:
     uint8_t _workloadRegion { workload::Region::INVALID };
     BodyLOD _bodyLOD { BodyLOD::Sphere };
     bool _needsDetailedRebuild { false };
+    bool _jointsSimulated { false };
+    bool _jointsChanged { false };
 };
 
 using OtherAvatarPointer = std::shared_ptr<OtherAvatar>;
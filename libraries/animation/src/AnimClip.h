@@ -13,6 +13,7 @@
 
 #include <string>
 #include "AnimationCache.h"
+#include "AnimClipFrames.h"
 #include "AnimNode.h"
 
 // Playback a single animation timeline.
@@ -59,7 +60,6 @@ protected:
     virtual void setCurrentFrameInternal(float frame) override;
 
     void copyFromNetworkAnim();
-    void buildMirrorAnim();
 
     // for AnimDebugDraw rendering
     virtual const AnimPoseVec& getPosesInternal() const override;
@@ -67,9 +67,8 @@ protected:
     AnimationPointer _networkAnim;
     AnimPoseVec _poses;
 
-    // _anim[frame][joint]
-    std::vector<AnimPoseVec> _anim;
-    std::vector<AnimPoseVec> _mirrorAnim;
+    // retargeted keyframes, shared with every other clip playing this animation on an identical skeleton
+    AnimClipFrames::ConstPointer _frames;
 
     QString _url;
     float _startFrame;
@@ -0,0 +1,317 @@
+//
+//  AnimClipFrames.cpp
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "AnimClipFrames.h"
+
+#include <assert.h>
+#include <algorithm>
+
+#include <GLMHelpers.h>
+
+#include "AnimSkeleton.h"
+#include "AnimUtil.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#include <xmmintrin.h>
+#define ANIM_CLIP_FRAMES_SSE
+#endif
+
+#ifdef USE_CUSTOM_ASSERT
+#undef ASSERT
+#define ASSERT(x)                     \
+    do {                              \
+        if (!(x)) {                   \
+            int* bad_ptr = 0;         \
+            *bad_ptr = 0x0badf00d;    \
+        }                             \
+    } while (0)
+#else
+#define ASSERT assert
+#endif
+
+static const int SIMD_WIDTH = 4;
+
+AnimClipFrames::AnimClipFrames(int numFrames, int numJoints) :
+    _numFrames(numFrames),
+    _numJoints(numJoints),
+    _stride((numJoints + SIMD_WIDTH - 1) & ~(SIMD_WIDTH - 1)),
+    _data((size_t)numFrames * NUM_COMPONENTS * _stride, 0.0f)
+{
+    // pad with identity rotations so the unused lanes normalize cleanly
+    for (int frame = 0; frame < _numFrames; frame++) {
+        float* rotW = component(frame, ROT_W);
+        for (int joint = _numJoints; joint < _stride; joint++) {
+            rotW[joint] = 1.0f;
+        }
+    }
+}
+
+void AnimClipFrames::setPose(int frame, int joint, const AnimPose& pose) {
+    assert(frame >= 0 && frame < _numFrames && joint >= 0 && joint < _numJoints);
+    component(frame, ROT_X)[joint] = pose.rot().x;
+    component(frame, ROT_Y)[joint] = pose.rot().y;
+    component(frame, ROT_Z)[joint] = pose.rot().z;
+    component(frame, ROT_W)[joint] = pose.rot().w;
+    component(frame, TRANS_X)[joint] = pose.trans().x;
+    component(frame, TRANS_Y)[joint] = pose.trans().y;
+    component(frame, TRANS_Z)[joint] = pose.trans().z;
+    component(frame, SCALE_X)[joint] = pose.scale().x;
+    component(frame, SCALE_Y)[joint] = pose.scale().y;
+    component(frame, SCALE_Z)[joint] = pose.scale().z;
+}
+
+AnimPose AnimClipFrames::getPose(int frame, int joint) const {
+    assert(frame >= 0 && frame < _numFrames && joint >= 0 && joint < _numJoints);
+    return AnimPose(glm::vec3(component(frame, SCALE_X)[joint], component(frame, SCALE_Y)[joint], component(frame, SCALE_Z)[joint]),
+                    glm::quat(component(frame, ROT_W)[joint], component(frame, ROT_X)[joint], component(frame, ROT_Y)[joint], component(frame, ROT_Z)[joint]),
+                    glm::vec3(component(frame, TRANS_X)[joint], component(frame, TRANS_Y)[joint], component(frame, TRANS_Z)[joint]));
+}
+
+void AnimClipFrames::blendScalar(int prevFrame, int nextFrame, float alpha, AnimPose* result) const {
+    for (int joint = 0; joint < _numJoints; joint++) {
+        AnimPose prevPose = getPose(prevFrame, joint);
+        AnimPose nextPose = getPose(nextFrame, joint);
+        result[joint].scale() = lerp(prevPose.scale(), nextPose.scale(), alpha);
+        result[joint].rot() = safeLerp(prevPose.rot(), nextPose.rot(), alpha);
+        result[joint].trans() = lerp(prevPose.trans(), nextPose.trans(), alpha);
+    }
+}
+
+#ifdef ANIM_CLIP_FRAMES_SSE
+
+void AnimClipFrames::blend(int prevFrame, int nextFrame, float alpha, AnimPose* result) const {
+    const float* prev[NUM_COMPONENTS];
+    const float* next[NUM_COMPONENTS];
+    for (int c = 0; c < NUM_COMPONENTS; c++) {
+        prev[c] = component(prevFrame, (Component)c);
+        next[c] = component(nextFrame, (Component)c);
+    }
+
+    const __m128 a = _mm_set1_ps(alpha);
+    const __m128 oneMinusA = _mm_set1_ps(1.0f - alpha);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+
+    alignas(16) float out[NUM_COMPONENTS][SIMD_WIDTH];
+
+    for (int j = 0; j < _numJoints; j += SIMD_WIDTH) {
+
+        // rotation: flip next onto the same hemisphere as prev, lerp, then normalize
+        __m128 px = _mm_loadu_ps(prev[ROT_X] + j);
+        __m128 py = _mm_loadu_ps(prev[ROT_Y] + j);
+        __m128 pz = _mm_loadu_ps(prev[ROT_Z] + j);
+        __m128 pw = _mm_loadu_ps(prev[ROT_W] + j);
+        __m128 nx = _mm_loadu_ps(next[ROT_X] + j);
+        __m128 ny = _mm_loadu_ps(next[ROT_Y] + j);
+        __m128 nz = _mm_loadu_ps(next[ROT_Z] + j);
+        __m128 nw = _mm_loadu_ps(next[ROT_W] + j);
+
+        __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, nx), _mm_mul_ps(py, ny)),
+                                _mm_add_ps(_mm_mul_ps(pz, nz), _mm_mul_ps(pw, nw)));
+        __m128 flip = _mm_and_ps(_mm_cmplt_ps(dot, zero), signBit);
+        nx = _mm_xor_ps(nx, flip);
+        ny = _mm_xor_ps(ny, flip);
+        nz = _mm_xor_ps(nz, flip);
+        nw = _mm_xor_ps(nw, flip);
+
+        __m128 rx = _mm_add_ps(_mm_mul_ps(oneMinusA, px), _mm_mul_ps(a, nx));
+        __m128 ry = _mm_add_ps(_mm_mul_ps(oneMinusA, py), _mm_mul_ps(a, ny));
+        __m128 rz = _mm_add_ps(_mm_mul_ps(oneMinusA, pz), _mm_mul_ps(a, nz));
+        __m128 rw = _mm_add_ps(_mm_mul_ps(oneMinusA, pw), _mm_mul_ps(a, nw));
+
+        __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(rx, rx), _mm_mul_ps(ry, ry)),
+                                               _mm_add_ps(_mm_mul_ps(rz, rz), _mm_mul_ps(rw, rw))));
+        _mm_store_ps(out[ROT_X], _mm_div_ps(rx, length));
+        _mm_store_ps(out[ROT_Y], _mm_div_ps(ry, length));
+        _mm_store_ps(out[ROT_Z], _mm_div_ps(rz, length));
+        _mm_store_ps(out[ROT_W], _mm_div_ps(rw, length));
+
+        // translation and scale: plain lerp
+        for (int c = TRANS_X; c < NUM_COMPONENTS; c++) {
+            __m128 p = _mm_loadu_ps(prev[c] + j);
+            __m128 n = _mm_loadu_ps(next[c] + j);
+            _mm_store_ps(out[c], _mm_add_ps(_mm_mul_ps(oneMinusA, p), _mm_mul_ps(a, n)));
+        }
+
+        // scatter back into the AnimPoses
+        int count = std::min(SIMD_WIDTH, _numJoints - j);
+        for (int k = 0; k < count; k++) {
+            AnimPose& pose = result[j + k];
+            pose.rot() = glm::quat(out[ROT_W][k], out[ROT_X][k], out[ROT_Y][k], out[ROT_Z][k]);
+            pose.trans() = glm::vec3(out[TRANS_X][k], out[TRANS_Y][k], out[TRANS_Z][k]);
+            pose.scale() = glm::vec3(out[SCALE_X][k], out[SCALE_Y][k], out[SCALE_Z][k]);
+        }
+    }
+}
+
+#else
+
+void AnimClipFrames::blend(int prevFrame, int nextFrame, float alpha, AnimPose* result) const {
+    blendScalar(prevFrame, nextFrame, alpha, result);
+}
+
+#endif
+
+const AnimClipFrames& AnimClipFrames::getMirror(const AnimSkeleton& skeleton) const {
+    std::call_once(_mirrorOnce, [&] {
+        std::unique_ptr<AnimClipFrames> mirror(new AnimClipFrames(_numFrames, _numJoints));
+        AnimPoseVec poses(_numJoints);
+        for (int frame = 0; frame < _numFrames; frame++) {
+            for (int joint = 0; joint < _numJoints; joint++) {
+                poses[joint] = getPose(frame, joint);
+            }
+            skeleton.mirrorRelativePoses(poses);
+            for (int joint = 0; joint < _numJoints; joint++) {
+                mirror->setPose(frame, joint, poses[joint]);
+            }
+        }
+        _mirror = std::move(mirror);
+    });
+    return *_mirror;
+}
+
+static std::vector<int> buildJointIndexMap(const AnimSkeleton& dstSkeleton, const AnimSkeleton& srcSkeleton) {
+    std::vector<int> jointIndexMap;
+    int srcJointCount = srcSkeleton.getNumJoints();
+    jointIndexMap.reserve(srcJointCount);
+    for (int srcJointIndex = 0; srcJointIndex < srcJointCount; srcJointIndex++) {
+        QString srcJointName = srcSkeleton.getJointName(srcJointIndex);
+        int dstJointIndex = dstSkeleton.nameToJointIndex(srcJointName);
+        jointIndexMap.push_back(dstJointIndex);
+    }
+    return jointIndexMap;
+}
+
+AnimClipFrames::Pointer AnimClipFrames::build(const HFMModel& animModel, const AnimSkeleton& avatarSkeleton) {
+    AnimSkeleton animSkeleton(animModel);
+    const int animJointCount = animSkeleton.getNumJoints();
+    const int avatarJointCount = avatarSkeleton.getNumJoints();
+
+    // build a mapping from animation joint indices to avatar joint indices by matching joints with the same name.
+    std::vector<int> avatarToAnimJointIndexMap = buildJointIndexMap(animSkeleton, avatarSkeleton);
+
+    const int animFrameCount = animModel.animationFrames.size();
+    Pointer frames = std::make_shared<AnimClipFrames>(animFrameCount, avatarJointCount);
+
+    // find the size scale factor for translation in the animation.
+    float boneLengthScale = 1.0f;
+    const int avatarHipsIndex = avatarSkeleton.nameToJointIndex("Hips");
+    const int animHipsIndex = animSkeleton.nameToJointIndex("Hips");
+    if (avatarHipsIndex != -1 && animHipsIndex != -1) {
+        const int avatarHipsParentIndex = avatarSkeleton.getParentIndex(avatarHipsIndex);
+        const int animHipsParentIndex = animSkeleton.getParentIndex(animHipsIndex);
+
+        const AnimPose& avatarHipsAbsoluteDefaultPose = avatarSkeleton.getAbsoluteDefaultPose(avatarHipsIndex);
+        const AnimPose& animHipsAbsoluteDefaultPose = animSkeleton.getAbsoluteDefaultPose(animHipsIndex);
+
+        // the get the units and the heights for the animation and the avatar
+        const float avatarUnitScale = extractScale(avatarSkeleton.getGeometryOffset()).y;
+        const float animationUnitScale = extractScale(animModel.offset).y;
+        const float avatarHeightInMeters = avatarUnitScale * avatarHipsAbsoluteDefaultPose.trans().y;
+        const float animHeightInMeters = animationUnitScale * animHipsAbsoluteDefaultPose.trans().y;
+
+        // get the parent scales for the avatar and the animation
+        float avatarHipsParentScale = 1.0f;
+        if (avatarHipsParentIndex != -1) {
+            const AnimPose& avatarHipsParentAbsoluteDefaultPose = avatarSkeleton.getAbsoluteDefaultPose(avatarHipsParentIndex);
+            avatarHipsParentScale = avatarHipsParentAbsoluteDefaultPose.scale().y;
+        }
+        float animHipsParentScale = 1.0f;
+        if (animHipsParentIndex != -1) {
+            const AnimPose& animationHipsParentAbsoluteDefaultPose = animSkeleton.getAbsoluteDefaultPose(animHipsParentIndex);
+            animHipsParentScale = animationHipsParentAbsoluteDefaultPose.scale().y;
+        }
+
+        const float EPSILON = 0.0001f;
+        // compute the ratios for the units, the heights in meters, and the parent scales
+        if ((fabsf(animHeightInMeters) > EPSILON) && (animationUnitScale > EPSILON) && (animHipsParentScale > EPSILON)) {
+            const float avatarToAnimationHeightRatio = avatarHeightInMeters / animHeightInMeters;
+            const float unitsRatio = 1.0f / (avatarUnitScale / animationUnitScale);
+            const float parentScaleRatio = 1.0f / (avatarHipsParentScale / animHipsParentScale);
+
+            boneLengthScale = avatarToAnimationHeightRatio * unitsRatio * parentScaleRatio;
+        }
+    }
+
+    for (int frame = 0; frame < animFrameCount; frame++) {
+        const HFMAnimationFrame& animFrame = animModel.animationFrames[frame];
+        ASSERT(frame >= 0 && frame < (int)animModel.animationFrames.size());
+
+        // extract the full rotations from the animFrame (including pre and post rotations from the animModel).
+        std::vector<glm::quat> animRotations;
+        animRotations.reserve(animJointCount);
+        for (int i = 0; i < animJointCount; i++) {
+            ASSERT(i >= 0 && i < (int)animModel.joints.size());
+            ASSERT(i >= 0 && i < (int)animFrame.rotations.size());
+            animRotations.push_back(animModel.joints[i].preRotation * animFrame.rotations[i] * animModel.joints[i].postRotation);
+        }
+
+        // convert rotations into absolute frame
+        animSkeleton.convertRelativeRotationsToAbsolute(animRotations);
+
+        // build absolute rotations for the avatar
+        std::vector<glm::quat> avatarRotations;
+        avatarRotations.reserve(avatarJointCount);
+        for (int avatarJointIndex = 0; avatarJointIndex < avatarJointCount; avatarJointIndex++) {
+            ASSERT(avatarJointIndex >= 0 && avatarJointIndex < (int)avatarToAnimJointIndexMap.size());
+            int animJointIndex = avatarToAnimJointIndexMap[avatarJointIndex];
+            if (animJointIndex >= 0) {
+                // This joint is in both animation and avatar.
+                // Set the absolute rotation directly
+                ASSERT(animJointIndex >= 0 && animJointIndex < (int)animRotations.size());
+                avatarRotations.push_back(animRotations[animJointIndex]);
+            } else {
+                // This joint is NOT in the animation at all.
+                // Set it so that the default relative rotation remains unchanged.
+                glm::quat avatarRelativeDefaultRot = avatarSkeleton.getRelativeDefaultPose(avatarJointIndex).rot();
+                glm::quat avatarParentAbsoluteRot;
+                int avatarParentJointIndex = avatarSkeleton.getParentIndex(avatarJointIndex);
+                if (avatarParentJointIndex >= 0) {
+                    ASSERT(avatarParentJointIndex >= 0 && avatarParentJointIndex < (int)avatarRotations.size());
+                    avatarParentAbsoluteRot = avatarRotations[avatarParentJointIndex];
+                }
+                avatarRotations.push_back(avatarParentAbsoluteRot * avatarRelativeDefaultRot);
+            }
+        }
+
+        // convert avatar rotations into relative frame
+        avatarSkeleton.convertAbsoluteRotationsToRelative(avatarRotations);
+
+        for (int avatarJointIndex = 0; avatarJointIndex < avatarJointCount; avatarJointIndex++) {
+            const AnimPose& avatarDefaultPose = avatarSkeleton.getRelativeDefaultPose(avatarJointIndex);
+
+            // copy scale over from avatar default pose
+            glm::vec3 relativeScale = avatarDefaultPose.scale();
+
+            glm::vec3 relativeTranslation;
+            ASSERT(avatarJointIndex >= 0 && avatarJointIndex < (int)avatarToAnimJointIndexMap.size());
+            int animJointIndex = avatarToAnimJointIndexMap[avatarJointIndex];
+            if (animJointIndex >= 0) {
+                // This joint is in both animation and avatar.
+                ASSERT(animJointIndex >= 0 && animJointIndex < (int)animFrame.translations.size());
+                const glm::vec3& animTrans = animFrame.translations[animJointIndex];
+
+                // retarget translation from animation to avatar
+                ASSERT(animJointIndex >= 0 && animJointIndex < (int)animModel.animationFrames[0].translations.size());
+                const glm::vec3& animZeroTrans = animModel.animationFrames[0].translations[animJointIndex];
+                relativeTranslation = avatarDefaultPose.trans() + boneLengthScale * (animTrans - animZeroTrans);
+            } else {
+                // This joint is NOT in the animation at all.
+                // preserve the default translation.
+                relativeTranslation = avatarDefaultPose.trans();
+            }
+
+            // build the final pose
+            ASSERT(avatarJointIndex >= 0 && avatarJointIndex < (int)avatarRotations.size());
+            frames->setPose(frame, avatarJointIndex, AnimPose(relativeScale, avatarRotations[avatarJointIndex], relativeTranslation));
+        }
+    }
+
+    return frames;
+}
@@ -0,0 +1,90 @@
+//
+//  AnimClipFrames.h
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AnimClipFrames_h
+#define hifi_AnimClipFrames_h
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <hfm/HFM.h>
+
+#include "AnimPose.h"
+
+class AnimSkeleton;
+
+// The keyframes of an animation retargeted onto a particular skeleton.
+//
+// Frames are stored as a structure-of-arrays: for every frame each pose component (rot.x, rot.y, ..., scale.z) is
+// a contiguous run of floats, one per joint, padded to a multiple of four joints.  This lets blend() interpolate
+// four joints at a time with SIMD and touch only the two frames it needs.
+//
+// Instances are immutable once built and are shared through the AnimationCache between all clips that play the same
+// animation on an identical skeleton.  The mirrored frames are built lazily, once, by the first clip that asks.
+
+class AnimClipFrames {
+public:
+    using Pointer = std::shared_ptr<AnimClipFrames>;
+    using ConstPointer = std::shared_ptr<const AnimClipFrames>;
+
+    AnimClipFrames(int numFrames, int numJoints);
+
+    // retarget the frames of animModel onto avatarSkeleton
+    static Pointer build(const HFMModel& animModel, const AnimSkeleton& avatarSkeleton);
+
+    int getNumFrames() const { return _numFrames; }
+    int getNumJoints() const { return _numJoints; }
+
+    void setPose(int frame, int joint, const AnimPose& pose);
+    AnimPose getPose(int frame, int joint) const;
+
+    // interpolate between prevFrame and nextFrame, writing getNumJoints() poses into result
+    void blend(int prevFrame, int nextFrame, float alpha, AnimPose* result) const;
+
+    // reference implementation, one joint at a time
+    void blendScalar(int prevFrame, int nextFrame, float alpha, AnimPose* result) const;
+
+    // \return frames mirrored across the skeleton's mirror plane, building them on first use
+    const AnimClipFrames& getMirror(const AnimSkeleton& skeleton) const;
+
+    size_t getMemoryUsage() const { return _data.size() * sizeof(float); }
+
+private:
+    enum Component {
+        ROT_X = 0,
+        ROT_Y,
+        ROT_Z,
+        ROT_W,
+        TRANS_X,
+        TRANS_Y,
+        TRANS_Z,
+        SCALE_X,
+        SCALE_Y,
+        SCALE_Z,
+        NUM_COMPONENTS
+    };
+
+    const float* component(int frame, Component c) const { return &_data[(frame * NUM_COMPONENTS + c) * _stride]; }
+    float* component(int frame, Component c) { return &_data[(frame * NUM_COMPONENTS + c) * _stride]; }
+
+    int _numFrames;
+    int _numJoints;
+    int _stride;
+    std::vector<float> _data;
+
+    mutable std::once_flag _mirrorOnce;
+    mutable std::unique_ptr<AnimClipFrames> _mirror;
+
+    // no copies
+    AnimClipFrames(const AnimClipFrames&) = delete;
+    AnimClipFrames& operator=(const AnimClipFrames&) = delete;
+};
+
+#endif // hifi_AnimClipFrames_h
@@ -10,6 +10,8 @@
 
 #include "AnimSkeleton.h"
 
+#include <QCryptographicHash>
+
 #include <glm/gtx/transform.hpp>
 
 #include <GLMHelpers.h>
@@ -294,6 +296,18 @@ void AnimSkeleton::buildSkeletonFromJoints(const std::vector<HFMJoint>& joints,
             _mirrorMap.push_back(i);
         }
     }
+
+    // fingerprint everything that affects retargeting, so identical skeletons can share retargeted animations.
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData((const char*)&_geometryOffset[0][0], sizeof(_geometryOffset));
+    for (int i = 0; i < _jointsSize; i++) {
+        hash.addData(_joints[i].name.toUtf8());
+        hash.addData((const char*)&_parentIndices[i], sizeof(int));
+        hash.addData((const char*)&_relativeDefaultPoses[i].scale()[0], sizeof(glm::vec3));
+        hash.addData((const char*)&_relativeDefaultPoses[i].rot()[0], sizeof(glm::quat));
+        hash.addData((const char*)&_relativeDefaultPoses[i].trans()[0], sizeof(glm::vec3));
+    }
+    _fingerprint = hash.result();
 }
 
 void AnimSkeleton::dump(bool verbose) const {
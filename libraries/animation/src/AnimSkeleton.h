@@ -68,6 +68,9 @@ public:
     void dump(const AnimPoseVec& poses) const;
 
     std::vector<int> lookUpJointIndices(const std::vector<QString>& jointNames) const;
+    // two skeletons with the same fingerprint retarget animations identically
+    const QByteArray& getFingerprint() const { return _fingerprint; }
+
     const HFMCluster getClusterBindMatricesOriginalValues(const int meshIndex, const int clusterIndex) const { return _clusterBindMatrixOriginalValues[meshIndex][clusterIndex]; }
 
 protected:
@@ -86,6 +89,7 @@ protected:
     QHash<QString, int> _jointIndicesByName;
     std::vector<std::vector<HFMCluster>> _clusterBindMatrixOriginalValues;
     glm::mat4 _geometryOffset;
+    QByteArray _fingerprint;
 
     // no copies
     AnimSkeleton(const AnimSkeleton&) = delete;
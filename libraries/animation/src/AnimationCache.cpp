@@ -19,11 +19,15 @@
 #include <StatTracker.h>
 #include <Profile.h>
 
+#include "AnimClipFrames.h"
+#include "AnimSkeleton.h"
 #include "AnimationLogging.h"
 #include <FBXSerializer.h>
 
 int animationPointerMetaTypeId = qRegisterMetaType<AnimationPointer>();
 
+std::atomic<uint64_t> Animation::_nextGeneration { 1 };
+
 AnimationCache::AnimationCache(QObject* parent) :
     ResourceCache(parent)
 {
@@ -36,6 +40,51 @@ AnimationPointer AnimationCache::getAnimation(const QUrl& url) {
     return getResource(url).staticCast<Animation>();
 }
 
+std::shared_ptr<const AnimClipFrames> AnimationCache::getClipFrames(const AnimationPointer& animation, const AnimSkeleton& skeleton) {
+    assert(animation && animation->isLoaded());
+    const HFMModel& animModel = animation->getHFMModel();
+
+    // the generation distinguishes reloads of the same url
+    std::string key = animation->getURL().toString().toStdString() + "#" +
+        std::to_string(animation->getGeneration()) + "#" + skeleton.getFingerprint().toHex().toStdString();
+
+    {
+        std::unique_lock<std::mutex> lock(_clipFramesMutex);
+        auto itr = _clipFrames.find(key);
+        if (itr != _clipFrames.end()) {
+            auto frames = itr->second.lock();
+            if (frames) {
+                return frames;
+            }
+        }
+    }
+
+    // retargeting is slow so build outside the lock
+    std::shared_ptr<const AnimClipFrames> frames = AnimClipFrames::build(animModel, skeleton);
+
+    std::unique_lock<std::mutex> lock(_clipFramesMutex);
+    auto itr = _clipFrames.find(key);
+    if (itr != _clipFrames.end()) {
+        // another thread built the same frames meanwhile --> share theirs
+        auto existingFrames = itr->second.lock();
+        if (existingFrames) {
+            return existingFrames;
+        }
+    }
+
+    // forget entries whose clips have all gone away
+    for (auto entry = _clipFrames.begin(); entry != _clipFrames.end();) {
+        if (entry->second.expired()) {
+            entry = _clipFrames.erase(entry);
+        } else {
+            ++entry;
+        }
+    }
+
+    _clipFrames[key] = frames;
+    return frames;
+}
+
 QSharedPointer<Resource> AnimationCache::createResource(const QUrl& url) {
     return QSharedPointer<Resource>(new Animation(url), &Resource::deleter);
 }
@@ -47,11 +96,11 @@ QSharedPointer<Resource> AnimationCache::createResourceCopy(const QSharedPointer
 AnimationReader::AnimationReader(const QUrl& url, const QByteArray& data) :
     _url(url),
     _data(data) {
-    DependencyManager::get<StatTracker>()->incrementStat("PendingProcessing");
+    STAT_COUNTER("PendingProcessing").increment();
 }
 
 void AnimationReader::run() {
-    DependencyManager::get<StatTracker>()->decrementStat("PendingProcessing");
+    STAT_COUNTER("PendingProcessing").decrement();
     CounterStat counter("Processing");
 
     PROFILE_RANGE_EX(resource_parse, __FUNCTION__, 0xFF00FF00, 0, { { "url", _url.toString() } });
@@ -137,6 +186,7 @@ void Animation::downloadFinished(const QByteArray& data) {
 
 void Animation::animationParseSuccess(HFMModel::Pointer hfmModel) {
     _hfmModel = hfmModel;
+    _generation = _nextGeneration++;
     finishedLoading(true);
 }
 
@@ -12,6 +12,11 @@
 #ifndef hifi_AnimationCache_h
 #define hifi_AnimationCache_h
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
 #include <QtCore/QRunnable>
 #include <QtScript/QScriptEngine>
 #include <QtScript/QScriptValue>
@@ -21,6 +26,8 @@
 #include <ResourceCache.h>
 
 class Animation;
+class AnimClipFrames;
+class AnimSkeleton;
 
 using AnimationPointer = QSharedPointer<Animation>;
 
@@ -33,6 +40,10 @@ public:
     Q_INVOKABLE AnimationPointer getAnimation(const QString& url) { return getAnimation(QUrl(url)); }
     Q_INVOKABLE AnimationPointer getAnimation(const QUrl& url);
 
+    /// \return the frames of a loaded animation retargeted onto skeleton.  Clips playing the same animation on
+    /// identical skeletons (e.g. many avatars wearing the same model) share a single copy.
+    std::shared_ptr<const AnimClipFrames> getClipFrames(const AnimationPointer& animation, const AnimSkeleton& skeleton);
+
 protected:
     virtual QSharedPointer<Resource> createResource(const QUrl& url) override;
     QSharedPointer<Resource> createResourceCopy(const QSharedPointer<Resource>& resource) override;
@@ -41,6 +52,8 @@ private:
     explicit AnimationCache(QObject* parent = NULL);
     virtual ~AnimationCache() { }
 
+    std::mutex _clipFramesMutex;
+    std::unordered_map<std::string, std::weak_ptr<const AnimClipFrames>> _clipFrames;
 };
 
 Q_DECLARE_METATYPE(AnimationPointer)
@@ -51,13 +64,16 @@ class Animation : public Resource {
 
 public:
 
-    Animation(const Animation& other) : Resource(other), _hfmModel(other._hfmModel) {}
+    Animation(const Animation& other) : Resource(other), _hfmModel(other._hfmModel), _generation(other._generation) {}
     Animation(const QUrl& url) : Resource(url) {}
 
     QString getType() const override { return "Animation"; }
 
     const HFMModel& getHFMModel() const { return *_hfmModel; }
 
+    /// \return an id unique to the currently loaded HFMModel, so reloads of the same url can be told apart
+    uint64_t getGeneration() const { return _generation; }
+
     virtual bool isLoaded() const override;
 
     Q_INVOKABLE QStringList getJointNames() const;
@@ -74,8 +90,10 @@ protected slots:
     void animationParseError(int error, QString str);
 
 private:
-    
+    static std::atomic<uint64_t> _nextGeneration;
+
     HFMModel::Pointer _hfmModel;
+    uint64_t _generation { 0 };
 };
 
 /// Reads geometry in a worker thread.
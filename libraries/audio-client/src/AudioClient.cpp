@@ -1528,122 +1528,18 @@ void AudioClient::prepareLocalAudioInjectors(std::unique_ptr<Lock> localAudioLoc
 }
 
 bool AudioClient::mixLocalAudioInjectors(float* mixBuffer) {
-    // check the flag for injectors before attempting to lock
-    if (!_localInjectorsAvailable.load(std::memory_order_acquire)) {
+    // check for injectors before asking where we are
+    if (!_localInjectorVoices.hasInjectors()) {
         return false;
     }
 
-    // lock the injectors
-    Lock lock(_injectorsMutex);
+    AudioInjectorVoicePool::Listener listener;
+    listener.position = _positionGetter();
+    listener.orientation = _orientationGetter();
+    listener.localInjectorGain = _localInjectorGain;
+    listener.systemInjectorGain = _systemInjectorGain;
 
-    QVector<AudioInjectorPointer> injectorsToRemove;
-
-    memset(mixBuffer, 0, AudioConstants::NETWORK_FRAME_SAMPLES_STEREO * sizeof(float));
-
-    for (const AudioInjectorPointer& injector : _activeLocalAudioInjectors) {
-        // the lock guarantees that injectorBuffer, if found, is invariant
-        auto injectorBuffer = injector->getLocalBuffer();
-        if (injectorBuffer) {
-
-            auto options = injector->getOptions();
-
-            static const int HRTF_DATASET_INDEX = 1;
-
-            int numChannels = options.ambisonic ? AudioConstants::AMBISONIC : (options.stereo ? AudioConstants::STEREO : AudioConstants::MONO);
-            size_t bytesToRead = numChannels * AudioConstants::NETWORK_FRAME_BYTES_PER_CHANNEL;
-
-            // get one frame from the injector
-            memset(_localScratchBuffer, 0, bytesToRead);
-            if (0 < injectorBuffer->readData((char*)_localScratchBuffer, bytesToRead)) {
-
-                bool isSystemSound = !options.positionSet && !options.ambisonic;
-
-                float gain = options.volume * (isSystemSound ? _systemInjectorGain : _localInjectorGain);
-
-                if (options.ambisonic) {
-
-                    if (options.positionSet) {
-
-                        // distance attenuation
-                        glm::vec3 relativePosition = options.position - _positionGetter();
-                        float distance = glm::max(glm::length(relativePosition), EPSILON);
-                        gain = gainForSource(distance, gain);
-                    }
-
-                    //
-                    // Calculate the soundfield orientation relative to the listener.
-                    // Injector orientation can be used to align a recording to our world coordinates.
-                    //
-                    glm::quat relativeOrientation = options.orientation * glm::inverse(_orientationGetter());
-
-                    // convert from Y-up (OpenGL) to Z-up (Ambisonic) coordinate system
-                    float qw = relativeOrientation.w;
-                    float qx = -relativeOrientation.z;
-                    float qy = -relativeOrientation.x;
-                    float qz = relativeOrientation.y;
-
-                    // spatialize into mixBuffer
-                    injector->getLocalFOA().render(_localScratchBuffer, mixBuffer, HRTF_DATASET_INDEX,
-                                                   qw, qx, qy, qz, gain, AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL);
-                } else if (options.stereo) {
-
-                    if (options.positionSet) {
-
-                        // distance attenuation
-                        glm::vec3 relativePosition = options.position - _positionGetter();
-                        float distance = glm::max(glm::length(relativePosition), EPSILON);
-                        gain = gainForSource(distance, gain);
-                    }
-
-                    // direct mix into mixBuffer
-                    injector->getLocalHRTF().mixStereo(_localScratchBuffer, mixBuffer, gain,
-                                                       AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL);
-                } else {    // injector is mono
-
-                    if (options.positionSet) {
-
-                        // distance attenuation
-                        glm::vec3 relativePosition = options.position - _positionGetter();
-                        float distance = glm::max(glm::length(relativePosition), EPSILON);
-                        gain = gainForSource(distance, gain);
-
-                        float azimuth = azimuthForSource(relativePosition);
-
-                        // spatialize into mixBuffer
-                        injector->getLocalHRTF().render(_localScratchBuffer, mixBuffer, HRTF_DATASET_INDEX,
-                                                        azimuth, distance, gain, AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL);
-                    } else {
-
-                        // direct mix into mixBuffer
-                        injector->getLocalHRTF().mixMono(_localScratchBuffer, mixBuffer, gain,
-                                                         AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL);
-                    }
-                }
-
-            } else {
-
-                //qCDebug(audioclient) << "injector has no more data, marking finished for removal";
-                injector->finishLocalInjection();
-                injectorsToRemove.append(injector);
-            }
-
-        } else {
-
-            //qCDebug(audioclient) << "injector has no local buffer, marking as finished for removal";
-            injector->finishLocalInjection();
-            injectorsToRemove.append(injector);
-        }
-    }
-
-    for (const AudioInjectorPointer& injector : injectorsToRemove) {
-        //qCDebug(audioclient) << "removing injector";
-        _activeLocalAudioInjectors.removeOne(injector);
-    }
-
-    // update the flag
-    _localInjectorsAvailable.exchange(!_activeLocalAudioInjectors.empty(), std::memory_order_release);
-
-    return true;
+    return _localInjectorVoices.mix(mixBuffer, listener);
 }
 
 void AudioClient::processReceivedSamples(const QByteArray& decodedBuffer, QByteArray& outputBuffer) {
@@ -1767,16 +1663,10 @@ bool AudioClient::setIsStereoInput(bool isStereoInput) {
 bool AudioClient::outputLocalInjector(const AudioInjectorPointer& injector) {
     auto injectorBuffer = injector->getLocalBuffer();
     if (injectorBuffer) {
-        // local injectors are on the AudioInjectorsThread, so we must guard access
-        Lock lock(_injectorsMutex);
-        if (!_activeLocalAudioInjectors.contains(injector)) {
-            //qCDebug(audioclient) << "adding new injector";
-            _activeLocalAudioInjectors.append(injector);
-
-            // update the flag
-            _localInjectorsAvailable.exchange(true, std::memory_order_release);
-        } else {
-            qCDebug(audioclient) << "injector exists in active list already";
+        // local injectors come from any thread, and are picked up by the next local mix
+        if (!_localInjectorVoices.queueInjector(injector)) {
+            qCDebug(audioclient) << "too many local injectors waiting to play, dropping injector";
+            return false;
         }
 
         return true;
@@ -1788,8 +1678,7 @@ bool AudioClient::outputLocalInjector(const AudioInjectorPointer& injector) {
 }
 
 int AudioClient::getNumLocalInjectors() {
-    Lock lock(_injectorsMutex);
-    return _activeLocalAudioInjectors.size();
+    return _localInjectorVoices.getNumVoices();
 }
 
 void AudioClient::outputFormatChanged() {
@@ -2224,41 +2113,6 @@ int AudioClient::calculateNumberOfFrameSamples(int numBytes) const {
     return frameSamples;
 }
 
-float AudioClient::azimuthForSource(const glm::vec3& relativePosition) {
-    glm::quat inverseOrientation = glm::inverse(_orientationGetter());
-
-    glm::vec3 rotatedSourcePosition = inverseOrientation * relativePosition;
-
-    // project the rotated source position vector onto the XZ plane
-    rotatedSourcePosition.y = 0.0f;
-
-    static const float SOURCE_DISTANCE_THRESHOLD = 1e-30f;
-
-    float rotatedSourcePositionLength2 = glm::length2(rotatedSourcePosition);
-    if (rotatedSourcePositionLength2 > SOURCE_DISTANCE_THRESHOLD) {
-
-        // produce an oriented angle about the y-axis
-        glm::vec3 direction = rotatedSourcePosition * (1.0f / fastSqrtf(rotatedSourcePositionLength2));
-        float angle = fastAcosf(glm::clamp(-direction.z, -1.0f, 1.0f)); // UNIT_NEG_Z is "forward"
-        return (direction.x < 0.0f) ? -angle : angle;
-
-    } else {
-        // no azimuth if they are in same spot
-        return 0.0f;
-    }
-}
-
-float AudioClient::gainForSource(float distance, float volume) {
-
-    // attenuation = -6dB * log2(distance)
-    // reference attenuation of 0dB at distance = ATTN_DISTANCE_REF
-    float d = (1.0f / ATTN_DISTANCE_REF) * std::max(distance, HRTF_NEARFIELD_MIN);
-    float gain = volume / d;
-    gain = std::min(gain, ATTN_GAIN_MAX);
-
-    return gain;
-}
-
 qint64 AudioClient::AudioOutputIODevice::readData(char * data, qint64 maxSize) {
 
     // lock-free wait for initialization to avoid races
@@ -2299,7 +2153,7 @@ qint64 AudioClient::AudioOutputIODevice::readData(char * data, qint64 maxSize) {
         int samplesAvailable = _audio->_localSamplesAvailable.load(std::memory_order_acquire);
 
         // if we do not have enough samples buffered despite having injectors, buffer them synchronously
-        if (samplesAvailable < samplesRequested && _audio->_localInjectorsAvailable.load(std::memory_order_acquire)) {
+        if (samplesAvailable < samplesRequested && _audio->_localInjectorVoices.hasInjectors()) {
             // try_to_lock, in case the device is being shut down already
             std::unique_ptr<Lock> localAudioLock(new Lock(_audio->_localAudioMutex, std::try_to_lock));
             if (localAudioLock->owns_lock()) {
@@ -42,6 +42,7 @@
 #include <AudioHRTF.h>
 #include <AudioSRC.h>
 #include <AudioInjector.h>
+#include <AudioInjectorVoicePool.h>
 #include <AudioReverb.h>
 #include <AudioLimiter.h>
 #include <AudioConstants.h>
@@ -302,8 +303,6 @@ private:
     void handleAudioInput(QByteArray& audioBuffer);
     void prepareLocalAudioInjectors(std::unique_ptr<Lock> localAudioLock = nullptr);
     bool mixLocalAudioInjectors(float* mixBuffer);
-    float azimuthForSource(const glm::vec3& relativePosition);
-    float gainForSource(float distance, float volume);
 
 #ifdef Q_OS_ANDROID
     QTimer _checkInputTimer;
@@ -337,7 +336,6 @@ private:
 
     Gate _gate;
 
-    Mutex _injectorsMutex;
     QAudioInput* _audioInput;
     QTimer* _dummyAudioInput;
     QAudioFormat _desiredInputFormat;
@@ -355,9 +353,8 @@ private:
     AudioRingBuffer _inputRingBuffer;
     LocalInjectorsStream _localInjectorsStream;
     // In order to use _localInjectorsStream as a lock-free pipe,
-    // use it with a single producer/consumer, and track available samples and injectors
+    // use it with a single producer/consumer, and track available samples
     std::atomic<int> _localSamplesAvailable { 0 };
-    std::atomic<bool> _localInjectorsAvailable { false };
     MixedProcessedAudioStream _receivedAudioStream;
     bool _isStereoInput;
     std::atomic<bool> _enablePeakValues { false };
@@ -412,7 +409,6 @@ private:
     std::atomic<float> _localInjectorGain { 1.0f };
     std::atomic<float> _systemInjectorGain { 1.0f };
     float _localMixBuffer[AudioConstants::NETWORK_FRAME_SAMPLES_STEREO];
-    int16_t _localScratchBuffer[AudioConstants::NETWORK_FRAME_SAMPLES_AMBISONIC];
     float* _localOutputMixBuffer { NULL };
     Mutex _localAudioMutex;
     AudioLimiter _audioLimiter;
@@ -469,7 +465,8 @@ private:
 
     bool _hasReceivedFirstPacket { false };
 
-    QVector<AudioInjectorPointer> _activeLocalAudioInjectors;
+    // local injectors are queued from any thread, and played by whichever thread holds _localAudioMutex
+    AudioInjectorVoicePool _localInjectorVoices;
 
     bool _isPlayingBackRecording { false };
     bool _audioPaused { false };
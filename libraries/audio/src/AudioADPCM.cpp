@@ -0,0 +1,137 @@
+//
+//  AudioADPCM.cpp
+//  libraries/audio/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "AudioADPCM.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+static const int NUM_STEP_SIZES = 89;
+
+static const int16_t STEP_SIZES[NUM_STEP_SIZES] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+// how far the step index moves after each code magnitude
+static const int STEP_INDEX_ADJUSTMENTS[8] = { -1, -1, -1, -1, 2, 4, 6, 8 };
+
+static inline int clampStepIndex(int stepIndex) {
+    return std::min(std::max(stepIndex, 0), NUM_STEP_SIZES - 1);
+}
+
+static inline int clampSample(int sample) {
+    return std::min(std::max(sample, -32768), 32767);
+}
+
+// 3 bits of magnitude in steps of step / 4, and a sign bit
+static inline int quantize(int difference, int step) {
+    int code = difference < 0 ? 8 : 0;
+    difference = std::abs(difference);
+
+    if (difference >= step) {
+        code |= 4;
+        difference -= step;
+    }
+    step >>= 1;
+    if (difference >= step) {
+        code |= 2;
+        difference -= step;
+    }
+    step >>= 1;
+    if (difference >= step) {
+        code |= 1;
+    }
+    return code;
+}
+
+// the encoder predicts with this too, so that it tracks exactly what the decoder reconstructs
+static inline int dequantize(int code, int step) {
+    int difference = step >> 3;
+    if (code & 4) {
+        difference += step;
+    }
+    if (code & 2) {
+        difference += step >> 1;
+    }
+    if (code & 1) {
+        difference += step >> 2;
+    }
+    return (code & 8) ? -difference : difference;
+}
+
+AudioADPCM::AudioADPCM(int numChannels) :
+    _numChannels(numChannels),
+    _stepIndices(numChannels, 0) {
+}
+
+void AudioADPCM::encode(const int16_t* input, uint8_t* output, int numFrames) {
+    const int bytesPerChannel = getEncodedSize(numFrames, 1);
+
+    for (int channel = 0; channel < _numChannels; ++channel) {
+        uint8_t* header = output + channel * bytesPerChannel;
+        uint8_t* codes = header + HEADER_BYTES_PER_CHANNEL;
+
+        int predictor = input[channel];
+        int stepIndex = _stepIndices[channel];
+
+        header[0] = (uint8_t)(predictor & 0xff);
+        header[1] = (uint8_t)((predictor >> 8) & 0xff);
+        header[2] = (uint8_t)stepIndex;
+        header[3] = 0;
+
+        // the first sample is in the header, the rest are packed two codes to a byte, low nibble first
+        for (int i = 1; i < numFrames; ++i) {
+            int step = STEP_SIZES[stepIndex];
+            int code = quantize(input[i * _numChannels + channel] - predictor, step);
+
+            predictor = clampSample(predictor + dequantize(code, step));
+            stepIndex = clampStepIndex(stepIndex + STEP_INDEX_ADJUSTMENTS[code & 7]);
+
+            int n = i - 1;
+            if (n & 1) {
+                codes[n >> 1] |= (uint8_t)(code << 4);
+            } else {
+                codes[n >> 1] = (uint8_t)code;
+            }
+        }
+
+        _stepIndices[channel] = stepIndex;
+    }
+}
+
+void AudioADPCM::decode(const uint8_t* input, int16_t* output, int numFrames, int numChannels) {
+    const int bytesPerChannel = getEncodedSize(numFrames, 1);
+
+    for (int channel = 0; channel < numChannels; ++channel) {
+        const uint8_t* header = input + channel * bytesPerChannel;
+        const uint8_t* codes = header + HEADER_BYTES_PER_CHANNEL;
+
+        int predictor = (int16_t)(header[0] | (header[1] << 8));
+        // the header came over the network, keep the step index in range
+        int stepIndex = clampStepIndex(header[2]);
+
+        output[channel] = (int16_t)predictor;
+
+        for (int i = 1; i < numFrames; ++i) {
+            int n = i - 1;
+            int code = (codes[n >> 1] >> ((n & 1) << 2)) & 0x0f;
+            int step = STEP_SIZES[stepIndex];
+
+            predictor = clampSample(predictor + dequantize(code, step));
+            stepIndex = clampStepIndex(stepIndex + STEP_INDEX_ADJUSTMENTS[code & 7]);
+
+            output[i * numChannels + channel] = (int16_t)predictor;
+        }
+    }
+}
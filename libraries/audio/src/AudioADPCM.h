@@ -0,0 +1,47 @@
+//
+//  AudioADPCM.h
+//  libraries/audio/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AudioADPCM_h
+#define hifi_AudioADPCM_h
+
+#include <stdint.h>
+#include <vector>
+
+//
+// Fixed rate 4-bit adaptive differential PCM, using the IMA step sizes, for roughly 4:1 on int16_t audio.
+// Each channel of a frame starts with a header holding its first sample and step index, so a frame decodes on
+// its own and a lost one doesn't throw off the frames after it.
+//
+class AudioADPCM {
+public:
+    static const int HEADER_BYTES_PER_CHANNEL = 4;
+
+    // The bytes a frame of numFrames takes, headers included
+    static int getEncodedSize(int numFrames, int numChannels) {
+        return numChannels * (HEADER_BYTES_PER_CHANNEL + numFrames / 2);
+    }
+
+    AudioADPCM(int numChannels);
+
+    //
+    // Encode interleaved int16_t input into getEncodedSize(numFrames) bytes of output.
+    // The step sizes carry over from the previous frame, so the encoder doesn't adapt from scratch every frame.
+    //
+    void encode(const int16_t* input, uint8_t* output, int numFrames);
+
+    // Decode getEncodedSize(numFrames) bytes of input into interleaved int16_t output
+    static void decode(const uint8_t* input, int16_t* output, int numFrames, int numChannels);
+
+private:
+    int _numChannels;
+    std::vector<int> _stepIndices;
+};
+
+#endif // hifi_AudioADPCM_h
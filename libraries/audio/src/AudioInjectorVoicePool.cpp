@@ -0,0 +1,269 @@
+//
+//  AudioInjectorVoicePool.cpp
+//  libraries/audio/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "AudioInjectorVoicePool.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <glm/gtx/norm.hpp>
+
+#include <AudioHelpers.h>
+#include <NumericalConstants.h>
+
+#include "AudioHRTF.h"
+#include "AudioInjectorLocalBuffer.h"
+#include "AudioLogging.h"
+
+const int AudioInjectorVoicePool::MAX_VOICES;
+const int AudioInjectorVoicePool::MAX_QUEUED_INJECTORS;
+
+static_assert((AudioInjectorVoicePool::MAX_QUEUED_INJECTORS & (AudioInjectorVoicePool::MAX_QUEUED_INJECTORS - 1)) == 0,
+              "MAX_QUEUED_INJECTORS must be a power of two");
+
+static const int HRTF_DATASET_INDEX = 1;
+
+static float azimuthForSource(const glm::vec3& relativePosition, const glm::quat& orientation) {
+    glm::quat inverseOrientation = glm::inverse(orientation);
+
+    glm::vec3 rotatedSourcePosition = inverseOrientation * relativePosition;
+
+    // project the rotated source position vector onto the XZ plane
+    rotatedSourcePosition.y = 0.0f;
+
+    static const float SOURCE_DISTANCE_THRESHOLD = 1e-30f;
+
+    float rotatedSourcePositionLength2 = glm::length2(rotatedSourcePosition);
+    if (rotatedSourcePositionLength2 > SOURCE_DISTANCE_THRESHOLD) {
+
+        // produce an oriented angle about the y-axis
+        glm::vec3 direction = rotatedSourcePosition * (1.0f / fastSqrtf(rotatedSourcePositionLength2));
+        float angle = fastAcosf(glm::clamp(-direction.z, -1.0f, 1.0f)); // UNIT_NEG_Z is "forward"
+        return (direction.x < 0.0f) ? -angle : angle;
+
+    } else {
+        // no azimuth if they are in same spot
+        return 0.0f;
+    }
+}
+
+static float gainForSource(float distance, float volume) {
+
+    // attenuation = -6dB * log2(distance)
+    // reference attenuation of 0dB at distance = ATTN_DISTANCE_REF
+    float d = (1.0f / ATTN_DISTANCE_REF) * std::max(distance, HRTF_NEARFIELD_MIN);
+    float gain = volume / d;
+    gain = std::min(gain, ATTN_GAIN_MAX);
+
+    return gain;
+}
+
+// the gain an injector plays at, with distance attenuation when it has a position
+static float gainForInjector(const AudioInjectorOptions& options, const AudioInjectorVoicePool::Listener& listener,
+                             glm::vec3& relativePosition, float& distance) {
+    bool isSystemSound = !options.positionSet && !options.ambisonic;
+
+    float gain = options.volume * (isSystemSound ? listener.systemInjectorGain : listener.localInjectorGain);
+
+    if (options.positionSet) {
+        relativePosition = options.position - listener.position;
+        distance = glm::max(glm::length(relativePosition), EPSILON);
+        gain = gainForSource(distance, gain);
+    }
+    return gain;
+}
+
+AudioInjectorVoicePool::AudioInjectorVoicePool() {
+    for (uint32_t i = 0; i < (uint32_t)MAX_QUEUED_INJECTORS; ++i) {
+        _queue[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool AudioInjectorVoicePool::queueInjector(const AudioInjectorPointer& injector) {
+    uint32_t position = _enqueuePosition.load(std::memory_order_relaxed);
+    while (true) {
+        QueueCell& cell = _queue[position & (MAX_QUEUED_INJECTORS - 1)];
+        int32_t difference = (int32_t)(cell.sequence.load(std::memory_order_acquire) - position);
+
+        if (difference == 0) {
+            // the cell is free, claim it
+            if (_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                cell.injector = injector;
+                cell.sequence.store(position + 1);
+                break;
+            }
+        } else if (difference < 0) {
+            // the mix hasn't caught up with the queue
+            return false;
+        } else {
+            // another thread claimed the cell first
+            position = _enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    // after the cell is ready, so the mix can't miss it
+    _hasInjectors.store(true);
+    return true;
+}
+
+bool AudioInjectorVoicePool::dequeueInjector(AudioInjectorPointer& injector) {
+    QueueCell& cell = _queue[_dequeuePosition & (MAX_QUEUED_INJECTORS - 1)];
+    if (cell.sequence.load() != _dequeuePosition + 1) {
+        return false;
+    }
+
+    injector.swap(cell.injector);
+    cell.sequence.store(_dequeuePosition + MAX_QUEUED_INJECTORS, std::memory_order_release);
+    ++_dequeuePosition;
+    return true;
+}
+
+bool AudioInjectorVoicePool::mix(float* mixBuffer, const Listener& listener) {
+    // check the flag for injectors before taking anything off the queue
+    if (!_hasInjectors.load()) {
+        return false;
+    }
+
+    AudioInjectorPointer injector;
+    while (dequeueInjector(injector)) {
+        startVoice(std::move(injector), listener);
+        injector.reset();
+    }
+
+    memset(mixBuffer, 0, AudioConstants::NETWORK_FRAME_SAMPLES_STEREO * sizeof(float));
+
+    int i = 0;
+    while (i < _numVoices) {
+        if (mixVoice(_voices[i], mixBuffer, listener)) {
+            ++i;
+        } else {
+            // the last voice takes this one's place, and is mixed next
+            stopVoice(i);
+        }
+    }
+
+    _numVoicesPlaying.store(_numVoices, std::memory_order_relaxed);
+
+    // update the flag, and set it again if an injector was queued since the queue was emptied
+    _hasInjectors.store(_numVoices > 0);
+    if (_numVoices == 0 && _queue[_dequeuePosition & (MAX_QUEUED_INJECTORS - 1)].sequence.load() == _dequeuePosition + 1) {
+        _hasInjectors.store(true);
+    }
+
+    return true;
+}
+
+void AudioInjectorVoicePool::startVoice(AudioInjectorPointer injector, const Listener& listener) {
+    for (int i = 0; i < _numVoices; ++i) {
+        if (_voices[i].injector == injector) {
+            qCDebug(audio) << "injector exists in active list already";
+            return;
+        }
+    }
+
+    glm::vec3 relativePosition;
+    float distance;
+    float gain = gainForInjector(injector->getOptions(), listener, relativePosition, distance);
+
+    if (_numVoices < MAX_VOICES) {
+        _voices[_numVoices].injector = std::move(injector);
+        _voices[_numVoices].gain = gain;
+        ++_numVoices;
+        return;
+    }
+
+    // every voice is playing, steal the quietest
+    auto quietest = std::min_element(_voices.begin(), _voices.end(), [](const Voice& a, const Voice& b) {
+        return a.gain < b.gain;
+    });
+
+    if (quietest->gain <= gain) {
+        quietest->injector->finishLocalInjection();
+        quietest->injector = std::move(injector);
+        quietest->gain = gain;
+    } else {
+        injector->finishLocalInjection();
+    }
+}
+
+void AudioInjectorVoicePool::stopVoice(int index) {
+    --_numVoices;
+    if (index != _numVoices) {
+        std::swap(_voices[index], _voices[_numVoices]);
+    }
+    _voices[_numVoices].injector.reset();
+}
+
+bool AudioInjectorVoicePool::mixVoice(Voice& voice, float* mixBuffer, const Listener& listener) {
+    const AudioInjectorPointer& injector = voice.injector;
+
+    auto injectorBuffer = injector->getLocalBuffer();
+    if (!injectorBuffer) {
+        //qCDebug(audio) << "injector has no local buffer, marking as finished for removal";
+        injector->finishLocalInjection();
+        return false;
+    }
+
+    auto options = injector->getOptions();
+
+    int numChannels = options.ambisonic ? AudioConstants::AMBISONIC : (options.stereo ? AudioConstants::STEREO : AudioConstants::MONO);
+    size_t bytesToRead = numChannels * AudioConstants::NETWORK_FRAME_BYTES_PER_CHANNEL;
+
+    // get one frame from the injector
+    memset(_scratchBuffer, 0, bytesToRead);
+    if (0 >= injectorBuffer->readData((char*)_scratchBuffer, bytesToRead)) {
+        //qCDebug(audio) << "injector has no more data, marking finished for removal";
+        injector->finishLocalInjection();
+        return false;
+    }
+
+    glm::vec3 relativePosition;
+    float distance = 0.0f;
+    float gain = gainForInjector(options, listener, relativePosition, distance);
+    voice.gain = gain;
+
+    if (options.ambisonic) {
+
+        //
+        // Calculate the soundfield orientation relative to the listener.
+        // Injector orientation can be used to align a recording to our world coordinates.
+        //
+        glm::quat relativeOrientation = options.orientation * glm::inverse(listener.orientation);
+
+        // convert from Y-up (OpenGL) to Z-up (Ambisonic) coordinate system
+        float qw = relativeOrientation.w;
+        float qx = -relativeOrientation.z;
+        float qy = -relativeOrientation.x;
+        float qz = relativeOrientation.y;
+
+        // spatialize into mixBuffer
+        injector->getLocalFOA().render(_scratchBuffer, mixBuffer, HRTF_DATASET_INDEX,
+                                       qw, qx, qy, qz, gain, AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL);
+    } else if (options.stereo) {
+
+        // direct mix into mixBuffer
+        injector->getLocalHRTF().mixStereo(_scratchBuffer, mixBuffer, gain,
+                                           AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL);
+    } else if (options.positionSet) {
+
+        float azimuth = azimuthForSource(relativePosition, listener.orientation);
+
+        // spatialize into mixBuffer
+        injector->getLocalHRTF().render(_scratchBuffer, mixBuffer, HRTF_DATASET_INDEX,
+                                        azimuth, distance, gain, AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL);
+    } else {
+
+        // direct mix into mixBuffer
+        injector->getLocalHRTF().mixMono(_scratchBuffer, mixBuffer, gain,
+                                         AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL);
+    }
+
+    return true;
+}
@@ -0,0 +1,88 @@
+//
+//  AudioInjectorVoicePool.h
+//  libraries/audio/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AudioInjectorVoicePool_h
+#define hifi_AudioInjectorVoicePool_h
+
+#include <array>
+#include <atomic>
+#include <stdint.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "AudioConstants.h"
+#include "AudioInjector.h"
+
+//
+// Mixes local injectors on a fixed pool of voices.  Injectors are queued from any thread without taking a lock,
+// and the mix takes them off the queue at the start of each frame, so starting a sound never holds up the audio
+// thread.  When every voice is playing, a new injector takes the quietest voice's place, or is dropped if it
+// would be quieter still.
+//
+class AudioInjectorVoicePool {
+public:
+    static const int MAX_VOICES = 256;
+    static const int MAX_QUEUED_INJECTORS = 256;
+
+    struct Listener {
+        glm::vec3 position;
+        glm::quat orientation;
+        float localInjectorGain { 1.0f };
+        float systemInjectorGain { 1.0f };
+    };
+
+    AudioInjectorVoicePool();
+
+    // thread-safe and lock-free, returns false if the queue is full
+    bool queueInjector(const AudioInjectorPointer& injector);
+
+    // thread-safe, whether there are voices playing or injectors waiting for one
+    bool hasInjectors() const { return _hasInjectors.load(); }
+    int getNumVoices() const { return _numVoicesPlaying.load(std::memory_order_relaxed); }
+
+    //
+    // Mix a network frame of every voice into mixBuffer, returning false if there was nothing to mix.
+    // Only one thread may mix at a time, and only that thread touches the voices.
+    //
+    bool mix(float* mixBuffer, const Listener& listener);
+
+private:
+    struct Voice {
+        AudioInjectorPointer injector;
+        float gain { 0.0f }; // as of the last frame, for stealing
+    };
+
+    struct QueueCell {
+        std::atomic<uint32_t> sequence;
+        AudioInjectorPointer injector;
+    };
+
+    bool dequeueInjector(AudioInjectorPointer& injector);
+    void startVoice(AudioInjectorPointer injector, const Listener& listener);
+    void stopVoice(int index);
+    bool mixVoice(Voice& voice, float* mixBuffer, const Listener& listener);
+
+    std::array<Voice, MAX_VOICES> _voices;
+    int _numVoices { 0 };
+
+    // a bounded queue with many producers and this one consumer, a cell is free for
+    // the producer at position when its sequence is position, and ready for the consumer at position + 1
+    std::array<QueueCell, MAX_QUEUED_INJECTORS> _queue;
+    std::atomic<uint32_t> _enqueuePosition { 0 };
+    uint32_t _dequeuePosition { 0 };
+
+    std::atomic<bool> _hasInjectors { false };
+    std::atomic<int> _numVoicesPlaying { 0 };
+
+    int16_t _scratchBuffer[AudioConstants::NETWORK_FRAME_SAMPLES_AMBISONIC];
+};
+
+#endif // hifi_AudioInjectorVoicePool_h
@@ -149,6 +149,20 @@ void SkeletonModel::updateAttitude(const glm::quat& orientation) {
 // Called by Avatar::simulate after it has set the joint states (fullUpdate true if changed),
 // but just before head has been simulated.
 void SkeletonModel::simulate(float deltaTime, bool fullUpdate) {
+    simulateRig(deltaTime, fullUpdate);
+    updateTexturesLoaded();
+
+    if (!isActive() || !_owningAvatar->isMyAvatar()) {
+        return; // only simulate for own avatar
+    }
+
+    auto player = DependencyManager::get<recording::Deck>();
+    if (player->isPlaying()) {
+        return;
+    }
+}
+
+void SkeletonModel::simulateRig(float deltaTime, bool fullUpdate) {
     updateAttitude(_owningAvatar->getWorldOrientation());
     if (fullUpdate) {
         setBlendshapeCoefficients(_owningAvatar->getHead()->getSummedBlendshapeCoefficients());
@@ -163,22 +177,15 @@ void SkeletonModel::simulate(float deltaTime, bool fullUpdate) {
     } else {
         Parent::simulate(deltaTime, fullUpdate);
     }
+}
 
+void SkeletonModel::updateTexturesLoaded() {
     // FIXME: This texture loading logic should probably live in Avatar, to mirror RenderableModelEntityItem,
     // but Avatars don't get updates in the same way
     if (!_texturesLoaded && getGeometry() && getGeometry()->areTexturesLoaded()) {
         _texturesLoaded = true;
         updateRenderItems();
     }
-
-    if (!isActive() || !_owningAvatar->isMyAvatar()) {
-        return; // only simulate for own avatar
-    }
-
-    auto player = DependencyManager::get<recording::Deck>();
-    if (player->isPlaying()) {
-        return;
-    }
 }
 
 class IndexValue {
@@ -37,6 +37,13 @@ public:
     void initJointStates() override;
 
     void simulate(float deltaTime, bool fullUpdate = true) override;
+
+    // simulate() is simulateRig() followed by updateTexturesLoaded().  simulateRig() only touches this model's
+    // Rig and transform, so it may run on a worker thread; updateTexturesLoaded() updates render items and
+    // must run on the main thread.
+    void simulateRig(float deltaTime, bool fullUpdate = true);
+    void updateTexturesLoaded();
+
     void updateRig(float deltaTime, glm::mat4 parentTransform) override;
     void updateAttitude(const glm::quat& orientation);
 
@@ -18,11 +18,15 @@
 #include <QtCore/QMimeDatabase>
 #include <QtNetwork/QTcpSocket>
 
+#include <StatRegistry.h>
+
 #include "HTTPConnection.h"
 #include "EmbeddedWebserverLogging.h"
 
 const int SOCKET_ERROR_EXIT_CODE = 2;
 const int SOCKET_CHECK_INTERVAL_IN_MS = 30000;
+const QString METRICS_PATH = "/metrics";
+const char* METRICS_CONTENT_TYPE = "text/plain; version=0.0.4";
 
 HTTPManager::HTTPManager(const QHostAddress& listenAddress, quint16 port, const QString& documentRoot, HTTPRequestHandler* requestHandler) :
     _listenAddress(listenAddress),
@@ -60,6 +64,13 @@ bool HTTPManager::handleHTTPRequest(HTTPConnection* connection, const QUrl& url,
         // so we don't need to attempt to do so in the document root
         return true;
     }
+
+    if (_isMetricsEnabled && url.path() == METRICS_PATH
+        && connection->requestOperation() == QNetworkAccessManager::GetOperation) {
+        connection->respond(HTTPConnection::StatusCode200, stats::StatRegistry::getInstance().toPrometheusText(),
+                            METRICS_CONTENT_TYPE);
+        return true;
+    }
     
     if (!_documentRoot.isEmpty()) {
         // check to see if there is a file to serve from the document root for this path
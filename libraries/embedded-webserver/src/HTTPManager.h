@@ -37,6 +37,10 @@ public:
     
     bool handleHTTPRequest(HTTPConnection* connection, const QUrl& url, bool skipSubHandler = false) override;
 
+    /// Serves the stats of the StatRegistry in the Prometheus text format at /metrics, to the GET requests
+    /// the request handler leaves to the manager
+    void setMetricsEnabled(bool enabled) { _isMetricsEnabled = enabled; }
+
 private slots:
     void isTcpServerListening();
     void queuedExit(QString errorMessage);
@@ -54,6 +58,7 @@ protected:
     HTTPRequestHandler* _requestHandler;
     QTimer* _isListeningTimer;
     const quint16 _port;
+    bool _isMetricsEnabled { false };
 };
 
 #endif // hifi_HTTPManager_h
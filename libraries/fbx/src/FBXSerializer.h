@@ -117,6 +117,13 @@ public:
     FBXNode _rootNode;
     static FBXNode parseFBX(QIODevice* device);
 
+    /// Parses binary FBX data in place, without copying its arrays more than once.
+    static FBXNode parseFBX(const hifi::ByteArray& data);
+
+    /// Memory maps the file at path and parses it in place.
+    /// \exception QString if the file can't be opened or an error occurs in parsing
+    static FBXNode parseFBXFile(const QString& path);
+
     HFMModel* extractHFMModel(const hifi::VariantHash& mapping, const QString& url);
 
     static ExtractedMesh extractMesh(const FBXNode& object, unsigned int& meshIndex, bool deduplicate);
@@ -11,9 +11,15 @@
 
 #include "FBXSerializer.h"
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <vector>
+
+#include <zlib.h>
+
 #include <QtCore/QBuffer>
-#include <QtCore/QDataStream>
+#include <QtCore/QFile>
 #include <QtCore/QIODevice>
 #include <QtCore/QStringList>
 #include <QtCore/QTextStream>
@@ -23,187 +29,178 @@
 
 #include <shared/NsightHelpers.h>
 #include <hfm/ModelFormatLogging.h>
+#include <TBBHelpers.h>
 
-template<class T>
-int streamSize() {
-    return sizeof(T);
+// Parses the binary FBX format straight out of the file's bytes, which may be memory mapped.
+//
+// Compressed arrays aren't inflated while the node tree is built: their final QVector is allocated and put in the
+// tree, and its inflation is queued.  Once the whole tree is built, all the queued arrays are inflated at once,
+// in parallel when there is enough data, directly into those vectors.
+class BinaryFBXParser {
+public:
+    BinaryFBXParser(const char* data, size_t size) : _begin(data), _end(data + size), _cursor(data) {}
+
+    FBXNode parse();
+
+private:
+    struct CompressedArray {
+        const char* source;
+        uLong sourceSize;
+        char* destination;
+        uLong destinationSize;
+        int elementSize;
+    };
+
+    qint64 getPosition() const { return _cursor - _begin; }
+    const char* readBytes(size_t length);
+
+    template<class T>
+    T read() {
+        T value;
+        memcpy(&value, readBytes(sizeof(T)), sizeof(T));
+        return qFromLittleEndian(value);
+    }
+
+    template<class T>
+    QVariant readArray();
+
+    QVariant parseProperty();
+    FBXNode parseNode();
+    void inflateArrays();
+
+    const char* _begin;
+    const char* _end;
+    const char* _cursor;
+    bool _has64BitPositions { false };
+    std::vector<CompressedArray> _compressedArrays;
+};
+
+template<>
+float BinaryFBXParser::read<float>() {
+    quint32 bits = read<quint32>();
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
 }
 
-template<bool>
-int streamSize() {
-    return 1;
+template<>
+double BinaryFBXParser::read<double>() {
+    quint64 bits = read<quint64>();
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
 }
 
-template<class T>
-QVariant readBinaryArray(QDataStream& in, int& position) {
-    quint32 arrayLength;
-    quint32 encoding;
-    quint32 compressedLength;
+static void toNativeByteOrder(char* data, size_t size, int elementSize) {
+    if (QSysInfo::ByteOrder == QSysInfo::LittleEndian || elementSize == 1) {
+        return;
+    }
+    for (char* element = data; element < data + size; element += elementSize) {
+        std::reverse(element, element + elementSize);
+    }
+}
 
-    in >> arrayLength;
+const char* BinaryFBXParser::readBytes(size_t length) {
+    if (length > (size_t)(_end - _cursor)) {
+        throw QString("FBX file most likely corrupt: unexpected end of data");
+    }
+    const char* bytes = _cursor;
+    _cursor += length;
+    return bytes;
+}
+
+template<class T>
+QVariant BinaryFBXParser::readArray() {
+    quint32 arrayLength = read<quint32>();
     if (arrayLength > std::numeric_limits<int>::max() / sizeof(T)) { // Upcoming byte containers are limited to max signed int
         throw QString("FBX file most likely corrupt: binary data exceeds data limits");
     }
-    in >> encoding;
-    in >> compressedLength;
+    quint32 encoding = read<quint32>();
+    quint32 compressedLength = read<quint32>();
     if (compressedLength > std::numeric_limits<int>::max() / sizeof(T)) { // Upcoming byte containers are limited to max signed int
         throw QString("FBX file most likely corrupt: compressed binary data exceeds data limits");
     }
-    position += sizeof(quint32) * 3;
-
-    QVector<T> values;
-    if ((int)QSysInfo::ByteOrder == (int)in.byteOrder()) {
-        values.resize(arrayLength);
-        hifi::ByteArray arrayData;
-        if (encoding == FBX_PROPERTY_COMPRESSED_FLAG) {
-            // preface encoded data with uncompressed length
-            hifi::ByteArray compressed(sizeof(quint32) + compressedLength, 0);
-            *((quint32*)compressed.data()) = qToBigEndian<quint32>(arrayLength * sizeof(T));
-            in.readRawData(compressed.data() + sizeof(quint32), compressedLength);
-            position += compressedLength;
-            arrayData = qUncompress(compressed);
-            if (arrayData.isEmpty() ||
-                (unsigned int)arrayData.size() != (sizeof(T) * arrayLength)) { // answers empty byte array if corrupt
-                throw QString("corrupt fbx file");
-            }
-        } else {
-            arrayData.resize(sizeof(T) * arrayLength);
-            position += sizeof(T) * arrayLength;
-            in.readRawData(arrayData.data(), arrayData.size());
-        }
 
-        if (arrayData.size() > 0) {
-            memcpy(&values[0], arrayData.constData(), arrayData.size());
-        }
-    } else {
-        values.reserve(arrayLength);
-        if (encoding == FBX_PROPERTY_COMPRESSED_FLAG) {
-            // preface encoded data with uncompressed length
-            hifi::ByteArray compressed(sizeof(quint32) + compressedLength, 0);
-            *((quint32*)compressed.data()) = qToBigEndian<quint32>(arrayLength * sizeof(T));
-            in.readRawData(compressed.data() + sizeof(quint32), compressedLength);
-            position += compressedLength;
-            hifi::ByteArray uncompressed = qUncompress(compressed);
-            if (uncompressed.isEmpty()) { // answers empty byte array if corrupt
-                throw QString("corrupt fbx file");
-            }
-            QDataStream uncompressedIn(uncompressed);
-            uncompressedIn.setByteOrder(QDataStream::LittleEndian);
-            uncompressedIn.setVersion(QDataStream::Qt_4_5); // for single/double precision switch
-            for (quint32 i = 0; i < arrayLength; i++) {
-                T value;
-                uncompressedIn >> value;
-                values.append(value);
-            }
-        } else {
-            for (quint32 i = 0; i < arrayLength; i++) {
-                T value;
-                in >> value;
-                position += streamSize<T>();
-                values.append(value);
-            }
+    QVector<T> values(arrayLength);
+    size_t size = sizeof(T) * arrayLength;
+    char* destination = reinterpret_cast<char*>(values.data());
+
+    if (encoding == FBX_PROPERTY_COMPRESSED_FLAG) {
+        // the returned QVariant shares this buffer, and nothing detaches it before inflateArrays() fills it
+        const char* source = readBytes(compressedLength);
+        if (size > 0) {
+            _compressedArrays.push_back({ source, (uLong)compressedLength, destination, (uLong)size, (int)sizeof(T) });
         }
+    } else if (size > 0) {
+        memcpy(destination, readBytes(size), size);
+        toNativeByteOrder(destination, size, sizeof(T));
     }
     return QVariant::fromValue(values);
 }
 
-QVariant parseBinaryFBXProperty(QDataStream& in, int& position) {
-    char ch;
-    in.device()->getChar(&ch);
-    position++;
+QVariant BinaryFBXParser::parseProperty() {
+    char ch = *readBytes(1);
     switch (ch) {
         case 'Y': {
-            qint16 value;
-            in >> value;
-            position += sizeof(qint16);
-            return QVariant::fromValue(value);
+            return QVariant::fromValue(read<qint16>());
         }
         case 'C': {
-            bool value;
-            in >> value;
-            position++;
-            return QVariant::fromValue(value);
+            return QVariant::fromValue(read<quint8>() != 0);
         }
         case 'I': {
-            qint32 value;
-            in >> value;
-            position += sizeof(qint32);
-            return QVariant::fromValue(value);
+            return QVariant::fromValue(read<qint32>());
         }
         case 'F': {
-            float value;
-            in >> value;
-            position += sizeof(float);
-            return QVariant::fromValue(value);
+            return QVariant::fromValue(read<float>());
         }
         case 'D': {
-            double value;
-            in >> value;
-            position += sizeof(double);
-            return QVariant::fromValue(value);
+            return QVariant::fromValue(read<double>());
         }
         case 'L': {
-            qint64 value;
-            in >> value;
-            position += sizeof(qint64);
-            return QVariant::fromValue(value);
+            return QVariant::fromValue(read<qint64>());
         }
         case 'f': {
-            return readBinaryArray<float>(in, position);
+            return readArray<float>();
         }
         case 'd': {
-            return readBinaryArray<double>(in, position);
+            return readArray<double>();
         }
         case 'l': {
-            return readBinaryArray<qint64>(in, position);
+            return readArray<qint64>();
         }
         case 'i': {
-            return readBinaryArray<qint32>(in, position);
+            return readArray<qint32>();
         }
         case 'b': {
-            return readBinaryArray<bool>(in, position);
+            return readArray<bool>();
         }
         case 'S':
         case 'R': {
-            quint32 length;
-            in >> length;
-            position += sizeof(quint32) + length;
-            return QVariant::fromValue(in.device()->read(length));
+            quint32 length = read<quint32>();
+            return QVariant::fromValue(hifi::ByteArray(readBytes(length), length));
         }
         default:
             throw QString("Unknown property type: ") + ch;
     }
 }
 
-FBXNode parseBinaryFBXNode(QDataStream& in, int& position, bool has64BitPositions = false) {
+FBXNode BinaryFBXParser::parseNode() {
     qint64 endOffset;
     quint64 propertyCount;
-    quint64 propertyListLength;
-    quint8 nameLength;
 
     // FBX 2016 and beyond uses 64bit positions in the node headers, pre-2016 used 32bit values
     // our code generally doesn't care about the size that much, so we will use 64bit values
-    // from here on out, but if the file is an older format we read the stream into temp 32bit 
-    // values and then assign to our actual 64bit values.
-    if (has64BitPositions) {
-        in >> endOffset;
-        in >> propertyCount;
-        in >> propertyListLength;
-        position += sizeof(quint64) * 3;
+    // from here on out, but if the file is an older format we widen the 32bit values.
+    if (_has64BitPositions) {
+        endOffset = read<qint64>();
+        propertyCount = read<quint64>();
+        read<quint64>(); // property list length
     } else {
-        qint32 tempEndOffset;
-        quint32 tempPropertyCount;
-        quint32 tempPropertyListLength;
-        in >> tempEndOffset;
-        in >> tempPropertyCount;
-        in >> tempPropertyListLength;
-        position += sizeof(quint32) * 3;
-        endOffset = tempEndOffset;
-        propertyCount = tempPropertyCount;
-        propertyListLength = tempPropertyListLength;
-    }
-    in >> nameLength;
-    position += sizeof(quint8);
+        endOffset = read<qint32>();
+        propertyCount = read<quint32>();
+        read<quint32>(); // property list length
+    }
+    quint8 nameLength = read<quint8>();
 
     FBXNode node;
     const int MIN_VALID_OFFSET = 40;
@@ -211,15 +208,14 @@ FBXNode parseBinaryFBXNode(QDataStream& in, int& position, bool has64BitPosition
         // use a null name to indicate a null node
         return node;
     }
-    node.name = in.device()->read(nameLength);
-    position += nameLength;
+    node.name = hifi::ByteArray(readBytes(nameLength), nameLength);
 
-    for (quint32 i = 0; i < propertyCount; i++) {
-        node.properties.append(parseBinaryFBXProperty(in, position));
+    for (quint64 i = 0; i < propertyCount; i++) {
+        node.properties.append(parseProperty());
     }
 
-    while (endOffset > position) {
-        FBXNode child = parseBinaryFBXNode(in, position, has64BitPositions);
+    while (endOffset > getPosition()) {
+        FBXNode child = parseNode();
         if (!child.name.isNull()) {
             node.children.append(child);
         }
@@ -228,6 +224,79 @@ FBXNode parseBinaryFBXNode(QDataStream& in, int& position, bool has64BitPosition
     return node;
 }
 
+void BinaryFBXParser::inflateArrays() {
+    auto inflateArray = [](const CompressedArray& array) {
+        uLongf size = array.destinationSize;
+        if (uncompress(reinterpret_cast<Bytef*>(array.destination), &size,
+                reinterpret_cast<const Bytef*>(array.source), array.sourceSize) != Z_OK ||
+                size != array.destinationSize) {
+            return false;
+        }
+        toNativeByteOrder(array.destination, size, array.elementSize);
+        return true;
+    };
+
+    // small files aren't worth waking up the worker threads for
+    const uLong MIN_PARALLEL_INFLATE_BYTES = 1024 * 1024;
+    uLong totalSize = 0;
+    for (const auto& array : _compressedArrays) {
+        totalSize += array.destinationSize;
+    }
+
+    std::atomic<bool> isCorrupt { false };
+    if (totalSize < MIN_PARALLEL_INFLATE_BYTES || _compressedArrays.size() < 2) {
+        for (const auto& array : _compressedArrays) {
+            if (!inflateArray(array)) {
+                isCorrupt = true;
+                break;
+            }
+        }
+    } else {
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, _compressedArrays.size(), 1), [&](const tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i < range.end() && !isCorrupt; ++i) {
+                if (!inflateArray(_compressedArrays[i])) {
+                    isCorrupt = true;
+                }
+            }
+        });
+    }
+    _compressedArrays.clear();
+
+    if (isCorrupt) {
+        throw QString("corrupt fbx file");
+    }
+}
+
+FBXNode BinaryFBXParser::parse() {
+    // see http://code.blender.org/index.php/2013/08/fbx-binary-file-format-specification/ for an explanation
+    // of the FBX binary format
+
+    // The first 27 bytes contain the header.
+    //   Bytes 0 - 20: Kaydara FBX Binary  \x00(file - magic, with 2 spaces at the end, then a NULL terminator).
+    //   Bytes 21 - 22: [0x1A, 0x00](unknown but all observed files show these bytes).
+    //   Bytes 23 - 26 : unsigned int, the version number. 7300 for version 7.3 for example.
+    readBytes(FBX_HEADER_BYTES_BEFORE_VERSION);
+    quint32 fileVersion = read<quint32>();
+    _has64BitPositions = (fileVersion >= FBX_VERSION_2016);
+
+    // the smallest node header, any less is trailing data
+    const size_t nodeHeaderSize = (_has64BitPositions ? sizeof(quint64) : sizeof(quint32)) * 3 + sizeof(quint8);
+
+    // parse the top-level node
+    FBXNode top;
+    while ((size_t)(_end - _cursor) >= nodeHeaderSize) {
+        FBXNode next = parseNode();
+        if (next.name.isNull()) {
+            break;
+        } else {
+            top.children.append(next);
+        }
+    }
+
+    inflateArrays();
+    return top;
+}
+
 class Tokenizer {
 public:
 
@@ -369,36 +438,36 @@ FBXNode FBXSerializer::parseFBX(QIODevice* device) {
         }
         return top;
     }
-    QDataStream in(device);
-    in.setByteOrder(QDataStream::LittleEndian);
-    in.setVersion(QDataStream::Qt_4_5); // for single/double precision switch
 
-    // see http://code.blender.org/index.php/2013/08/fbx-binary-file-format-specification/ for an explanation
-    // of the FBX binary format
+    hifi::ByteArray data = device->readAll();
+    return BinaryFBXParser(data.constData(), data.size()).parse();
+}
 
-    // The first 27 bytes contain the header.
-    //   Bytes 0 - 20: Kaydara FBX Binary  \x00(file - magic, with 2 spaces at the end, then a NULL terminator).
-    //   Bytes 21 - 22: [0x1A, 0x00](unknown but all observed files show these bytes).
-    //   Bytes 23 - 26 : unsigned int, the version number. 7300 for version 7.3 for example.
-    in.skipRawData(FBX_HEADER_BYTES_BEFORE_VERSION);
-    int position = FBX_HEADER_BYTES_BEFORE_VERSION;
-    quint32 fileVersion;
-    in >> fileVersion;
-    position += sizeof(fileVersion);
-    bool has64BitPositions = (fileVersion >= FBX_VERSION_2016);
+FBXNode FBXSerializer::parseFBX(const hifi::ByteArray& data) {
+    if (!data.startsWith(FBX_BINARY_PROLOG)) {
+        QBuffer buffer(const_cast<hifi::ByteArray*>(&data));
+        buffer.open(QIODevice::ReadOnly);
+        return parseFBX(&buffer);
+    }
 
-    // parse the top-level node
-    FBXNode top;
-    while (device->bytesAvailable()) {
-        FBXNode next = parseBinaryFBXNode(in, position, has64BitPositions);
-        if (next.name.isNull()) {
-            return top;
+    PROFILE_RANGE_EX(resource_parse, __FUNCTION__, 0xff0000ff, data.size());
+    return BinaryFBXParser(data.constData(), data.size()).parse();
+}
 
-        } else {
-            top.children.append(next);
-        }
+FBXNode FBXSerializer::parseFBXFile(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        throw QString("Unable to open FBX file: ") + path;
+    }
+
+    uchar* mapped = file.size() > 0 ? file.map(0, file.size()) : nullptr;
+    if (!mapped) {
+        return parseFBX(file.readAll());
     }
 
+    // the tree copies the names and strings it keeps, so the mapping can go away once parsing is done
+    FBXNode top = parseFBX(hifi::ByteArray::fromRawData(reinterpret_cast<const char*>(mapped), file.size()));
+    file.unmap(mapped);
     return top;
 }
 
@@ -11,9 +11,14 @@
 
 #include "GLTFSerializer.h"
 
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
 #include <QtCore/QBuffer>
 #include <QtCore/QIODevice>
 #include <QtCore/QEventLoop>
+#include <QtCore/QtEndian>
 #include <QtCore/qjsondocument.h>
 #include <QtCore/qjsonobject.h>
 #include <QtCore/qjsonarray.h>
@@ -34,6 +39,7 @@
 #include <PathUtils.h>
 #include <image/ColorChannel.h>
 #include <FaceshiftConstants.h>
+#include <TBBHelpers.h>
 
 #include "FBXSerializer.h"
 
@@ -149,26 +155,33 @@ bool GLTFSerializer::getObjectArrayVal(const QJsonObject& object, const QString&
 }
 
 hifi::ByteArray GLTFSerializer::setGLBChunks(const hifi::ByteArray& data) {
-    int byte = 4; 
-    int jsonStart = data.indexOf("JSON", Qt::CaseSensitive);
-    int binStart = data.indexOf("BIN", Qt::CaseSensitive);
-    int jsonLength, binLength;
-    hifi::ByteArray jsonLengthChunk, binLengthChunk;
-
-    jsonLengthChunk = data.mid(jsonStart - byte, byte);
-    QDataStream tempJsonLen(jsonLengthChunk);
-    tempJsonLen.setByteOrder(QDataStream::LittleEndian);
-    tempJsonLen >> jsonLength;
-    hifi::ByteArray jsonChunk = data.mid(jsonStart + byte, jsonLength);
-
-    if (binStart != -1) {
-        binLengthChunk = data.mid(binStart - byte, byte);
-
-        QDataStream tempBinLen(binLengthChunk);
-        tempBinLen.setByteOrder(QDataStream::LittleEndian);
-        tempBinLen >> binLength;
+    // 12 byte header (magic, version, length) followed by chunks, each a length, a type and the chunk data
+    const int GLB_HEADER_SIZE = 12;
+    const int GLB_CHUNK_HEADER_SIZE = 8;
+    const quint32 GLB_CHUNK_TYPE_JSON = 0x4E4F534A;
+    const quint32 GLB_CHUNK_TYPE_BIN = 0x004E4942;
+
+    hifi::ByteArray jsonChunk;
+    const char* bytes = data.constData();
+    int size = std::min(data.size(), (int)qFromLittleEndian<quint32>(bytes + 8));
+    int chunkStart = GLB_HEADER_SIZE;
+    while (chunkStart + GLB_CHUNK_HEADER_SIZE <= size) {
+        quint32 chunkLength = qFromLittleEndian<quint32>(bytes + chunkStart);
+        quint32 chunkType = qFromLittleEndian<quint32>(bytes + chunkStart + 4);
+        int chunkDataStart = chunkStart + GLB_CHUNK_HEADER_SIZE;
+        if (chunkLength > (quint32)(size - chunkDataStart)) {
+            qWarning(modelformat) << "Truncated GLB chunk in model " << _url;
+            break;
+        }
 
-        _glbBinary = data.mid(binStart + byte, binLength);
+        if (chunkType == GLB_CHUNK_TYPE_JSON && jsonChunk.isEmpty()) {
+            // only parsed while data is alive, no need to copy it
+            jsonChunk = hifi::ByteArray::fromRawData(bytes + chunkDataStart, chunkLength);
+        } else if (chunkType == GLB_CHUNK_TYPE_BIN && _glbBinary.isEmpty()) {
+            _glbBinary = data.mid(chunkDataStart, chunkLength);
+        }
+        // unknown chunk types are skipped
+        chunkStart = chunkDataStart + chunkLength;
     }
     return jsonChunk;
 }
@@ -407,11 +420,8 @@ bool GLTFSerializer::addBuffer(const QJsonObject& object) {
             return false;
         }
     }
-    if (getStringVal(object, "uri", buffer.uri, buffer.defined)) {
-        if (!readBinary(buffer.uri, buffer.blob)) {
-            return false;
-        }
-    }
+    // the uri, if any, is loaded by loadBuffers() along with every other buffer
+    getStringVal(object, "uri", buffer.uri, buffer.defined);
     _file.buffers.push_back(buffer);
     
     return true;
@@ -647,7 +657,7 @@ bool GLTFSerializer::parseGLTF(const hifi::ByteArray& data) {
 
     hifi::ByteArray jsonChunk = data;
 
-    if (_url.toString().endsWith("glb") && data.indexOf("glTF") == 0 && data.contains("JSON")) {
+    if (_url.toString().endsWith("glb") && data.startsWith("glTF") && data.size() >= 12) {
         jsonChunk = setGLBChunks(data);
     }    
    
@@ -690,6 +700,7 @@ bool GLTFSerializer::parseGLTF(const hifi::ByteArray& data) {
                     success = success && addBuffer(bufVal.toObject());
                 }
             }
+            success = success && loadBuffers();
         }
 
         QJsonArray cameras;
@@ -827,6 +838,16 @@ void GLTFSerializer::generateTargetData(int index, float weight, QVector<glm::ve
     }
 }
 
+// appends tightly packed float components to an array of glm vectors with a single copy
+template<typename V>
+static void appendVectors(QVector<V>& destination, const QVector<float>& components) {
+    const int VECTOR_SIZE = (int)(sizeof(V) / sizeof(float));
+    int count = components.size() / VECTOR_SIZE;
+    int start = destination.size();
+    destination.resize(start + count);
+    memcpy(destination.data() + start, components.constData(), count * sizeof(V));
+}
+
 bool GLTFSerializer::buildGeometry(HFMModel& hfmModel, const hifi::VariantHash& mapping, const hifi::URL& url) {
     int numNodes = _file.nodes.size();
 
@@ -1061,9 +1082,7 @@ bool GLTFSerializer::buildGeometry(HFMModel& hfmModel, const hifi::VariantHash&
                 // Buffers
                 QVector<int> indices;
                 QVector<float> vertices;
-                int verticesStride = 3;
                 QVector<float> normals;
-                int normalStride = 3;
                 QVector<float> tangents;
                 int tangentStride = 4;
                 QVector<float> texcoords;
@@ -1323,10 +1342,10 @@ bool GLTFSerializer::buildGeometry(HFMModel& hfmModel, const hifi::VariantHash&
                     partVerticesCount = vertices.size() / 3;
                 }
 
-                QVector<int> validatedIndices;
+                QVector<int> validatedIndices(indices.count());
                 for (int n = 0; n < indices.count(); ++n) {
                     if (indices[n] < partVerticesCount) {
-                        validatedIndices.push_back(indices[n] + prevMeshVerticesCount);
+                        validatedIndices[n] = indices[n] + prevMeshVerticesCount;
                     } else {
                         validatedIndices = QVector<int>();
                         break;
@@ -1340,13 +1359,8 @@ bool GLTFSerializer::buildGeometry(HFMModel& hfmModel, const hifi::VariantHash&
 
                 part.triangleIndices.append(validatedIndices);
 
-                for (int n = 0; n < vertices.size(); n = n + verticesStride) {
-                    mesh.vertices.push_back(glm::vec3(vertices[n], vertices[n + 1], vertices[n + 2]));
-                }
-
-                for (int n = 0; n < normals.size(); n = n + normalStride) {
-                    mesh.normals.push_back(glm::vec3(normals[n], normals[n + 1], normals[n + 2]));
-                }
+                appendVectors(mesh.vertices, vertices);
+                appendVectors(mesh.normals, normals);
 
                 // TODO: add correct tangent generation
                 if (tangents.size() == partVerticesCount * tangentStride) {
@@ -1363,9 +1377,7 @@ bool GLTFSerializer::buildGeometry(HFMModel& hfmModel, const hifi::VariantHash&
                 }
 
                 if (texcoords.size() == partVerticesCount * texCoordStride) {
-                    for (int n = 0; n < texcoords.size(); n = n + 2) {
-                        mesh.texCoords.push_back(glm::vec2(texcoords[n], texcoords[n + 1]));
-                    }
+                    appendVectors(mesh.texCoords, texcoords);
                 } else {
                     if (meshAttributes.contains("TEXCOORD_0")) {
                         for (int i = 0; i < partVerticesCount; ++i) {
@@ -1375,9 +1387,7 @@ bool GLTFSerializer::buildGeometry(HFMModel& hfmModel, const hifi::VariantHash&
                 }
 
                 if (texcoords2.size() == partVerticesCount * texCoord2Stride) {
-                    for (int n = 0; n < texcoords2.size(); n = n + 2) {
-                        mesh.texCoords1.push_back(glm::vec2(texcoords2[n], texcoords2[n + 1]));
-                    }
+                    appendVectors(mesh.texCoords1, texcoords2);
                 } else {
                     if (meshAttributes.contains("TEXCOORD_1")) {
                         for (int i = 0; i < partVerticesCount; ++i) {
@@ -1662,17 +1672,71 @@ HFMModel::Pointer GLTFSerializer::read(const hifi::ByteArray& data, const hifi::
     return nullptr;
 }
 
-bool GLTFSerializer::readBinary(const QString& url, hifi::ByteArray& outdata) {
-    bool success;
+bool GLTFSerializer::loadBuffers() {
+    static const QString EMBEDDED_DATA_PREFIX = "data:application/octet-stream;base64,";
 
-    if (url.contains("data:application/octet-stream;base64,")) {
-        outdata = requestEmbeddedData(url);
-        success = !outdata.isEmpty();
-    } else {
-        hifi::URL binaryUrl = _url.resolved(url);
-        std::tie<bool, hifi::ByteArray>(success, outdata) = requestData(binaryUrl);
+    std::vector<int> embeddedBuffers;
+    std::vector<std::pair<int, ResourceRequest*>> requests;
+    bool success = true;
+
+    // start every external request before waiting on any of them
+    for (int i = 0; i < _file.buffers.size(); ++i) {
+        const GLTFBuffer& buffer = _file.buffers[i];
+        if (!buffer.defined.value("uri")) {
+            continue;
+        }
+        if (buffer.uri.contains(EMBEDDED_DATA_PREFIX)) {
+            embeddedBuffers.push_back(i);
+        } else {
+            hifi::URL binaryUrl = _url.resolved(buffer.uri);
+            auto request = DependencyManager::get<ResourceManager>()->createResourceRequest(
+                nullptr, binaryUrl, true, -1, "GLTFSerializer::loadBuffers");
+            if (!request) {
+                success = false;
+                break;
+            }
+            requests.push_back({ i, request });
+        }
     }
-    
+
+    QEventLoop loop;
+    size_t pendingRequests = 0;
+    if (success) {
+        pendingRequests = requests.size();
+        for (auto& request : requests) {
+            QObject::connect(request.second, &ResourceRequest::finished, &loop, [&] {
+                if (--pendingRequests == 0) {
+                    loop.quit();
+                }
+            });
+            request.second->send();
+        }
+    }
+
+    // decode the data uris while the requests are in flight
+    GLTFBuffer* buffers = _file.buffers.data();
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, embeddedBuffers.size(), 1), [&](const tbb::blocked_range<size_t>& range) {
+        for (size_t i = range.begin(); i < range.end(); ++i) {
+            buffers[embeddedBuffers[i]].blob = requestEmbeddedData(buffers[embeddedBuffers[i]].uri);
+        }
+    });
+    for (int i : embeddedBuffers) {
+        success = success && !buffers[i].blob.isEmpty();
+    }
+
+    if (pendingRequests > 0) {
+        loop.exec();
+    }
+
+    for (auto& request : requests) {
+        if (success && request.second->getResult() == ResourceRequest::Success) {
+            buffers[request.first].blob = request.second->getData();
+        } else {
+            success = false;
+        }
+        request.second->deleteLater();
+    }
+
     return success;
 }
 
@@ -1684,29 +1748,35 @@ bool GLTFSerializer::doesResourceExist(const QString& url) {
     return DependencyManager::get<ResourceManager>()->resourceExists(candidateUrl);
 }
 
-std::tuple<bool, hifi::ByteArray> GLTFSerializer::requestData(hifi::URL& url) {
-    auto request = DependencyManager::get<ResourceManager>()->createResourceRequest(
-        nullptr, url, true, -1, "GLTFSerializer::requestData");
+hifi::ByteArray GLTFSerializer::requestEmbeddedData(const QString& url) {
+    // base64 decodes each group of 4 characters independently, so large buffers are split in pieces decoded in parallel
+    static const int BASE64_PIECE_SIZE = 1 << 20;
 
-    if (!request) {
-        return std::make_tuple(false, hifi::ByteArray());
+    int dataStart = url.indexOf(',') + 1;
+    if (dataStart == 0 || dataStart == url.size()) {
+        return hifi::ByteArray();
+    }
+    QStringRef encoded = url.midRef(dataStart);
+    int numPieces = (encoded.size() + BASE64_PIECE_SIZE - 1) / BASE64_PIECE_SIZE;
+    if (numPieces == 1) {
+        return QByteArray::fromBase64(encoded.toLatin1());
     }
 
-    QEventLoop loop;
-    QObject::connect(request, &ResourceRequest::finished, &loop, &QEventLoop::quit);
-    request->send();
-    loop.exec();
+    std::vector<hifi::ByteArray> pieces(numPieces);
+    tbb::parallel_for(0, numPieces, [&](int i) {
+        pieces[i] = QByteArray::fromBase64(encoded.mid(i * BASE64_PIECE_SIZE, BASE64_PIECE_SIZE).toLatin1());
+    });
 
-    if (request->getResult() == ResourceRequest::Success) {
-        return std::make_tuple(true, request->getData());
-    } else {
-        return std::make_tuple(false, hifi::ByteArray());
+    int size = 0;
+    for (const auto& piece : pieces) {
+        size += piece.size();
     }
-}
-
-hifi::ByteArray GLTFSerializer::requestEmbeddedData(const QString& url) {
-    QString binaryUrl = url.split(",")[1]; 
-    return binaryUrl.isEmpty() ? hifi::ByteArray() : QByteArray::fromBase64(binaryUrl.toUtf8());
+    hifi::ByteArray data;
+    data.reserve(size);
+    for (const auto& piece : pieces) {
+        data.append(piece);
+    }
+    return data;
 }
 
 
@@ -1824,15 +1894,29 @@ void GLTFSerializer::setHFMMaterial(HFMMaterial& fbxmat, const GLTFMaterial& mat
 
 }
 
+// accessor components are tightly packed little endian values, converted to L as they are copied
+template<typename T, typename L>
+static void convertValues(const char* source, int count, L* destination) {
+    if (std::is_same<T, L>::value && QSysInfo::ByteOrder == QSysInfo::LittleEndian) {
+        memcpy(destination, source, count * sizeof(T));
+        return;
+    }
+    for (int i = 0; i < count; ++i) {
+        T value;
+        memcpy(&value, source + i * sizeof(T), sizeof(T));
+        if (QSysInfo::ByteOrder == QSysInfo::BigEndian) {
+            char* bytes = reinterpret_cast<char*>(&value);
+            std::reverse(bytes, bytes + sizeof(T));
+        }
+        destination[i] = value;
+    }
+}
+
 template<typename T, typename L>
 bool GLTFSerializer::readArray(const hifi::ByteArray& bin, int byteOffset, int count,
                            QVector<L>& outarray, int accessorType) {
-    
-    QDataStream blobstream(bin);
-    blobstream.setByteOrder(QDataStream::LittleEndian);
-    blobstream.setVersion(QDataStream::Qt_5_9);
-    blobstream.setFloatingPointPrecision(QDataStream::FloatingPointPrecision::SinglePrecision);
-    blobstream.skipRawData(byteOffset);
+    // large accessors are converted in parallel, in runs of this many values
+    static const int VALUES_PER_TASK = 1 << 16;
 
     int bufferCount = 0;
     switch (accessorType) {
@@ -1859,23 +1943,24 @@ bool GLTFSerializer::readArray(const hifi::ByteArray& bin, int byteOffset, int c
         break;
     default:
         qWarning(modelformat) << "Unknown accessorType: " << accessorType;
-        blobstream.unsetDevice();
         return false;
     }
-    for (int i = 0; i < count; ++i) {
-        for (int j = 0; j < bufferCount; ++j) {
-            if (!blobstream.atEnd()) {
-                T value;
-                blobstream >> value;
-                outarray.push_back(value);
-            } else {
-                blobstream.unsetDevice();
-                return false;
-            }
-        }
+
+    qint64 numValues = (qint64)count * bufferCount;
+    if (byteOffset < 0 || count < 0 || byteOffset + numValues * (qint64)sizeof(T) > bin.size() ||
+        outarray.size() + numValues > std::numeric_limits<int>::max()) {
+        return false;
     }
 
-    blobstream.unsetDevice();
+    // resized once and written in place
+    int start = outarray.size();
+    outarray.resize(start + (int)numValues);
+    const char* source = bin.constData() + byteOffset;
+    L* destination = outarray.data() + start;
+    tbb::parallel_for(tbb::blocked_range<int>(0, (int)numValues, VALUES_PER_TASK), [&](const tbb::blocked_range<int>& range) {
+        convertValues<T>(source + (size_t)range.begin() * sizeof(T), (int)range.size(), destination + range.begin());
+    });
+
     return true;
 }
 template<typename T>
@@ -1916,11 +2001,7 @@ bool GLTFSerializer::addArrayFromAccessor(GLTFAccessor& accessor, QVector<T>& ou
         success = addArrayOfType(buffer.blob, bufferview.byteOffset + accBoffset, accessor.count, outarray, accessor.type,
                                  accessor.componentType);
     } else {
-        for (int i = 0; i < accessor.count; ++i) {
-            T value;
-            memset(&value, 0, sizeof(T));  // Make sure the dummy array is initalised to zero.
-            outarray.push_back(value);
-        }
+        outarray.resize(outarray.size() + accessor.count); // Make sure the dummy array is initalised to zero.
     }
 
     if (success) {
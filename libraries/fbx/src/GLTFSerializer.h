@@ -830,7 +830,7 @@ private:
     bool addSkin(const QJsonObject& object);
     bool addTexture(const QJsonObject& object);
 
-    bool readBinary(const QString& url, hifi::ByteArray& outdata);
+    bool loadBuffers();
 
     template<typename T, typename L>
     bool readArray(const hifi::ByteArray& bin, int byteOffset, int count,
@@ -847,7 +847,6 @@ private:
                        const QVector<glm::vec3>& in_normals, QVector<int>& out_indices, 
                        QVector<glm::vec3>& out_vertices, QVector<glm::vec3>& out_normals);
 
-    std::tuple<bool, hifi::ByteArray> requestData(hifi::URL& url);
     hifi::ByteArray requestEmbeddedData(const QString& url);
 
     QNetworkReply* request(hifi::URL& url, bool isTest);
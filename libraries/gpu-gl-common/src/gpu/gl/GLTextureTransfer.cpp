@@ -10,6 +10,7 @@
 
 #include <QtCore/QThread>
 #include <NumericalConstants.h>
+#include <gpu/KtxMipLoader.h>
 
 #include "GLBackend.h"
 
@@ -83,6 +84,7 @@ protected:
     bool processActiveBufferQueue();
     void processTransferQueues();
     void populateTransferQueue(const TexturePointer& texturePointer);
+    void clearPendingTransfers();
     //void addToWorkQueue(const TexturePointer& texturePointer);
     void updateMemoryPressure();
 
@@ -244,7 +246,7 @@ void GLTextureTransferEngineDefault::updateMemoryPressure() {
     if (newState != _memoryPressureState) {
         _memoryPressureState = newState;
         _promoteQueue = WorkQueue();
-        _pendingTransfersMap.clear();
+        clearPendingTransfers();
 
         if (MemoryPressureState::Idle == _memoryPressureState) {
             return;
@@ -417,10 +419,26 @@ void GLTextureTransferEngineDefault::populateTransferQueue(const TexturePointer&
     PROFILE_RANGE(render_gpu_gl, __FUNCTION__);
     vargltexture->populateTransferQueue(pendingTransfers);
     if (!pendingTransfers.empty()) {
+        // Read the source mips from disk ahead of the buffering thread, smallest textures first.  The transfers go from
+        // the mip below the populated one up to the allocated one: the smaller mips are on the GPU already
+        KtxMipLoader::getInstance().request(texturePointer, pendingTransfers.front()->sourceMip(),
+                                            pendingTransfers.back()->sourceMip(), 1.0f / (float)gltexture->size());
         _pendingTransfersMap[weakTexture] = pendingTransfers;
     }
 }
 
+void GLTextureTransferEngineDefault::clearPendingTransfers() {
+    // the mips read ahead for the transfers dropped here would never be consumed, give their budget back to the loader
+    auto& mipLoader = KtxMipLoader::getInstance();
+    for (const auto& pendingTransfers : _pendingTransfersMap) {
+        auto texture = pendingTransfers.first.lock();
+        if (texture) {
+            mipLoader.cancel(texture);
+        }
+    }
+    _pendingTransfersMap.clear();
+}
+
 // From the queue of textures to be promited
 void GLTextureTransferEngineDefault::processPromotes() {
     // FIXME use max allocated memory per frame instead of promotion count
@@ -484,6 +502,8 @@ void GLTextureTransferEngineDefault::processDemotes(size_t reliefRequired, const
             auto oldSize = gltexture->size();
             GLVariableAllocationSupport* vargltexture = dynamic_cast<GLVariableAllocationSupport*>(gltexture);
             vargltexture->demote();
+            // the mips read ahead for it are above the allocated one now, or go with its dropped transfers
+            KtxMipLoader::getInstance().cancel(texture);
             auto newSize = gltexture->size();
             relieved += (oldSize - newSize);
         }
@@ -0,0 +1,364 @@
+//
+//  KtxMipLoader.cpp
+//  libraries/gpu/src/gpu
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "KtxMipLoader.h"
+
+#include <algorithm>
+
+#include <QtCore/QFile>
+
+#include <ktx/KTX.h>
+#include <NumericalConstants.h>
+
+#include "GPULogging.h"
+#include "Texture.h"
+
+using namespace gpu;
+
+// reads are mostly waiting on the disk, a couple of threads keep a queue deep enough for it
+static const unsigned int MAX_IO_THREADS = 2;
+
+static const size_t DEFAULT_MAX_BUFFERED_BYTES = MB_TO_BYTES(64);
+
+// past this many heap entries per request, drop the ones left behind by newer requests and rebuild the heap
+static const size_t MAX_ENTRIES_PER_REQUEST = 4;
+
+const size_t KtxMipLoader::MAX_READ_SIZE = MB_TO_BYTES(4);
+
+// The mips of one read, counted against the loader budget until the last of their faces is consumed.
+class KtxMipLoader::ReadBuffer : public storage::MemoryStorage {
+public:
+    ReadBuffer(KtxMipLoader& loader, size_t size) : storage::MemoryStorage(size), _loader(loader) {}
+    ~ReadBuffer() { _loader.release(size()); }
+
+private:
+    KtxMipLoader& _loader;
+};
+
+KtxMipLoader& KtxMipLoader::getInstance() {
+    static KtxMipLoader instance;
+    return instance;
+}
+
+KtxMipLoader::KtxMipLoader() : _maxBufferedBytes(DEFAULT_MAX_BUFFERED_BYTES) {
+    auto threadCount = std::max(1u, std::min(MAX_IO_THREADS, std::thread::hardware_concurrency() / 4));
+    for (unsigned int i = 0; i < threadCount; ++i) {
+        _threads.emplace_back(&KtxMipLoader::run, this);
+    }
+}
+
+KtxMipLoader::~KtxMipLoader() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _isStopping = true;
+    }
+    _condition.notify_all();
+
+    for (auto& thread : _threads) {
+        thread.join();
+    }
+}
+
+bool KtxMipLoader::request(const TexturePointer& texture, uint16 maxMip, uint16 minMip, float priority) {
+    auto ktxStorage = texture ? dynamic_cast<Texture::KtxStorage*>(texture->_storage.get()) : nullptr;
+    if (!ktxStorage || ktxStorage->_ktxDescriptor->images.empty()) {
+        return false;
+    }
+
+    // faces outside of [minMip, maxMip] aren't wanted anymore, freed after _mutex is unlocked since releasing them takes it
+    std::vector<Texture::PixelsPointer> droppedFaces;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto& state = _requests[texture.get()];
+    if (state.texture.lock() != texture) {
+        const auto& descriptor = *ktxStorage->_ktxDescriptor;
+        auto mips = std::make_shared<std::vector<MipLayout>>();
+        for (uint16 mip = 0; mip < descriptor.images.size(); ++mip) {
+            MipLayout layout;
+            layout.faceSize = descriptor.getMipFaceTexelsSize(mip);
+            for (uint8 face = 0; face < descriptor.images[mip]._numFaces; ++face) {
+                layout.faceOffsets.push_back(descriptor.getMipFaceTexelsOffset(mip, face));
+            }
+            mips->push_back(std::move(layout));
+        }
+
+        state = RequestState();
+        state.texture = texture;
+        state.filename = ktxStorage->_filename;
+        state.mips = mips;
+    }
+
+    state.maxMip = std::min((int)maxMip, (int)state.mips->size() - 1);
+    state.minMip = std::max(minMip, ktxStorage->minAvailableMipLevel());
+    state.priority = priority;
+    if (!state.isReading) {
+        state.nextMip = state.maxMip;
+    }
+
+    {
+        std::lock_guard<std::mutex> loadedLock(ktxStorage->_loadedMipsMutex);
+        auto& loadedMips = ktxStorage->_loadedMips;
+
+        // faces above maxMip are on the GPU already and those below minMip aren't wanted anymore: they'd never be consumed
+        for (auto it = loadedMips.begin(); it != loadedMips.end();) {
+            if (it->first.first < state.minMip || it->first.first > state.maxMip) {
+                droppedFaces.push_back(std::move(it->second));
+                it = loadedMips.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        // start at the first mip that still needs reading: previous requests may have read some that weren't consumed yet
+        while (!state.isReading && state.nextMip >= state.minMip) {
+            const auto& layout = (*state.mips)[state.nextMip];
+            uint8 numFaces = (uint8)layout.faceOffsets.size();
+            auto loadedFaces = std::count_if(loadedMips.begin(), loadedMips.end(), [&](const auto& loaded) {
+                return loaded.first.first == state.nextMip && loaded.first.second < numFaces;
+            });
+            if (loadedFaces < numFaces) {
+                break;
+            }
+            --state.nextMip;
+        }
+    }
+
+    if (state.isReading) {
+        // rescheduled with the new priority once the current read completes
+        return true;
+    }
+
+    if (state.nextMip < state.minMip) {
+        _requests.erase(texture.get());
+        _idleCondition.notify_all();
+        return true;
+    }
+
+    schedule(texture.get(), state);
+    return true;
+}
+
+void KtxMipLoader::cancel(const TexturePointer& texture) {
+    auto ktxStorage = texture ? dynamic_cast<Texture::KtxStorage*>(texture->_storage.get()) : nullptr;
+    if (!ktxStorage) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _requests.find(texture.get());
+        if (it != _requests.end() && it->second.texture.lock() == texture) {
+            // its heap entry, if any, is ignored from now on and a read in progress won't hand out its faces
+            _requests.erase(it);
+            _idleCondition.notify_all();
+        }
+    }
+
+    // nothing consumes the faces read for it anymore, freed after the lock is released since releasing them takes _mutex
+    decltype(ktxStorage->_loadedMips) droppedFaces;
+    {
+        std::lock_guard<std::mutex> loadedLock(ktxStorage->_loadedMipsMutex);
+        droppedFaces.swap(ktxStorage->_loadedMips);
+    }
+}
+
+void KtxMipLoader::waitIdle() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _idleCondition.wait(lock, [&] { return _activeReads == 0 && (_requests.empty() || _isOverBudget); });
+}
+
+size_t KtxMipLoader::getMaxBufferedBytes() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _maxBufferedBytes;
+}
+
+void KtxMipLoader::setMaxBufferedBytes(size_t maxBufferedBytes) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _maxBufferedBytes = maxBufferedBytes;
+        _isOverBudget = false;
+    }
+    _condition.notify_all();
+}
+
+size_t KtxMipLoader::getBufferedBytes() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _bufferedBytes;
+}
+
+size_t KtxMipLoader::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _requests.size();
+}
+
+void KtxMipLoader::schedule(const Texture* key, RequestState& state) {
+    state.generation = ++_nextGeneration;
+
+    if (_queue.size() > MAX_ENTRIES_PER_REQUEST * _requests.size()) {
+        decltype(_queue) queue;
+        for (const auto& pair : _requests) {
+            if (!pair.second.isReading && pair.first != key) {
+                queue.push({ pair.second.priority, pair.first, pair.second.generation });
+            }
+        }
+        _queue.swap(queue);
+    }
+
+    _queue.push({ state.priority, key, state.generation });
+    _condition.notify_one();
+}
+
+void KtxMipLoader::release(size_t size) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _bufferedBytes -= size;
+        _isOverBudget = false;
+    }
+    _condition.notify_all();
+}
+
+void KtxMipLoader::run() {
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    // textures and read buffers are only ever released with _mutex unlocked, since freeing buffered mips takes it
+    Read read;
+    while (takeNextRead(lock, read)) {
+        lock.unlock();
+
+        performRead(read);
+
+        lock.lock();
+
+        finishRead(read);
+    }
+}
+
+bool KtxMipLoader::takeNextRead(std::unique_lock<std::mutex>& lock, Read& read) {
+    while (!_isStopping) {
+        if (_queue.empty()) {
+            _condition.wait(lock);
+            continue;
+        }
+
+        Entry entry = _queue.top();
+
+        auto it = _requests.find(entry.texture);
+        if (it == _requests.end() || it->second.generation != entry.generation || it->second.isReading) {
+            // this request was canceled or replaced since this entry was pushed, or will be rescheduled after its read
+            _queue.pop();
+            continue;
+        }
+
+        auto& state = it->second;
+        if (state.texture.expired()) {
+            _queue.pop();
+            _requests.erase(it);
+            _idleCondition.notify_all();
+            continue;
+        }
+
+        // the smallest mip left, and as many of the adjacent larger ones as fit in one read
+        const auto& mips = *state.mips;
+        int lastMip = state.nextMip;
+        size_t end = mips[state.nextMip].getEnd();
+        while (lastMip > state.minMip && end - mips[lastMip - 1].getOffset() <= MAX_READ_SIZE) {
+            --lastMip;
+        }
+        size_t offset = mips[lastMip].getOffset();
+        size_t size = end - offset;
+
+        // a read larger than the whole budget still goes through once nothing else is buffered
+        if (_bufferedBytes > 0 && _bufferedBytes + size > _maxBufferedBytes) {
+            _isOverBudget = true;
+            _idleCondition.notify_all();
+            _condition.wait(lock);
+            continue;
+        }
+
+        _queue.pop();
+        state.isReading = true;
+        _bufferedBytes += size;
+        ++_activeReads;
+
+        read.key = entry.texture;
+        read.texture = state.texture;
+        read.filename = state.filename;
+        read.mips = state.mips;
+        read.firstMip = state.nextMip;
+        read.lastMip = lastMip;
+        read.offset = offset;
+        read.size = size;
+        return true;
+    }
+    return false;
+}
+
+void KtxMipLoader::performRead(const Read& read) {
+    // holds the budget reserved by takeNextRead from here on
+    auto buffer = std::make_shared<ReadBuffer>(*this, read.size);
+
+    QFile file(QString::fromStdString(read.filename));
+    if (!file.open(QFile::ReadOnly | QFile::Unbuffered) || !file.seek((qint64)read.offset) ||
+        file.read(reinterpret_cast<char*>(buffer->data()), (qint64)read.size) != (qint64)read.size) {
+        qCWarning(gpulogging) << "Failed to read mips" << read.lastMip << "to" << read.firstMip << "of"
+                              << QString::fromStdString(read.filename);
+        return;
+    }
+    file.close();
+
+    ++_readCount;
+    _bytesRead += read.size;
+
+    auto texture = read.texture.lock();
+    auto ktxStorage = texture ? dynamic_cast<Texture::KtxStorage*>(texture->_storage.get()) : nullptr;
+    if (!ktxStorage || ktxStorage->_filename != read.filename) {
+        return;
+    }
+
+    // only hand out the mips still wanted: the request may have been narrowed or canceled while we were reading,
+    // and faces nobody consumes would hold the budget forever
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _requests.find(read.key);
+    if (it == _requests.end() || it->second.texture.owner_before(read.texture) ||
+        read.texture.owner_before(it->second.texture)) {
+        return;
+    }
+    int minMip = std::max(read.lastMip, it->second.minMip);
+    int maxMip = std::min(read.firstMip, it->second.maxMip);
+
+    std::lock_guard<std::mutex> loadedLock(ktxStorage->_loadedMipsMutex);
+    for (int mip = minMip; mip <= maxMip; ++mip) {
+        const auto& layout = (*read.mips)[mip];
+        for (uint8 face = 0; face < layout.faceOffsets.size(); ++face) {
+            auto view = buffer->createView(layout.faceSize, layout.faceOffsets[face] - read.offset);
+            ktxStorage->_loadedMips.emplace(std::make_pair((uint16)mip, face), view);
+        }
+    }
+}
+
+void KtxMipLoader::finishRead(const Read& read) {
+    --_activeReads;
+
+    auto it = _requests.find(read.key);
+    if (it != _requests.end() && it->second.isReading && !it->second.texture.owner_before(read.texture) &&
+        !read.texture.owner_before(it->second.texture)) {
+        auto& state = it->second;
+        state.isReading = false;
+        // the request may have been narrowed while we were reading
+        state.nextMip = std::min({ state.nextMip, read.lastMip - 1, state.maxMip });
+        if (state.nextMip >= state.minMip && !state.texture.expired()) {
+            schedule(read.key, state);
+        } else {
+            _requests.erase(it);
+        }
+    }
+
+    _idleCondition.notify_all();
+}
@@ -0,0 +1,143 @@
+//
+//  KtxMipLoader.h
+//  libraries/gpu/src/gpu
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_gpu_KtxMipLoader_h
+#define hifi_gpu_KtxMipLoader_h
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Forward.h"
+
+namespace gpu {
+
+// A small pool of I/O threads reading the mips of KTX backed textures ahead of the GL transfers that need them.
+//
+// Each texture has at most one pending request, in a max-heap by priority.  Requests are read from the smallest
+// mip down, a run of adjacent mips in a single read of up to MAX_READ_SIZE bytes, and their faces are handed out
+// once by KtxStorage::getMipFace instead of reading the mapped file on the buffering thread.  Reads stop while the
+// mips read but not consumed yet would exceed getMaxBufferedBytes().
+
+class KtxMipLoader {
+public:
+    static const size_t MAX_READ_SIZE;
+
+    static KtxMipLoader& getInstance();
+
+    ~KtxMipLoader();
+
+    // reads the stored mips of texture from maxMip down to minMip, higher priorities first, skipping those read already
+    // replaces the pending request of texture, if any, and frees the faces read for it outside of [minMip, maxMip]
+    // \return false if texture isn't backed by a KTX file with any mips
+    bool request(const TexturePointer& texture, uint16 maxMip, uint16 minMip, float priority);
+
+    // drops the pending request of texture, if any, and frees every face read for it that wasn't consumed yet
+    void cancel(const TexturePointer& texture);
+
+    // blocks until every request was read, or is waiting for buffered mips to be consumed
+    void waitIdle();
+
+    size_t getMaxBufferedBytes() const;
+    void setMaxBufferedBytes(size_t maxBufferedBytes);
+
+    size_t getBufferedBytes() const;
+    size_t getPendingCount() const;
+    size_t getThreadCount() const { return _threads.size(); }
+
+    uint64_t getReadCount() const { return _readCount; }
+    uint64_t getBytesRead() const { return _bytesRead; }
+
+private:
+    class ReadBuffer;
+
+    KtxMipLoader();
+    KtxMipLoader(const KtxMipLoader&) = delete;
+    KtxMipLoader& operator=(const KtxMipLoader&) = delete;
+
+    struct MipLayout {
+        std::vector<size_t> faceOffsets; // of the texels of each face in the file
+        size_t faceSize;
+
+        size_t getOffset() const { return faceOffsets.front(); }
+        size_t getEnd() const { return faceOffsets.back() + faceSize; }
+    };
+    using MipLayouts = std::shared_ptr<const std::vector<MipLayout>>;
+
+    struct RequestState {
+        TextureWeakPointer texture;
+        std::string filename;
+        MipLayouts mips;
+        int nextMip; // the next mip to read, counting down to minMip
+        int maxMip;
+        int minMip;
+        float priority;
+        uint64_t generation { 0 }; // matches the one heap entry that is still valid for this request
+        bool isReading { false };
+    };
+
+    struct Entry {
+        float priority;
+        const Texture* texture;
+        uint64_t generation;
+
+        // older requests first among equal priorities
+        bool operator<(const Entry& other) const {
+            return priority < other.priority || (priority == other.priority && generation > other.generation);
+        }
+    };
+
+    struct Read {
+        const Texture* key;
+        TextureWeakPointer texture;
+        std::string filename;
+        MipLayouts mips; // of the whole texture
+        int firstMip; // the smallest mip of the read
+        int lastMip; // the largest mip of the read
+        size_t offset;
+        size_t size;
+    };
+
+    void run();
+    bool takeNextRead(std::unique_lock<std::mutex>& lock, Read& read); // expects _mutex to be held
+    void performRead(const Read& read);
+    void finishRead(const Read& read); // expects _mutex to be held
+    void schedule(const Texture* key, RequestState& state); // expects _mutex to be held
+    void release(size_t size);
+
+    mutable std::mutex _mutex;
+    std::condition_variable _condition; // signaled when there is a new request or buffered mips were released
+    std::condition_variable _idleCondition; // signaled when a read completes or stalls, for waitIdle()
+
+    std::priority_queue<Entry> _queue;
+    std::unordered_map<const Texture*, RequestState> _requests;
+    uint64_t _nextGeneration { 0 };
+    size_t _bufferedBytes { 0 };
+    size_t _maxBufferedBytes;
+    int _activeReads { 0 };
+    bool _isOverBudget { false };
+    bool _isStopping { false };
+
+    std::atomic<uint64_t> _readCount { 0 };
+    std::atomic<uint64_t> _bytesRead { 0 };
+
+    std::vector<std::thread> _threads;
+};
+
+}
+
+#endif // hifi_gpu_KtxMipLoader_h
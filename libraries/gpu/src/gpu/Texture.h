@@ -13,6 +13,8 @@
 
 #include <algorithm> //min max and more
 #include <bitset>
+#include <map>
+#include <mutex>
 
 #include <QMetaType>
 #include <QUrl>
@@ -372,9 +374,15 @@ public:
         size_t _offsetToMinMipKV;
 
         ktx::KTXDescriptorPointer _ktxDescriptor;
+
+        // faces read ahead by the KtxMipLoader, each one is handed out once by getMipFace
+        mutable std::mutex _loadedMipsMutex;
+        mutable std::map<std::pair<uint16, uint8>, PixelsPointer> _loadedMips;
+
         friend class Texture;
         friend class Serializer;
         friend class Deserializer;
+        friend class KtxMipLoader;
     };
 
     uint16 minAvailableMipLevel() const { return _storage->minAvailableMipLevel(); };
@@ -636,6 +644,7 @@ protected:
 
     friend class Serializer;
     friend class Deserializer;
+    friend class KtxMipLoader;
 };
 
 typedef std::shared_ptr<Texture> TexturePointer;
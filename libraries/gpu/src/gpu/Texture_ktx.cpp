@@ -226,6 +226,16 @@ void KtxStorage::releaseOpenKtxFiles() {
 }
 
 PixelsPointer KtxStorage::getMipFace(uint16 level, uint8 face) const {
+    {
+        std::lock_guard<std::mutex> lock(_loadedMipsMutex);
+        auto it = _loadedMips.find({ level, face });
+        if (it != _loadedMips.end()) {
+            auto result = std::move(it->second);
+            _loadedMips.erase(it);
+            return result;
+        }
+    }
+
     auto faceOffset = _ktxDescriptor->getMipFaceTexelsOffset(level, face);
     auto faceSize = _ktxDescriptor->getMipFaceTexelsSize(level, face);
     if (faceSize != 0 && faceOffset != 0) {
@@ -23,6 +23,11 @@
 
 #include <nvtt/nvtt.h>
 
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#include <xmmintrin.h>
+#define CUBEMAP_SSE
+#endif
+
 using namespace image;
 
 static const glm::vec3 FACE_NORMALS[24] = {
@@ -81,42 +86,69 @@ public:
     }
 
     glm::vec4 fetch(int face, glm::vec2 uv) const {
-        glm::vec2 coordFrac = uv * glm::vec2(_dims) - 0.5f;
+        size_t offsets[4];
+        glm::vec2 coordFrac;
+        getTexelOffsets(uv, offsets, coordFrac);
+
+        const auto& pixels = _faces[face];
+        glm::vec4 colorLL = pixels[offsets[0]];
+        glm::vec4 colorHL = pixels[offsets[1]];
+        glm::vec4 colorLH = pixels[offsets[2]];
+        glm::vec4 colorHH = pixels[offsets[3]];
+
+        colorLL += (colorHL - colorLL) * coordFrac.x;
+        colorLH += (colorHH - colorLH) * coordFrac.x;
+        return colorLL + (colorLH - colorLL) * coordFrac.y;
+    }
+
+#ifdef CUBEMAP_SSE
+    __m128 fetchSSE(int face, glm::vec2 uv) const {
+        size_t offsets[4];
+        glm::vec2 coordFrac;
+        getTexelOffsets(uv, offsets, coordFrac);
+
+        const float* pixels = reinterpret_cast<const float*>(_faces[face].data());
+        __m128 colorLL = _mm_loadu_ps(pixels + 4 * offsets[0]);
+        __m128 colorHL = _mm_loadu_ps(pixels + 4 * offsets[1]);
+        __m128 colorLH = _mm_loadu_ps(pixels + 4 * offsets[2]);
+        __m128 colorHH = _mm_loadu_ps(pixels + 4 * offsets[3]);
+
+        const __m128 fracX = _mm_set1_ps(coordFrac.x);
+        colorLL = _mm_add_ps(colorLL, _mm_mul_ps(_mm_sub_ps(colorHL, colorLL), fracX));
+        colorLH = _mm_add_ps(colorLH, _mm_mul_ps(_mm_sub_ps(colorHH, colorLH), fracX));
+        return _mm_add_ps(colorLL, _mm_mul_ps(_mm_sub_ps(colorLH, colorLL), _mm_set1_ps(coordFrac.y)));
+    }
+#endif
+
+private:
+
+    const Faces& _faces;
+
+    // offsets of the LL, HL, LH and HH texels around uv and the bilinear weights between them
+    void getTexelOffsets(glm::vec2 uv, size_t offsets[4], glm::vec2& coordFrac) const {
+        coordFrac = uv * glm::vec2(_dims) - 0.5f;
         glm::vec2 coords = glm::floor(coordFrac);
 
         coordFrac -= coords;
 
         coords += (float)EDGE_WIDTH;
 
-        const auto& pixels = _faces[face];
         gpu::Vec2i loCoords(coords);
         gpu::Vec2i hiCoords;
 
         hiCoords = glm::clamp(loCoords + 1, gpu::Vec2i(0, 0), _dims - 1 + (int)EDGE_WIDTH);
         loCoords = glm::clamp(loCoords, gpu::Vec2i(0, 0), _dims - 1 + (int)EDGE_WIDTH);
 
-        const size_t offsetLL = loCoords.x + loCoords.y * _lineStride;
-        const size_t offsetHL = hiCoords.x + loCoords.y * _lineStride;
-        const size_t offsetLH = loCoords.x + hiCoords.y * _lineStride;
-        const size_t offsetHH = hiCoords.x + hiCoords.y * _lineStride;
-        assert(offsetLL >= 0 && offsetLL < _lineStride * (_dims.y + 2 * EDGE_WIDTH));
-        assert(offsetHL >= 0 && offsetHL < _lineStride * (_dims.y + 2 * EDGE_WIDTH));
-        assert(offsetLH >= 0 && offsetLH < _lineStride * (_dims.y + 2 * EDGE_WIDTH));
-        assert(offsetHH >= 0 && offsetHH < _lineStride * (_dims.y + 2 * EDGE_WIDTH));
-        glm::vec4 colorLL = pixels[offsetLL];
-        glm::vec4 colorHL = pixels[offsetHL];
-        glm::vec4 colorLH = pixels[offsetLH];
-        glm::vec4 colorHH = pixels[offsetHH];
-
-        colorLL += (colorHL - colorLL) * coordFrac.x;
-        colorLH += (colorHH - colorLH) * coordFrac.x;
-        return colorLL + (colorLH - colorLL) * coordFrac.y;
+        offsets[0] = loCoords.x + loCoords.y * _lineStride;
+        offsets[1] = hiCoords.x + loCoords.y * _lineStride;
+        offsets[2] = loCoords.x + hiCoords.y * _lineStride;
+        offsets[3] = hiCoords.x + hiCoords.y * _lineStride;
+        assert(offsets[0] < _lineStride * (_dims.y + 2 * EDGE_WIDTH));
+        assert(offsets[1] < _lineStride * (_dims.y + 2 * EDGE_WIDTH));
+        assert(offsets[2] < _lineStride * (_dims.y + 2 * EDGE_WIDTH));
+        assert(offsets[3] < _lineStride * (_dims.y + 2 * EDGE_WIDTH));
     }
 
-private:
-
-    const Faces& _faces;
-
 };
 
 class CubeMap::Mip : public CubeFaceMip {
@@ -504,8 +536,28 @@ glm::vec4 CubeMap::fetchLod(const glm::vec3& dir, float lod) const {
 }
 
 struct CubeMap::GGXSamples {
+    // Everything about a sample that doesn't depend on the pixel being convolved: the source mip levels it reads and
+    // its weight in each of them, already scaled by NdotL and invTotalWeight
+    struct Resolved {
+        glm::vec3 L;
+        gpu::uint16 loLevel;
+        gpu::uint16 hiLevel;
+        float loWeight;
+        float hiWeight;
+    };
+
     float invTotalWeight;
     std::vector<glm::vec4> points;
+    std::vector<Resolved> resolved;
+};
+
+struct CubeMap::GGXTile {
+    gpu::uint16 mipLevel;
+    int face;
+    int beginX;
+    int endX;
+    int beginY;
+    int endY;
 };
 
 // All the GGX convolution code is inspired from:
@@ -567,15 +619,36 @@ void CubeMap::generateGGXSamples(GGXSamples& data, float roughness, const int re
     data.invTotalWeight = 1.0f / data.invTotalWeight;
 }
 
+void CubeMap::resolveGGXSamples(GGXSamples& data, gpu::uint16 mipCount) {
+    data.resolved.resize(data.points.size());
+
+    for (size_t i = 0; i < data.points.size(); ++i) {
+        const auto& sample = data.points[i];
+        auto& resolved = data.resolved[i];
+        const float lod = glm::clamp<float>(sample.w, 0.0f, mipCount - 1);
+        const float weight = sample.z * data.invTotalWeight;
+
+        resolved.L = glm::vec3(sample);
+        resolved.loLevel = (gpu::uint16)std::floor(lod);
+        resolved.hiLevel = (gpu::uint16)std::ceil(lod);
+
+        const float lodFrac = lod - (float)resolved.loLevel;
+        resolved.loWeight = weight * (1.0f - lodFrac);
+        resolved.hiWeight = weight * lodFrac;
+    }
+}
+
 void CubeMap::convolveForGGX(CubeMap& output, const std::atomic<bool>& abortProcessing) const {
     // This should match the value in the getMipLevelFromRoughness function (LightAmbient.slh)
     static const float ROUGHNESS_1_MIP_RESOLUTION = 1.5f;
     static const size_t MAX_SAMPLE_COUNT = 4000;
+    static const int TILE_SIZE = 32;
 
     const auto mipCount = getMipCount();
-    GGXSamples params;
 
-    params.points.reserve(MAX_SAMPLE_COUNT);
+    // Build the sample tables of every level up front: generateGGXSamples relies on rand() so it has to stay on this
+    // thread, and each table is then shared by all the faces and tiles of its level.
+    std::vector<GGXSamples> mipSamples(mipCount);
 
     for (gpu::uint16 mipLevel = 0; mipLevel < mipCount; ++mipLevel) {
         // This is the inverse code found in LightAmbient.slh in getMipLevelFromRoughness
@@ -591,70 +664,107 @@ void CubeMap::convolveForGGX(CubeMap& output, const std::atomic<bool>& abortProc
         sampleCount = std::min(sampleCount, 2 * mipTotalPixelCount);
         sampleCount = std::min(MAX_SAMPLE_COUNT, sampleCount);
 
-        params.points.resize(sampleCount);
-        generateGGXSamples(params, mipRoughness, _width);
+        auto& samples = mipSamples[mipLevel];
+        samples.points.resize(sampleCount);
+        generateGGXSamples(samples, mipRoughness, _width);
+        resolveGGXSamples(samples, mipCount);
+    }
 
+    std::vector<ConstMip> sourceMips;
+    sourceMips.reserve(mipCount);
+    for (gpu::uint16 mipLevel = 0; mipLevel < mipCount; ++mipLevel) {
+        sourceMips.emplace_back(mipLevel, this);
+    }
+
+    // Split every face of every level in tiles and schedule them all at once so the small, rough (and most
+    // expensive per pixel) levels run alongside the large ones instead of after them.
+    std::vector<GGXTile> tiles;
+    for (gpu::uint16 mipLevel = 0; mipLevel < mipCount; ++mipLevel) {
+        const auto mipDimensions = output.getMipDimensions(mipLevel);
         for (int face = 0; face < 6; face++) {
-            convolveMipFaceForGGX(params, output, mipLevel, face, abortProcessing);
-            if (abortProcessing.load()) {
-                return;
+            for (int y = 0; y < mipDimensions.y; y += TILE_SIZE) {
+                for (int x = 0; x < mipDimensions.x; x += TILE_SIZE) {
+                    tiles.push_back({ mipLevel, face, x, std::min(x + TILE_SIZE, mipDimensions.x), y, std::min(y + TILE_SIZE, mipDimensions.y) });
+                }
             }
         }
     }
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, tiles.size(), 1), [&](const tbb::blocked_range<size_t>& range) {
+        for (auto i = range.begin(); i < range.end(); i++) {
+            if (abortProcessing.load()) {
+                break;
+            }
+            const auto& tile = tiles[i];
+            convolveTileForGGX(mipSamples[tile.mipLevel], sourceMips.data(), tile, output, abortProcessing);
+        }
+    });
 }
 
-void CubeMap::convolveMipFaceForGGX(const GGXSamples& samples, CubeMap& output, gpu::uint16 mipLevel, int face, const std::atomic<bool>& abortProcessing) const {
-    const glm::vec3* faceNormals = FACE_NORMALS + face * 4;
+void CubeMap::convolveTileForGGX(const GGXSamples& samples, const ConstMip* sourceMips, const GGXTile& tile, CubeMap& output, const std::atomic<bool>& abortProcessing) const {
+    const glm::vec3* faceNormals = FACE_NORMALS + tile.face * 4;
     const glm::vec3 deltaYNormalLo = faceNormals[2] - faceNormals[0];
     const glm::vec3 deltaYNormalHi = faceNormals[3] - faceNormals[1];
-    const auto mipDimensions = output.getMipDimensions(mipLevel);
-    const auto outputLineStride = output.getMipLineStride(mipLevel);
-    auto outputFacePixels = output.editFace(mipLevel, face);
-
-    tbb::parallel_for(tbb::blocked_range2d<int, int>(0, mipDimensions.y, 32, 0, mipDimensions.x, 32), [&](const tbb::blocked_range2d<int, int>& range) {
-        auto rowRange = range.rows();
-        auto colRange = range.cols();
+    const auto mipDimensions = output.getMipDimensions(tile.mipLevel);
+    const auto outputLineStride = output.getMipLineStride(tile.mipLevel);
+    auto outputFacePixels = output.editFace(tile.mipLevel, tile.face);
 
-        for (auto y = rowRange.begin(); y < rowRange.end(); y++) {
-            if (abortProcessing.load()) {
-                break;
-            }
+    for (auto y = tile.beginY; y < tile.endY; y++) {
+        if (abortProcessing.load()) {
+            break;
+        }
 
-            const float yAlpha = (y + 0.5f) / mipDimensions.y;
-            const glm::vec3 normalXLo = faceNormals[0] + deltaYNormalLo * yAlpha;
-            const glm::vec3 normalXHi = faceNormals[1] + deltaYNormalHi * yAlpha;
-            const glm::vec3 deltaXNormal = normalXHi - normalXLo;
+        const float yAlpha = (y + 0.5f) / mipDimensions.y;
+        const glm::vec3 normalXLo = faceNormals[0] + deltaYNormalLo * yAlpha;
+        const glm::vec3 normalXHi = faceNormals[1] + deltaYNormalHi * yAlpha;
+        const glm::vec3 deltaXNormal = normalXHi - normalXLo;
 
-            for (auto x = colRange.begin(); x < colRange.end(); x++) {
-                const float xAlpha = (x + 0.5f) / mipDimensions.x;
-                // Interpolate normal for this pixel
-                const glm::vec3 normal = glm::normalize(normalXLo + deltaXNormal * xAlpha);
+        for (auto x = tile.beginX; x < tile.endX; x++) {
+            const float xAlpha = (x + 0.5f) / mipDimensions.x;
+            // Interpolate normal for this pixel
+            const glm::vec3 normal = glm::normalize(normalXLo + deltaXNormal * xAlpha);
 
-                outputFacePixels[x + y * outputLineStride] = computeConvolution(normal, samples);
-            }
+            outputFacePixels[x + y * outputLineStride] = computeConvolution(normal, samples, sourceMips);
         }
-    });
+    }
 }
 
-glm::vec4 CubeMap::computeConvolution(const glm::vec3& N, const GGXSamples& samples) const {
+glm::vec4 CubeMap::computeConvolution(const glm::vec3& N, const GGXSamples& samples, const ConstMip* sourceMips) const {
     // from tangent-space vector to world-space
     glm::vec3 bitangent = std::abs(N.z) < 0.999f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
     glm::vec3 tangent = glm::normalize(glm::cross(bitangent, N));
     bitangent = glm::cross(N, tangent);
 
-    const size_t sampleCount = samples.points.size();
-    glm::vec4 prefilteredColor = glm::vec4(0.0f);
+    glm::vec4 prefilteredColor;
+    int face;
+    glm::vec2 uv;
 
-    for (size_t i = 0; i < sampleCount; ++i) {
-        const auto& sample = samples.points[i];
-        glm::vec3 L(sample.x, sample.y, sample.z);
-        float NdotL = L.z;
-        float mipLevel = sample.w;
+#ifdef CUBEMAP_SSE
+    __m128 accumulator = _mm_setzero_ps();
+
+    for (const auto& sample : samples.resolved) {
+        // Now back to world space
+        const glm::vec3 L = tangent * sample.L.x + bitangent * sample.L.y + N * sample.L.z;
+        getFaceUV(L, &face, &uv);
+        accumulator = _mm_add_ps(accumulator, _mm_mul_ps(sourceMips[sample.loLevel].fetchSSE(face, uv), _mm_set1_ps(sample.loWeight)));
+        if (sample.hiLevel != sample.loLevel) {
+            accumulator = _mm_add_ps(accumulator, _mm_mul_ps(sourceMips[sample.hiLevel].fetchSSE(face, uv), _mm_set1_ps(sample.hiWeight)));
+        }
+    }
+    _mm_storeu_ps(&prefilteredColor.x, accumulator);
+#else
+    prefilteredColor = glm::vec4(0.0f);
+
+    for (const auto& sample : samples.resolved) {
         // Now back to world space
-        L = tangent * L.x + bitangent * L.y + N * L.z;
-        prefilteredColor += fetchLod(L, mipLevel) * NdotL;
+        const glm::vec3 L = tangent * sample.L.x + bitangent * sample.L.y + N * sample.L.z;
+        getFaceUV(L, &face, &uv);
+        prefilteredColor += sourceMips[sample.loLevel].fetch(face, uv) * sample.loWeight;
+        if (sample.hiLevel != sample.loLevel) {
+            prefilteredColor += sourceMips[sample.hiLevel].fetch(face, uv) * sample.hiWeight;
+        }
     }
-    prefilteredColor = prefilteredColor * samples.invTotalWeight;
+#endif
     prefilteredColor.a = 1.0f;
     return prefilteredColor;
-}
\ No newline at end of file
+}
@@ -69,6 +69,7 @@ namespace image {
     private:
 
         struct GGXSamples;
+        struct GGXTile;
         class Mip;
         class ConstMip;
 
@@ -82,8 +83,9 @@ namespace image {
         static void getFaceUV(const glm::vec3& dir, int* index, glm::vec2* uv);
         static void generateGGXSamples(GGXSamples& data, float roughness, const int resolution);
         static void copyFace(int width, int height, const glm::vec4* source, size_t srcLineStride, glm::vec4* dest, size_t dstLineStride);
-        void convolveMipFaceForGGX(const GGXSamples& samples, CubeMap& output, gpu::uint16 mipLevel, int face, const std::atomic<bool>& abortProcessing) const;
-        glm::vec4 computeConvolution(const glm::vec3& normal, const GGXSamples& samples) const;
+        static void resolveGGXSamples(GGXSamples& data, gpu::uint16 mipCount);
+        void convolveTileForGGX(const GGXSamples& samples, const ConstMip* sourceMips, const GGXTile& tile, CubeMap& output, const std::atomic<bool>& abortProcessing) const;
+        glm::vec4 computeConvolution(const glm::vec3& normal, const GGXSamples& samples, const ConstMip* sourceMips) const;
 
     };
 
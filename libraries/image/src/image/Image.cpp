@@ -179,7 +179,7 @@ Image Image::getConvertedToFormat(Format newFormat) const {
 
         switch (newFormat) {
             case Format_R11G11B10F:
-                convertToPackedFromFloat(newImage.editBits(), _dims.x, _dims.y, getBytesPerLineCount(), gpu::Element::COLOR_R11G11B10, _floatData.data(), _dims.x);
+                convertToPackedFromFloat(newImage.editBits(), _dims.x, _dims.y, newImage.getBytesPerLineCount(), gpu::Element::COLOR_R11G11B10, _floatData.data(), _dims.x);
                 break;
 
             default:
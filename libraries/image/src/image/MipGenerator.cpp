@@ -0,0 +1,725 @@
+//
+//  MipGenerator.cpp
+//  image/src/image
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "MipGenerator.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include <QtCore/QtGlobal>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <TBBHelpers.h>
+#include <gpu/Texture.h>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#include <emmintrin.h>
+#define MIPGENERATOR_SSE
+#endif
+
+#ifndef M_PI
+#define M_PI    3.14159265359
+#endif
+
+using namespace image;
+
+// the Kaiser filter spans this many texels of the next mip on each side of a texel
+static const float KAISER_WIDTH = 2.0f;
+static const float KAISER_ALPHA = 4.0f;
+
+// rows are spread over the TBB threads in chunks of about this many texels
+static const int TEXELS_PER_TASK = 32 * 1024;
+
+// the smallest normal and the largest finite values of the 10 and 11 bit floats, lower values flush to zero
+static const float MIN_PACKED_FLOAT = 6.103515625e-5f;
+static const float MAX_PACKED_FLOAT = 6.50e4f;
+// (2^9 - 1) / 2^9 * 2^(31 - 15)
+static const float MAX_RGB9E5 = 65408.0f;
+
+static std::atomic<MipFilter> DEFAULT_MIP_FILTER { MipFilter::Box };
+
+MipFilter image::getDefaultMipFilter() {
+    return DEFAULT_MIP_FILTER;
+}
+
+void image::setDefaultMipFilter(MipFilter filter) {
+    DEFAULT_MIP_FILTER = filter;
+}
+
+template <typename F>
+static void forEachRows(int rowCount, int rowWidth, F&& function) {
+    int rowsPerTask = std::max(1, TEXELS_PER_TASK / std::max(1, rowWidth));
+    if (rowCount <= rowsPerTask) {
+        function(0, rowCount);
+        return;
+    }
+    tbb::parallel_for(tbb::blocked_range<int>(0, rowCount, rowsPerTask), [&](const tbb::blocked_range<int>& range) {
+        function(range.begin(), range.end());
+    });
+}
+
+//
+// sRGB
+//
+
+static float decodeSRGB(float value) {
+    return value <= 0.04045f ? value / 12.92f : powf((value + 0.055f) / 1.055f, 2.4f);
+}
+
+static float encodeSRGB(float value) {
+    return value <= 0.0031308f ? value * 12.92f : 1.055f * powf(value, 1.0f / 2.4f) - 0.055f;
+}
+
+static const int SRGB_ENCODE_TABLE_SIZE = 1 << 16;
+
+struct Unorm8Tables {
+    std::array<float, 256> linear;
+    std::array<float, 256> srgbToLinear;
+    // indexed by a linear value in [0, 1] scaled to [0, 65535], fine enough that every 8 bit sRGB value round trips
+    std::vector<uint8_t> linearToSRGB;
+
+    Unorm8Tables() : linearToSRGB(SRGB_ENCODE_TABLE_SIZE) {
+        for (int i = 0; i < 256; ++i) {
+            linear[i] = (float)i / 255.0f;
+            srgbToLinear[i] = decodeSRGB(linear[i]);
+        }
+        for (int i = 0; i < SRGB_ENCODE_TABLE_SIZE; ++i) {
+            float value = encodeSRGB((float)i / (float)(SRGB_ENCODE_TABLE_SIZE - 1));
+            linearToSRGB[i] = (uint8_t)std::lrintf(glm::clamp(value, 0.0f, 1.0f) * 255.0f);
+        }
+    }
+};
+
+static const Unorm8Tables& getUnorm8Tables() {
+    static const Unorm8Tables tables;
+    return tables;
+}
+
+//
+// Row packing
+//
+
+enum class Unorm8Layout {
+    Invalid,
+    RGBA,
+    BGRA,
+    R,
+    RG
+};
+
+static Unorm8Layout getUnorm8Layout(const gpu::Element& format, bool& isSRGB) {
+    isSRGB = format == gpu::Element::COLOR_SRGBA_32 || format == gpu::Element::COLOR_SBGRA_32 ||
+             format == gpu::Element::COLOR_SR_8;
+    if (format == gpu::Element::COLOR_RGBA_32 || format == gpu::Element::COLOR_SRGBA_32) {
+        return Unorm8Layout::RGBA;
+    } else if (format == gpu::Element::COLOR_BGRA_32 || format == gpu::Element::COLOR_SBGRA_32) {
+        return Unorm8Layout::BGRA;
+    } else if (format == gpu::Element::COLOR_R_8 || format == gpu::Element::COLOR_SR_8) {
+        return Unorm8Layout::R;
+    } else if (format == gpu::Element::VEC2NU8_XY) {
+        return Unorm8Layout::RG;
+    }
+    return Unorm8Layout::Invalid;
+}
+
+bool image::isPackableFormat(const gpu::Element& format) {
+    bool isSRGB;
+    return format == gpu::Element::COLOR_R11G11B10 || format == gpu::Element::COLOR_RGB9E5 ||
+           getUnorm8Layout(format, isSRGB) != Unorm8Layout::Invalid;
+}
+
+static uint32_t encodeUnorm8(const glm::vec4& texel, bool isSRGB) {
+    const auto& tables = getUnorm8Tables();
+    glm::vec4 value = glm::clamp(texel, 0.0f, 1.0f);
+    uint32_t channels[4];
+    for (int i = 0; i < 4; ++i) {
+        if (isSRGB && i < 3) {
+            channels[i] = tables.linearToSRGB[std::lrintf(value[i] * (float)(SRGB_ENCODE_TABLE_SIZE - 1))];
+        } else {
+            channels[i] = (uint32_t)std::lrintf(value[i] * 255.0f);
+        }
+    }
+    return channels[0] | (channels[1] << 8) | (channels[2] << 16) | (channels[3] << 24);
+}
+
+// count texels to 8 bit RGBA, R in the low byte
+static void encodeUnorm8Row(const glm::vec4* source, int count, bool isSRGB, uint32_t* destination) {
+    int i = 0;
+#ifdef MIPGENERATOR_SSE
+    const auto& tables = getUnorm8Tables();
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 unorm8Scale = _mm_set1_ps(255.0f);
+    const __m128 tableScale = _mm_set1_ps((float)(SRGB_ENCODE_TABLE_SIZE - 1));
+    for (; i + 4 <= count; i += 4) {
+        __m128 texels[4];
+        __m128i values[4];
+        for (int j = 0; j < 4; ++j) {
+            texels[j] = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(&source[i + j].x), zero), one);
+            values[j] = _mm_cvtps_epi32(_mm_mul_ps(texels[j], unorm8Scale));
+        }
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(values[0], values[1]), _mm_packs_epi32(values[2], values[3]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), packed);
+
+        if (isSRGB) {
+            // the color channels are looked up, alpha stays linear
+            int32_t indices[16];
+            for (int j = 0; j < 4; ++j) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(indices + 4 * j), _mm_cvtps_epi32(_mm_mul_ps(texels[j], tableScale)));
+            }
+            for (int j = 0; j < 4; ++j) {
+                const int32_t* index = indices + 4 * j;
+                destination[i + j] = (destination[i + j] & 0xFF000000) | tables.linearToSRGB[index[0]] |
+                                     (tables.linearToSRGB[index[1]] << 8) | (tables.linearToSRGB[index[2]] << 16);
+            }
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        destination[i] = encodeUnorm8(source[i], isSRGB);
+    }
+}
+
+static void packUnorm8Row(const glm::vec4* source, int count, Unorm8Layout layout, bool isSRGB, gpu::Byte* destination) {
+    const int CHUNK_SIZE = 256;
+    uint32_t texels[CHUNK_SIZE];
+    for (int begin = 0; begin < count; begin += CHUNK_SIZE) {
+        int chunkCount = std::min(CHUNK_SIZE, count - begin);
+        encodeUnorm8Row(source + begin, chunkCount, isSRGB, texels);
+        switch (layout) {
+            case Unorm8Layout::BGRA:
+                for (int i = 0; i < chunkCount; ++i) {
+                    uint32_t texel = texels[i];
+                    texels[i] = (texel & 0xFF00FF00) | ((texel & 0xFF) << 16) | ((texel >> 16) & 0xFF);
+                }
+                // fall through
+            case Unorm8Layout::RGBA:
+                memcpy(destination + 4 * begin, texels, chunkCount * sizeof(uint32_t));
+                break;
+            case Unorm8Layout::R:
+                for (int i = 0; i < chunkCount; ++i) {
+                    destination[begin + i] = (gpu::Byte)texels[i];
+                }
+                break;
+            case Unorm8Layout::RG:
+                for (int i = 0; i < chunkCount; ++i) {
+                    destination[2 * (begin + i)] = (gpu::Byte)texels[i];
+                    destination[2 * (begin + i) + 1] = (gpu::Byte)(texels[i] >> 8);
+                }
+                break;
+            default:
+                Q_UNREACHABLE();
+        }
+    }
+}
+
+static void unpackUnorm8Row(const gpu::Byte* source, int count, Unorm8Layout layout, bool isSRGB, glm::vec4* destination) {
+    const auto& tables = getUnorm8Tables();
+    const auto& color = isSRGB ? tables.srgbToLinear : tables.linear;
+    const auto& alpha = tables.linear;
+    switch (layout) {
+        case Unorm8Layout::RGBA:
+            for (int i = 0; i < count; ++i, source += 4) {
+                destination[i] = glm::vec4(color[source[0]], color[source[1]], color[source[2]], alpha[source[3]]);
+            }
+            break;
+        case Unorm8Layout::BGRA:
+            for (int i = 0; i < count; ++i, source += 4) {
+                destination[i] = glm::vec4(color[source[2]], color[source[1]], color[source[0]], alpha[source[3]]);
+            }
+            break;
+        case Unorm8Layout::R:
+            for (int i = 0; i < count; ++i) {
+                destination[i] = glm::vec4(color[source[i]], 0.0f, 0.0f, 1.0f);
+            }
+            break;
+        case Unorm8Layout::RG:
+            for (int i = 0; i < count; ++i, source += 2) {
+                destination[i] = glm::vec4(color[source[0]], color[source[1]], 0.0f, 1.0f);
+            }
+            break;
+        default:
+            Q_UNREACHABLE();
+    }
+}
+
+// Truncates a positive float to an unsigned float with mantissaBits bits of mantissa and 5 of exponent,
+// like glm::packF2x11_1x10 but keeping the values just under the smallest normal from wrapping to infinity.
+static uint32_t packSmallFloat(float value, int mantissaBits) {
+    if (!(value >= MIN_PACKED_FLOAT)) {
+        // negative, NaN or too small
+        return 0;
+    }
+    value = std::min(MAX_PACKED_FLOAT, value);
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return (bits >> (23 - mantissaBits)) - (112u << mantissaBits);
+}
+
+static uint32_t packR11G11B10(const glm::vec4& texel) {
+    return packSmallFloat(texel.r, 6) | (packSmallFloat(texel.g, 6) << 11) | (packSmallFloat(texel.b, 5) << 22);
+}
+
+static uint32_t packRGB9E5(const glm::vec4& texel) {
+    glm::vec3 color;
+    for (int i = 0; i < 3; ++i) {
+        color[i] = texel[i] > 0.0f ? std::min(texel[i], MAX_RGB9E5) : 0.0f;
+    }
+    float maxValue = std::max(color.r, std::max(color.g, color.b));
+
+    // floor(log2(maxValue)) straight from its exponent bits, and a shared exponent one above it
+    uint32_t bits;
+    memcpy(&bits, &maxValue, sizeof(bits));
+    int32_t exponent = std::max(-16, (int32_t)((bits >> 23) & 0xFF) - 127) + 16;
+    uint32_t scaleBits = (uint32_t)(151 - exponent) << 23;
+    float scale;
+    memcpy(&scale, &scaleBits, sizeof(scale));
+    if ((int32_t)(maxValue * scale + 0.5f) == 512) {
+        ++exponent;
+        scale *= 0.5f;
+    }
+
+    glm::uvec3 mantissas(color * scale + 0.5f);
+    return mantissas.r | (mantissas.g << 9) | (mantissas.b << 18) | ((uint32_t)exponent << 27);
+}
+
+#ifdef MIPGENERATOR_SSE
+// 4 texels are transposed so each register holds one channel of all of them
+static void loadChannels(const glm::vec4* source, __m128& red, __m128& green, __m128& blue) {
+    __m128 texel0 = _mm_loadu_ps(&source[0].x);
+    __m128 texel1 = _mm_loadu_ps(&source[1].x);
+    __m128 texel2 = _mm_loadu_ps(&source[2].x);
+    __m128 texel3 = _mm_loadu_ps(&source[3].x);
+    _MM_TRANSPOSE4_PS(texel0, texel1, texel2, texel3);
+    red = texel0;
+    green = texel1;
+    blue = texel2;
+}
+
+template <int MANTISSA_BITS>
+static __m128i packSmallFloatSSE(__m128 value) {
+    value = _mm_min_ps(_mm_set1_ps(MAX_PACKED_FLOAT), value);
+    __m128 isValid = _mm_cmpge_ps(value, _mm_set1_ps(MIN_PACKED_FLOAT));
+    __m128i bits = _mm_srli_epi32(_mm_castps_si128(value), 23 - MANTISSA_BITS);
+    bits = _mm_sub_epi32(bits, _mm_set1_epi32(112 << MANTISSA_BITS));
+    return _mm_and_si128(bits, _mm_castps_si128(isValid));
+}
+#endif
+
+static void packR11G11B10Row(const glm::vec4* source, int count, uint32_t* destination) {
+    int i = 0;
+#ifdef MIPGENERATOR_SSE
+    for (; i + 4 <= count; i += 4) {
+        __m128 red, green, blue;
+        loadChannels(source + i, red, green, blue);
+        __m128i packed = packSmallFloatSSE<6>(red);
+        packed = _mm_or_si128(packed, _mm_slli_epi32(packSmallFloatSSE<6>(green), 11));
+        packed = _mm_or_si128(packed, _mm_slli_epi32(packSmallFloatSSE<5>(blue), 22));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), packed);
+    }
+#endif
+    for (; i < count; ++i) {
+        destination[i] = packR11G11B10(source[i]);
+    }
+}
+
+static void packRGB9E5Row(const glm::vec4* source, int count, uint32_t* destination) {
+    int i = 0;
+#ifdef MIPGENERATOR_SSE
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 maxValue = _mm_set1_ps(MAX_RGB9E5);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128i minExponent = _mm_set1_epi32(-16);
+    for (; i + 4 <= count; i += 4) {
+        __m128 red, green, blue;
+        loadChannels(source + i, red, green, blue);
+        // max first so NaNs become 0
+        red = _mm_min_ps(_mm_max_ps(red, zero), maxValue);
+        green = _mm_min_ps(_mm_max_ps(green, zero), maxValue);
+        blue = _mm_min_ps(_mm_max_ps(blue, zero), maxValue);
+        __m128 maxChannel = _mm_max_ps(red, _mm_max_ps(green, blue));
+
+        __m128i exponent = _mm_sub_epi32(_mm_and_si128(_mm_srli_epi32(_mm_castps_si128(maxChannel), 23), _mm_set1_epi32(0xFF)),
+                                         _mm_set1_epi32(127));
+        __m128i isAboveMin = _mm_cmpgt_epi32(exponent, minExponent);
+        exponent = _mm_or_si128(_mm_and_si128(isAboveMin, exponent), _mm_andnot_si128(isAboveMin, minExponent));
+        exponent = _mm_add_epi32(exponent, _mm_set1_epi32(16));
+        __m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_sub_epi32(_mm_set1_epi32(151), exponent), 23));
+
+        __m128i maxMantissa = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(maxChannel, scale), half));
+        __m128i isOverflow = _mm_cmpeq_epi32(maxMantissa, _mm_set1_epi32(512));
+        exponent = _mm_sub_epi32(exponent, isOverflow);
+        __m128 overflowScale = _mm_or_ps(_mm_and_ps(_mm_castsi128_ps(isOverflow), half),
+                                         _mm_andnot_ps(_mm_castsi128_ps(isOverflow), one));
+        scale = _mm_mul_ps(scale, overflowScale);
+
+        __m128i packed = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(red, scale), half));
+        packed = _mm_or_si128(packed, _mm_slli_epi32(_mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(green, scale), half)), 9));
+        packed = _mm_or_si128(packed, _mm_slli_epi32(_mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(blue, scale), half)), 18));
+        packed = _mm_or_si128(packed, _mm_slli_epi32(exponent, 27));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), packed);
+    }
+#endif
+    for (; i < count; ++i) {
+        destination[i] = packRGB9E5(source[i]);
+    }
+}
+
+void image::packRow(const glm::vec4* source, int count, const gpu::Element& format, gpu::Byte* destination) {
+    if (format == gpu::Element::COLOR_R11G11B10) {
+        packR11G11B10Row(source, count, reinterpret_cast<uint32_t*>(destination));
+    } else if (format == gpu::Element::COLOR_RGB9E5) {
+        packRGB9E5Row(source, count, reinterpret_cast<uint32_t*>(destination));
+    } else {
+        bool isSRGB;
+        auto layout = getUnorm8Layout(format, isSRGB);
+        assert(layout != Unorm8Layout::Invalid);
+        packUnorm8Row(source, count, layout, isSRGB, destination);
+    }
+}
+
+void image::unpackRow(const gpu::Byte* source, int count, const gpu::Element& format, glm::vec4* destination) {
+    if (format == gpu::Element::COLOR_R11G11B10 || format == gpu::Element::COLOR_RGB9E5) {
+        auto unpack = format == gpu::Element::COLOR_R11G11B10 ? glm::unpackF2x11_1x10 : glm::unpackF3x9_E1x5;
+        for (int i = 0; i < count; ++i) {
+            uint32_t packed;
+            memcpy(&packed, source + i * sizeof(packed), sizeof(packed));
+            destination[i] = glm::vec4(unpack(packed), 1.0f);
+        }
+    } else {
+        bool isSRGB;
+        auto layout = getUnorm8Layout(format, isSRGB);
+        assert(layout != Unorm8Layout::Invalid);
+        unpackUnorm8Row(source, count, layout, isSRGB, destination);
+    }
+}
+
+void image::packImage(const Image& image, const gpu::Element& format, gpu::Byte* destination, size_t lineByteStride) {
+    assert(image.getFormat() == Image::Format_RGBAF);
+    const int width = image.getWidth();
+    const int height = image.getHeight();
+    if (lineByteStride == 0) {
+        lineByteStride = gpu::Texture::evalLineSize(width, format);
+    }
+
+    const glm::vec4* texels = reinterpret_cast<const glm::vec4*>(image.getBits());
+    forEachRows(height, width, [&](int begin, int end) {
+        for (int y = begin; y < end; ++y) {
+            packRow(texels + y * width, width, format, destination + y * lineByteStride);
+        }
+    });
+}
+
+Image image::convertToLinearFloat(Image&& image, bool isSRGB) {
+    Image source = std::move(image);
+    if (source.getFormat() == Image::Format_RGBAF) {
+        return source;
+    }
+
+    const gpu::Element* format = &gpu::Element::COLOR_R11G11B10;
+    if (source.getFormat() != Image::Format_PACKED_FLOAT) {
+        if (source.getFormat() != Image::Format_ARGB32) {
+            source = source.getConvertedToFormat(Image::Format_ARGB32);
+        }
+        // 0xAARRGGBB in memory on little endian machines
+        format = isSRGB ? &gpu::Element::COLOR_SBGRA_32 : &gpu::Element::COLOR_BGRA_32;
+    }
+
+    const int width = source.getWidth();
+    const int height = source.getHeight();
+    Image result(width, height, Image::Format_RGBAF);
+    const gpu::Byte* sourceBits = source.getBits();
+    const size_t sourceLineByteStride = source.getBytesPerLineCount();
+    glm::vec4* texels = reinterpret_cast<glm::vec4*>(result.editBits());
+    forEachRows(height, width, [&](int begin, int end) {
+        for (int y = begin; y < end; ++y) {
+            unpackRow(sourceBits + y * sourceLineByteStride, width, *format, texels + y * width);
+        }
+    });
+    return result;
+}
+
+//
+// Filtering
+//
+
+#ifdef MIPGENERATOR_SSE
+using Texel = __m128;
+static inline Texel loadTexel(const glm::vec4& texel) { return _mm_loadu_ps(&texel.x); }
+static inline void storeTexel(glm::vec4& texel, Texel value) { _mm_storeu_ps(&texel.x, value); }
+static inline Texel splatTexel(float value) { return _mm_set1_ps(value); }
+static inline Texel addTexels(Texel a, Texel b) { return _mm_add_ps(a, b); }
+static inline Texel mulTexels(Texel a, Texel b) { return _mm_mul_ps(a, b); }
+static inline Texel premultiplyTexel(Texel texel) {
+    const __m128 COLOR_MASK = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+    __m128 alpha = _mm_shuffle_ps(texel, texel, _MM_SHUFFLE(3, 3, 3, 3));
+    return _mm_or_ps(_mm_and_ps(_mm_mul_ps(texel, alpha), COLOR_MASK), _mm_andnot_ps(COLOR_MASK, texel));
+}
+#else
+using Texel = glm::vec4;
+static inline Texel loadTexel(const glm::vec4& texel) { return texel; }
+static inline void storeTexel(glm::vec4& texel, Texel value) { texel = value; }
+static inline Texel splatTexel(float value) { return glm::vec4(value); }
+static inline Texel addTexels(Texel a, Texel b) { return a + b; }
+static inline Texel mulTexels(Texel a, Texel b) { return a * b; }
+static inline Texel premultiplyTexel(Texel texel) { return glm::vec4(glm::vec3(texel) * texel.a, texel.a); }
+#endif
+
+template <bool IS_ALPHA_WEIGHTED>
+static inline Texel fetchTexel(const glm::vec4& texel) {
+    return IS_ALPHA_WEIGHTED ? premultiplyTexel(loadTexel(texel)) : loadTexel(texel);
+}
+
+// The source texels of every texel of the next mip along one dimension, and their normalized weights
+struct FilterTaps {
+    int count { 0 }; // per texel
+    std::vector<int> indices; // of the source texels, mirrored into range
+    std::vector<float> weights;
+};
+
+// modified Bessel function of the first kind of order 0
+static double bessel0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 64; ++k) {
+        term *= 0.5 * x / k;
+        sum += term * term;
+        if (term * term < 1.0e-12 * sum) {
+            break;
+        }
+    }
+    return sum;
+}
+
+// x in texels of the next mip
+static float evalKaiser(float x) {
+    if (fabsf(x) >= KAISER_WIDTH) {
+        return 0.0f;
+    }
+    double sinc = x == 0.0f ? 1.0 : sin(M_PI * x) / (M_PI * x);
+    double ratio = x / KAISER_WIDTH;
+    return (float)(sinc * bessel0(KAISER_ALPHA * sqrt(1.0 - ratio * ratio)) / bessel0(KAISER_ALPHA));
+}
+
+static int mirrorIndex(int index, int size) {
+    if (size == 1) {
+        return 0;
+    }
+    int period = 2 * size;
+    index %= period;
+    if (index < 0) {
+        index += period;
+    }
+    return index < size ? index : period - 1 - index;
+}
+
+static FilterTaps evalFilterTaps(int sourceSize, int size, MipFilter filter) {
+    FilterTaps taps;
+    if (sourceSize == size) {
+        taps.count = 1;
+        for (int i = 0; i < size; ++i) {
+            taps.indices.push_back(i);
+            taps.weights.push_back(1.0f);
+        }
+        return taps;
+    }
+
+    const float scale = (float)sourceSize / (float)size;
+    const float radius = KAISER_WIDTH * scale;
+    taps.count = filter == MipFilter::Box ? (int)ceilf(scale) + 1 : (int)ceilf(2.0f * radius) + 1;
+    taps.indices.resize(size * taps.count);
+    taps.weights.resize(size * taps.count);
+
+    for (int i = 0; i < size; ++i) {
+        int* indices = taps.indices.data() + i * taps.count;
+        float* weights = taps.weights.data() + i * taps.count;
+        float sum = 0.0f;
+        if (filter == MipFilter::Box) {
+            // the coverage of each source texel by the texel of the next mip
+            float begin = i * scale;
+            float end = begin + scale;
+            int first = (int)floorf(begin);
+            for (int j = 0; j < taps.count; ++j) {
+                int index = first + j;
+                indices[j] = std::min(index, sourceSize - 1);
+                weights[j] = std::max(0.0f, std::min(end, (float)index + 1.0f) - std::max(begin, (float)index));
+                sum += weights[j];
+            }
+        } else {
+            float center = (i + 0.5f) * scale;
+            int first = (int)floorf(center - radius);
+            for (int j = 0; j < taps.count; ++j) {
+                int index = first + j;
+                indices[j] = mirrorIndex(index, sourceSize);
+                weights[j] = evalKaiser(((float)index + 0.5f - center) / scale);
+                sum += weights[j];
+            }
+        }
+        for (int j = 0; j < taps.count; ++j) {
+            weights[j] /= sum;
+        }
+    }
+    return taps;
+}
+
+template <bool IS_ALPHA_WEIGHTED>
+static void filterBoxRows(const glm::vec4* source, int sourceWidth, glm::vec4* destination, int width, int begin, int end) {
+    const Texel quarter = splatTexel(0.25f);
+    for (int y = begin; y < end; ++y) {
+        const glm::vec4* row0 = source + (2 * y) * sourceWidth;
+        const glm::vec4* row1 = row0 + sourceWidth;
+        glm::vec4* output = destination + y * width;
+        for (int x = 0; x < width; ++x) {
+            Texel sum = addTexels(fetchTexel<IS_ALPHA_WEIGHTED>(row0[2 * x]), fetchTexel<IS_ALPHA_WEIGHTED>(row0[2 * x + 1]));
+            sum = addTexels(sum, addTexels(fetchTexel<IS_ALPHA_WEIGHTED>(row1[2 * x]), fetchTexel<IS_ALPHA_WEIGHTED>(row1[2 * x + 1])));
+            storeTexel(output[x], mulTexels(sum, quarter));
+        }
+    }
+}
+
+template <bool IS_ALPHA_WEIGHTED>
+static void filterRowsHorizontally(const glm::vec4* source, int sourceWidth, const FilterTaps& taps, glm::vec4* destination,
+                                   int width, int begin, int end) {
+    for (int y = begin; y < end; ++y) {
+        const glm::vec4* input = source + y * sourceWidth;
+        glm::vec4* output = destination + y * width;
+        const int* indices = taps.indices.data();
+        const float* weights = taps.weights.data();
+        for (int x = 0; x < width; ++x, indices += taps.count, weights += taps.count) {
+            Texel sum = mulTexels(fetchTexel<IS_ALPHA_WEIGHTED>(input[indices[0]]), splatTexel(weights[0]));
+            for (int j = 1; j < taps.count; ++j) {
+                sum = addTexels(sum, mulTexels(fetchTexel<IS_ALPHA_WEIGHTED>(input[indices[j]]), splatTexel(weights[j])));
+            }
+            storeTexel(output[x], sum);
+        }
+    }
+}
+
+static void filterRowsVertically(const glm::vec4* source, const FilterTaps& taps, glm::vec4* destination, int width,
+                                 int begin, int end) {
+    for (int y = begin; y < end; ++y) {
+        const int* indices = taps.indices.data() + y * taps.count;
+        const float* weights = taps.weights.data() + y * taps.count;
+        glm::vec4* output = destination + y * width;
+
+        const glm::vec4* input = source + indices[0] * width;
+        Texel weight = splatTexel(weights[0]);
+        for (int x = 0; x < width; ++x) {
+            storeTexel(output[x], mulTexels(loadTexel(input[x]), weight));
+        }
+        for (int j = 1; j < taps.count; ++j) {
+            if (weights[j] == 0.0f) {
+                continue;
+            }
+            input = source + indices[j] * width;
+            weight = splatTexel(weights[j]);
+            for (int x = 0; x < width; ++x) {
+                storeTexel(output[x], addTexels(loadTexel(output[x]), mulTexels(loadTexel(input[x]), weight)));
+            }
+        }
+    }
+}
+
+// undoes the alpha weighting, clamps the Kaiser lobes and renormalizes normals
+static void finishRows(glm::vec4* texels, int width, int begin, int end, MipFilter filter, const MipEncoding& encoding) {
+    for (int y = begin; y < end; ++y) {
+        glm::vec4* row = texels + y * width;
+        for (int x = 0; x < width; ++x) {
+            glm::vec4& texel = row[x];
+            if (filter == MipFilter::Kaiser) {
+                texel = glm::max(texel, glm::vec4(0.0f));
+                texel.a = std::min(texel.a, 1.0f);
+            }
+            if (encoding.isAlphaWeighted) {
+                float scale = texel.a > 0.0f ? 1.0f / texel.a : 0.0f;
+                texel.r *= scale;
+                texel.g *= scale;
+                texel.b *= scale;
+            }
+            if (encoding.isNormalMap) {
+                glm::vec3 normal = glm::vec3(texel) * 2.0f - 1.0f;
+                float length = glm::length(normal);
+                if (length > 0.0f) {
+                    normal = normal / length * 0.5f + 0.5f;
+                    texel.r = normal.x;
+                    texel.g = normal.y;
+                    texel.b = normal.z;
+                }
+            }
+        }
+    }
+}
+
+static Image generateNextMip(const Image& source, MipFilter filter, const MipEncoding& encoding) {
+    const int sourceWidth = source.getWidth();
+    const int sourceHeight = source.getHeight();
+    const int width = std::max(1, sourceWidth / 2);
+    const int height = std::max(1, sourceHeight / 2);
+
+    Image mip(width, height, Image::Format_RGBAF);
+    const glm::vec4* sourceTexels = reinterpret_cast<const glm::vec4*>(source.getBits());
+    glm::vec4* texels = reinterpret_cast<glm::vec4*>(mip.editBits());
+    const bool needsFinish = filter == MipFilter::Kaiser || encoding.isAlphaWeighted || encoding.isNormalMap;
+
+    if (filter == MipFilter::Box && sourceWidth == 2 * width && sourceHeight == 2 * height) {
+        forEachRows(height, sourceWidth * 2, [&](int begin, int end) {
+            if (encoding.isAlphaWeighted) {
+                filterBoxRows<true>(sourceTexels, sourceWidth, texels, width, begin, end);
+            } else {
+                filterBoxRows<false>(sourceTexels, sourceWidth, texels, width, begin, end);
+            }
+            if (needsFinish) {
+                finishRows(texels, width, begin, end, filter, encoding);
+            }
+        });
+        return mip;
+    }
+
+    // separable, every source row is filtered horizontally then the rows are combined
+    FilterTaps horizontalTaps = evalFilterTaps(sourceWidth, width, filter);
+    FilterTaps verticalTaps = evalFilterTaps(sourceHeight, height, filter);
+    std::vector<glm::vec4> filteredRows(sourceHeight * width);
+    forEachRows(sourceHeight, width * horizontalTaps.count, [&](int begin, int end) {
+        if (encoding.isAlphaWeighted) {
+            filterRowsHorizontally<true>(sourceTexels, sourceWidth, horizontalTaps, filteredRows.data(), width, begin, end);
+        } else {
+            filterRowsHorizontally<false>(sourceTexels, sourceWidth, horizontalTaps, filteredRows.data(), width, begin, end);
+        }
+    });
+    forEachRows(height, width * verticalTaps.count, [&](int begin, int end) {
+        filterRowsVertically(filteredRows.data(), verticalTaps, texels, width, begin, end);
+        if (needsFinish) {
+            finishRows(texels, width, begin, end, filter, encoding);
+        }
+    });
+    return mip;
+}
+
+void image::generateMips(Image&& image, MipFilter filter, const MipEncoding& encoding, int numMips,
+                         const std::atomic<bool>& abortProcessing, const MipHandler& handler) {
+    Image mip = convertToLinearFloat(std::move(image), encoding.isSRGB);
+    for (int mipLevel = 0; numMips <= 0 || mipLevel < numMips; ++mipLevel) {
+        if (abortProcessing.load()) {
+            return;
+        }
+        handler(mipLevel, mip);
+        if ((mip.getWidth() == 1 && mip.getHeight() == 1) || mipLevel + 1 == numMips) {
+            break;
+        }
+        mip = generateNextMip(mip, filter, encoding);
+    }
+}
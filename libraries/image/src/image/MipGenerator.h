@@ -0,0 +1,66 @@
+//
+//  MipGenerator.h
+//  image/src/image
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_image_MipGenerator_h
+#define hifi_image_MipGenerator_h
+
+#include <atomic>
+#include <functional>
+
+#include <glm/vec4.hpp>
+
+#include <gpu/Format.h>
+
+#include "Image.h"
+
+namespace image {
+
+    enum class MipFilter {
+        Box,    // averages the 2x2 texels under each texel of the next mip
+        Kaiser  // Kaiser windowed sinc, sharper but four times the taps
+    };
+
+    // How the texels of a mip chain are encoded, which decides how they are filtered
+    struct MipEncoding {
+        bool isSRGB { false };          // 8 bit color channels are sRGB encoded, mips are filtered in linear space
+        bool isNormalMap { false };     // xyz are a normal remapped to [0, 1], renormalized in every mip
+        bool isAlphaWeighted { false }; // colors are weighted by their alpha, so transparent texels don't bleed into mips
+    };
+
+    // Called with each mip as linear RGBAF, from mip 0 of the source image down
+    using MipHandler = std::function<void(int mipLevel, const Image& mip)>;
+
+    // The filter used by the texture processing, Box by default
+    MipFilter getDefaultMipFilter();
+    void setDefaultMipFilter(MipFilter filter);
+
+    // Builds the mip chain of image down to 1x1, or numMips mips if numMips > 0, with SSE where available
+    // and the rows of each mip spread over the TBB worker threads.
+    void generateMips(Image&& image, MipFilter filter, const MipEncoding& encoding, int numMips,
+                      const std::atomic<bool>& abortProcessing, const MipHandler& handler);
+
+    // Any image to linear RGBAF, decoding 8 bit sRGB color channels if isSRGB
+    Image convertToLinearFloat(Image&& image, bool isSRGB);
+
+    // Whether packRow/unpackRow support format:
+    // R_8, SR_8, VEC2NU8_XY, (S)RGBA_32, (S)BGRA_32, R11G11B10 and RGB9E5
+    bool isPackableFormat(const gpu::Element& format);
+
+    // Converts count linear float texels to format, and back.  8 bit channels are clamped to [0, 1] and encoded to
+    // sRGB for the sRGB formats.  Formats without alpha drop it on packing and unpack it to 1.
+    void packRow(const glm::vec4* source, int count, const gpu::Element& format, gpu::Byte* destination);
+    void unpackRow(const gpu::Byte* source, int count, const gpu::Element& format, glm::vec4* destination);
+
+    // Packs a whole RGBAF image, rows lineByteStride bytes apart, or gpu::Texture::evalLineSize apart if 0
+    void packImage(const Image& image, const gpu::Element& format, gpu::Byte* destination, size_t lineByteStride = 0);
+
+} // namespace image
+
+#endif // hifi_image_MipGenerator_h
@@ -12,6 +12,7 @@
 #include "OpenEXRReader.h"
 
 #include "TextureProcessing.h"
+#include "MipGenerator.h"
 #include "ImageLogging.h"
 
 #include <QIODevice>
@@ -75,19 +76,15 @@ image::Image image::readOpenEXR(QIODevice& content, const std::string& filename)
         file.readPixels(viewport.min.y, viewport.max.y);
 
         Image image{ width, height, Image::Format_PACKED_FLOAT };
-        auto packHDRPixel = getHDRPackingFunction();
-        
+        std::vector<glm::vec4> floatPixels(width);
+
         for (int y = 0; y < height; y++) {
             const auto srcScanline = pixels[y];
-            gpu::uint32* dstScanline = (gpu::uint32*) image.editScanLine(y);
-
             for (int x = 0; x < width; x++) {
                 const auto& srcPixel = srcScanline[x];
-                auto& dstPixel = dstScanline[x];
-                glm::vec3 floatPixel{ srcPixel.r, srcPixel.g, srcPixel.b };
-
-                dstPixel = packHDRPixel(floatPixel);
+                floatPixels[x] = glm::vec4(srcPixel.r, srcPixel.g, srcPixel.b, 1.0f);
             }
+            packRow(floatPixels.data(), width, gpu::Element::COLOR_R11G11B10, image.editScanLine(y));
         }
         return image;
     } else {
@@ -11,6 +11,8 @@
 
 #include "TextureProcessing.h"
 
+#include <array>
+
 #include <glm/gtc/packing.hpp>
 
 #include <QtCore/QtGlobal>
@@ -30,6 +32,7 @@
 #endif
 #include "ImageLogging.h"
 #include "CubeMap.h"
+#include "MipGenerator.h"
 
 using namespace gpu;
 
@@ -420,6 +423,19 @@ Image processSourceImage(Image&& srcImage, bool cubemap, BackendTarget target) {
     return localCopy;
 }
 
+static bool isLinearTextureFormat(gpu::Element format) {
+    return !((format == gpu::Element::COLOR_SRGBA_32)
+        || (format == gpu::Element::COLOR_SBGRA_32)
+        || (format == gpu::Element::COLOR_SR_8)
+        || (format == gpu::Element::COLOR_COMPRESSED_BCX_SRGB)
+        || (format == gpu::Element::COLOR_COMPRESSED_BCX_SRGBA_MASK)
+        || (format == gpu::Element::COLOR_COMPRESSED_BCX_SRGBA)
+        || (format == gpu::Element::COLOR_COMPRESSED_BCX_SRGBA_HIGH)
+        || (format == gpu::Element::COLOR_COMPRESSED_ETC2_SRGB)
+        || (format == gpu::Element::COLOR_COMPRESSED_ETC2_SRGBA)
+        || (format == gpu::Element::COLOR_COMPRESSED_ETC2_SRGB_PUNCHTHROUGH_ALPHA));
+}
+
 #if defined(NVTT_API)
 struct OutputHandler : public nvtt::OutputHandler {
     OutputHandler(gpu::Texture* texture, int face) : _texture(texture), _face(face) {}
@@ -457,43 +473,6 @@ struct OutputHandler : public nvtt::OutputHandler {
     int _face = -1;
 };
 
-struct PackedFloatOutputHandler : public OutputHandler {
-    PackedFloatOutputHandler(gpu::Texture* texture, int face, gpu::Element format) : OutputHandler(texture, face) {
-        _packFunc = getHDRPackingFunction(format);
-    }
-
-    virtual void beginImage(int size, int width, int height, int depth, int face, int miplevel) override {
-        // Divide by 3 because we will compress from 3*floats to 1 uint32
-        OutputHandler::beginImage(size / 3, width, height, depth, face, miplevel);
-    }
-    virtual bool writeData(const void* data, int size) override {
-        // Expecting to write multiple of floats
-        if (_packFunc) {
-            assert((size % sizeof(float)) == 0);
-            auto floatCount = size / sizeof(float);
-            const float* floatBegin = (const float*)data;
-            const float* floatEnd = floatBegin + floatCount;
-
-            while (floatBegin < floatEnd) {
-                _pixel[_coordIndex] = *floatBegin;
-                floatBegin++;
-                _coordIndex++;
-                if (_coordIndex == 3) {
-                    uint32 packedRGB = _packFunc(_pixel);
-                    _coordIndex = 0;
-                    OutputHandler::writeData(&packedRGB, sizeof(packedRGB));
-                }
-            }
-            return true;
-        }
-        return false;
-    }
-
-    std::function<uint32(const glm::vec3&)> _packFunc;
-    glm::vec3 _pixel;
-    int _coordIndex{ 0 };
-};
-
 struct MyErrorHandler : public nvtt::ErrorHandler {
     virtual void error(nvtt::Error e) override {
         qCWarning(imagelogging) << "Texture compression error:" << nvtt::errorString(e);
@@ -522,117 +501,83 @@ public:
 
 void convertToFloatFromPacked(const unsigned char* source, int width, int height, size_t srcLineByteStride, gpu::Element sourceFormat,
                               glm::vec4* output, size_t outputLinePixelStride) {
-    glm::vec4* outputIt;
-    auto unpackFunc = getHDRUnpackingFunction(sourceFormat);
-
-    outputLinePixelStride -= width;
-    outputIt = output;
     for (auto lineNb = 0; lineNb < height; lineNb++) {
-        const uint32* srcPixelIt = reinterpret_cast<const uint32*>(source + lineNb * srcLineByteStride);
-        const uint32* srcPixelEnd = srcPixelIt + width;
-
-        while (srcPixelIt < srcPixelEnd) {
-            *outputIt = glm::vec4(unpackFunc(*srcPixelIt), 1.0f);
-            ++srcPixelIt;
-            ++outputIt;
-        }
-        outputIt += outputLinePixelStride;
+        unpackRow(source + lineNb * srcLineByteStride, width, sourceFormat, output + lineNb * outputLinePixelStride);
     }
 }
 
 void convertToPackedFromFloat(unsigned char* output, int width, int height, size_t outputLineByteStride, gpu::Element outputFormat,
                               const glm::vec4* source, size_t srcLinePixelStride) {
-    const glm::vec4* sourceIt;
-    auto packFunc = getHDRPackingFunction(outputFormat);
-
-    srcLinePixelStride -= width;
-    sourceIt = source;
     for (auto lineNb = 0; lineNb < height; lineNb++) {
-        uint32* outPixelIt = reinterpret_cast<uint32*>(output + lineNb * outputLineByteStride);
-        uint32* outPixelEnd = outPixelIt + width;
+        packRow(source + lineNb * srcLinePixelStride, width, outputFormat, output + lineNb * outputLineByteStride);
+    }
+}
 
-        while (outPixelIt < outPixelEnd) {
-            *outPixelIt = packFunc(*sourceIt);
-            ++outPixelIt;
-            ++sourceIt;
+static MipEncoding getMipEncoding(const gpu::Element& format) {
+    MipEncoding encoding;
+    encoding.isSRGB = !isLinearTextureFormat(format);
+    encoding.isNormalMap = format == gpu::Element::VEC2NU8_XY || format == gpu::Element::COLOR_COMPRESSED_BCX_XY;
+    encoding.isAlphaWeighted = format == gpu::Element::COLOR_COMPRESSED_BCX_SRGBA_MASK ||
+                               format == gpu::Element::COLOR_COMPRESSED_BCX_SRGBA ||
+                               format == gpu::Element::COLOR_COMPRESSED_BCX_SRGBA_HIGH;
+    return encoding;
+}
+
+// Uncompressed mips are packed straight from the filtered texels, without going through nvtt
+static void convertImageToPackedTexture(gpu::Texture* texture, Image&& image, int baseMipLevel, bool buildMips, const std::atomic<bool>& abortProcessing, int face) {
+    auto mipFormat = texture->getStoredMipFormat();
+    generateMips(std::move(image), getDefaultMipFilter(), getMipEncoding(mipFormat), buildMips ? 0 : 1, abortProcessing,
+                 [&](int level, const Image& mip) {
+        std::vector<gpu::Byte> data(gpu::Texture::evalLineSize(mip.getWidth(), mipFormat) * mip.getHeight());
+        packImage(mip, mipFormat, data.data());
+        if (face >= 0) {
+            texture->assignStoredMipFace(baseMipLevel + level, face, data.size(), data.data());
+        } else {
+            texture->assignStoredMip(baseMipLevel + level, data.size(), data.data());
         }
-        sourceIt += srcLinePixelStride;
-    }
+    });
 }
 
-nvtt::OutputHandler* getNVTTCompressionOutputHandler(gpu::Texture* outputTexture, int face, nvtt::CompressionOptions& compressionOptions) {
-    auto outputFormat = outputTexture->getStoredMipFormat();
-    bool useNVTT = false;
+void convertImageToHDRTexture(gpu::Texture* texture, Image&& image, BackendTarget target, int baseMipLevel, bool buildMips, const std::atomic<bool>& abortProcessing, int face) {
+    assert(image.hasFloatFormat());
+
+    auto mipFormat = texture->getStoredMipFormat();
+    if (isPackableFormat(mipFormat)) {
+        // Don't use NVTT (at least version 2.1) as it outputs wrong RGB9E5 and R11G11B10F values from floats
+        convertImageToPackedTexture(texture, std::move(image), baseMipLevel, buildMips, abortProcessing, face);
+        return;
+    }
 
+    nvtt::CompressionOptions compressionOptions;
     compressionOptions.setQuality(nvtt::Quality_Production);
-
-    if (outputFormat == gpu::Element::COLOR_COMPRESSED_BCX_HDR_RGB) {
-        useNVTT = true;
+    if (mipFormat == gpu::Element::COLOR_COMPRESSED_BCX_HDR_RGB) {
         compressionOptions.setFormat(nvtt::Format_BC6);
-    } else if (outputFormat == gpu::Element::COLOR_RGB9E5) {
-        compressionOptions.setFormat(nvtt::Format_RGB);
-        compressionOptions.setPixelType(nvtt::PixelType_Float);
-        compressionOptions.setPixelFormat(32, 32, 32, 0);
-    } else if (outputFormat == gpu::Element::COLOR_R11G11B10) {
-        compressionOptions.setFormat(nvtt::Format_RGB);
-        compressionOptions.setPixelType(nvtt::PixelType_Float);
-        compressionOptions.setPixelFormat(32, 32, 32, 0);
-    } else if (outputFormat == gpu::Element::COLOR_SRGBA_32) {
-        useNVTT = true;
-        compressionOptions.setFormat(nvtt::Format_RGB);
-        compressionOptions.setPixelType(nvtt::PixelType_UnsignedNorm);
-        compressionOptions.setPixelFormat(8, 8, 8, 0);
     } else {
         qCWarning(imagelogging) << "Unknown mip format";
         Q_UNREACHABLE();
-        return nullptr;
+        return;
     }
 
-    if (!useNVTT) {
-        // Don't use NVTT (at least version 2.1) as it outputs wrong RGB9E5 and R11G11B10F values from floats
-        return new PackedFloatOutputHandler(outputTexture, face, outputFormat);
-    } else {
-        return new OutputHandler(outputTexture, face);
-    }
-}
-
-void convertImageToHDRTexture(gpu::Texture* texture, Image&& image, BackendTarget target, int baseMipLevel, bool buildMips, const std::atomic<bool>& abortProcessing, int face) {
-    assert(image.hasFloatFormat());
-
-    Image localCopy = image.getConvertedToFormat(Image::Format_RGBAF);
-
-    const int width = localCopy.getWidth();
-    const int height = localCopy.getHeight();
-
     nvtt::OutputOptions outputOptions;
     outputOptions.setOutputHeader(false);
-
-    nvtt::CompressionOptions compressionOptions;
-    std::unique_ptr<nvtt::OutputHandler> outputHandler{ getNVTTCompressionOutputHandler(texture, face, compressionOptions) };
-
+    OutputHandler outputHandler(texture, face);
+    outputOptions.setOutputHandler(&outputHandler);
     MyErrorHandler errorHandler;
     outputOptions.setErrorHandler(&errorHandler);
-    nvtt::Context context;
-    int mipLevel = baseMipLevel;
-
-    outputOptions.setOutputHandler(outputHandler.get());
-
-    nvtt::Surface surface;
-    surface.setImage(nvtt::InputFormat_RGBA_32F, width, height, 1, localCopy.getBits());
-    surface.setAlphaMode(nvtt::AlphaMode_None);
-    surface.setWrapMode(nvtt::WrapMode_Mirror);
 
     SequentialTaskDispatcher dispatcher(abortProcessing);
-    nvtt::Compressor compressor;
+    nvtt::Context context;
     context.setTaskDispatcher(&dispatcher);
 
-    context.compress(surface, face, mipLevel++, compressionOptions, outputOptions);
-    if (buildMips) {
-        while (surface.canMakeNextMipmap() && !abortProcessing.load()) {
-            surface.buildNextMipmap(nvtt::MipmapFilter_Box);
-            context.compress(surface, face, mipLevel++, compressionOptions, outputOptions);
-        }
-    }
+    // nvtt only block compresses the mips, they are filtered beforehand
+    generateMips(std::move(image), getDefaultMipFilter(), getMipEncoding(mipFormat), buildMips ? 0 : 1, abortProcessing,
+                 [&](int level, const Image& mip) {
+        nvtt::Surface surface;
+        surface.setImage(nvtt::InputFormat_RGBA_32F, mip.getWidth(), mip.getHeight(), 1, mip.getBits());
+        surface.setAlphaMode(nvtt::AlphaMode_None);
+        surface.setWrapMode(nvtt::WrapMode_Mirror);
+        context.compress(surface, face, baseMipLevel + level, compressionOptions, outputOptions);
+    });
 }
 
 void convertImageToLDRTexture(gpu::Texture* texture, Image&& image, BackendTarget target, int baseMipLevel, bool buildMips, const std::atomic<bool>& abortProcessing, int face) {
@@ -642,39 +587,14 @@ void convertImageToLDRTexture(gpu::Texture* texture, Image&& image, BackendTarge
 
     const int width = localCopy.getWidth(), height = localCopy.getHeight();
     auto mipFormat = texture->getStoredMipFormat();
-    int mipLevel = baseMipLevel;
 
     if (target != BackendTarget::GLES32) {
-        if (localCopy.getFormat() != Image::Format_ARGB32) {
-            localCopy = localCopy.getConvertedToFormat(Image::Format_ARGB32);
+        if (isPackableFormat(mipFormat)) {
+            convertImageToPackedTexture(texture, std::move(localCopy), baseMipLevel, buildMips, abortProcessing, face);
+            return;
         }
 
-        const void* data = static_cast<const void*>(localCopy.getBits());
-        nvtt::TextureType textureType = nvtt::TextureType_2D;
-        nvtt::InputFormat inputFormat = nvtt::InputFormat_BGRA_8UB;
-        nvtt::WrapMode wrapMode = nvtt::WrapMode_Mirror;
-        nvtt::RoundMode roundMode = nvtt::RoundMode_None;
         nvtt::AlphaMode alphaMode = nvtt::AlphaMode_None;
-
-        float inputGamma = 2.2f;
-        float outputGamma = 2.2f;
-
-        nvtt::Surface surface;
-        surface.setImage(inputFormat, width, height, 1, data);
-        surface.setAlphaMode(alphaMode);
-        surface.setWrapMode(wrapMode);
-
-        // Surface copies the memory, so free up the memory afterward to avoid bloating the heap
-        data = nullptr;
-        localCopy = Image(); // Image doesn't have a clear function, so override it with an empty one.
-
-        nvtt::InputOptions inputOptions;
-        inputOptions.setTextureLayout(textureType, width, height);
-
-        inputOptions.setFormat(inputFormat);
-        inputOptions.setGamma(inputGamma, outputGamma);
-        inputOptions.setRoundMode(roundMode);
-
         nvtt::CompressionOptions compressionOptions;
         compressionOptions.setQuality(nvtt::Quality_Production);
 
@@ -695,57 +615,6 @@ void convertImageToLDRTexture(gpu::Texture* texture, Image&& image, BackendTarge
         } else if (mipFormat == gpu::Element::COLOR_COMPRESSED_BCX_SRGBA_HIGH) {
             alphaMode = nvtt::AlphaMode_Transparency;
             compressionOptions.setFormat(nvtt::Format_BC7);
-        } else if (mipFormat == gpu::Element::COLOR_RGBA_32) {
-            compressionOptions.setFormat(nvtt::Format_RGBA);
-            compressionOptions.setPixelType(nvtt::PixelType_UnsignedNorm);
-            compressionOptions.setPitchAlignment(4);
-            compressionOptions.setPixelFormat(32,
-                                              0x000000FF,
-                                              0x0000FF00,
-                                              0x00FF0000,
-                                              0xFF000000);
-            inputGamma = 1.0f;
-            outputGamma = 1.0f;
-        } else if (mipFormat == gpu::Element::COLOR_BGRA_32) {
-            compressionOptions.setFormat(nvtt::Format_RGBA);
-            compressionOptions.setPixelType(nvtt::PixelType_UnsignedNorm);
-            compressionOptions.setPitchAlignment(4);
-            compressionOptions.setPixelFormat(32,
-                                              0x00FF0000,
-                                              0x0000FF00,
-                                              0x000000FF,
-                                              0xFF000000);
-            inputGamma = 1.0f;
-            outputGamma = 1.0f;
-        } else if (mipFormat == gpu::Element::COLOR_SRGBA_32) {
-            compressionOptions.setFormat(nvtt::Format_RGBA);
-            compressionOptions.setPixelType(nvtt::PixelType_UnsignedNorm);
-            compressionOptions.setPitchAlignment(4);
-            compressionOptions.setPixelFormat(32,
-                                              0x000000FF,
-                                              0x0000FF00,
-                                              0x00FF0000,
-                                              0xFF000000);
-        } else if (mipFormat == gpu::Element::COLOR_SBGRA_32) {
-            compressionOptions.setFormat(nvtt::Format_RGBA);
-            compressionOptions.setPixelType(nvtt::PixelType_UnsignedNorm);
-            compressionOptions.setPitchAlignment(4);
-            compressionOptions.setPixelFormat(32,
-                                              0x00FF0000,
-                                              0x0000FF00,
-                                              0x000000FF,
-                                              0xFF000000);
-        } else if (mipFormat == gpu::Element::COLOR_R_8) {
-            compressionOptions.setFormat(nvtt::Format_RGB);
-            compressionOptions.setPixelType(nvtt::PixelType_UnsignedNorm);
-            compressionOptions.setPitchAlignment(4);
-            compressionOptions.setPixelFormat(8, 0, 0, 0);
-        } else if (mipFormat == gpu::Element::VEC2NU8_XY) {
-            inputOptions.setNormalMap(true);
-            compressionOptions.setFormat(nvtt::Format_RGBA);
-            compressionOptions.setPixelType(nvtt::PixelType_UnsignedNorm);
-            compressionOptions.setPitchAlignment(4);
-            compressionOptions.setPixelFormat(8, 8, 0, 0);
         } else {
             qCWarning(imagelogging) << "Unknown mip format";
             Q_UNREACHABLE();
@@ -759,16 +628,23 @@ void convertImageToLDRTexture(gpu::Texture* texture, Image&& image, BackendTarge
         MyErrorHandler errorHandler;
         outputOptions.setErrorHandler(&errorHandler);
 
-        SequentialTaskDispatcher dispatcher(abortProcessing);
         nvtt::Compressor context;
 
-        context.compress(surface, face, mipLevel++, compressionOptions, outputOptions);
-        if (buildMips) {
-            while (surface.canMakeNextMipmap() && !abortProcessing.load()) {
-                surface.buildNextMipmap(nvtt::MipmapFilter_Box);
-                context.compress(surface, face, mipLevel++, compressionOptions, outputOptions);
-            }
-        }
+        // nvtt only block compresses the mips, they are filtered in linear space beforehand and handed over as 8 bit BGRA
+        auto encoding = getMipEncoding(mipFormat);
+        const auto& packedFormat = encoding.isSRGB ? gpu::Element::COLOR_SBGRA_32 : gpu::Element::COLOR_BGRA_32;
+        generateMips(std::move(localCopy), getDefaultMipFilter(), encoding, buildMips ? 0 : 1, abortProcessing,
+                     [&](int level, const Image& mip) {
+            const int mipWidth = mip.getWidth(), mipHeight = mip.getHeight();
+            std::vector<gpu::Byte> texels(mipWidth * mipHeight * sizeof(uint32));
+            packImage(mip, packedFormat, texels.data(), mipWidth * sizeof(uint32));
+
+            nvtt::Surface surface;
+            surface.setImage(nvtt::InputFormat_BGRA_8UB, mipWidth, mipHeight, 1, texels.data());
+            surface.setAlphaMode(alphaMode);
+            surface.setWrapMode(nvtt::WrapMode_Mirror);
+            context.compress(surface, face, baseMipLevel + level, compressionOptions, outputOptions);
+        });
     } else {
         int numMips = 1;
     
@@ -1374,7 +1250,6 @@ const CubeLayout CubeLayout::CUBEMAP_LAYOUTS[] = {
 };
 const int CubeLayout::NUM_CUBEMAP_LAYOUTS = sizeof(CubeLayout::CUBEMAP_LAYOUTS) / sizeof(CubeLayout);
 
-//#define DEBUG_COLOR_PACKING
 Image convertToLDRFormat(Image&& srcImage, Image::Format format) {
     // Take a local copy to force move construction
     // https://github.com/isocpp/CppCoreGuidelines/blob/master/CppCoreGuidelines.md#f18-for-consume-parameters-pass-by-x-and-stdmove-the-parameter
@@ -1412,72 +1287,32 @@ Image convertToHDRFormat(Image&& srcImage, gpu::Element format) {
     // https://github.com/isocpp/CppCoreGuidelines/blob/master/CppCoreGuidelines.md#f18-for-consume-parameters-pass-by-x-and-stdmove-the-parameter
     Image localCopy = std::move(srcImage);
 
-    Image hdrImage(localCopy.getWidth(), localCopy.getHeight(), Image::Format_PACKED_FLOAT);
-    std::function<uint32(const glm::vec3&)> packFunc;
-#ifdef DEBUG_COLOR_PACKING
-    std::function<glm::vec3(uint32)> unpackFunc;
-#endif
+    if (format != gpu::Element::COLOR_R11G11B10 && format != gpu::Element::COLOR_RGB9E5) {
+        qCWarning(imagelogging) << "Unsupported HDR format";
+        Q_UNREACHABLE();
+        return localCopy;
+    }
 
-    switch (format.getSemantic()) {
-        case gpu::R11G11B10:
-            packFunc = packR11G11B10F;
-#ifdef DEBUG_COLOR_PACKING
-            unpackFunc = glm::unpackF2x11_1x10;
-#endif
-            break;
-        case gpu::RGB9E5:
-            packFunc = glm::packF3x9_E1x5;
-#ifdef DEBUG_COLOR_PACKING
-            unpackFunc = glm::unpackF3x9_E1x5;
-#endif
-            break;
-        default:
-            qCWarning(imagelogging) << "Unsupported HDR format";
-            Q_UNREACHABLE();
-            return localCopy;
+    // Normalize and apply gamma
+    std::array<float, 256> linearValues;
+    for (size_t i = 0; i < linearValues.size(); i++) {
+        linearValues[i] = std::pow((float)i / 255.0f, 2.2f);
     }
 
     localCopy = localCopy.getConvertedToFormat(Image::Format_ARGB32);
+    Image hdrImage(localCopy.getWidth(), localCopy.getHeight(), Image::Format_PACKED_FLOAT);
+    std::vector<glm::vec4> line(localCopy.getWidth());
     for (glm::uint32 y = 0; y < localCopy.getHeight(); y++) {
         const QRgb* srcLineIt = reinterpret_cast<const QRgb*>( localCopy.getScanLine(y) );
-        const QRgb* srcLineEnd = srcLineIt + localCopy.getWidth();
-        uint32* hdrLineIt = reinterpret_cast<uint32*>( hdrImage.editScanLine(y) );
-        glm::vec3 color;
-
-        while (srcLineIt < srcLineEnd) {
-            color.r = qRed(*srcLineIt);
-            color.g = qGreen(*srcLineIt);
-            color.b = qBlue(*srcLineIt);
-            // Normalize and apply gamma
-            color /= 255.0f;
-            color.r = std::pow(color.r, 2.2f);
-            color.g = std::pow(color.g, 2.2f);
-            color.b = std::pow(color.b, 2.2f);
-            *hdrLineIt = packFunc(color);
-#ifdef DEBUG_COLOR_PACKING
-            glm::vec3 ucolor = unpackFunc(*hdrLineIt);
-            assert(glm::distance(color, ucolor) <= 5e-2);
-#endif
+        for (auto& color : line) {
+            color = glm::vec4(linearValues[qRed(*srcLineIt)], linearValues[qGreen(*srcLineIt)], linearValues[qBlue(*srcLineIt)], 1.0f);
             ++srcLineIt;
-            ++hdrLineIt;
         }
+        packRow(line.data(), (int)line.size(), format, hdrImage.editScanLine(y));
     }
     return hdrImage;
 }
 
-static bool isLinearTextureFormat(gpu::Element format) {
-    return !((format == gpu::Element::COLOR_SRGBA_32)
-        || (format == gpu::Element::COLOR_SBGRA_32)
-        || (format == gpu::Element::COLOR_SR_8)
-        || (format == gpu::Element::COLOR_COMPRESSED_BCX_SRGB)
-        || (format == gpu::Element::COLOR_COMPRESSED_BCX_SRGBA_MASK)
-        || (format == gpu::Element::COLOR_COMPRESSED_BCX_SRGBA)
-        || (format == gpu::Element::COLOR_COMPRESSED_BCX_SRGBA_HIGH)
-        || (format == gpu::Element::COLOR_COMPRESSED_ETC2_SRGB)
-        || (format == gpu::Element::COLOR_COMPRESSED_ETC2_SRGBA)
-        || (format == gpu::Element::COLOR_COMPRESSED_ETC2_SRGB_PUNCHTHROUGH_ALPHA));
-}
-
 void convolveForGGX(const std::vector<Image>& faces, gpu::Texture* texture, BackendTarget target, const std::atomic<bool>& abortProcessing = false) {
     PROFILE_RANGE(resource_parse, "convolveForGGX");
     CubeMap source(faces, texture->getNumMips(), abortProcessing);
@@ -24,7 +24,10 @@ const int KTXCache::INVALID_VERSION = 0x00;
 const char* KTXCache::SETTING_VERSION_NAME = "hifi.ktx.cache_version";
 
 KTXCache::KTXCache(const std::string& dir, const std::string& ext) :
-    FileCache(dir, ext) { }
+    FileCache(dir, ext) {
+    // textures used in every session are kept over one-off downloads
+    setEvictionPolicy(std::make_unique<cache::TinyLFUEvictionPolicy>());
+}
 
 void KTXCache::initialize() {
     FileCache::initialize();
@@ -823,10 +823,10 @@ void NetworkTexture::ktxMipRequestFinished() {
             auto data = _ktxMipRequest->getData();
             auto mipLevel = _ktxMipLevelRangeInFlight.first;
             auto texture = _textureSource->getGPUTexture();
-            DependencyManager::get<StatTracker>()->incrementStat("PendingProcessing");
+            STAT_COUNTER("PendingProcessing").increment();
             QtConcurrent::run(QThreadPool::globalInstance(), [self, data, mipLevel, url, texture] {
                 PROFILE_RANGE_EX(resource_parse_image, "NetworkTexture - Processing Mip Data", 0xffff0000, 0, { { "url", url.toString() } });
-                DependencyManager::get<StatTracker>()->decrementStat("PendingProcessing");
+                STAT_COUNTER("PendingProcessing").decrement();
                 CounterStat counter("Processing");
 
                 auto originalPriority = QThread::currentThread()->priority();
@@ -891,10 +891,10 @@ void NetworkTexture::handleFinishedInitialLoad() {
 
     auto self = _self;
     auto url = _url;
-    DependencyManager::get<StatTracker>()->incrementStat("PendingProcessing");
+    STAT_COUNTER("PendingProcessing").increment();
     QtConcurrent::run(QThreadPool::globalInstance(), [self, ktxHeaderData, ktxHighMipData, url] {
         PROFILE_RANGE_EX(resource_parse_image, "NetworkTexture - Processing Initial Data", 0xffff0000, 0, { { "url", url.toString() } });
-        DependencyManager::get<StatTracker>()->decrementStat("PendingProcessing");
+        STAT_COUNTER("PendingProcessing").decrement();
         CounterStat counter("Processing");
 
         auto originalPriority = QThread::currentThread()->priority();
@@ -1160,7 +1160,7 @@ ImageReader::ImageReader(const QWeakPointer<Resource>& resource, const QUrl& url
     _maxNumPixels(maxNumPixels),
     _sourceChannel(sourceChannel)
 {
-    DependencyManager::get<StatTracker>()->incrementStat("PendingProcessing");
+    STAT_COUNTER("PendingProcessing").increment();
     listSupportedImageFormats();
 
 #if DEBUG_DUMP_TEXTURE_LOADS
@@ -1193,7 +1193,7 @@ void ImageReader::listSupportedImageFormats() {
 
 void ImageReader::run() {
     PROFILE_RANGE_EX(resource_parse_image, __FUNCTION__, 0xffff0000, 0, { { "url", _url.toString() } });
-    DependencyManager::get<StatTracker>()->decrementStat("PendingProcessing");
+    STAT_COUNTER("PendingProcessing").decrement();
     CounterStat counter("Processing");
 
     auto originalPriority = QThread::currentThread()->priority();
@@ -10,6 +10,7 @@
 //
 
 #include <hfm/HFM.h>
+#include <TBBHelpers.h>
 
 #include "BakerTypes.h"
 
@@ -36,6 +37,22 @@ namespace baker {
         }
     }
 
+    // Calls function(i) for each i in [0, count), spread across the worker threads.
+    // function must only write to the outputs at index i, so that results don't depend on the scheduling.
+    template<typename F>
+    void parallelFor(size_t count, F function) {
+        if (count == 1) {
+            function((size_t)0);
+            return;
+        }
+        // one mesh per task, meshes of a model vary too much in size for coarser grains to balance
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, count, 1), [&](const tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i < range.end(); ++i) {
+                function(i);
+            }
+        });
+    }
+
     // Returns a reference to the normal at the specified index, or nullptr if it cannot be accessed
     using NormalAccessor = std::function<glm::vec3*(int index)>;
 
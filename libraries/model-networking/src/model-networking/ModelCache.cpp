@@ -91,7 +91,7 @@ public:
                    const QByteArray& data, bool combineParts, const QString& webMediaType) :
         _modelLoader(modelLoader), _resource(resource), _url(url), _mapping(mapping), _data(data), _combineParts(combineParts), _webMediaType(webMediaType) {
 
-        DependencyManager::get<StatTracker>()->incrementStat("PendingProcessing");
+        STAT_COUNTER("PendingProcessing").increment();
     }
 
     virtual void run() override;
@@ -107,7 +107,7 @@ private:
 };
 
 void GeometryReader::run() {
-    DependencyManager::get<StatTracker>()->decrementStat("PendingProcessing");
+    STAT_COUNTER("PendingProcessing").decrement();
     CounterStat counter("Processing");
     PROFILE_RANGE_EX(resource_parse_geometry, "GeometryReader::run", 0xFF00FF00, 0, { { "url", _url.toString() } });
     auto originalPriority = QThread::currentThread()->priority();
@@ -54,7 +54,7 @@ bool AssetResourceRequest::urlIsAssetHash(const QUrl& url) {
 }
 
 void AssetResourceRequest::doSend() {
-    DependencyManager::get<StatTracker>()->incrementStat(STAT_ATP_REQUEST_STARTED);
+    STAT_COUNTER(STAT_ATP_REQUEST_STARTED).increment();
 
     // We'll either have a hash or an ATP path to a file (that maps to a hash)
     if (urlIsAssetHash(_url)) {
@@ -73,16 +73,13 @@ void AssetResourceRequest::doSend() {
 }
 
 void AssetResourceRequest::requestMappingForPath(const AssetUtils::AssetPath& path) {
-    auto statTracker = DependencyManager::get<StatTracker>();
-    statTracker->incrementStat(STAT_ATP_MAPPING_REQUEST_STARTED);
+    STAT_COUNTER(STAT_ATP_MAPPING_REQUEST_STARTED).increment();
 
     auto assetClient = DependencyManager::get<AssetClient>();
     _assetMappingRequest = assetClient->createGetMappingRequest(path);
 
     // make sure we'll hear about the result of the get mapping request
     connect(_assetMappingRequest, &GetMappingRequest::finished, this, [this, path](GetMappingRequest* request){
-        auto statTracker = DependencyManager::get<StatTracker>();
-        
         Q_ASSERT(_state == InProgress);
         Q_ASSERT(request == _assetMappingRequest);
 
@@ -93,7 +90,7 @@ void AssetResourceRequest::requestMappingForPath(const AssetUtils::AssetPath& pa
                 // we have no error, we should have a resulting hash - use that to send of a request for that asset
                 qCDebug(networking) << "Got mapping for:" << path << "=>" << request->getHash();
 
-                statTracker->incrementStat(STAT_ATP_MAPPING_REQUEST_SUCCESS);
+                STAT_COUNTER(STAT_ATP_MAPPING_REQUEST_SUCCESS).increment();
 
                 // if we got a redirected path we need to store that with the resource request as relative path URL
                 if (request->wasRedirected()) {
@@ -133,8 +130,8 @@ void AssetResourceRequest::requestMappingForPath(const AssetUtils::AssetPath& pa
             _state = Finished;
             emit finished();
 
-            statTracker->incrementStat(STAT_ATP_MAPPING_REQUEST_FAILED);
-            statTracker->incrementStat(STAT_ATP_REQUEST_FAILED);
+            STAT_COUNTER(STAT_ATP_MAPPING_REQUEST_FAILED).increment();
+            STAT_COUNTER(STAT_ATP_REQUEST_FAILED).increment();
         }
 
         _assetMappingRequest->deleteLater();
@@ -175,8 +172,6 @@ void AssetResourceRequest::requestHash(const AssetUtils::AssetHash& hash) {
                 break;
         }
 
-        auto statTracker = DependencyManager::get<StatTracker>();
-
         if (_assetRequest->loadedFromCache()) {
             _loadedFromCache = true;
         }
@@ -185,13 +180,13 @@ void AssetResourceRequest::requestHash(const AssetUtils::AssetHash& hash) {
         emit finished();
 
         if (_result == Success) {
-            statTracker->incrementStat(STAT_ATP_REQUEST_SUCCESS);
+            STAT_COUNTER(STAT_ATP_REQUEST_SUCCESS).increment();
 
             if (loadedFromCache()) {
-                statTracker->incrementStat(STAT_ATP_REQUEST_CACHE);
+                STAT_COUNTER(STAT_ATP_REQUEST_CACHE).increment();
             }
         } else {
-            statTracker->incrementStat(STAT_ATP_REQUEST_FAILED);
+            STAT_COUNTER(STAT_ATP_REQUEST_FAILED).increment();
         }
 
         _assetRequest->deleteLater();
@@ -24,8 +24,7 @@
 #include "NetworkingConstants.h"
 
 void FileResourceRequest::doSend() {
-    auto statTracker = DependencyManager::get<StatTracker>();
-    statTracker->incrementStat(STAT_FILE_REQUEST_STARTED);
+    STAT_COUNTER(STAT_FILE_REQUEST_STARTED).increment();
     int fileSize = 0;
     QString filename;
     if (_url.scheme() == URL_SCHEME_QRC) {
@@ -87,9 +86,9 @@ void FileResourceRequest::doSend() {
     emit finished();
 
     if (_result == ResourceRequest::Success) {
-        statTracker->incrementStat(STAT_FILE_REQUEST_SUCCESS);
-        statTracker->updateStat(STAT_FILE_RESOURCE_TOTAL_BYTES, fileSize);
+        STAT_COUNTER(STAT_FILE_REQUEST_SUCCESS).increment();
+        STAT_COUNTER(STAT_FILE_RESOURCE_TOTAL_BYTES).add(fileSize);
     } else {
-        statTracker->incrementStat(STAT_FILE_REQUEST_FAILED);
+        STAT_COUNTER(STAT_FILE_REQUEST_FAILED).increment();
     }
 }
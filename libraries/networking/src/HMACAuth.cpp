@@ -19,57 +19,107 @@
 #include <cassert>
 
 #if OPENSSL_VERSION_NUMBER >= 0x10100000
-HMACAuth::HMACAuth(AuthMethod authMethod)
-    : _hmacContext(HMAC_CTX_new())
-    , _authMethod(authMethod) { }
+static HMAC_CTX* newHMACContext() {
+    return HMAC_CTX_new();
+}
 
-HMACAuth::~HMACAuth()
-{
-    HMAC_CTX_free(_hmacContext);
+static void freeHMACContext(HMAC_CTX* context) {
+    HMAC_CTX_free(context);
+}
+
+static bool copyHMACContext(HMAC_CTX* destination, HMAC_CTX* source) {
+    // HMAC_CTX_copy() resets destination itself
+    return HMAC_CTX_copy(destination, source);
 }
 
 #else
 
-HMACAuth::HMACAuth(AuthMethod authMethod)
-    : _hmacContext(new HMAC_CTX())
-    , _authMethod(authMethod) {
-    HMAC_CTX_init(_hmacContext);
+static HMAC_CTX* newHMACContext() {
+    auto context = new HMAC_CTX();
+    HMAC_CTX_init(context);
+    return context;
 }
 
-HMACAuth::~HMACAuth() {
-    HMAC_CTX_cleanup(_hmacContext);
-    delete _hmacContext;
+static void freeHMACContext(HMAC_CTX* context) {
+    HMAC_CTX_cleanup(context);
+    delete context;
+}
+
+static bool copyHMACContext(HMAC_CTX* destination, HMAC_CTX* source) {
+    // before 1.1 HMAC_CTX_copy() overwrites destination without freeing what it held: release that first
+    HMAC_CTX_cleanup(destination);
+    HMAC_CTX_init(destination);
+    return HMAC_CTX_copy(destination, source);
 }
 #endif
 
-bool HMACAuth::setKey(const char* keyValue, int keyLen) {
-    const EVP_MD* sslStruct = nullptr;
+static_assert(HMACAuth::MAX_HASH_SIZE >= EVP_MAX_MD_SIZE, "HMACAuth::MAX_HASH_SIZE is too small");
+
+struct HMACAuth::Key {
+    Key() : context(newHMACContext()) { }
+    ~Key() { freeHMACContext(context); }
 
-    switch (_authMethod) {
-    case MD5:
-        sslStruct = EVP_md5();
-        break;
+    Key(const Key&) = delete;
+    Key& operator=(const Key&) = delete;
 
-    case SHA1:
-        sslStruct = EVP_sha1();
-        break;
+    HMAC_CTX* context;
+};
 
-    case SHA224:
-        sslStruct = EVP_sha224();
-        break;
+// The context each thread hashes with: a copy of the keyed context of whichever HMACAuth it is hashing for.
+// Copying skips the key setup and nothing is shared between threads but the (read only) keyed context.
+static HMAC_CTX* threadHMACContext() {
+    struct ThreadContext {
+        ThreadContext() : context(newHMACContext()) { }
+        ~ThreadContext() { freeHMACContext(context); }
+        HMAC_CTX* context;
+    };
 
-    case SHA256:
-        sslStruct = EVP_sha256();
-        break;
+    thread_local ThreadContext threadContext;
+    return threadContext.context;
+}
+
+static const EVP_MD* evpForAuthMethod(HMACAuth::AuthMethod authMethod) {
+    switch (authMethod) {
+    case HMACAuth::MD5:
+        return EVP_md5();
+
+    case HMACAuth::SHA1:
+        return EVP_sha1();
 
-    case RIPEMD160:
-        sslStruct = EVP_ripemd160();
-        break;
+    case HMACAuth::SHA224:
+        return EVP_sha224();
+
+    case HMACAuth::SHA256:
+        return EVP_sha256();
+
+    case HMACAuth::RIPEMD160:
+        return EVP_ripemd160();
 
     default:
+        return nullptr;
+    }
+}
+
+HMACAuth::HMACAuth(AuthMethod authMethod)
+    : _hmacContext(newHMACContext())
+    , _authMethod(authMethod) { }
+
+HMACAuth::~HMACAuth() {
+    freeHMACContext(_hmacContext);
+}
+
+bool HMACAuth::setKey(const char* keyValue, int keyLen) {
+    const EVP_MD* sslStruct = evpForAuthMethod(_authMethod);
+    if (!sslStruct) {
         return false;
     }
 
+    auto key = std::make_shared<Key>();
+    if (!HMAC_Init_ex(key->context, keyValue, keyLen, sslStruct, nullptr)) {
+        return false;
+    }
+    std::atomic_store(&_key, std::shared_ptr<const Key>(std::move(key)));
+
     QMutexLocker lock(&_lock);
     return (bool) HMAC_Init_ex(_hmacContext, keyValue, keyLen, sslStruct, nullptr);
 }
@@ -79,6 +129,11 @@ bool HMACAuth::setKey(const QUuid& uidKey) {
     return setKey(rfcBytes.constData(), rfcBytes.length());
 }
 
+int HMACAuth::getHashSize() const {
+    const EVP_MD* sslStruct = evpForAuthMethod(_authMethod);
+    return sslStruct ? EVP_MD_size(sslStruct) : 0;
+}
+
 bool HMACAuth::addData(const char* data, int dataLen) {
     QMutexLocker lock(&_lock);
     return (bool) HMAC_Update(_hmacContext, reinterpret_cast<const unsigned char*>(data), dataLen);
@@ -104,14 +159,42 @@ HMACAuth::HMACHash HMACAuth::result() {
     return hashValue;
 }
 
-bool HMACAuth::calculateHash(HMACHash& hashResult, const char* data, int dataLen) {
-    QMutexLocker lock(&_lock);
-    if (!addData(data, dataLen)) {
-        qCWarning(networking) << "Error occured calling HMACAuth::addData()";
-        assert(false);
+int HMACAuth::calculateHash(unsigned char* hashResult, const char* data, int dataLen) const {
+    return calculateHashes(hashResult, &data, &dataLen, 1) ? getHashSize() : 0;
+}
+
+bool HMACAuth::calculateHashes(unsigned char* hashResults, const char* const* data, const int* dataLens, int count) const {
+    auto key = std::atomic_load(&_key);
+    if (!key) {
+        qCWarning(networking) << "HMACAuth::calculateHashes() called before setKey()";
+        return false;
+    }
+
+    auto context = threadHMACContext();
+    const int hashSize = getHashSize();
+    unsigned int hashLen;
+
+    for (int i = 0; i < count; ++i) {
+        if (!copyHMACContext(context, key->context)
+            || !HMAC_Update(context, reinterpret_cast<const unsigned char*>(data[i]), dataLens[i])
+            || !HMAC_Final(context, hashResults + i * hashSize, &hashLen)) {
+            qCWarning(networking) << "Error occured calculating HMAC";
+            assert(false);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool HMACAuth::calculateHash(HMACHash& hashResult, const char* data, int dataLen) const {
+    hashResult.resize(MAX_HASH_SIZE);
+
+    int hashSize = calculateHash(hashResult.data(), data, dataLen);
+    if (!hashSize) {
+        qCWarning(networking) << "Error occured calling HMACAuth::calculateHash()";
         return false;
     }
 
-    hashResult = result();
+    hashResult.resize(hashSize);
     return true;
 }
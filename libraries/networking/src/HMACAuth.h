@@ -22,14 +22,26 @@ class HMACAuth {
 public:
     enum AuthMethod { MD5, SHA1, SHA224, SHA256, RIPEMD160 };
     using HMACHash = std::vector<unsigned char>;
+
+    static const int MAX_HASH_SIZE = 64;
     
     explicit HMACAuth(AuthMethod authMethod = MD5);
     ~HMACAuth();
 
     bool setKey(const char* keyValue, int keyLen);
     bool setKey(const QUuid& uidKey);
+
     // Calculate complete hash in one.
-    bool calculateHash(HMACHash& hashResult, const char* data, int dataLen);
+    // These don't lock: any number of threads can hash with the same key at once, each on its own context.
+    bool calculateHash(HMACHash& hashResult, const char* data, int dataLen) const;
+    // Same without allocating, hashResult must have room for MAX_HASH_SIZE bytes.
+    // Returns the size of the hash, 0 on error.
+    int calculateHash(unsigned char* hashResult, const char* data, int dataLen) const;
+    // Hash count buffers with the current key, e.g. a burst of packets from the same node.
+    // hashResults receives count hashes of getHashSize() bytes each.
+    bool calculateHashes(unsigned char* hashResults, const char* const* data, const int* dataLens, int count) const;
+
+    int getHashSize() const;
 
     // Append to data to be hashed.
     bool addData(const char* data, int dataLen);
@@ -39,9 +51,14 @@ public:
     HMACHash result();
 
 private:
+    struct Key;
+
     QMutex _lock { QMutex::Recursive };
     struct hmac_ctx_st* _hmacContext;
     AuthMethod _authMethod;
+
+    // keyed context that is only ever copied from, replaced as a whole by setKey()
+    std::shared_ptr<const Key> _key;
 };
 
 #endif  // hifi_HMACAuth_h
@@ -50,7 +50,7 @@ void HTTPResourceRequest::cleanupTimer() {
 }
 
 void HTTPResourceRequest::doSend() {
-    DependencyManager::get<StatTracker>()->incrementStat(STAT_HTTP_REQUEST_STARTED);
+    STAT_COUNTER(STAT_HTTP_REQUEST_STARTED).increment();
 
     QNetworkRequest networkRequest(_url);
     networkRequest.setAttribute(QNetworkRequest::FollowRedirectsAttribute, true);
@@ -203,15 +203,14 @@ void HTTPResourceRequest::onRequestFinished() {
     _state = Finished;
     emit finished();
 
-    auto statTracker = DependencyManager::get<StatTracker>();
     if (_result == Success) {
-        statTracker->incrementStat(STAT_HTTP_REQUEST_SUCCESS);
+        STAT_COUNTER(STAT_HTTP_REQUEST_SUCCESS).increment();
 
         if (loadedFromCache()) {
-            statTracker->incrementStat(STAT_HTTP_REQUEST_CACHE);
+            STAT_COUNTER(STAT_HTTP_REQUEST_CACHE).increment();
         }
     } else {
-        statTracker->incrementStat(STAT_HTTP_REQUEST_FAILED);
+        STAT_COUNTER(STAT_HTTP_REQUEST_FAILED).increment();
     }
 }
 
@@ -240,5 +239,5 @@ void HTTPResourceRequest::onTimeout() {
     _state = Finished;
     emit finished();
 
-    DependencyManager::get<StatTracker>()->incrementStat(STAT_HTTP_REQUEST_FAILED);
+    STAT_COUNTER(STAT_HTTP_REQUEST_FAILED).increment();
 }
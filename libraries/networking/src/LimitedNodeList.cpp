@@ -11,9 +11,11 @@
 
 #include "LimitedNodeList.h"
 
+#include <algorithm>
 #include <cstring>
 #include <cstdlib>
 #include <cstdio>
+#include <thread>
 
 #include <QtCore/QDataStream>
 #include <QtCore/QDebug>
@@ -341,18 +343,19 @@ bool LimitedNodeList::packetSourceAndHashMatchAndTrackBandwidth(const udt::Packe
 
             if (verifiedPacket && verificationEnabled) {
 
-                QByteArray packetHeaderHash = NLPacket::verificationHashInHeader(packet);
-                QByteArray expectedHash;
                 auto sourceNodeHMACAuth = sourceNode->getAuthenticateHash();
-                if (sourceNode->getAuthenticateHash()) {
-                    expectedHash = NLPacket::hashForPacketAndHMAC(packet, *sourceNodeHMACAuth);
-                }
 
                 // check if the HMAC-md5 hash in the header matches the hash we would expect
-                if (!sourceNodeHMACAuth || packetHeaderHash != expectedHash) {
+                if (!sourceNodeHMACAuth || !NLPacket::hashMatchesForPacket(packet, *sourceNodeHMACAuth)) {
                     static QMultiMap<QUuid, PacketType> hashDebugSuppressMap;
 
                     if (!hashDebugSuppressMap.contains(sourceID, headerType)) {
+                        QByteArray packetHeaderHash = NLPacket::verificationHashInHeader(packet);
+                        QByteArray expectedHash;
+                        if (sourceNodeHMACAuth) {
+                            expectedHash = NLPacket::hashForPacketAndHMAC(packet, *sourceNodeHMACAuth);
+                        }
+
                         qCDebug(networking) << "Packet hash mismatch on" << headerType << "- Sender" << sourceID;
                         qCDebug(networking) << "Packet len:" << packet.getDataSize() << "Expected hash:" <<
                             expectedHash.toHex() << "Actual:" << packetHeaderHash.toHex();
@@ -571,37 +574,85 @@ NodeData* LimitedNodeList::getOrCreateLinkedData(SharedNodePointer node) {
 }
 
 SharedNodePointer LimitedNodeList::nodeWithUUID(const QUuid& nodeUUID) {
-    QReadLocker readLocker(&_nodeMutex);
+    auto snapshot = getNodeSnapshot();
 
-    NodeHash::const_iterator it = _nodeHash.find(nodeUUID);
-    return it == _nodeHash.cend() ? SharedNodePointer() : it->second;
+    auto it = snapshot->nodesByUUID.find(nodeUUID);
+    return it == snapshot->nodesByUUID.cend() ? SharedNodePointer() : it->second;
  }
 
 SharedNodePointer LimitedNodeList::nodeWithLocalID(Node::LocalID localID) const {
-    QReadLocker readLocker(&_nodeMutex);
+    auto snapshot = getNodeSnapshot();
+
+    auto it = snapshot->nodesByLocalID.find(localID);
+    return it == snapshot->nodesByLocalID.end() ? nullptr : it->second;
+}
+
+LimitedNodeList::NodeSnapshot::Pointer LimitedNodeList::getNodeSnapshot() const {
+    while (true) {
+        int index = _currentSnapshotSlot.load();
+        SnapshotSlot& slot = _snapshotSlots[index];
+        ++slot.numReaders;
+        if (_currentSnapshotSlot.load() == index) {
+            // pinned while current: the writer won't refill this slot until we let go of it
+            NodeSnapshot::Pointer snapshot = slot.snapshot;
+            --slot.numReaders;
+            return snapshot;
+        }
+        // a newer snapshot was published meanwhile, this slot may be about to be refilled
+        --slot.numReaders;
+    }
+}
 
-    LocalIDMapping::const_iterator idIter = _localIDMap.find(localID);
-    return idIter == _localIDMap.cend() ? nullptr : idIter->second;
+void LimitedNodeList::publishNodes(std::vector<SharedNodePointer> nodes) {
+    auto snapshot = std::make_shared<NodeSnapshot>();
+
+    snapshot->nodesByUUID.reserve(nodes.size());
+    snapshot->nodesByLocalID.reserve(nodes.size());
+    for (const auto& node : nodes) {
+        snapshot->nodesByUUID.insert({ node->getUUID(), node });
+        // like the map this replaces, the first node keeps a local ID that is (briefly) shared
+        snapshot->nodesByLocalID.insert({ node->getLocalID(), node });
+    }
+
+    snapshot->nodes = std::move(nodes);
+
+    // readers that saw this slot as current before the last publish only hold it for as long as they take to notice
+    int index = (_currentSnapshotSlot.load() + 1) % NUM_SNAPSHOT_SLOTS;
+    SnapshotSlot& slot = _snapshotSlots[index];
+    while (slot.numReaders.load() != 0) {
+        std::this_thread::yield();
+    }
+    slot.snapshot = std::move(snapshot);
+    _currentSnapshotSlot.store(index);
+}
+
+bool LimitedNodeList::eraseNode(const SharedNodePointer& node) {
+    std::lock_guard<std::mutex> writeLocker(_nodeWriteMutex);
+
+    auto nodes = getNodeSnapshot()->nodes;
+    auto it = std::find(nodes.begin(), nodes.end(), node);
+    if (it == nodes.end()) {
+        return false;
+    }
+
+    nodes.erase(it);
+    publishNodes(std::move(nodes));
+    return true;
 }
 
 void LimitedNodeList::eraseAllNodes(QString reason) {
     std::vector<SharedNodePointer> killedNodes;
 
     {
-        // iterate the current nodes - grab them so we can emit that they are dying
-        // and then remove them from the hash
-        QWriteLocker writeLocker(&_nodeMutex);
+        // grab the current nodes so we can emit that they are dying
+        // and then publish an empty snapshot
+        std::lock_guard<std::mutex> writeLocker(_nodeWriteMutex);
 
-        if (_nodeHash.size() > 0) {
+        killedNodes = getNodeSnapshot()->nodes;
+        if (killedNodes.size() > 0) {
             qCDebug(networking) << "LimitedNodeList::eraseAllNodes() removing all nodes from NodeList:" << reason;
-
-            killedNodes.reserve(_nodeHash.size());
-            for (auto& pair : _nodeHash) {
-                killedNodes.push_back(pair.second);
-            }
         }
-        _localIDMap.clear();
-        _nodeHash.clear();
+        publishNodes({});
     }
 
     foreach(const SharedNodePointer& killedNode, killedNodes) {
@@ -622,13 +673,7 @@ void LimitedNodeList::reset(QString reason) {
 bool LimitedNodeList::killNodeWithUUID(const QUuid& nodeUUID, ConnectionID newConnectionID) {
     auto matchingNode = nodeWithUUID(nodeUUID);
 
-    if (matchingNode) {
-        {
-            QWriteLocker writeLocker(&_nodeMutex);
-            _localIDMap.unsafe_erase(matchingNode->getLocalID());
-            _nodeHash.unsafe_erase(matchingNode->getUUID());
-        }
-
+    if (matchingNode && eraseNode(matchingNode)) {
         handleNodeKill(matchingNode, newConnectionID);
         return true;
     }
@@ -668,26 +713,31 @@ SharedNodePointer LimitedNodeList::addOrUpdateNode(const QUuid& uuid, NodeType_t
                                                    const HifiSockAddr& publicSocket, const HifiSockAddr& localSocket,
                                                    Node::LocalID localID, bool isReplicated, bool isUpstream,
                                                    const QUuid& connectionSecret, const NodePermissions& permissions) {
+    // returns true if the local ID changed: the caller sets it and re-publishes the nodes with _nodeWriteMutex held
+    // so that nodeWithLocalID() finds the node under its new ID
+    auto updateNode = [&](const SharedNodePointer& node) {
+        node->setPublicSocket(publicSocket);
+        node->setLocalSocket(localSocket);
+        node->setPermissions(permissions);
+        node->setConnectionSecret(connectionSecret);
+        node->setIsReplicated(isReplicated);
+        node->setIsUpstream(isUpstream || NodeType::isUpstream(nodeType));
+        return node->getLocalID() != localID;
+    };
+
     auto matchingNode = nodeWithUUID(uuid);
     if (matchingNode) {
-        matchingNode->setPublicSocket(publicSocket);
-        matchingNode->setLocalSocket(localSocket);
-        matchingNode->setPermissions(permissions);
-        matchingNode->setConnectionSecret(connectionSecret);
-        matchingNode->setIsReplicated(isReplicated);
-        matchingNode->setIsUpstream(isUpstream || NodeType::isUpstream(nodeType));
-        matchingNode->setLocalID(localID);
+        if (updateNode(matchingNode)) {
+            std::lock_guard<std::mutex> writeLocker(_nodeWriteMutex);
+            matchingNode->setLocalID(localID);
+            publishNodes(getNodeSnapshot()->nodes);
+        }
 
         return matchingNode;
     }
 
     auto removeOldNode = [&](auto node) {
-        if (node) {
-            {
-                QWriteLocker writeLocker(&_nodeMutex);
-                _localIDMap.unsafe_erase(node->getLocalID());
-                _nodeHash.unsafe_erase(node->getUUID());
-            }
+        if (node && eraseNode(node)) {
             handleNodeKill(node);
         }
     };
@@ -727,10 +777,24 @@ SharedNodePointer LimitedNodeList::addOrUpdateNode(const QUuid& uuid, NodeType_t
 
 
     {
-        QReadLocker readLocker(&_nodeMutex);
-        // insert the new node and release our read lock
-        _nodeHash.insert({ newNode->getUUID(), newNodePointer });
-        _localIDMap.insert({ localID, newNodePointer });
+        std::lock_guard<std::mutex> writeLocker(_nodeWriteMutex);
+        auto snapshot = getNodeSnapshot();
+
+        // the lookup above didn't hold the lock, another thread may have added the node since
+        auto existingNode = snapshot->nodesByUUID.find(uuid);
+        if (existingNode != snapshot->nodesByUUID.end()) {
+            matchingNode = existingNode->second;
+            if (updateNode(matchingNode)) {
+                matchingNode->setLocalID(localID);
+                publishNodes(snapshot->nodes);
+            }
+            return matchingNode;
+        }
+
+        // publish a snapshot with the new node
+        auto nodes = snapshot->nodes;
+        nodes.push_back(newNodePointer);
+        publishNodes(std::move(nodes));
     }
 
     qCDebug(networking) << "Added" << *newNode;
@@ -888,24 +952,28 @@ void LimitedNodeList::removeSilentNodes() {
 
     auto startedAt = usecTimestampNow();
 
-    eachNodeHashIterator([&](NodeHash::iterator& it){
-        SharedNodePointer node = it->second;
-        node->getMutex().lock();
+    {
+        std::lock_guard<std::mutex> writeLocker(_nodeWriteMutex);
 
-        if (!node->isForcedNeverSilent()
-            && (usecTimestampNow() - node->getLastHeardMicrostamp()) > (NODE_SILENCE_THRESHOLD_MSECS * USECS_PER_MSEC)) {
-            // call the NodeHash erase to get rid of this node
-            _localIDMap.unsafe_erase(node->getLocalID());
-            it = _nodeHash.unsafe_erase(it);
+        std::vector<SharedNodePointer> liveNodes;
+        for (const auto& node : getNodeSnapshot()->nodes) {
+            node->getMutex().lock();
 
-            killedNodes.insert(node);
-        } else {
-            // we didn't erase this node, push the iterator forwards
-            ++it;
+            if (!node->isForcedNeverSilent()
+                && (usecTimestampNow() - node->getLastHeardMicrostamp()) > (NODE_SILENCE_THRESHOLD_MSECS * USECS_PER_MSEC)) {
+                // leave this node out of the next snapshot
+                killedNodes.insert(node);
+            } else {
+                liveNodes.push_back(node);
+            }
+
+            node->getMutex().unlock();
         }
 
-        node->getMutex().unlock();
-    });
+        if (!killedNodes.isEmpty()) {
+            publishNodes(std::move(liveNodes));
+        }
+    }
 
     foreach(const SharedNodePointer& killedNode, killedNodes) {
         auto now = usecTimestampNow();
@@ -1275,23 +1343,15 @@ void LimitedNodeList::sendPeerQueryToIceServer(const HifiSockAddr& iceServerSock
 }
 
 SharedNodePointer LimitedNodeList::findNodeWithAddr(const HifiSockAddr& addr) {
-    QReadLocker locker(&_nodeMutex);
-    auto it = std::find_if(std::begin(_nodeHash), std::end(_nodeHash), [&addr](const UUIDNodePair& pair) {
-        return pair.second->getPublicSocket() == addr
-            || pair.second->getLocalSocket() == addr
-            || pair.second->getSymmetricSocket() == addr;
+    return nodeMatchingPredicate([&addr](const SharedNodePointer& node) {
+        return node->getPublicSocket() == addr
+            || node->getLocalSocket() == addr
+            || node->getSymmetricSocket() == addr;
     });
-    return (it != std::end(_nodeHash)) ? it->second : SharedNodePointer();
 }
 
 bool LimitedNodeList::sockAddrBelongsToNode(const HifiSockAddr& sockAddr) {
-    QReadLocker locker(&_nodeMutex);
-    auto it = std::find_if(std::begin(_nodeHash), std::end(_nodeHash), [&sockAddr](const UUIDNodePair& pair) {
-        return pair.second->getPublicSocket() == sockAddr
-            || pair.second->getLocalSocket() == sockAddr
-            || pair.second->getSymmetricSocket() == sockAddr;
-    });
-    return it != std::end(_nodeHash);
+    return !findNodeWithAddr(sockAddr).isNull();
 }
 
 void LimitedNodeList::sendPacketToIceServer(PacketType packetType, const HifiSockAddr& iceServerSockAddr,
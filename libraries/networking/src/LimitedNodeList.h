@@ -14,10 +14,13 @@
 
 #include <assert.h>
 #include <stdint.h>
+#include <atomic>
 #include <iterator>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <unordered_map>
+#include <vector>
 
 #ifndef _WIN32
 #include <unistd.h> // not on windows, not needed for mac or windows
@@ -71,7 +74,6 @@ const ConnectionID NULL_CONNECTION_ID { -1 };
 const ConnectionID INITIAL_CONNECTION_ID { 0 };
 
 typedef std::pair<QUuid, SharedNodePointer> UUIDNodePair;
-typedef tbb::concurrent_unordered_map<QUuid, SharedNodePointer, UUIDHasher> NodeHash;
 
 typedef quint8 PingType_t;
 namespace PingType {
@@ -166,7 +168,7 @@ public:
 
     std::function<void(Node*)> linkedDataCreateCallback;
 
-    size_t size() const { QReadLocker readLock(&_nodeMutex); return _nodeHash.size(); }
+    size_t size() const { return getNodeSnapshot()->nodes.size(); }
 
     SharedNodePointer nodeWithUUID(const QUuid& nodeUUID);
     SharedNodePointer nodeWithLocalID(Node::LocalID localID) const;
@@ -205,10 +207,8 @@ public:
     using value_type = SharedNodePointer;
     using const_iterator = std::vector<value_type>::const_iterator;
 
-    // Cede control of iteration under a single read lock (e.g. for use by thread pools)
-    // Use this for nested loops instead of taking nested read locks!
-    //   This allows multiple threads (i.e. a thread pool) to share a lock
-    //   without deadlocking when a dying node attempts to acquire a write lock
+    // Cede control of iteration over a single snapshot of the nodes (e.g. for use by thread pools)
+    // Use this for nested loops so that they all see the same nodes
     template<typename NestedNodeLambda>
     void nestedEach(NestedNodeLambda functor,
                     int* lockWaitOut = nullptr,
@@ -217,29 +217,19 @@ public:
         quint64 start, endTransform, endFunctor;
 
         start = usecTimestampNow();
-        std::vector<SharedNodePointer> nodes;
-        {
-            QReadLocker readLock(&_nodeMutex);
-            auto endLock = usecTimestampNow();
-            if (lockWaitOut) {
-                *lockWaitOut = (endLock - start);
-            }
 
-            // Size of _nodeHash could change at any time,
-            // so reserve enough memory for the current size
-            // and then back insert all the nodes found
-            nodes.reserve(_nodeHash.size());
-            std::transform(_nodeHash.cbegin(), _nodeHash.cend(), std::back_inserter(nodes), [&](const NodeHash::value_type& it) {
-                return it.second;
-            });
-
-            endTransform = usecTimestampNow();
-            if (nodeTransformOut) {
-                *nodeTransformOut = (endTransform - endLock);
-            }
+        // the snapshot never changes once published, so it is iterated in place instead of being copied
+        auto snapshot = getNodeSnapshot();
+
+        endTransform = usecTimestampNow();
+        if (lockWaitOut) {
+            *lockWaitOut = (endTransform - start);
+        }
+        if (nodeTransformOut) {
+            *nodeTransformOut = 0;
         }
 
-        functor(nodes.cbegin(), nodes.cend());
+        functor(snapshot->nodes.cbegin(), snapshot->nodes.cend());
         endFunctor = usecTimestampNow();
         if (functorOut) {
             *functorOut = (endFunctor - endTransform);
@@ -248,30 +238,30 @@ public:
 
     template<typename NodeLambda>
     void eachNode(NodeLambda functor) {
-        QReadLocker readLock(&_nodeMutex);
+        auto snapshot = getNodeSnapshot();
 
-        for (NodeHash::const_iterator it = _nodeHash.cbegin(); it != _nodeHash.cend(); ++it) {
-            functor(it->second);
+        for (const auto& node : snapshot->nodes) {
+            functor(node);
         }
     }
 
     template<typename PredLambda, typename NodeLambda>
     void eachMatchingNode(PredLambda predicate, NodeLambda functor) {
-        QReadLocker readLock(&_nodeMutex);
+        auto snapshot = getNodeSnapshot();
 
-        for (NodeHash::const_iterator it = _nodeHash.cbegin(); it != _nodeHash.cend(); ++it) {
-            if (predicate(it->second)) {
-                functor(it->second);
+        for (const auto& node : snapshot->nodes) {
+            if (predicate(node)) {
+                functor(node);
             }
         }
     }
 
     template<typename BreakableNodeLambda>
     void eachNodeBreakable(BreakableNodeLambda functor) {
-        QReadLocker readLock(&_nodeMutex);
+        auto snapshot = getNodeSnapshot();
 
-        for (NodeHash::const_iterator it = _nodeHash.cbegin(); it != _nodeHash.cend(); ++it) {
-            if (!functor(it->second)) {
+        for (const auto& node : snapshot->nodes) {
+            if (!functor(node)) {
                 break;
             }
         }
@@ -279,25 +269,22 @@ public:
 
     template<typename PredLambda>
     SharedNodePointer nodeMatchingPredicate(const PredLambda predicate) {
-        QReadLocker readLock(&_nodeMutex);
+        auto snapshot = getNodeSnapshot();
 
-        for (NodeHash::const_iterator it = _nodeHash.cbegin(); it != _nodeHash.cend(); ++it) {
-            if (predicate(it->second)) {
-                return it->second;
+        for (const auto& node : snapshot->nodes) {
+            if (predicate(node)) {
+                return node;
             }
         }
 
         return SharedNodePointer();
     }
 
-    // This is unsafe because it does not take a lock
-    // Must only be called when you know that a read lock on the node mutex is held
-    // and will be held for the duration of your iteration
+    // Used to be the lock-free variant of eachNode for callers already holding the node read lock,
+    // iterating a snapshot is now just as cheap
     template<typename NodeLambda>
     void unsafeEachNode(NodeLambda functor) {
-        for (NodeHash::const_iterator it = _nodeHash.cbegin(); it != _nodeHash.cend(); ++it) {
-            functor(it->second);
-        }
+        eachNode(functor);
     }
 
     void putLocalPortIntoSharedMemory(const QString key, QObject* parent, quint16 localPort);
@@ -436,8 +423,32 @@ protected:
     void removeDelayedAdd(QUuid nodeUUID);
     bool isDelayedNode(QUuid nodeUUID);
 
-    NodeHash _nodeHash;
-    mutable QReadWriteLock _nodeMutex { QReadWriteLock::Recursive };
+    // An immutable view of the nodes. Readers iterate whichever snapshot is current without taking any lock,
+    // writers (add / kill / update local ID) build the next snapshot and publish it in one atomic store.
+    struct NodeSnapshot {
+        using Pointer = std::shared_ptr<const NodeSnapshot>;
+
+        std::vector<SharedNodePointer> nodes;
+        std::unordered_map<QUuid, SharedNodePointer, UUIDHasher> nodesByUUID;
+        std::unordered_map<Node::LocalID, SharedNodePointer> nodesByLocalID;
+    };
+
+    // Snapshots are handed over through a few versioned slots: std::atomic_load on a shared_ptr takes a lock in libstdc++.
+    // A reader pins the current slot with its reader count while it copies the pointer out, and the writer only refills
+    // a slot that is neither current nor pinned, so the copy never races with a store.
+    struct SnapshotSlot {
+        NodeSnapshot::Pointer snapshot { std::make_shared<NodeSnapshot>() };
+        std::atomic<int> numReaders { 0 };
+    };
+    static const int NUM_SNAPSHOT_SLOTS = 4;
+
+    NodeSnapshot::Pointer getNodeSnapshot() const;
+    void publishNodes(std::vector<SharedNodePointer> nodes); // must hold _nodeWriteMutex
+    bool eraseNode(const SharedNodePointer& node);
+
+    mutable SnapshotSlot _snapshotSlots[NUM_SNAPSHOT_SLOTS];
+    std::atomic<int> _currentSnapshotSlot { 0 };
+    std::mutex _nodeWriteMutex; // serializes the writers, readers never wait on it
     udt::Socket _nodeSocket;
     QUdpSocket* _dtlsSocket { nullptr };
     HifiSockAddr _localSockAddr;
@@ -461,16 +472,6 @@ protected:
     QMap<quint64, ConnectionStep> _lastConnectionTimes;
     bool _areConnectionTimesComplete = false;
 
-    template<typename IteratorLambda>
-    void eachNodeHashIterator(IteratorLambda functor) {
-        QWriteLocker writeLock(&_nodeMutex);
-        NodeHash::iterator it = _nodeHash.begin();
-
-        while (it != _nodeHash.end()) {
-            functor(it);
-        }
-    }
-
     std::unordered_map<QUuid, ConnectionID> _connectionIDs;
     quint64 _nodeConnectTimestamp{ 0 };
     quint64 _nodeDisconnectTimestamp{ 0 };
@@ -484,8 +485,6 @@ private slots:
 private:
     mutable QReadWriteLock _sessionUUIDLock;
     QUuid _sessionUUID;
-    using LocalIDMapping = tbb::concurrent_unordered_map<Node::LocalID, SharedNodePointer>;
-    LocalIDMapping _localIDMap;
     Node::LocalID _sessionLocalID { 0 };
     bool _flagTimeForConnectionStep { false }; // only keep track in interface
 
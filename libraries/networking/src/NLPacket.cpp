@@ -11,6 +11,9 @@
 
 #include "NLPacket.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "HMACAuth.h"
 
 int NLPacket::localHeaderSize(PacketType type) {
@@ -152,9 +155,13 @@ QByteArray NLPacket::verificationHashInHeader(const udt::Packet& packet) {
     return QByteArray(packet.getData() + offset, NUM_BYTES_MD5_HASH);
 }
 
-QByteArray NLPacket::hashForPacketAndHMAC(const udt::Packet& packet, HMACAuth& hash) {
-    int offset = Packet::totalHeaderSize(packet.isPartOfMessage()) + sizeof(PacketType) + sizeof(PacketVersion)
+static int hashedDataOffset(const udt::Packet& packet) {
+    return udt::Packet::totalHeaderSize(packet.isPartOfMessage()) + sizeof(PacketType) + sizeof(PacketVersion)
         + NUM_BYTES_LOCALID + NUM_BYTES_MD5_HASH;
+}
+
+QByteArray NLPacket::hashForPacketAndHMAC(const udt::Packet& packet, const HMACAuth& hash) {
+    int offset = hashedDataOffset(packet);
     
     // add the packet payload and the connection UUID
     HMACAuth::HMACHash hashResult;
@@ -164,6 +171,43 @@ QByteArray NLPacket::hashForPacketAndHMAC(const udt::Packet& packet, HMACAuth& h
     return QByteArray((const char*) hashResult.data(), (int) hashResult.size());
 }
 
+bool NLPacket::hashMatchesForPacket(const udt::Packet& packet, const HMACAuth& hash) {
+    bool verified;
+    const udt::Packet* packets[] = { &packet };
+    hashesMatchForPackets(packets, 1, hash, &verified);
+    return verified;
+}
+
+void NLPacket::hashesMatchForPackets(const udt::Packet* const* packets, int count, const HMACAuth& hash, bool* verified) {
+    // hash in small batches so that everything stays on the stack
+    static const int BATCH_SIZE = 16;
+    const char* data[BATCH_SIZE];
+    int dataLens[BATCH_SIZE];
+    unsigned char hashes[BATCH_SIZE * HMACAuth::MAX_HASH_SIZE];
+
+    const int hashSize = hash.getHashSize();
+    const int comparedSize = std::min(hashSize, NUM_BYTES_MD5_HASH);
+
+    for (int batchStart = 0; batchStart < count; batchStart += BATCH_SIZE) {
+        int batchCount = std::min(BATCH_SIZE, count - batchStart);
+
+        for (int i = 0; i < batchCount; ++i) {
+            const udt::Packet& packet = *packets[batchStart + i];
+            int offset = hashedDataOffset(packet);
+            data[i] = packet.getData() + offset;
+            dataLens[i] = packet.getDataSize() - offset;
+        }
+
+        bool hashed = hash.calculateHashes(hashes, data, dataLens, batchCount);
+
+        for (int i = 0; i < batchCount; ++i) {
+            const udt::Packet& packet = *packets[batchStart + i];
+            const char* headerHash = packet.getData() + hashedDataOffset(packet) - NUM_BYTES_MD5_HASH;
+            verified[batchStart + i] = hashed && memcmp(headerHash, hashes + i * hashSize, comparedSize) == 0;
+        }
+    }
+}
+
 void NLPacket::writeTypeAndVersion() {
     auto headerOffset = Packet::totalHeaderSize(isPartOfMessage());
     
@@ -216,14 +260,14 @@ void NLPacket::writeSourceID(LocalID sourceID) const {
     _sourceID = sourceID;
 }
 
-void NLPacket::writeVerificationHash(HMACAuth& hmacAuth) const {
+void NLPacket::writeVerificationHash(const HMACAuth& hmacAuth) const {
     Q_ASSERT(!PacketTypeEnum::getNonSourcedPackets().contains(_type) &&
              !PacketTypeEnum::getNonVerifiedPackets().contains(_type));
     
-    auto offset = Packet::totalHeaderSize(isPartOfMessage()) + sizeof(PacketType) + sizeof(PacketVersion)
-                + NUM_BYTES_LOCALID;
+    auto offset = hashedDataOffset(*this);
 
-    QByteArray verificationHash = hashForPacketAndHMAC(*this, hmacAuth);
+    unsigned char verificationHash[HMACAuth::MAX_HASH_SIZE];
+    int hashSize = hmacAuth.calculateHash(verificationHash, _packet.get() + offset, getDataSize() - offset);
     
-    memcpy(_packet.get() + offset, verificationHash.data(), verificationHash.size());
+    memcpy(_packet.get() + offset - NUM_BYTES_MD5_HASH, verificationHash, std::min(hashSize, NUM_BYTES_MD5_HASH));
 }
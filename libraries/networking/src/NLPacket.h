@@ -71,7 +71,11 @@ public:
     
     static LocalID sourceIDInHeader(const udt::Packet& packet);
     static QByteArray verificationHashInHeader(const udt::Packet& packet);
-    static QByteArray hashForPacketAndHMAC(const udt::Packet& packet, HMACAuth& hash);
+    static QByteArray hashForPacketAndHMAC(const udt::Packet& packet, const HMACAuth& hash);
+    // compare the hash in the header with the one expected for this packet, without allocating
+    static bool hashMatchesForPacket(const udt::Packet& packet, const HMACAuth& hash);
+    // same for several packets from the same source at once, verified must have room for count results
+    static void hashesMatchForPackets(const udt::Packet* const* packets, int count, const HMACAuth& hash, bool* verified);
     
     PacketType getType() const { return _type; }
     void setType(PacketType type);
@@ -82,7 +86,7 @@ public:
     LocalID getSourceID() const { return _sourceID; }
     
     void writeSourceID(LocalID sourceID) const;
-    void writeVerificationHash(HMACAuth& hmacAuth) const;
+    void writeVerificationHash(const HMACAuth& hmacAuth) const;
 
 protected:
     
@@ -288,6 +288,9 @@ void NodeList::reset(QString reason, bool skipDomainHandlerReset) {
     setSessionUUID(QUuid());
     setSessionLocalID(Node::NULL_LOCAL_ID);
 
+    // the next domain list has to be a full one
+    _domainListEpoch = 0;
+
     // if we setup the DTLS socket, also disconnect from the DTLS socket readyRead() so it can handle handshaking
     if (_dtlsSocket) {
         disconnect(_dtlsSocket, 0, this, 0);
@@ -466,6 +469,10 @@ void NodeList::sendDomainServerCheckIn() {
         packetStream << _ownerType.load() << publicSockAddr << localSockAddr << _nodeTypesOfInterest.toList();
         packetStream << DependencyManager::get<AddressManager>()->getPlaceName();
 
+        if (domainPacketType == PacketType::DomainListRequest) {
+            packetStream << _domainListEpoch.load();
+        }
+
         if (!domainIsConnected) {
             DataServerAccountInfo& accountInfo = accountManager->getAccountInfo();
             packetStream << accountInfo.getUsername();
@@ -707,6 +714,12 @@ void NodeList::processDomainServerList(QSharedPointer<ReceivedMessage> message)
     bool newConnection;
     packetStream >> newConnection;
 
+    // a delta holds the changes from baseEpoch to epoch, a full list every node as of epoch
+    quint64 epoch;
+    quint64 baseEpoch;
+    bool isDelta;
+    packetStream >> epoch >> baseEpoch >> isDelta;
+
     if (newConnection) {
         _nodeConnectTimestamp = usecTimestampNow();
         _connectReason = Connect;
@@ -786,10 +799,30 @@ void NodeList::processDomainServerList(QSharedPointer<ReceivedMessage> message)
     setPermissions(newPermissions);
     setAuthenticatePackets(isAuthenticated);
 
+    // skip lists older than the one we have, they could bring back nodes removed since, and deltas that don't
+    // start at or before it, which would leave out changes
+    quint64 knownEpoch = _domainListEpoch;
+    if (epoch < knownEpoch || (isDelta && baseEpoch > knownEpoch)) {
+        return;
+    }
+
     // pull each node in the packet
     while (packetStream.device()->pos() < message->getSize()) {
+        if (isDelta) {
+            bool isRemoved;
+            packetStream >> isRemoved;
+            if (isRemoved) {
+                QUuid nodeUUID;
+                packetStream >> nodeUUID;
+                killNodeWithUUID(nodeUUID);
+                removeDelayedAdd(nodeUUID);
+                continue;
+            }
+        }
         parseNodeFromPacketStream(packetStream);
     }
+
+    _domainListEpoch = epoch;
 }
 
 void NodeList::processDomainServerAddedNode(QSharedPointer<ReceivedMessage> message) {
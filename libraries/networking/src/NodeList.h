@@ -176,6 +176,10 @@ private:
 
     bool _sendDomainServerCheckInEnabled { true };
 
+    // the node list epoch of the last domain list applied, sent with check-ins so the domain-server can reply with
+    // only the changes since then
+    std::atomic<quint64> _domainListEpoch { 0 };
+
     mutable QReadWriteLock _ignoredSetLock;
     tbb::concurrent_unordered_set<QUuid, UUIDHasher> _ignoredNodeIDs;
     mutable QReadWriteLock _personalMutedSetLock;
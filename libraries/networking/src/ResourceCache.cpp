@@ -28,17 +28,72 @@
 #include "NetworkLogging.h"
 #include "NodeList.h"
 
+// past this many heap entries per pending request, drop the superseded ones and rebuild the heaps
+static const size_t MAX_HEAP_ENTRIES_PER_PENDING_REQUEST = 2;
+
 bool ResourceCacheSharedItems::appendRequest(QWeakPointer<Resource> resource) {
     Lock lock(_mutex);
     if ((uint32_t)_loadingRequests.size() < _requestLimit) {
         _loadingRequests.append(resource);
         return true;
     } else {
-        _pendingRequests.append(resource);
+        auto locked = resource.lock();
+        if (locked) {
+            addPendingRequest(locked);
+        }
         return false;
     }
 }
 
+void ResourceCacheSharedItems::addPendingRequest(const QSharedPointer<Resource>& resource) {
+    auto& request = _pendingRequests[resource.data()];
+
+    // a resource that is already pending keeps its single place in the queue
+    request.resource = resource;
+    request.bucket = resource->getURL().scheme() == HIFI_URL_SCHEME_FILE ? FILE_BUCKET : OTHER_BUCKET;
+    pushPendingRequest(resource.data(), request, resource->getLoadPriority());
+}
+
+void ResourceCacheSharedItems::pushPendingRequest(Resource* resource, PendingRequest& request, float priority) {
+    request.priority = priority;
+    request.generation = ++_nextGeneration;
+
+    size_t heapEntryCount = 0;
+    for (const auto& heap : _pendingHeaps) {
+        heapEntryCount += heap.size();
+    }
+
+    if (heapEntryCount > MAX_HEAP_ENTRIES_PER_PENDING_REQUEST * _pendingRequests.size()) {
+        std::vector<HeapEntry> entries[NUM_BUCKETS];
+        for (const auto& pair : _pendingRequests) {
+            entries[pair.second.bucket].push_back({ pair.second.priority, pair.second.generation, pair.first });
+        }
+        for (int i = 0; i < NUM_BUCKETS; ++i) {
+            _pendingHeaps[i] = std::priority_queue<HeapEntry>(std::less<HeapEntry>(), std::move(entries[i]));
+        }
+    } else {
+        _pendingHeaps[request.bucket].push({ priority, request.generation, resource });
+    }
+}
+
+void ResourceCacheSharedItems::updatePendingRequest(QWeakPointer<Resource> resource) {
+    auto locked = resource.lock();
+    if (!locked) {
+        return;
+    }
+
+    Lock lock(_mutex);
+    auto it = _pendingRequests.find(locked.data());
+    if (it == _pendingRequests.end()) {
+        return;
+    }
+
+    float priority = locked->getLoadPriority();
+    if (priority != it->second.priority) {
+        pushPendingRequest(it->first, it->second, priority);
+    }
+}
+
 void ResourceCacheSharedItems::setRequestLimit(uint32_t limit) {
     Lock lock(_mutex);
     _requestLimit = limit;
@@ -53,8 +108,8 @@ QList<QSharedPointer<Resource>> ResourceCacheSharedItems::getPendingRequests() c
     QList<QSharedPointer<Resource>> result;
     Lock lock(_mutex);
 
-    foreach (QWeakPointer<Resource> resource, _pendingRequests) {
-        auto locked = resource.lock();
+    for (const auto& pair : _pendingRequests) {
+        auto locked = pair.second.resource.lock();
         if (locked) {
             result.append(locked);
         }
@@ -65,7 +120,7 @@ QList<QSharedPointer<Resource>> ResourceCacheSharedItems::getPendingRequests() c
 
 uint32_t ResourceCacheSharedItems::getPendingRequestsCount() const {
     Lock lock(_mutex);
-    return _pendingRequests.size();
+    return (uint32_t)_pendingRequests.size();
 }
 
 QList<QSharedPointer<Resource>> ResourceCacheSharedItems::getLoadingRequests() const {
@@ -105,44 +160,50 @@ void ResourceCacheSharedItems::removeRequest(QWeakPointer<Resource> resource) {
 }
 
 QSharedPointer<Resource> ResourceCacheSharedItems::getHighestPendingRequest() {
-    // look for the highest priority pending request
-    int highestIndex = -1;
-    float highestPriority = -FLT_MAX;
-    QSharedPointer<Resource> highestResource;
     Lock lock(_mutex);
 
-    bool currentHighestIsFile = false;
+    for (auto& heap : _pendingHeaps) {
+        while (!heap.empty()) {
+            HeapEntry top = heap.top();
+            heap.pop();
 
-    for (int i = 0; i < _pendingRequests.size();) {
-        // Clear any freed resources
-        auto resource = _pendingRequests.at(i).lock();
-        if (!resource) {
-            _pendingRequests.removeAt(i);
-            continue;
-        }
+            auto it = _pendingRequests.find(top.resource);
+            if (it == _pendingRequests.end() || it->second.generation != top.generation) {
+                // superseded by a newer entry for the same resource
+                continue;
+            }
 
-        // Check load priority
-        float priority = resource->getLoadPriority();
-        bool isFile = resource->getURL().scheme() == HIFI_URL_SCHEME_FILE;
-        if (priority >= highestPriority && (isFile || !currentHighestIsFile)) {
-            highestPriority = priority;
-            highestIndex = i;
-            highestResource = resource;
-            currentHighestIsFile = isFile;
-        }
-        i++;
-    }
+            // Clear any freed resources
+            auto resource = it->second.resource.lock();
+            if (!resource) {
+                _pendingRequests.erase(it);
+                continue;
+            }
+
+            // owners that went away since this entry was pushed lower the priority: re-queue it where it now belongs.
+            // Once the last owner is gone getLoadPriority() prunes it and returns -FLT_MAX, so the request sinks to
+            // the bottom.  When it surfaces again the priorities are empty and getLoadPriority() returns 0, which is
+            // not lower than the entry's, so the ownerless request is dispatched then rather than re-queued forever
+            float priority = resource->getLoadPriority();
+            if (priority < top.priority) {
+                pushPendingRequest(it->first, it->second, priority);
+                continue;
+            }
 
-    if (highestIndex >= 0) {
-        _pendingRequests.takeAt(highestIndex);
+            _pendingRequests.erase(it);
+            return resource;
+        }
     }
 
-    return highestResource;
+    return QSharedPointer<Resource>();
 }
 
 void ResourceCacheSharedItems::clear() {
     Lock lock(_mutex);
     _pendingRequests.clear();
+    for (auto& heap : _pendingHeaps) {
+        heap = std::priority_queue<HeapEntry>();
+    }
     _loadingRequests.clear();
 }
 
@@ -600,6 +661,7 @@ void Resource::ensureLoading() {
 void Resource::setLoadPriority(const QPointer<QObject>& owner, float priority) {
     if (!_failedToLoad) {
         _loadPriorities.insert(owner, priority);
+        updatePendingRequest();
     }
 }
 
@@ -611,6 +673,14 @@ void Resource::setLoadPriorities(const QHash<QPointer<QObject>, float>& prioriti
             it != priorities.constEnd(); it++) {
         _loadPriorities.insert(it.key(), it.value());
     }
+    updatePendingRequest();
+}
+
+void Resource::updatePendingRequest() {
+    // lowered priorities are picked up lazily when the request reaches the front of the queue
+    if (DependencyManager::isSet<ResourceCacheSharedItems>()) {
+        DependencyManager::get<ResourceCacheSharedItems>()->updatePendingRequest(_self);
+    }
 }
 
 void Resource::clearLoadPriority(const QPointer<QObject>& owner) {
@@ -14,6 +14,9 @@
 
 #include <atomic>
 #include <mutex>
+#include <queue>
+#include <unordered_map>
+#include <vector>
 
 #include <QtCore/QHash>
 #include <QtCore/QList>
@@ -68,6 +71,7 @@ class ResourceCacheSharedItems : public Dependency  {
 public:
     bool appendRequest(QWeakPointer<Resource> newRequest);
     void removeRequest(QWeakPointer<Resource> doneRequest);
+    void updatePendingRequest(QWeakPointer<Resource> request); // call when the load priority of request may have risen
     void setRequestLimit(uint32_t limit);
     uint32_t getRequestLimit() const;
     QList<QSharedPointer<Resource>> getPendingRequests() const;
@@ -80,8 +84,42 @@ public:
 private:
     ResourceCacheSharedItems() = default;
 
+    // Pending requests are indexed by resource and ordered by one max-heap per bucket; local file requests are
+    // always dispatched before anything else.  A heap entry holds the priority its resource had when pushed.
+    // When that priority changes the resource gets a new entry with a new generation, and superseded entries,
+    // like those of freed resources, are only dropped once they reach the top of their heap.
+    enum Bucket {
+        FILE_BUCKET = 0,
+        OTHER_BUCKET,
+        NUM_BUCKETS
+    };
+
+    struct PendingRequest {
+        QWeakPointer<Resource> resource;
+        float priority;
+        uint64_t generation;
+        Bucket bucket;
+    };
+
+    struct HeapEntry {
+        float priority;
+        uint64_t generation;
+        Resource* resource;
+
+        // ties go to the most recent request
+        bool operator<(const HeapEntry& other) const {
+            return priority < other.priority || (priority == other.priority && generation < other.generation);
+        }
+    };
+
+    // these expect _mutex to be held
+    void addPendingRequest(const QSharedPointer<Resource>& resource);
+    void pushPendingRequest(Resource* resource, PendingRequest& request, float priority);
+
     mutable Mutex _mutex;
-    QList<QWeakPointer<Resource>> _pendingRequests;
+    std::unordered_map<Resource*, PendingRequest> _pendingRequests;
+    std::priority_queue<HeapEntry> _pendingHeaps[NUM_BUCKETS];
+    uint64_t _nextGeneration { 0 };
     QList<QWeakPointer<Resource>> _loadingRequests;
     const uint32_t DEFAULT_REQUEST_LIMIT = 10;
     uint32_t _requestLimit { DEFAULT_REQUEST_LIMIT };
@@ -487,6 +525,9 @@ protected slots:
 protected:
     virtual void init(bool resetLoaded = true);
 
+    /// Lets a queued request move ahead after its load priority was raised.
+    void updatePendingRequest();
+
     /// Called by ResourceCache to begin loading this Resource.
     /// This method can be overriden to provide custom request functionality. If this is done,
     /// downloadFinished and ResourceCache::requestCompleted must be called.
@@ -52,6 +52,6 @@ void ResourceRequest::recordBytesDownloadedInStats(const QString& statName, int6
     auto dBytes = bytesReceived - _lastRecordedBytesDownloaded;
     if (dBytes > 0) {
         _lastRecordedBytesDownloaded = bytesReceived;
-        DependencyManager::get<StatTracker>()->updateStat(statName, dBytes);
+        StatTracker::getCounter(statName).add(dBytes);
     }
 }
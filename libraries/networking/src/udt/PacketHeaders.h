@@ -372,7 +372,13 @@ enum class DomainListVersion : PacketVersion {
     GetMachineFingerprintFromUUIDSupport,
     AuthenticationOptional,
     HasTimestamp,
-    HasConnectReason
+    HasConnectReason,
+    HasNodeListEpoch
+};
+
+enum class DomainListRequestVersion : PacketVersion {
+    PreNodeListEpoch = 22,
+    HasNodeListEpoch
 };
 
 enum class AudioVersion : PacketVersion {
@@ -13,7 +13,6 @@
 #define hifi_SendQueue_h
 
 #include <atomic>
-#include <condition_variable>
 #include <cstdint>
 #include <list>
 #include <memory>
@@ -38,8 +37,13 @@ class BasePacket;
 class ControlPacket;
 class Packet;
 class PacketList;
+class SendQueueScheduler;
 class Socket;
-    
+
+// Sends the reliable packets of one Connection, paced by its congestion control.
+//
+// SendQueues don't have threads of their own: the process-wide SendQueueScheduler services each of them whenever
+// it is due (next packet, handshake re-send, timeout) or has just been handed packets, ACKs or NAKs.
 class SendQueue : public QObject {
     Q_OBJECT
     
@@ -85,15 +89,23 @@ signals:
 
     void timeout();
     
-private slots:
-    void run();
-    
 private:
+    friend class SendQueueScheduler;
+
+    enum class WaitState {
+        None,
+        Empty, // everything was ACKed, waiting for new packets or inactivity
+        ACK // waiting for the receiver to ACK what is on the wire
+    };
+
     SendQueue(Socket* socket, HifiSockAddr dest, SequenceNumber currentSequenceNumber,
               MessageNumber currentMessageNumber, bool hasReceivedHandshakeACK);
     SendQueue(SendQueue& other) = delete;
     SendQueue(SendQueue&& other) = delete;
     
+    // does one round of sending, returns false once the queue is done
+    bool service(p_high_resolution_clock::time_point now, p_high_resolution_clock::time_point& nextService);
+
     void sendHandshake();
     
     int sendPacket(const Packet& packet);
@@ -102,7 +114,7 @@ private:
     int maybeSendNewPacket(); // Figures out what packet to send next
     bool maybeResendPacket(); // Determines whether to resend a packet and which one
     
-    bool isInactive(bool attemptedToSendPacket);
+    bool isInactive(p_high_resolution_clock::time_point now, p_high_resolution_clock::time_point& nextService);
     void deactivate(); // makes the queue inactive and cleans it up
 
     bool isFlowWindowFull() const;
@@ -113,6 +125,7 @@ private:
     PacketQueue _packets;
     
     Socket* _socket { nullptr }; // Socket to send packet on
+    std::mutex _destinationLock; // Protects the destination addr
     HifiSockAddr _destination; // Destination addr
     
     std::atomic<uint32_t> _lastACKSequenceNumber { 0 }; // Last ACKed sequence number
@@ -134,13 +147,14 @@ private:
     using PacketResendPair = std::pair<uint8_t, std::unique_ptr<Packet>>; // Number of resend + packet ptr
     std::unordered_map<SequenceNumber, PacketResendPair> _sentPackets; // Packets waiting for ACK.
     
-    std::mutex _handshakeMutex; // Protects the handshake ACK condition_variable
     std::atomic<bool> _hasReceivedHandshakeACK { false }; // flag for receipt of handshake ACK from client
-    std::condition_variable _handshakeACKCondition;
-    
-    std::condition_variable_any _emptyCondition;
 
+    // Only touched while being serviced
     std::chrono::high_resolution_clock::time_point _lastPacketSentAt;
+    p_high_resolution_clock::time_point _nextPacketTimestamp; // when the next packet should be sent
+    p_high_resolution_clock::time_point _nextHandshakeTimestamp; // when to re-send the handshake
+    WaitState _waitState { WaitState::None };
+    p_high_resolution_clock::time_point _waitDeadline; // end of the current wait
 
     static const std::chrono::microseconds MAXIMUM_ESTIMATED_TIMEOUT;
     static const std::chrono::microseconds MINIMUM_ESTIMATED_TIMEOUT;
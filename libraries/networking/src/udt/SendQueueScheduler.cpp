@@ -0,0 +1,161 @@
+//
+//  SendQueueScheduler.cpp
+//  libraries/networking/src/udt
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "SendQueueScheduler.h"
+
+#include <algorithm>
+
+#include "SendQueue.h"
+
+using namespace udt;
+
+// sending is mostly syscalls, a few threads keep up with thousands of paced queues
+static const unsigned int MAX_PACING_THREADS = 4;
+
+// past this many heap entries per queue, drop the ones left behind by wake() and rebuild the heap
+static const size_t MAX_DEADLINES_PER_QUEUE = 4;
+
+SendQueueScheduler& SendQueueScheduler::getInstance() {
+    static SendQueueScheduler instance;
+    return instance;
+}
+
+SendQueueScheduler::SendQueueScheduler() {
+    auto threadCount = std::max(1u, std::min(MAX_PACING_THREADS, std::thread::hardware_concurrency() / 2));
+    for (unsigned int i = 0; i < threadCount; ++i) {
+        _threads.emplace_back(&SendQueueScheduler::run, this);
+    }
+}
+
+SendQueueScheduler::~SendQueueScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _isStopping = true;
+    }
+    _condition.notify_all();
+
+    for (auto& thread : _threads) {
+        thread.join();
+    }
+}
+
+void SendQueueScheduler::add(SendQueue* queue) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    schedule(queue, _queues[queue], Clock::now());
+}
+
+void SendQueueScheduler::remove(SendQueue* queue) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    auto it = _queues.find(queue);
+    if (it == _queues.end()) {
+        return;
+    }
+
+    // its heap entry, if any, is ignored from now on since the queue can't be found anymore
+    _serviceDone.wait(lock, [&] { return !it->second.isInService; });
+    _queues.erase(it);
+}
+
+void SendQueueScheduler::wake(SendQueue* queue) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _queues.find(queue);
+    if (it == _queues.end()) {
+        return;
+    }
+
+    auto& state = it->second;
+    if (state.isInService) {
+        // it will be rescheduled right away when the current service completes
+        state.isWakePending = true;
+        return;
+    }
+
+    // a queue that isn't scheduled has stopped itself and has nothing left to do
+    auto now = Clock::now();
+    if (state.isScheduled && state.deadline > now) {
+        schedule(queue, state, now);
+    }
+}
+
+size_t SendQueueScheduler::getQueueCount() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _queues.size();
+}
+
+void SendQueueScheduler::schedule(SendQueue* queue, QueueState& state, Clock::time_point deadline) {
+    state.generation = ++_nextGeneration;
+    state.deadline = deadline;
+    state.isScheduled = true;
+
+    if (_deadlines.size() > MAX_DEADLINES_PER_QUEUE * _queues.size()) {
+        decltype(_deadlines) deadlines;
+        for (const auto& pair : _queues) {
+            if (pair.second.isScheduled && pair.first != queue) {
+                deadlines.push({ pair.second.deadline, pair.first, pair.second.generation });
+            }
+        }
+        _deadlines.swap(deadlines);
+    }
+
+    bool isEarliest = _deadlines.empty() || deadline < _deadlines.top().deadline;
+    _deadlines.push({ deadline, queue, state.generation });
+
+    if (isEarliest) {
+        // a pacing thread may be waiting on a later deadline
+        _condition.notify_one();
+    }
+}
+
+void SendQueueScheduler::run() {
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (!_isStopping) {
+        if (_deadlines.empty()) {
+            _condition.wait(lock);
+            continue;
+        }
+
+        Entry entry = _deadlines.top();
+
+        auto it = _queues.find(entry.queue);
+        if (it == _queues.end() || it->second.generation != entry.generation) {
+            // this queue was removed or rescheduled since this entry was pushed
+            _deadlines.pop();
+            continue;
+        }
+
+        if (entry.deadline > Clock::now()) {
+            _condition.wait_until(lock, entry.deadline);
+            continue;
+        }
+
+        _deadlines.pop();
+
+        // references to unordered_map elements survive rehashing, and remove() won't erase it while in service
+        auto& state = it->second;
+        state.isScheduled = false;
+        state.isInService = true;
+        state.isWakePending = false;
+
+        lock.unlock();
+
+        Clock::time_point nextService;
+        bool shouldContinue = entry.queue->service(Clock::now(), nextService);
+
+        lock.lock();
+
+        state.isInService = false;
+        if (shouldContinue) {
+            schedule(entry.queue, state, state.isWakePending ? Clock::now() : nextService);
+        }
+
+        _serviceDone.notify_all();
+    }
+}
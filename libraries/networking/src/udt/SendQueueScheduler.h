@@ -0,0 +1,94 @@
+//
+//  SendQueueScheduler.h
+//  libraries/networking/src/udt
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_SendQueueScheduler_h
+#define hifi_SendQueueScheduler_h
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <PortableHighResolutionClock.h>
+
+namespace udt {
+
+class SendQueue;
+
+// A small pool of pacing threads shared by every SendQueue in the process.
+//
+// Each registered queue has a single deadline in a min-heap: the time of its next packet (as paced by its congestion
+// control), of its next handshake or of the end of its current inactivity / ACK wait.  Whichever pacing thread is
+// free services the earliest due queue, then puts it back in the heap at the deadline the queue asks for.
+// A queue is never serviced by two threads at once.
+
+class SendQueueScheduler {
+public:
+    using Clock = p_high_resolution_clock;
+
+    static SendQueueScheduler& getInstance();
+
+    ~SendQueueScheduler();
+
+    // starts servicing queue right away
+    void add(SendQueue* queue);
+
+    // blocks until queue isn't being serviced anymore, it won't be serviced again once this returns
+    void remove(SendQueue* queue);
+
+    // services queue as soon as possible instead of at its current deadline,
+    // the queue itself holds off sending until its next packet is due
+    void wake(SendQueue* queue);
+
+    size_t getThreadCount() const { return _threads.size(); }
+    size_t getQueueCount() const;
+
+private:
+    SendQueueScheduler();
+    SendQueueScheduler(const SendQueueScheduler&) = delete;
+    SendQueueScheduler& operator=(const SendQueueScheduler&) = delete;
+
+    struct QueueState {
+        uint64_t generation { 0 }; // matches the one heap entry that is still valid for this queue
+        Clock::time_point deadline;
+        bool isScheduled { false };
+        bool isInService { false };
+        bool isWakePending { false };
+    };
+
+    struct Entry {
+        Clock::time_point deadline;
+        SendQueue* queue;
+        uint64_t generation;
+
+        bool operator>(const Entry& other) const { return deadline > other.deadline; }
+    };
+
+    void run();
+    void schedule(SendQueue* queue, QueueState& state, Clock::time_point deadline); // expects _mutex to be held
+
+    mutable std::mutex _mutex;
+    std::condition_variable _condition; // signaled when the earliest deadline changes
+    std::condition_variable _serviceDone; // signaled when a queue leaves service, for remove()
+
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> _deadlines;
+    std::unordered_map<SendQueue*, QueueState> _queues;
+    uint64_t _nextGeneration { 0 };
+    bool _isStopping { false };
+
+    std::vector<std::thread> _threads;
+};
+
+}
+
+#endif // hifi_SendQueueScheduler_h
@@ -265,18 +265,27 @@ void PhysicalEntitySimulation::buildMotionStatesForEntitiesThatNeedThem() {
                         requestItr = _shapeRequests.erase(requestItr);
                         continue;
                     }
-                    // rebuild the ShapeInfo to verify hash because entity's desired shape may have changed
-                    // TODO? is there a better way to do this?
+                    // DIRTY_SHAPE was cleared when the shape was requested, so if it is still clear
+                    // the hash we asked for is the one the entity wants
+                    if (!(entity->getDirtyFlags() & Simulation::DIRTY_SHAPE)) {
+                        buildMotionState(shape, entity);
+                        requestItr = _shapeRequests.erase(requestItr);
+                        continue;
+                    }
+
+                    // the entity's desired shape has changed so rebuild the ShapeInfo to verify hash
                     ShapeInfo shapeInfo;
                     entity->computeShapeInfo(shapeInfo);
+                    entity->clearDirtyFlags(Simulation::DIRTY_SHAPE);
 
                     if (shapeInfo.getType() == SHAPE_TYPE_NONE) {
+                        ObjectMotionState::getShapeManager()->releaseShape(shape);
                         requestItr = _shapeRequests.erase(requestItr);
                     } else if (shapeInfo.getHash() != requestItr->shapeHash) {
                         // bummer, the hashes are different and we no longer want the shape we've received
                         ObjectMotionState::getShapeManager()->releaseShape(shape);
                         // try again
-                        shape = const_cast<btCollisionShape*>(ObjectMotionState::getShapeManager()->getShape(shapeInfo));
+                        shape = const_cast<btCollisionShape*>(ObjectMotionState::getShapeManager()->requestShape(shapeInfo));
                         if (shape) {
                             buildMotionState(shape, entity);
                             requestItr = _shapeRequests.erase(requestItr);
@@ -350,13 +359,16 @@ void PhysicalEntitySimulation::buildMotionStatesForEntitiesThatNeedThem() {
                 ShapeInfo shapeInfo;
                 entity->computeShapeInfo(shapeInfo);
                 uint32_t requestCount = ObjectMotionState::getShapeManager()->getWorkRequestCount();
-                btCollisionShape* shape = const_cast<btCollisionShape*>(ObjectMotionState::getShapeManager()->getShape(shapeInfo));
+                btCollisionShape* shape = const_cast<btCollisionShape*>(ObjectMotionState::getShapeManager()->requestShape(shapeInfo));
                 if (shape) {
                     buildMotionState(shape, entity);
                 } else if (requestCount != ObjectMotionState::getShapeManager()->getWorkRequestCount()) {
                     // shape doesn't exist but a new worker has been spawned to build it --> add to shapeRequests and wait
                     shapeRequest.shapeHash = shapeInfo.getHash();
                     _shapeRequests.insert(shapeRequest);
+                    // nothing else consumes the flags of an entity without a motionState: clear DIRTY_SHAPE
+                    // so we can tell on delivery whether this ShapeInfo is still the one it wants
+                    entity->clearDirtyFlags(Simulation::DIRTY_SHAPE);
                 } else {
                     // failed to build shape --> will not be added
                 }
@@ -406,14 +418,14 @@ void PhysicalEntitySimulation::buildPhysicsTransaction(PhysicsEngine::Transactio
         bool needsNewShape = object->needsNewShape();
         if (needsNewShape) {
             ShapeType shapeType = object->getShapeType();
-            if (shapeType == SHAPE_TYPE_STATIC_MESH) {
+            if (shapeType == SHAPE_TYPE_STATIC_MESH || ShapeCache::isCacheableType(shapeType)) {
                 ShapeRequest shapeRequest(object->_entity);
                 ShapeRequests::iterator  requestItr = _shapeRequests.find(shapeRequest);
                 if (requestItr == _shapeRequests.end()) {
                     ShapeInfo shapeInfo;
                     object->_entity->computeShapeInfo(shapeInfo);
                     uint32_t requestCount = ObjectMotionState::getShapeManager()->getWorkRequestCount();
-                    btCollisionShape* shape = const_cast<btCollisionShape*>(ObjectMotionState::getShapeManager()->getShape(shapeInfo));
+                    btCollisionShape* shape = const_cast<btCollisionShape*>(ObjectMotionState::getShapeManager()->requestShape(shapeInfo));
                     if (shape) {
                         object->setShape(shape);
                         handledFlags |= Simulation::DIRTY_SHAPE;
@@ -0,0 +1,242 @@
+//
+//  ShapeCache.cpp
+//  libraries/physics/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "ShapeCache.h"
+
+#include <functional>
+
+#include <QDataStream>
+#include <QFile>
+#include <QRunnable>
+#include <QThreadPool>
+
+#include <HashKey.h>
+#include <SettingHandle.h>
+
+#include "PhysicsLogging.h"
+#include "ShapeFactory.h"
+
+using File = cache::File;
+
+// Whenever a change is made to the serialized format for the shape cache that isn't backward compatible,
+// this value should be incremented.  This will force the shape cache to be wiped
+const int ShapeCache::CURRENT_VERSION = 0x01;
+const int ShapeCache::INVALID_VERSION = 0x00;
+const char* ShapeCache::SETTING_VERSION_NAME = "hifi.physics.shape_cache_version";
+
+static const quint32 SHAPE_CACHE_MAGIC = 0x43534648; // "HFSC"
+
+enum SerializedShapeKind : quint8 {
+    SERIALIZED_CONVEX_HULL = 0,
+    SERIALIZED_COMPOUND = 1
+};
+
+namespace {
+
+class ShapeCacheTask : public QRunnable {
+public:
+    ShapeCacheTask(std::function<void()> task) : _task(task) {}
+    void run() override { _task(); }
+private:
+    std::function<void()> _task;
+};
+
+bool writeShape(QDataStream& stream, const btCollisionShape* shape) {
+    int shapeType = shape->getShapeType();
+    if (shapeType == (int)CONVEX_HULL_SHAPE_PROXYTYPE) {
+        const btConvexHullShape* hull = static_cast<const btConvexHullShape*>(shape);
+        int32_t numPoints = hull->getNumPoints();
+        const btVector3* points = hull->getUnscaledPoints();
+        stream << (quint8)SERIALIZED_CONVEX_HULL << (float)hull->getMargin() << (quint32)numPoints;
+        for (int32_t i = 0; i < numPoints; ++i) {
+            stream << (float)points[i].getX() << (float)points[i].getY() << (float)points[i].getZ();
+        }
+        return true;
+    } else if (shapeType == (int)COMPOUND_SHAPE_PROXYTYPE) {
+        const btCompoundShape* compound = static_cast<const btCompoundShape*>(shape);
+        int32_t numChildren = compound->getNumChildShapes();
+        stream << (quint8)SERIALIZED_COMPOUND << (quint32)numChildren;
+        for (int32_t i = 0; i < numChildren; ++i) {
+            const btTransform& transform = compound->getChildTransform(i);
+            const btVector3& origin = transform.getOrigin();
+            btQuaternion rotation = transform.getRotation();
+            stream << (float)origin.getX() << (float)origin.getY() << (float)origin.getZ();
+            stream << (float)rotation.getX() << (float)rotation.getY() << (float)rotation.getZ() << (float)rotation.getW();
+            if (!writeShape(stream, compound->getChildShape(i))) {
+                return false;
+            }
+        }
+        return true;
+    }
+    // unsupported shape type
+    return false;
+}
+
+btCollisionShape* readShape(QDataStream& stream) {
+    quint8 kind;
+    stream >> kind;
+    if (stream.status() != QDataStream::Ok) {
+        return nullptr;
+    }
+    if (kind == SERIALIZED_CONVEX_HULL) {
+        float margin;
+        quint32 numPoints;
+        stream >> margin >> numPoints;
+        if (stream.status() != QDataStream::Ok || numPoints == 0) {
+            return nullptr;
+        }
+        btConvexHullShape* hull = new btConvexHullShape();
+        hull->setMargin(margin);
+        for (quint32 i = 0; i < numPoints; ++i) {
+            float x, y, z;
+            stream >> x >> y >> z;
+            hull->addPoint(btVector3(x, y, z), false);
+        }
+        if (stream.status() != QDataStream::Ok) {
+            delete hull;
+            return nullptr;
+        }
+        hull->recalcLocalAabb();
+        return hull;
+    } else if (kind == SERIALIZED_COMPOUND) {
+        quint32 numChildren;
+        stream >> numChildren;
+        if (stream.status() != QDataStream::Ok) {
+            return nullptr;
+        }
+        btCompoundShape* compound = new btCompoundShape();
+        for (quint32 i = 0; i < numChildren; ++i) {
+            float x, y, z, qx, qy, qz, qw;
+            stream >> x >> y >> z >> qx >> qy >> qz >> qw;
+            btCollisionShape* child = readShape(stream);
+            if (!child) {
+                ShapeFactory::deleteShape(compound);
+                return nullptr;
+            }
+            btTransform transform(btQuaternion(qx, qy, qz, qw), btVector3(x, y, z));
+            compound->addChildShape(transform, child);
+        }
+        compound->recalculateLocalAabb();
+        return compound;
+    }
+    return nullptr;
+}
+
+}
+
+ShapeCache::ShapeCache(const std::string& dir, const std::string& ext) :
+    FileCache(dir, ext) { }
+
+void ShapeCache::initialize() {
+    FileCache::initialize();
+    Setting::Handle<int> cacheVersionHandle(SETTING_VERSION_NAME, INVALID_VERSION);
+    auto cacheVersion = cacheVersionHandle.get();
+    if (cacheVersion != CURRENT_VERSION) {
+        wipe();
+        cacheVersionHandle.set(CURRENT_VERSION);
+    }
+}
+
+std::unique_ptr<File> ShapeCache::createFile(Metadata&& metadata, const std::string& filepath) {
+    qCDebug(physics) << "Wrote shape" << metadata.key.c_str();
+    return FileCache::createFile(std::move(metadata), filepath);
+}
+
+bool ShapeCache::isCacheableType(ShapeType type) {
+    // these are the types that require convex hull construction from (possibly many) points
+    return type == SHAPE_TYPE_COMPOUND || type == SHAPE_TYPE_SIMPLE_COMPOUND || type == SHAPE_TYPE_SIMPLE_HULL;
+}
+
+uint64_t ShapeCache::computePointsChecksum(const ShapeInfo& info) {
+    HashKey::Hasher hasher;
+    const ShapeInfo::PointCollection& pointCollection = info.getPointCollection();
+    for (const auto& points : pointCollection) {
+        hasher.hashUint64((uint64_t)points.size());
+        for (const auto& point : points) {
+            hasher.hashVec3(point);
+        }
+    }
+    const ShapeInfo::TriangleIndices& triangleIndices = info.getTriangleIndices();
+    hasher.hashUint64((uint64_t)triangleIndices.size());
+    for (int32_t index : triangleIndices) {
+        hasher.hashUint64((uint64_t)(uint32_t)index);
+    }
+    return hasher.getHash64();
+}
+
+QByteArray ShapeCache::serializeShape(const btCollisionShape* shape) {
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    stream << SHAPE_CACHE_MAGIC << (quint32)CURRENT_VERSION;
+    if (!writeShape(stream, shape)) {
+        data.clear();
+    }
+    return data;
+}
+
+const btCollisionShape* ShapeCache::deserializeShape(const QByteArray& data) {
+    QDataStream stream(data);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    quint32 magic;
+    quint32 version;
+    stream >> magic >> version;
+    if (stream.status() != QDataStream::Ok || magic != SHAPE_CACHE_MAGIC || version != (quint32)CURRENT_VERSION) {
+        return nullptr;
+    }
+    return readShape(stream);
+}
+
+ShapeCache::Key ShapeCache::getKey(const ShapeInfo& info) {
+    // the ShapeInfo hash of compound shapes doesn't cover their points so we append a checksum of those:
+    // when the content behind a url changes we miss and the stale entry eventually ages out of the cache
+    return (QString::number(info.getHash(), 16) + "-" + QString::number(computePointsChecksum(info), 16)).toStdString();
+}
+
+QByteArray ShapeCache::readEntry(const Key& key) {
+    QByteArray data;
+    auto file = getFile(key);
+    if (file) {
+        QFile inputFile(file->getFilepath().c_str());
+        if (inputFile.open(QIODevice::ReadOnly)) {
+            data = inputFile.readAll();
+        }
+    }
+    return data;
+}
+
+const btCollisionShape* ShapeCache::loadShape(const ShapeInfo& info) {
+    if (!isCacheableType(info.getType())) {
+        return nullptr;
+    }
+    QByteArray data = readEntry(getKey(info));
+    if (data.isEmpty()) {
+        return nullptr;
+    }
+    return deserializeShape(data);
+}
+
+void ShapeCache::saveShape(const ShapeInfo& info, const btCollisionShape* shape) {
+    if (!shape || !isCacheableType(info.getType())) {
+        return;
+    }
+    // serialize now, while the caller still guarantees the shape is alive, and write later
+    QByteArray data = serializeShape(shape);
+    if (data.isEmpty()) {
+        return;
+    }
+    Key key = getKey(info);
+    auto self = std::static_pointer_cast<ShapeCache>(shared_from_this());
+    QThreadPool::globalInstance()->start(new ShapeCacheTask([self, key, data] {
+        if (!self->getFile(key)) {
+            self->writeFile(data.data(), Metadata(key, data.size()));
+        }
+    }));
+}
@@ -0,0 +1,70 @@
+//
+//  ShapeCache.h
+//  libraries/physics/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ShapeCache_h
+#define hifi_ShapeCache_h
+
+#include <QByteArray>
+#include <btBulletDynamicsCommon.h>
+
+#include <ShapeInfo.h>
+#include <shared/FileCache.h>
+
+// The ShapeCache persists the convex hulls built by the ShapeFactory to disk so that heavy
+// compound shapes need not be rebuilt from mesh points in every session.
+//
+// Entries are keyed by the ShapeInfo hash.  Since that hash does not cover the points of
+// compound shapes (only their url, extents and hull count) the key also carries a checksum
+// of the source points, so a model whose content changed behind the same url misses the cache.
+//
+// Only shapes made entirely of btConvexHullShapes (optionally nested in a btCompoundShape)
+// are cached.  Everything else is cheap to build or, like the static mesh, has an acceleration
+// structure we don't serialize.
+
+class ShapeCache : public cache::FileCache {
+    Q_OBJECT
+
+public:
+    // Whenever a change is made to the serialized format for the shape cache that isn't backward compatible,
+    // this value should be incremented.  This will force the shape cache to be wiped
+    static const int CURRENT_VERSION;
+    static const int INVALID_VERSION;
+    static const char* SETTING_VERSION_NAME;
+
+    ShapeCache(const std::string& dir, const std::string& ext);
+
+    void initialize() override;
+
+    static bool isCacheableType(ShapeType type);
+
+    /// reads the disk, so call this from a worker thread
+    /// \return new shape built from the persisted entry, or nullptr on miss
+    /// (caller takes ownership and must release it with ShapeFactory::deleteShape)
+    const btCollisionShape* loadShape(const ShapeInfo& info);
+
+    /// persist shape on a background thread
+    void saveShape(const ShapeInfo& info, const btCollisionShape* shape);
+
+    /// \return empty array if shape contains anything other than convex hulls
+    static QByteArray serializeShape(const btCollisionShape* shape);
+    static const btCollisionShape* deserializeShape(const QByteArray& data);
+    static uint64_t computePointsChecksum(const ShapeInfo& info);
+
+protected:
+    std::unique_ptr<cache::File> createFile(Metadata&& metadata, const std::string& filepath) override final;
+
+private:
+    static Key getKey(const ShapeInfo& info);
+    QByteArray readEntry(const Key& key);
+};
+
+using ShapeCachePointer = std::shared_ptr<ShapeCache>;
+
+#endif // hifi_ShapeCache_h
@@ -16,6 +16,7 @@
 #include <SharedUtil.h> // for MILLIMETERS_PER_METER
 
 #include "BulletUtil.h"
+#include "ShapeCache.h"
 
 
 class StaticMeshShape : public btBvhTriangleMeshShape {
@@ -489,6 +490,15 @@ void ShapeFactory::deleteShape(const btCollisionShape* shape) {
 }
 
 void ShapeFactory::Worker::run() {
-    shape = ShapeFactory::createShapeFromInfo(shapeInfo);
+    if (shapeCache) {
+        shape = shapeCache->loadShape(shapeInfo);
+        isCacheHit = (shape != nullptr);
+    }
+    if (!shape) {
+        shape = ShapeFactory::createShapeFromInfo(shapeInfo);
+        if (shapeCache) {
+            shapeCache->saveShape(shapeInfo, shape);
+        }
+    }
     emit submitWork(this);
 }
@@ -12,6 +12,8 @@
 #ifndef hifi_ShapeFactory_h
 #define hifi_ShapeFactory_h
 
+#include <memory>
+
 #include <btBulletDynamicsCommon.h>
 #include <glm/glm.hpp>
 #include <QObject>
@@ -21,6 +23,8 @@
 
 // The ShapeFactory assembles and correctly disassembles btCollisionShapes.
 
+class ShapeCache;
+
 namespace ShapeFactory {
     const btCollisionShape* createShapeFromInfo(const ShapeInfo& info);
     void deleteShape(const btCollisionShape* shape);
@@ -32,6 +36,8 @@ namespace ShapeFactory {
         void run() override;
         ShapeInfo shapeInfo;
         const btCollisionShape* shape;
+        std::shared_ptr<ShapeCache> shapeCache; // when set: load shape from here if possible, else build and save it
+        bool isCacheHit { false };
     signals:
         void submitWork(Worker*);
     };
@@ -48,30 +48,7 @@ const btCollisionShape* ShapeManager::getShape(const ShapeInfo& info) {
     }
     const btCollisionShape* shape = nullptr;
     if (info.getType() == SHAPE_TYPE_STATIC_MESH) {
-        uint64_t hash = info.getHash();
-
-        // bump the request count to the caller knows we're 
-        // starting or waiting on a thread.
-        ++_workRequestCount;
-
-        const auto itr = std::find(_pendingMeshShapes.begin(), _pendingMeshShapes.end(), hash);
-        if (itr == _pendingMeshShapes.end()) {
-            // start a worker
-            _pendingMeshShapes.push_back(hash);
-            // try to recycle old deadWorker
-            ShapeFactory::Worker* worker = _deadWorker;
-            if (!worker) {
-                worker = new ShapeFactory::Worker(info);
-            } else {
-                worker->shapeInfo = info;
-                _deadWorker = nullptr;
-            }
-            // we will delete worker manually later
-            worker->setAutoDelete(false);
-            QObject::connect(worker, &ShapeFactory::Worker::submitWork, this, &ShapeManager::acceptWork);
-            QThreadPool::globalInstance()->start(worker);
-        }
-        // else we're still waiting for the shape to be created on another thread
+        startWorker(info, nullptr);
     } else {
         shape = ShapeFactory::createShapeFromInfo(info);
         if (shape) {
@@ -80,11 +57,58 @@ const btCollisionShape* ShapeManager::getShape(const ShapeInfo& info) {
             newRef.shape = shape;
             newRef.key = info.getHash();
             _shapeMap.insert(hashKey, newRef);
+            if (_shapeCache) {
+                _shapeCache->saveShape(info, shape);
+            }
         }
     }
     return shape;
 }
 
+const btCollisionShape* ShapeManager::requestShape(const ShapeInfo& info) {
+    if (!_shapeCache || !ShapeCache::isCacheableType(info.getType())) {
+        return getShape(info);
+    }
+    HashKey hashKey(info.getHash());
+    ShapeReference* shapeRef = _shapeMap.find(hashKey);
+    if (shapeRef) {
+        shapeRef->refCount++;
+        return shapeRef->shape;
+    }
+    // the worker reads the ShapeCache so the disk is never touched on this thread
+    startWorker(info, _shapeCache);
+    return nullptr;
+}
+
+// private helper method
+void ShapeManager::startWorker(const ShapeInfo& info, const ShapeCachePointer& shapeCache) {
+    uint64_t hash = info.getHash();
+
+    // bump the request count to the caller knows we're
+    // starting or waiting on a thread.
+    ++_workRequestCount;
+
+    const auto itr = std::find(_pendingMeshShapes.begin(), _pendingMeshShapes.end(), hash);
+    if (itr == _pendingMeshShapes.end()) {
+        // start a worker
+        _pendingMeshShapes.push_back(hash);
+        // try to recycle old deadWorker
+        ShapeFactory::Worker* worker = _deadWorker;
+        if (!worker) {
+            worker = new ShapeFactory::Worker(info);
+        } else {
+            worker->shapeInfo = info;
+            _deadWorker = nullptr;
+        }
+        worker->shapeCache = shapeCache;
+        // we will delete worker manually later
+        worker->setAutoDelete(false);
+        QObject::connect(worker, &ShapeFactory::Worker::submitWork, this, &ShapeManager::acceptWork);
+        QThreadPool::globalInstance()->start(worker);
+    }
+    // else we're still waiting for the shape to be created on another thread
+}
+
 const btCollisionShape* ShapeManager::getShapeByKey(uint64_t key) {
     HashKey hashKey(key);
     ShapeReference* shapeRef = _shapeMap.find(hashKey);
@@ -274,9 +298,15 @@ void ShapeManager::acceptWork(ShapeFactory::Worker* worker) {
         // delete the previous deadWorker manually
         delete _deadWorker;
     }
+    if (worker->isCacheHit) {
+        ++_cacheHitCount;
+    }
+
     // save this dead worker for later
     worker->shapeInfo.clear();
     worker->shape = nullptr;
+    worker->shapeCache.reset();
+    worker->isCacheHit = false;
     _deadWorker = worker;
     ++_workDeliveryCount;
 }
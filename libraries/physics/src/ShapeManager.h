@@ -22,6 +22,7 @@
 
 #include <ShapeInfo.h>
 
+#include "ShapeCache.h"
 #include "ShapeFactory.h"
 #include "HashKey.h"
 
@@ -46,6 +47,9 @@
 // doesn't delete it right away.  Instead it puts the shape's key on a list delete
 // later.  When that list grows big enough the ShapeManager will remove any matching
 // entries that still have zero ref-count.
+//
+// When a ShapeCache is supplied the ShapeManager will persist newly built hull shapes there, and
+// requestShape() will look for them on disk, on a worker thread, before building them again.
 
 
 class ShapeManager : public QObject {
@@ -55,8 +59,16 @@ public:
     ShapeManager();
     ~ShapeManager();
 
+    void setShapeCache(const ShapeCachePointer& shapeCache) { _shapeCache = shapeCache; }
+    const ShapeCachePointer& getShapeCache() const { return _shapeCache; }
+
     /// \return pointer to shape
     const btCollisionShape* getShape(const ShapeInfo& info);
+
+    /// like getShape() but shapes that may be in the ShapeCache are loaded (or built) on a worker thread:
+    /// \return pointer to shape, or nullptr while the work request is pending
+    const btCollisionShape* requestShape(const ShapeInfo& info);
+
     const btCollisionShape* getShapeByKey(uint64_t key);
     bool hasShapeWithKey(uint64_t key) const;
 
@@ -73,11 +85,13 @@ public:
     bool hasShape(const btCollisionShape* shape) const;
     uint32_t getWorkRequestCount() const { return _workRequestCount; }
     uint32_t getWorkDeliveryCount() const { return _workDeliveryCount; }
+    uint32_t getCacheHitCount() const { return _cacheHitCount; }
 
 protected slots:
     void acceptWork(ShapeFactory::Worker* worker);
 
 private:
+    void startWorker(const ShapeInfo& info, const ShapeCachePointer& shapeCache);
     void addToGarbage(uint64_t key);
     bool releaseShapeByKey(uint64_t key);
 
@@ -102,11 +116,13 @@ private:
     std::vector<uint64_t> _garbageRing;
     std::vector<uint64_t> _pendingMeshShapes;
     std::vector<KeyExpiry> _orphans;
+    ShapeCachePointer _shapeCache;
     ShapeFactory::Worker* _deadWorker { nullptr };
     TimePoint _nextOrphanExpiry;
     uint32_t _ringIndex { 0 };
     std::atomic_uint _workRequestCount { 0 };
     std::atomic_uint _workDeliveryCount { 0 };
+    uint32_t _cacheHitCount { 0 };
 };
 
 #endif // hifi_ShapeManager_h
@@ -26,3 +26,33 @@ QSharedPointer<Dependency> DependencyManager::safeGet(size_t hashCode) const {
     return _instanceHash.value(hashCode);
 }
 
+const int DependencyManager::MAX_SLOTS;
+
+int DependencyManager::getSlot(size_t hashCode) {
+    QMutexLocker lock(&_instanceHashMutex);
+    auto slot = _slotIndices.find(hashCode);
+    if (slot != _slotIndices.end()) {
+        return slot.value();
+    }
+
+    // slots that couldn't be handed out are in there too, as -1
+    int numSlots = _slotIndices.size();
+    if (numSlots >= MAX_SLOTS) {
+        qWarning() << "DependencyManager: out of slots, ref() falls back to get() for new dependencies";
+        _slotIndices.insert(hashCode, -1);
+        return -1;
+    }
+
+    // hand the slot out with whatever is set for the type already
+    auto instance = _instanceHash.value(hashCode);
+    _slots[numSlots].store(instance.data(), std::memory_order_release);
+    _slotIndices.insert(hashCode, numSlots);
+    return numSlots;
+}
+
+void DependencyManager::publish(size_t hashCode, Dependency* instance) {
+    int slot = getSlot(hashCode);
+    if (slot >= 0) {
+        _slots[slot].store(instance, std::memory_order_release);
+    }
+}
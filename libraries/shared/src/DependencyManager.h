@@ -19,6 +19,7 @@
 #include <QWeakPointer>
 #include <QMutex>
 
+#include <atomic>
 #include <functional>
 #include <typeinfo>
 
@@ -43,6 +44,7 @@ protected:
 
 // usage:
 //     auto instance = DependencyManager::get<T>();
+//     auto pointer = DependencyManager::ref<T>();
 //     auto instance = DependencyManager::set<T>(Args... args);
 //     DependencyManager::destroy<T>();
 //     DependencyManager::registerInheritance<Base, Derived>();
@@ -51,6 +53,12 @@ public:
     template<typename T>
     static QSharedPointer<T> get();
 
+    // Non-owning access for hot paths, without locking or refcounting once the dependency is set.
+    // The pointer is only good until the dependency is destroyed or replaced, so it is meant for
+    // dependencies that live until shutdown, and shouldn't be held on to past the call site.
+    template<typename T>
+    static T* ref();
+
     template<typename T>
     static bool isSet();
 
@@ -86,9 +94,20 @@ private:
 
     QSharedPointer<Dependency> safeGet(size_t hashCode) const;
 
+    // every dependency type gets a slot the first time it is set or asked for,
+    // -1 once they have all been handed out
+    int getSlot(size_t hashCode);
+    void publish(size_t hashCode, Dependency* instance);
+
+    static const int MAX_SLOTS = 1024;
+
     QHash<size_t, QSharedPointer<Dependency>> _instanceHash;
     QHash<size_t, size_t> _inheritanceHash;
 
+    // the instances in _instanceHash, by slot, for ref()
+    std::atomic<Dependency*> _slots[MAX_SLOTS] {};
+    QHash<size_t, int> _slotIndices; // guarded by _instanceHashMutex
+
     mutable QMutex _instanceHashMutex { QMutex::Recursive };
     mutable QMutex _inheritanceHashMutex;
 
@@ -121,6 +140,20 @@ QSharedPointer<T> DependencyManager::get() {
     return instance.toStrongRef();
 }
 
+template <typename T>
+T* DependencyManager::ref() {
+    static int slot = manager().getSlot(manager().getHashCode<T>());
+    if (slot < 0) {
+        return get<T>().data();
+    }
+
+    Dependency* instance = manager()._slots[slot].load(std::memory_order_acquire);
+    if (!instance && !manager()._exiting) {
+        qWarning() << "DependencyManager::ref(): No instance available for" << typeid(T).name();
+    }
+    return static_cast<T*>(instance);
+}
+
 template <typename T>
 bool DependencyManager::isSet() {
     static size_t hashCode = manager().getHashCode<T>();
@@ -137,11 +170,13 @@ QSharedPointer<T> DependencyManager::set(Args&&... args) {
     // clear the previous instance before constructing the new instance
     auto iter = manager()._instanceHash.find(hashCode);
     if (iter != manager()._instanceHash.end()) {
+        manager().publish(hashCode, nullptr);
         iter.value().clear();
     }
 
     QSharedPointer<T> newInstance(new T(args...), &T::customDeleter);
     manager()._instanceHash.insert(hashCode, newInstance);
+    manager().publish(hashCode, newInstance.data());
 
     return newInstance;
 }
@@ -154,11 +189,13 @@ QSharedPointer<T> DependencyManager::set(Args&&... args) {
     // clear the previous instance before constructing the new instance
     auto iter = manager()._instanceHash.find(hashCode);
     if (iter != manager()._instanceHash.end()) {
+        manager().publish(hashCode, nullptr);
         iter.value().clear();
     }
 
     QSharedPointer<T> newInstance(new I(args...), &I::customDeleter);
     manager()._instanceHash.insert(hashCode, newInstance);
+    manager().publish(hashCode, newInstance.data());
 
     return newInstance;
 }
@@ -168,6 +205,7 @@ void DependencyManager::destroy() {
     static size_t hashCode = manager().getHashCode<T>();
 
     QMutexLocker lock(&manager()._instanceHashMutex);
+    manager().publish(hashCode, nullptr);
     QSharedPointer<Dependency> shared = manager()._instanceHash.take(hashCode);
     QWeakPointer<Dependency> weak = shared;
     shared.clear();
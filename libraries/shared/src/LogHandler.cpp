@@ -12,6 +12,9 @@
 
 #include "LogHandler.h"
 
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <mutex>
 
 #ifdef Q_OS_WIN
@@ -21,11 +24,74 @@
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDateTime>
 #include <QtCore/QDebug>
-#include <QtCore/QMutexLocker>
+#include <QtCore/QHash>
 #include <QtCore/QThread>
-#include <QtCore/QTimer>
 
-QMutex LogHandler::_mutex(QMutex::Recursive);
+struct LogHandler::QueuedMessage {
+    std::atomic<QueuedMessage*> next { nullptr };
+    LogMsgType type { LogDebug };
+    qint64 timestamp { 0 };
+    size_t threadID { 0 };
+    // copied, since categories and qml file names may not outlive the message
+    QByteArray category;
+    QString file;
+    QString message;
+    int repeatedMessageID { -1 };
+};
+
+// A call site is its file and line.  In release builds the context has neither, so it falls back on the category
+// and the start of the message.  The key of a lookup only wraps the logged strings, it is copied when inserted.
+struct CallSiteKey {
+    QByteArray file;
+    int line;
+    const char* category;
+    QString messagePrefix;
+
+    bool operator==(const CallSiteKey& other) const {
+        return line == other.line && category == other.category && file == other.file &&
+            messagePrefix == other.messagePrefix;
+    }
+};
+
+static uint qHash(const CallSiteKey& key) {
+    return qHash(key.file) ^ qHash(key.line) ^ qHash((quintptr)key.category) ^ qHash(key.messagePrefix);
+}
+
+static const int CALL_SITE_MESSAGE_PREFIX_LENGTH = 16;
+
+static CallSiteKey getCallSiteKey(const QMessageLogContext& context, const QString& message) {
+    if (context.file) {
+        return { QByteArray::fromRawData(context.file, (int)strlen(context.file)), context.line, context.category, QString() };
+    }
+    return { QByteArray(), 0, context.category,
+             QString::fromRawData(message.constData(), std::min(message.size(), CALL_SITE_MESSAGE_PREFIX_LENGTH)) };
+}
+
+// the messages a call site logged in its current second, and those it had suppressed since they were last reported
+struct CallSiteWindow {
+    uint32_t second { 0 };
+    int count { 0 };
+    int suppressedCount { 0 };
+    QByteArray category;
+    QString lastSuppressedMessage;
+};
+
+// The call sites are spread across shards so that threads logging from different ones rarely wait on each other.
+// The writer drops the windows of the call sites that went quiet, so the shards only hold the recent ones.
+struct CallSiteShard {
+    std::mutex mutex;
+    QHash<CallSiteKey, CallSiteWindow> windows;
+};
+static const int NUM_CALL_SITE_SHARDS = 64;
+static const int MAX_CALL_SITES_PER_SHARD = 256;
+static std::array<CallSiteShard, NUM_CALL_SITE_SHARDS> callSiteShards;
+
+static uint32_t getCurrentSecond() {
+    using namespace std::chrono;
+    return (uint32_t)duration_cast<seconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static const std::chrono::milliseconds WRITER_WAIT_INTERVAL { 100 };
 
 LogHandler& LogHandler::getInstance() {
     static LogHandler staticInstance;
@@ -33,11 +99,22 @@ LogHandler& LogHandler::getInstance() {
 }
 
 LogHandler::LogHandler() {
-    // make sure we setup the repeated message flusher, but do it on the LogHandler thread	
-    QMetaObject::invokeMethod(this, "setupRepeatedMessageFlusher");
+    // the queue starts with a stub message that is never output
+    auto stub = new QueuedMessage();
+    _queueHead.store(stub);
+    _queueTail = stub;
+    _lastRepeatedMessagesFlush = std::chrono::steady_clock::now();
 }
 
 LogHandler::~LogHandler() {
+    _isStopping = true;
+    _writerCondition.notify_one();
+    if (_writerThread.joinable()) {
+        _writerThread.join();
+    }
+    flush();
+    flushSuppressedMessages(true);
+    delete _queueTail;
 }
 
 const char* stringForLogType(LogMsgType msgType) {
@@ -66,48 +143,33 @@ const QString DATE_STRING_FORMAT = "MM/dd hh:mm:ss";
 const QString DATE_STRING_FORMAT_WITH_MILLISECONDS = "MM/dd hh:mm:ss.zzz";
 
 void LogHandler::setTargetName(const QString& targetName) {
-    QMutexLocker lock(&_mutex);
+    std::lock_guard<std::mutex> lock(_settingsMutex);
     _targetName = targetName;
 }
 
 void LogHandler::setShouldOutputProcessID(bool shouldOutputProcessID) {
-    QMutexLocker lock(&_mutex);
     _shouldOutputProcessID = shouldOutputProcessID;
 }
 
 void LogHandler::setShouldOutputThreadID(bool shouldOutputThreadID) {
-    QMutexLocker lock(&_mutex);
     _shouldOutputThreadID = shouldOutputThreadID;
 }
 
 void LogHandler::setShouldDisplayMilliseconds(bool shouldDisplayMilliseconds) {
-    QMutexLocker lock(&_mutex);
     _shouldDisplayMilliseconds = shouldDisplayMilliseconds;
 }
 
-
-void LogHandler::flushRepeatedMessages() {
-    QMutexLocker lock(&_mutex);
-
-    // New repeat-suppress scheme:
-    for (int m = 0; m < (int)_repeatedMessageRecords.size(); ++m) {
-        int repeatCount = _repeatedMessageRecords[m].repeatCount;
-        if (repeatCount > 1) {
-            QString repeatLogMessage = QString().setNum(repeatCount) + " repeated log entries - Last entry: \"" 
-                    + _repeatedMessageRecords[m].repeatString + "\"";
-            printMessage(LogSuppressed, QMessageLogContext(), repeatLogMessage);
-            _repeatedMessageRecords[m].repeatCount = 0;
-            _repeatedMessageRecords[m].repeatString = QString();
-        }
-    }
+void LogHandler::setMaxMessagesPerSecond(int maxMessagesPerSecond) {
+    _maxMessagesPerSecond = maxMessagesPerSecond;
 }
 
-QString LogHandler::printMessage(LogMsgType type, const QMessageLogContext& context, const QString& message) {
-    if (message.isEmpty()) {
-        return QString();
-    }
-    QMutexLocker lock(&_mutex);
+void LogHandler::setOutputFunction(const OutputFunction& outputFunction) {
+    std::lock_guard<std::mutex> lock(_settingsMutex);
+    _outputFunction = outputFunction;
+}
 
+QString LogHandler::formatMessage(LogMsgType type, qint64 timestamp, size_t threadID, const char* category,
+                                  const QString& file, const QString& message) {
     // log prefix is in the following format
     // [TIMESTAMP] [DEBUG] [PID] [TID] [TARGET] logged string
 
@@ -116,74 +178,332 @@ QString LogHandler::printMessage(LogMsgType type, const QMessageLogContext& cont
         dateFormatPtr = &DATE_STRING_FORMAT_WITH_MILLISECONDS;
     }
 
-    QString prefixString = QString("[%1] [%2] [%3]").arg(QDateTime::currentDateTime().toString(*dateFormatPtr),
-        stringForLogType(type), context.category);
+    QString prefixString = QString("[%1] [%2] [%3]").arg(QDateTime::fromMSecsSinceEpoch(timestamp).toString(*dateFormatPtr),
+        stringForLogType(type), category);
 
     if (_shouldOutputProcessID) {
         prefixString.append(QString(" [%1]").arg(QCoreApplication::applicationPid()));
     }
 
     if (_shouldOutputThreadID) {
-        size_t threadID = (size_t)QThread::currentThreadId();
         prefixString.append(QString(" [%1]").arg(threadID));
     }
 
-    if (!_targetName.isEmpty()) {
-        prefixString.append(QString(" [%1]").arg(_targetName));
+    QString targetName;
+    {
+        std::lock_guard<std::mutex> lock(_settingsMutex);
+        targetName = _targetName;
+    }
+    if (!targetName.isEmpty()) {
+        prefixString.append(QString(" [%1]").arg(targetName));
     }
 
     // for [qml] console.* messages include an abbreviated source filename
+    if (!file.isEmpty()) {
+        prefixString.append(QString(" [%1]").arg(file));
+    }
+
+    return QString("%1 %2\n").arg(prefixString, message.split('\n').join('\n' + prefixString + " "));
+}
+
+// the abbreviated source filename of [qml] console.* messages
+static QString getQmlFile(const QMessageLogContext& context) {
     if (context.category && context.file && !strcmp("qml", context.category)) {
         if (const char* basename = strrchr(context.file, '/')) {
-            prefixString.append(QString(" [%1]").arg(basename+1));
+            return QString(basename + 1);
         }
     }
+    return QString();
+}
 
-    QString logMessage = QString("%1 %2\n").arg(prefixString, message.split('\n').join('\n' + prefixString + " "));
+void LogHandler::output(const QString& lines) {
+    OutputFunction outputFunction;
+    {
+        std::lock_guard<std::mutex> lock(_settingsMutex);
+        outputFunction = _outputFunction;
+    }
+    if (outputFunction) {
+        outputFunction(lines);
+        return;
+    }
 
-    fprintf(stdout, "%s", qPrintable(logMessage));
+    fprintf(stdout, "%s", qPrintable(lines));
 #ifdef Q_OS_WIN
     // On windows, this will output log lines into the Visual Studio "output" tab
-    OutputDebugStringA(qPrintable(logMessage));
+    OutputDebugStringA(qPrintable(lines));
 #endif
+}
+
+QString LogHandler::printMessage(LogMsgType type, const QMessageLogContext& context, const QString& message) {
+    if (message.isEmpty()) {
+        return QString();
+    }
+
+    QString logMessage = formatMessage(type, QDateTime::currentMSecsSinceEpoch(), (size_t)QThread::currentThreadId(),
+                                       context.category, getQmlFile(context), message);
+    output(logMessage);
     return logMessage;
 }
 
-void LogHandler::verboseMessageHandler(QtMsgType type, const QMessageLogContext& context, const QString& message) {
-    getInstance().printMessage((LogMsgType) type, context, message);
+bool LogHandler::isAdmitted(LogMsgType type, const QMessageLogContext& context, const QString& message,
+                            int& suppressedCount) {
+    // only the chatty levels are limited, a warning is never lost to a flood of debug messages
+    if (type != LogDebug && type != LogInfo) {
+        return true;
+    }
+
+    int maxMessagesPerSecond = _maxMessagesPerSecond.load(std::memory_order_relaxed);
+    if (maxMessagesPerSecond <= 0) {
+        return true;
+    }
+
+    auto key = getCallSiteKey(context, message);
+    auto& shard = callSiteShards[qHash(key) % NUM_CALL_SITE_SHARDS];
+    auto second = getCurrentSecond();
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.windows.find(key);
+    if (it == shard.windows.end()) {
+        if (shard.windows.size() >= MAX_CALL_SITES_PER_SHARD) {
+            // too many call sites at once to track, let it through until the writer drops the quiet ones
+            return true;
+        }
+        CallSiteKey ownedKey { QByteArray(key.file.constData(), key.file.size()), key.line, key.category,
+                               QString(key.messagePrefix.constData(), key.messagePrefix.size()) };
+        CallSiteWindow window;
+        window.category = context.category;
+        it = shard.windows.insert(ownedKey, window);
+    }
+
+    auto& window = it.value();
+    if (window.second != second) {
+        // the first message of a second reports what the call site had suppressed before it
+        window.second = second;
+        window.count = 0;
+        suppressedCount = window.suppressedCount;
+        window.suppressedCount = 0;
+        window.lastSuppressedMessage = QString();
+    }
+
+    if (window.count >= maxMessagesPerSecond) {
+        ++window.suppressedCount;
+        window.lastSuppressedMessage = message;
+        return false;
+    }
+    ++window.count;
+    return true;
 }
 
-void LogHandler::setupRepeatedMessageFlusher() {
-    static std::once_flag once;
-    std::call_once(once, [&] {
-        // setup our timer to flush the verbose logs every 5 seconds
-        QTimer* logFlushTimer = new QTimer(this);
-        connect(logFlushTimer, &QTimer::timeout, this, &LogHandler::flushRepeatedMessages);
-        logFlushTimer->start(VERBOSE_LOG_INTERVAL_SECONDS * 1000);
+void LogHandler::pushMessage(QueuedMessage* queuedMessage) {
+    auto previous = _queueHead.exchange(queuedMessage, std::memory_order_acq_rel);
+    previous->next.store(queuedMessage, std::memory_order_release);
+
+    // the writer wakes up on its own every WRITER_WAIT_INTERVAL, a wake up missed here only delays output
+    if (_isWriterWaiting.exchange(false, std::memory_order_relaxed)) {
+        _writerCondition.notify_one();
+    }
+}
+
+void LogHandler::queueMessage(LogMsgType type, const QMessageLogContext& context, const QString& message) {
+    if (message.isEmpty()) {
+        return;
+    }
+    if (_isStopping) {
+        printMessage(type, context, message);
+        return;
+    }
+
+    int suppressedCount = 0;
+    if (!isAdmitted(type, context, message, suppressedCount)) {
+        return;
+    }
+    startWriter();
+
+    auto timestamp = QDateTime::currentMSecsSinceEpoch();
+    auto threadID = (size_t)QThread::currentThreadId();
+    if (suppressedCount > 0) {
+        auto suppressedMessage = new QueuedMessage();
+        suppressedMessage->type = LogSuppressed;
+        suppressedMessage->timestamp = timestamp;
+        suppressedMessage->threadID = threadID;
+        suppressedMessage->category = context.category;
+        suppressedMessage->message = QString("%1 log entries suppressed over the rate limit - Next entry: \"%2\"")
+            .arg(suppressedCount).arg(message);
+        pushMessage(suppressedMessage);
+    }
+
+    auto queuedMessage = new QueuedMessage();
+    queuedMessage->type = type;
+    queuedMessage->timestamp = timestamp;
+    queuedMessage->threadID = threadID;
+    queuedMessage->category = context.category;
+    queuedMessage->file = getQmlFile(context);
+    queuedMessage->message = message;
+    pushMessage(queuedMessage);
+}
+
+void LogHandler::startWriter() {
+    std::call_once(_writerStarted, [this] {
+        _writerThread = std::thread([this] {
+            while (!_isStopping) {
+                {
+                    std::unique_lock<std::mutex> lock(_writerWaitMutex);
+                    _isWriterWaiting = true;
+                    _writerCondition.wait_for(lock, WRITER_WAIT_INTERVAL);
+                    _isWriterWaiting = false;
+                }
+                flush();
+                // a burst that ended quietly has no next message to report it
+                flushSuppressedMessages(false);
+
+                auto now = std::chrono::steady_clock::now();
+                if (now - _lastRepeatedMessagesFlush >= std::chrono::seconds(VERBOSE_LOG_INTERVAL_SECONDS)) {
+                    _lastRepeatedMessagesFlush = now;
+                    flushRepeatedMessages();
+                }
+            }
+        });
     });
 }
 
+void LogHandler::writeQueuedMessages() {
+    QString lines;
+    while (true) {
+        auto tail = _queueTail;
+        auto next = tail->next.load(std::memory_order_acquire);
+        if (!next) {
+            break;
+        }
+        // the popped message becomes the new stub
+        _queueTail = next;
+        delete tail;
+
+        auto message = std::move(next->message);
+        if (next->repeatedMessageID >= 0) {
+            if ((int)_repeatedMessageRecords.size() <= next->repeatedMessageID) {
+                _repeatedMessageRecords.resize(next->repeatedMessageID + 1, { 0, QString() });
+            }
+            auto& record = _repeatedMessageRecords[next->repeatedMessageID];
+            ++record.repeatCount;
+            if (record.repeatCount > 1) {
+                record.repeatString = message;
+                continue;
+            }
+        }
+        lines += formatMessage(next->type, next->timestamp, next->threadID, next->category.constData(), next->file, message);
+    }
+
+    if (!lines.isEmpty()) {
+        output(lines);
+    }
+}
+
+void LogHandler::flush() {
+    std::lock_guard<std::mutex> lock(_writeMutex);
+    writeQueuedMessages();
+}
+
+void LogHandler::flushRepeatedMessages() {
+    std::lock_guard<std::mutex> lock(_writeMutex);
+    writeQueuedMessages();
+
+    // New repeat-suppress scheme:
+    QString lines;
+    auto timestamp = QDateTime::currentMSecsSinceEpoch();
+    auto threadID = (size_t)QThread::currentThreadId();
+    for (auto& record : _repeatedMessageRecords) {
+        if (record.repeatCount > 1) {
+            QString repeatLogMessage = QString().setNum(record.repeatCount) + " repeated log entries - Last entry: \""
+                    + record.repeatString + "\"";
+            lines += formatMessage(LogSuppressed, timestamp, threadID, nullptr, QString(), repeatLogMessage);
+            record.repeatCount = 0;
+            record.repeatString = QString();
+        }
+    }
+
+    if (!lines.isEmpty()) {
+        output(lines);
+    }
+}
+
+void LogHandler::flushSuppressedMessages(bool includeCurrentSecond) {
+    struct SuppressedReport {
+        QByteArray category;
+        int count;
+        QString lastMessage;
+    };
+    std::vector<SuppressedReport> reports;
+
+    auto second = getCurrentSecond();
+    for (auto& shard : callSiteShards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (auto it = shard.windows.begin(); it != shard.windows.end();) {
+            auto& window = it.value();
+            if (window.second == second && !includeCurrentSecond) {
+                ++it;
+                continue;
+            }
+            if (window.suppressedCount > 0) {
+                reports.push_back({ window.category, window.suppressedCount, window.lastSuppressedMessage });
+            }
+            // a call site that logs again starts a new window
+            it = shard.windows.erase(it);
+        }
+    }
+
+    if (reports.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_writeMutex);
+    writeQueuedMessages();
+
+    QString lines;
+    auto timestamp = QDateTime::currentMSecsSinceEpoch();
+    auto threadID = (size_t)QThread::currentThreadId();
+    for (const auto& report : reports) {
+        QString suppressedMessage = QString("%1 log entries suppressed over the rate limit - Last entry: \"%2\"")
+            .arg(report.count).arg(report.lastMessage);
+        lines += formatMessage(LogSuppressed, timestamp, threadID, report.category.constData(), QString(),
+                               suppressedMessage);
+    }
+    output(lines);
+}
+
+void LogHandler::verboseMessageHandler(QtMsgType type, const QMessageLogContext& context, const QString& message) {
+    auto& logHandler = getInstance();
+    if (type == QtFatalMsg) {
+        // Qt aborts once the handler returns
+        logHandler.flush();
+        logHandler.printMessage((LogMsgType) type, context, message);
+        return;
+    }
+    logHandler.queueMessage((LogMsgType) type, context, message);
+}
+
 int LogHandler::newRepeatedMessageID() {
-    QMutexLocker lock(&_mutex);
-    int newMessageId = _currentMessageID;
-    ++_currentMessageID;
-    RepeatedMessageRecord newRecord { 0, QString() };
-    _repeatedMessageRecords.push_back(newRecord);
-    return newMessageId;
+    return _currentMessageID.fetch_add(1);
 }
 
 void LogHandler::printRepeatedMessage(int messageID, LogMsgType type, const QMessageLogContext& context,
                                       const QString& message) {
-    QMutexLocker lock(&_mutex);
-    if (messageID >= _currentMessageID) {
+    if (messageID >= _currentMessageID || message.isEmpty()) {
         return;
     }
-
-    if (_repeatedMessageRecords[messageID].repeatCount == 0) {
+    if (_isStopping) {
         printMessage(type, context, message);
-    } else {
-        _repeatedMessageRecords[messageID].repeatString = message;
+        return;
     }
- 
-    ++_repeatedMessageRecords[messageID].repeatCount;
+    startWriter();
+
+    // the repeat counting happens on the writer, which owns the records
+    auto queuedMessage = new QueuedMessage();
+    queuedMessage->type = type;
+    queuedMessage->timestamp = QDateTime::currentMSecsSinceEpoch();
+    queuedMessage->threadID = (size_t)QThread::currentThreadId();
+    queuedMessage->category = context.category;
+    queuedMessage->file = getQmlFile(context);
+    queuedMessage->message = message;
+    queuedMessage->repeatedMessageID = messageID;
+    pushMessage(queuedMessage);
 }
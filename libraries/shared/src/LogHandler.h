@@ -17,11 +17,20 @@
 #include <QString>
 #include <QRegExp>
 #include <QMutex>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <memory>
 
 const int VERBOSE_LOG_INTERVAL_SECONDS = 5;
 
+// the default number of debug and info messages a call site may log each second before the rest are suppressed
+const int DEFAULT_MAX_MESSAGES_PER_SECOND = 50;
+
 enum LogMsgType {
     LogInfo = QtInfoMsg,
     LogDebug = QtDebugMsg,
@@ -45,8 +54,24 @@ public:
     void setShouldOutputThreadID(bool shouldOutputThreadID);
     void setShouldDisplayMilliseconds(bool shouldDisplayMilliseconds);
 
+    /// formats and outputs a message on the calling thread, returning the formatted message
     QString printMessage(LogMsgType type, const QMessageLogContext& context, const QString &message);
 
+    /// queues a message to be formatted and output on the log writer thread, without waiting on any lock
+    void queueMessage(LogMsgType type, const QMessageLogContext& context, const QString &message);
+
+    /// outputs the queued messages on the calling thread
+    void flush();
+
+    /// limits the queued debug and info messages of each call site to maxMessagesPerSecond, the rest are counted and
+    /// suppressed, warnings and worse are never dropped
+    /// \param maxMessagesPerSecond the limit, or 0 for none
+    void setMaxMessagesPerSecond(int maxMessagesPerSecond);
+
+    /// replaces stdout as the destination of the formatted messages, called with one or more lines at a time
+    using OutputFunction = std::function<void(const QString& lines)>;
+    void setOutputFunction(const OutputFunction& outputFunction);
+
     /// a qtMessageHandler that can be hooked up to a target that links to Qt
     /// prints various process, message type, and time information
     static void verboseMessageHandler(QtMsgType type, const QMessageLogContext& context, const QString &message);
@@ -54,27 +79,52 @@ public:
     int newRepeatedMessageID();
     void printRepeatedMessage(int messageID, LogMsgType type, const QMessageLogContext& context, const QString &message);
 
-private slots:
-    void setupRepeatedMessageFlusher();
-
 private:
+    struct QueuedMessage;
+
     LogHandler();
     ~LogHandler();
 
+    QString formatMessage(LogMsgType type, qint64 timestamp, size_t threadID, const char* category,
+                          const QString& file, const QString& message);
+    void output(const QString& lines);
+
+    bool isAdmitted(LogMsgType type, const QMessageLogContext& context, const QString& message, int& suppressedCount);
+    void pushMessage(QueuedMessage* queuedMessage);
+    void startWriter();
+    void writeQueuedMessages();
     void flushRepeatedMessages();
+    void flushSuppressedMessages(bool includeCurrentSecond);
 
     QString _targetName;
-    bool _shouldOutputProcessID { false };
-    bool _shouldOutputThreadID { false };
-    bool _shouldDisplayMilliseconds { false };
-
-    int _currentMessageID { 0 };
+    std::atomic<bool> _shouldOutputProcessID { false };
+    std::atomic<bool> _shouldOutputThreadID { false };
+    std::atomic<bool> _shouldDisplayMilliseconds { false };
+    std::atomic<int> _maxMessagesPerSecond { DEFAULT_MAX_MESSAGES_PER_SECOND };
+    OutputFunction _outputFunction;
+    std::mutex _settingsMutex;
+
+    // a multiple producer, single consumer intrusive queue: producers swap themselves in at the head,
+    // the holder of _writeMutex pops from the tail
+    std::atomic<QueuedMessage*> _queueHead;
+    QueuedMessage* _queueTail;
+    std::mutex _writeMutex;
+
+    std::thread _writerThread;
+    std::once_flag _writerStarted;
+    std::mutex _writerWaitMutex;
+    std::condition_variable _writerCondition;
+    std::atomic<bool> _isWriterWaiting { false };
+    std::atomic<bool> _isStopping { false };
+    std::chrono::steady_clock::time_point _lastRepeatedMessagesFlush;
+
+    std::atomic<int> _currentMessageID { 0 };
     struct RepeatedMessageRecord {
         int repeatCount;
         QString repeatString;
     };
+    // only touched with _writeMutex held
     std::vector<RepeatedMessageRecord> _repeatedMessageRecords;
-    static QMutex _mutex;
 };
 
 #define HIFI_FCDEBUG(category, message) \
@@ -58,9 +58,13 @@ Duration::Duration(const QLoggingCategory& category,
                    const QVariantMap& baseArgs) :
     DurationBase(category, name) {
     if (tracingEnabled() && category.isDebugEnabled()) {
-        QVariantMap args = baseArgs;
-        args["nv_payload"] = QVariant::fromValue(payload);
-        tracing::traceEvent(_category, _name, tracing::DurationBegin, "", args);
+        if (baseArgs.isEmpty()) {
+            _nameID = DependencyManager::get<tracing::Tracer>()->traceDurationBegin(_category, _name, payload);
+        } else {
+            QVariantMap args = baseArgs;
+            args["nv_payload"] = QVariant::fromValue(payload);
+            tracing::traceEvent(_category, _name, tracing::DurationBegin, "", args);
+        }
 
 #if defined(NSIGHT_TRACING)
         nvtxEventAttributes_t eventAttrib{ 0 };
@@ -80,7 +84,11 @@ Duration::Duration(const QLoggingCategory& category,
 
 Duration::~Duration() {
     if (tracingEnabled() && _category.isDebugEnabled()) {
-        tracing::traceEvent(_category, _name, tracing::DurationEnd);
+        if (_nameID != tracing::Tracer::INVALID_NAME_ID) {
+            DependencyManager::get<tracing::Tracer>()->traceDurationEnd(_category, _nameID);
+        } else {
+            tracing::traceEvent(_category, _name, tracing::DurationEnd);
+        }
 #ifdef NSIGHT_TRACING
         nvtxRangePop();
 #endif
@@ -52,6 +52,9 @@ public:
 
     static uint64_t beginRange(const QLoggingCategory& category, const char* name, uint32_t argbColor);
     static void endRange(const QLoggingCategory& category, uint64_t rangeId);
+
+private:
+    uint32_t _nameID { tracing::Tracer::INVALID_NAME_ID }; // interned at the begin, so the end needn't hash _name again
 };
 
 class ConditionalDuration : public DurationBase {
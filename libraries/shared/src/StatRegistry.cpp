@@ -0,0 +1,204 @@
+//
+//  StatRegistry.cpp
+//  libraries/shared/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "StatRegistry.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include <QtCore/QTextStream>
+
+using namespace stats;
+
+int stats::nextThreadShard() {
+    static std::atomic<int> nextShard { 0 };
+    return nextShard.fetch_add(1, std::memory_order_relaxed) % NUM_SHARDS;
+}
+
+void Counter::set(int64_t value) {
+    for (auto& shard : _shards) {
+        shard.value.store(0, std::memory_order_relaxed);
+    }
+    _shards[getThreadShard()].value.store(value, std::memory_order_relaxed);
+}
+
+int64_t Counter::get() const {
+    int64_t value = 0;
+    for (const auto& shard : _shards) {
+        value += shard.value.load(std::memory_order_relaxed);
+    }
+    return value;
+}
+
+const size_t Histogram::MAX_BUCKETS;
+
+Histogram::Histogram(const QString& name, const QString& help, std::vector<double> upperBounds) :
+    _name(name), _help(help), _upperBounds(std::move(upperBounds)) {
+    std::sort(_upperBounds.begin(), _upperBounds.end());
+    _upperBounds.erase(std::unique(_upperBounds.begin(), _upperBounds.end()), _upperBounds.end());
+    if (_upperBounds.size() > MAX_BUCKETS) {
+        _upperBounds.resize(MAX_BUCKETS);
+    }
+}
+
+void Histogram::record(double value) {
+    auto bucket = std::lower_bound(_upperBounds.begin(), _upperBounds.end(), value) - _upperBounds.begin();
+    auto& shard = _shards[getThreadShard()];
+    shard.counts[bucket].fetch_add(1, std::memory_order_relaxed);
+
+    // no fetch_add for doubles, but the shard is rarely contended
+    auto sum = shard.sum.load(std::memory_order_relaxed);
+    while (!shard.sum.compare_exchange_weak(sum, sum + value, std::memory_order_relaxed)) {
+    }
+}
+
+Histogram::Snapshot Histogram::getSnapshot() const {
+    Snapshot snapshot;
+    snapshot.upperBounds = _upperBounds;
+    snapshot.counts.resize(_upperBounds.size() + 1, 0);
+    for (const auto& shard : _shards) {
+        for (size_t i = 0; i < snapshot.counts.size(); ++i) {
+            auto count = shard.counts[i].load(std::memory_order_relaxed);
+            snapshot.counts[i] += count;
+            snapshot.count += count;
+        }
+        snapshot.sum += shard.sum.load(std::memory_order_relaxed);
+    }
+    return snapshot;
+}
+
+uint64_t Rate::getCurrentSecond() {
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<seconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+const int Rate::WINDOW_SECONDS;
+const uint64_t Rate::COUNT_MASK;
+
+void Rate::mark(int64_t count, uint64_t second) {
+    if (count <= 0) {
+        return;
+    }
+    _total.add(count);
+
+    auto& slot = _slots[second % NUM_SLOTS];
+    auto epoch = second << COUNT_BITS;
+    auto value = slot.load(std::memory_order_relaxed);
+    uint64_t newValue;
+    do {
+        if ((value & ~COUNT_MASK) == epoch) {
+            newValue = epoch | std::min((value & COUNT_MASK) + (uint64_t)count, COUNT_MASK);
+        } else {
+            // the first mark of a new second takes the slot over
+            newValue = epoch | std::min((uint64_t)count, COUNT_MASK);
+        }
+    } while (!slot.compare_exchange_weak(value, newValue, std::memory_order_relaxed));
+}
+
+float Rate::getRate(int seconds, uint64_t currentSecond) const {
+    seconds = std::max(1, std::min(seconds, WINDOW_SECONDS));
+    uint64_t count = 0;
+    for (int i = 1; i <= seconds && (uint64_t)i <= currentSecond; ++i) {
+        auto second = currentSecond - i;
+        auto value = _slots[second % NUM_SLOTS].load(std::memory_order_relaxed);
+        if ((value & ~COUNT_MASK) == (second << COUNT_BITS)) {
+            count += value & COUNT_MASK;
+        }
+    }
+    return (float)count / seconds;
+}
+
+StatRegistry& StatRegistry::getInstance() {
+    static StatRegistry instance;
+    return instance;
+}
+
+Counter& StatRegistry::getCounter(const QString& name, const QString& help) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto& counter = _counters[name];
+    if (!counter) {
+        counter = std::make_unique<Counter>(name, help);
+    }
+    return *counter;
+}
+
+Histogram& StatRegistry::getHistogram(const QString& name, const std::vector<double>& upperBounds, const QString& help) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto& histogram = _histograms[name];
+    if (!histogram) {
+        histogram = std::make_unique<Histogram>(name, help, upperBounds);
+    }
+    return *histogram;
+}
+
+Rate& StatRegistry::getRate(const QString& name, const QString& help) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto& rate = _rates[name];
+    if (!rate) {
+        rate = std::make_unique<Rate>(name, help);
+    }
+    return *rate;
+}
+
+// metric names are limited to [a-zA-Z0-9_:]
+static QString getMetricName(const QString& name) {
+    QString metricName = "hifi_";
+    for (auto c : name) {
+        metricName += (c.isLetterOrNumber() && c.unicode() < 128) || c == ':' ? c : QChar('_');
+    }
+    return metricName;
+}
+
+static void writeHeader(QTextStream& out, const QString& metricName, const QString& help, const char* type) {
+    if (!help.isEmpty()) {
+        QString escapedHelp = help;
+        escapedHelp.replace("\\", "\\\\").replace("\n", "\\n");
+        out << "# HELP " << metricName << ' ' << escapedHelp << '\n';
+    }
+    out << "# TYPE " << metricName << ' ' << type << '\n';
+}
+
+QByteArray StatRegistry::toPrometheusText() const {
+    QByteArray text;
+    QTextStream out(&text);
+    out.setRealNumberPrecision(9);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (const auto& entry : _counters) {
+        auto metricName = getMetricName(entry.first);
+        writeHeader(out, metricName, entry.second->getHelp(), "gauge");
+        out << metricName << ' ' << (qint64)entry.second->get() << '\n';
+    }
+
+    for (const auto& entry : _histograms) {
+        auto metricName = getMetricName(entry.first);
+        auto snapshot = entry.second->getSnapshot();
+        writeHeader(out, metricName, entry.second->getHelp(), "histogram");
+        uint64_t cumulativeCount = 0;
+        for (size_t i = 0; i < snapshot.upperBounds.size(); ++i) {
+            cumulativeCount += snapshot.counts[i];
+            out << metricName << "_bucket{le=\"" << snapshot.upperBounds[i] << "\"} " << (quint64)cumulativeCount << '\n';
+        }
+        out << metricName << "_bucket{le=\"+Inf\"} " << (quint64)snapshot.count << '\n';
+        out << metricName << "_sum " << snapshot.sum << '\n';
+        out << metricName << "_count " << (quint64)snapshot.count << '\n';
+    }
+
+    for (const auto& entry : _rates) {
+        auto metricName = getMetricName(entry.first);
+        writeHeader(out, metricName + "_total", entry.second->getHelp(), "counter");
+        out << metricName << "_total " << (qint64)entry.second->getTotal() << '\n';
+        writeHeader(out, metricName + "_per_second", QString(), "gauge");
+        out << metricName << "_per_second " << entry.second->getRate() << '\n';
+    }
+
+    out.flush();
+    return text;
+}
@@ -0,0 +1,163 @@
+//
+//  StatRegistry.h
+//  libraries/shared/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#pragma once
+#ifndef hifi_StatRegistry_h
+#define hifi_StatRegistry_h
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+
+namespace stats {
+
+// Each stat spreads its updates over NUM_SHARDS cache lines, summed when read
+static const int NUM_SHARDS = 16;
+
+int nextThreadShard();
+
+// The shard of the calling thread, threads are assigned round robin on first use
+inline int getThreadShard() {
+    static thread_local int shard = nextThreadShard();
+    return shard;
+}
+
+// A value that goes up and down, exported as a gauge
+class Counter {
+public:
+    Counter(const QString& name, const QString& help) : _name(name), _help(help) {}
+
+    const QString& getName() const { return _name; }
+    const QString& getHelp() const { return _help; }
+
+    void add(int64_t value) { _shards[getThreadShard()].value.fetch_add(value, std::memory_order_relaxed); }
+    void increment() { add(1); }
+    void decrement() { add(-1); }
+
+    // Updates made while the value is being set may be lost
+    void set(int64_t value);
+    int64_t get() const;
+
+private:
+    // padded rather than aligned, since over-aligned new needs C++17
+    struct Shard {
+        std::atomic<int64_t> value { 0 };
+        char padding[64 - sizeof(std::atomic<int64_t>)];
+    };
+
+    const QString _name;
+    const QString _help;
+    std::array<Shard, NUM_SHARDS> _shards;
+};
+
+// Counts values in up to MAX_BUCKETS buckets with fixed upper bounds, plus one for the values above them
+class Histogram {
+public:
+    static const size_t MAX_BUCKETS { 32 };
+
+    struct Snapshot {
+        std::vector<double> upperBounds;
+        std::vector<uint64_t> counts; // per bucket, not cumulative, with the values above the last bound at the end
+        uint64_t count { 0 };
+        double sum { 0.0 };
+    };
+
+    // upperBounds are sorted, and the ones past MAX_BUCKETS dropped
+    Histogram(const QString& name, const QString& help, std::vector<double> upperBounds);
+
+    const QString& getName() const { return _name; }
+    const QString& getHelp() const { return _help; }
+
+    void record(double value);
+    Snapshot getSnapshot() const;
+
+private:
+    struct Shard {
+        std::array<std::atomic<uint64_t>, MAX_BUCKETS + 1> counts {};
+        std::atomic<double> sum { 0.0 };
+        char padding[64 - sizeof(std::atomic<double>)];
+    };
+
+    const QString _name;
+    const QString _help;
+    std::vector<double> _upperBounds;
+    std::array<Shard, NUM_SHARDS> _shards;
+};
+
+// Events per second over the last WINDOW_SECONDS full seconds, and the total since creation
+class Rate {
+public:
+    static const int WINDOW_SECONDS { 60 };
+    static const int DEFAULT_RATE_SECONDS { 10 };
+
+    Rate(const QString& name, const QString& help) : _name(name), _help(help) {}
+
+    const QString& getName() const { return _name; }
+    const QString& getHelp() const { return _help; }
+
+    void mark(int64_t count = 1) { mark(count, getCurrentSecond()); }
+    void mark(int64_t count, uint64_t second);
+
+    // The average over the seconds before the current one, up to WINDOW_SECONDS
+    float getRate(int seconds = DEFAULT_RATE_SECONDS) const { return getRate(seconds, getCurrentSecond()); }
+    float getRate(int seconds, uint64_t currentSecond) const;
+    int64_t getTotal() const { return _total.get(); }
+
+    static uint64_t getCurrentSecond();
+
+private:
+    // each slot packs the second it counts in its top bits and the count below, so it resets with a single CAS
+    static const int NUM_SLOTS { 64 };
+    static const int COUNT_BITS { 40 };
+    static const uint64_t COUNT_MASK { (1ULL << COUNT_BITS) - 1 };
+
+    const QString _name;
+    const QString _help;
+    std::array<std::atomic<uint64_t>, NUM_SLOTS> _slots {};
+    Counter _total { QString(), QString() };
+};
+
+// Owns every stat by name.  Looking a stat up takes a lock, so resolve the handle once and keep it:
+// the stats live as long as the process.
+class StatRegistry {
+public:
+    static StatRegistry& getInstance();
+
+    Counter& getCounter(const QString& name, const QString& help = QString());
+    // upperBounds is only used by the first call for a name
+    Histogram& getHistogram(const QString& name, const std::vector<double>& upperBounds, const QString& help = QString());
+    Rate& getRate(const QString& name, const QString& help = QString());
+
+    // The stats in the Prometheus text exposition format, with names prefixed by hifi_
+    QByteArray toPrometheusText() const;
+
+private:
+    StatRegistry() {}
+
+    mutable std::mutex _mutex;
+    std::map<QString, std::unique_ptr<Counter>> _counters;
+    std::map<QString, std::unique_ptr<Histogram>> _histograms;
+    std::map<QString, std::unique_ptr<Rate>> _rates;
+};
+
+}
+
+// The counter for a name that is constant at the call site, looked up on first use only
+#define STAT_COUNTER(name) ([]() -> stats::Counter& { \
+        static auto& counter = stats::StatRegistry::getInstance().getCounter(name); return counter; }())
+
+#endif // hifi_StatRegistry_h
@@ -8,34 +8,38 @@
 
 #include "StatTracker.h"
 
+#include <QtCore/QHash>
+
 StatTracker::StatTracker() {
     
 }
 
+stats::Counter& StatTracker::getCounter(const QString& name) {
+    // spares the registry lock once a thread has seen a name
+    static thread_local QHash<QString, stats::Counter*> counters;
+    auto& counter = counters[name];
+    if (!counter) {
+        counter = &stats::StatRegistry::getInstance().getCounter(name);
+    }
+    return *counter;
+}
+
 QVariant StatTracker::getStat(const QString& name) {
-    std::lock_guard<std::mutex> lock(_statsLock);
-    return QVariant::fromValue<int64_t>(_stats[name]);
+    return QVariant::fromValue<int64_t>(getCounter(name).get());
 }
 
 void StatTracker::setStat(const QString& name, int64_t value) {
-    Lock lock(_statsLock);
-    _stats[name] = value;
+    getCounter(name).set(value);
 }
 
 void StatTracker::updateStat(const QString& name, int64_t value) {
-    Lock lock(_statsLock);
-    auto itr = _stats.find(name);
-    if (_stats.end() == itr) {
-        _stats[name] = value;
-    } else {
-        *itr = *itr + value;
-    }
+    getCounter(name).add(value);
 }
 
 void StatTracker::incrementStat(const QString& name) {
-    updateStat(name, 1);
+    getCounter(name).increment();
 }
 
 void StatTracker::decrementStat(const QString& name) {
-    updateStat(name, -1);
-}
\ No newline at end of file
+    getCounter(name).decrement();
+}
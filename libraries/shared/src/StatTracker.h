@@ -16,10 +16,13 @@
 #include <mutex>
 
 #include "DependencyManager.h"
+#include "StatRegistry.h"
 #include "Trace.h"
 
 using EditStatFunction = std::function<QVariant(QVariant currentValue)>;
 
+// The string keyed interface to the counters of the StatRegistry.  Prefer resolving a stats::Counter once,
+// with STAT_COUNTER or StatRegistry::getCounter, over looking the name up on every update.
 class StatTracker : public Dependency {
 public:
     StatTracker();
@@ -28,21 +31,18 @@ public:
     void updateStat(const QString& name, int64_t mod);
     void incrementStat(const QString& name);
     void decrementStat(const QString& name);
-private:
-    using Mutex = std::mutex;
-    using Lock = std::lock_guard<Mutex>;
-    Mutex _statsLock;
-    QHash<QString, int64_t> _stats;
+
+    static stats::Counter& getCounter(const QString& name);
 };
 
 class CounterStat {
 public:
-    CounterStat(QString name) : _name(name) {
-        DependencyManager::get<StatTracker>()->incrementStat(_name);
-    }    
+    CounterStat(const QString& name) : _counter(StatTracker::getCounter(name)) {
+        _counter.increment();
+    }
     ~CounterStat() {
-        DependencyManager::get<StatTracker>()->decrementStat(_name);
-    }    
+        _counter.decrement();
+    }
 private:
-    QString _name;
+    stats::Counter& _counter;
 };
@@ -31,6 +31,7 @@
 #include "Gzip.h"
 #include "PortableHighResolutionClock.h"
 #include "SharedLogging.h"
+#include "TraceRecorder.h"
 #include "shared/FileUtils.h"
 #include "shared/GlobalAppProperties.h"
 
@@ -48,6 +49,7 @@ void Tracer::startTracing() {
     }
 
     _events.clear();
+    TraceRecorder::getInstance().start();
     _enabled = true;
 }
 
@@ -58,6 +60,7 @@ void Tracer::stopTracing() {
         return;
     }
     _enabled = false;
+    TraceRecorder::getInstance().stop();
 }
 
 void TraceEvent::writeJson(QTextStream& out) const {
@@ -120,6 +123,11 @@ void Tracer::serialize(const QString& filename) {
             currentEvents.push_back(event);
         }
     }
+    auto& recorder = TraceRecorder::getInstance();
+    auto recordedEvents = recorder.takeEvents();
+    if (recorder.getDroppedCount() > 0) {
+        qCWarning(shared) << "Trace buffers overflowed," << recorder.getDroppedCount() << "events were dropped";
+    }
 
     // If we can't open a temp file for writing, fail early
     QByteArray data;
@@ -135,6 +143,7 @@ void Tracer::serialize(const QString& filename) {
             }
             event.writeJson(out);
         }
+        recorder.writeJson(recordedEvents, QCoreApplication::applicationPid(), out, first);
         out << "\n]";
     }
 
@@ -240,7 +249,31 @@ void Tracer::traceEvent(const QLoggingCategory& category,
         return;
     }
 
+    if (type != Metadata && id.isEmpty() && args.isEmpty() && extra.isEmpty()) {
+        TraceRecorder::getInstance().record(category, name, type, timestamp);
+        return;
+    }
+
     auto processID = QCoreApplication::applicationPid();
     auto threadID = int64_t(QThread::currentThreadId());
     traceEvent(category, name, type, timestamp, processID, threadID, id, args, extra);
 }
+
+uint32_t Tracer::traceDurationBegin(const QLoggingCategory& category, const QString& name, uint64_t payload) {
+    if (!_enabled) {
+        return INVALID_NAME_ID;
+    }
+
+    auto& recorder = TraceRecorder::getInstance();
+    uint32_t nameID = recorder.internName(name);
+    recorder.record(category, nameID, DurationBegin, now(), payload, TraceRecorder::HAS_PAYLOAD);
+    return nameID;
+}
+
+void Tracer::traceDurationEnd(const QLoggingCategory& category, uint32_t nameID) {
+    if (!_enabled) {
+        return;
+    }
+
+    TraceRecorder::getInstance().record(category, nameID, DurationEnd, now());
+}
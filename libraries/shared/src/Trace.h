@@ -10,6 +10,7 @@
 #ifndef hifi_Trace_h
 #define hifi_Trace_h
 
+#include <atomic>
 #include <cstdint>
 #include <mutex>
 
@@ -90,10 +91,17 @@ public:
         const QString& id = "", 
         const QVariantMap& args = QVariantMap(), const QVariantMap& extra = QVariantMap());
 
+    static const uint32_t INVALID_NAME_ID { 0xFFFFFFFF };
+
+    // The DurationBegin of a Duration, with its payload as the nv_payload arg
+    // \return the interned name to pass to traceDurationEnd, or INVALID_NAME_ID if nothing was traced
+    uint32_t traceDurationBegin(const QLoggingCategory& category, const QString& name, uint64_t payload);
+    void traceDurationEnd(const QLoggingCategory& category, uint32_t nameID);
+
     void startTracing();
     void stopTracing();
     void serialize(const QString& file);
-    bool isEnabled() const { return _enabled; }
+    bool isEnabled() const { return _enabled.load(std::memory_order_relaxed); }
 
 private:
     void traceEvent(const QLoggingCategory& category, 
@@ -102,7 +110,8 @@ private:
         const QString& id = "",
         const QVariantMap& args = QVariantMap(), const QVariantMap& extra = QVariantMap());
 
-    bool _enabled { false };
+    // Events without an id, args or extra are recorded by the TraceRecorder, the rest are kept here
+    std::atomic<bool> _enabled { false };
     std::list<TraceEvent> _events;
     std::list<TraceEvent> _metadataEvents;
     std::mutex _eventsMutex;
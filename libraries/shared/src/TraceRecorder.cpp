@@ -0,0 +1,275 @@
+//
+//  TraceRecorder.cpp
+//  libraries/shared/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "TraceRecorder.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QTextStream>
+#include <QtCore/QThread>
+
+using namespace tracing;
+
+static const std::chrono::milliseconds DRAIN_INTERVAL { 10 };
+static const size_t EVENT_MASK = TraceRecorder::EVENTS_PER_THREAD - 1;
+static_assert((TraceRecorder::EVENTS_PER_THREAD & EVENT_MASK) == 0, "EVENTS_PER_THREAD must be a power of two");
+static_assert(sizeof(TraceRecorder::Event) == 32, "trace events should stay compact");
+
+// Single producer, single consumer: only the owning thread pushes, and only the holder of _drainMutex pops
+struct TraceRecorder::ThreadBuffer {
+    std::array<Event, EVENTS_PER_THREAD> events;
+    // kept on separate cache lines, the producer writes one and the drain the other
+    std::atomic<uint64_t> head { 0 };
+    char headPadding[64 - sizeof(std::atomic<uint64_t>)];
+    std::atomic<uint64_t> tail { 0 };
+    char tailPadding[64 - sizeof(std::atomic<uint64_t>)];
+    std::atomic<bool> isOrphaned { false };
+    uint32_t threadIndex { 0 };
+
+    // only touched by the owning thread, in front of the shared tables
+    QHash<QString, uint32_t> nameIDs;
+    QHash<const QLoggingCategory*, uint16_t> categoryIDs;
+};
+
+// Flags the buffer of an exiting thread, so the drain thread drops it once it is empty
+struct TraceRecorder::ThreadBufferHolder {
+    ~ThreadBufferHolder() {
+        if (buffer) {
+            buffer->isOrphaned.store(true, std::memory_order_release);
+        }
+    }
+    std::shared_ptr<ThreadBuffer> buffer;
+};
+
+TraceRecorder& TraceRecorder::getInstance() {
+    static TraceRecorder instance;
+    return instance;
+}
+
+TraceRecorder::~TraceRecorder() {
+    {
+        std::lock_guard<std::mutex> guard(_drainConditionMutex);
+        _shouldStop = true;
+    }
+    _drainCondition.notify_all();
+    if (_drainThread.joinable()) {
+        _drainThread.join();
+    }
+}
+
+void TraceRecorder::start() {
+    {
+        std::lock_guard<std::mutex> guard(_drainConditionMutex);
+        if (!_isDraining) {
+            _isDraining = true;
+            _shouldStop = false;
+            _drainThread = std::thread([this] { drainLoop(); });
+        }
+    }
+    takeEvents();
+    _droppedCount.store(0, std::memory_order_relaxed);
+}
+
+void TraceRecorder::stop() {
+    {
+        std::lock_guard<std::mutex> guard(_drainConditionMutex);
+        if (!_isDraining) {
+            return;
+        }
+        _isDraining = false;
+        _shouldStop = true;
+    }
+    _drainCondition.notify_all();
+    _drainThread.join();
+
+    // keep what was recorded up to now, the thread buffers may not be drained again for a while
+    flush();
+}
+
+TraceRecorder::ThreadBuffer& TraceRecorder::getThreadBuffer() {
+    static thread_local ThreadBufferHolder holder;
+    if (!holder.buffer) {
+        auto buffer = std::make_shared<ThreadBuffer>();
+        std::lock_guard<std::mutex> guard(_threadBuffersMutex);
+        buffer->threadIndex = (uint32_t)_threadIDs.size();
+        _threadIDs.push_back(int64_t(QThread::currentThreadId()));
+        _threadBuffers.push_back(buffer);
+        holder.buffer = buffer;
+    }
+    return *holder.buffer;
+}
+
+uint32_t TraceRecorder::internName(const QString& name) {
+    return internName(getThreadBuffer(), name);
+}
+
+uint32_t TraceRecorder::internName(ThreadBuffer& buffer, const QString& name) {
+    auto cached = buffer.nameIDs.constFind(name);
+    if (cached != buffer.nameIDs.constEnd()) {
+        return cached.value();
+    }
+
+    uint32_t nameID;
+    {
+        // names are interned by content, since many are built on the fly or point into temporaries
+        std::lock_guard<std::mutex> guard(_namesMutex);
+        auto found = _nameIDs.constFind(name);
+        if (found != _nameIDs.constEnd()) {
+            nameID = found.value();
+        } else {
+            nameID = (uint32_t)_names.size();
+            _names.push_back(name);
+            _nameIDs.insert(name, nameID);
+        }
+    }
+    buffer.nameIDs.insert(name, nameID);
+    return nameID;
+}
+
+uint16_t TraceRecorder::internCategory(ThreadBuffer& buffer, const QLoggingCategory& category) {
+    auto cached = buffer.categoryIDs.constFind(&category);
+    if (cached != buffer.categoryIDs.constEnd()) {
+        return cached.value();
+    }
+
+    uint16_t categoryID;
+    {
+        // categories are declared with Q_LOGGING_CATEGORY and live as long as the process
+        std::lock_guard<std::mutex> guard(_namesMutex);
+        auto found = std::find(_categories.begin(), _categories.end(), &category);
+        categoryID = (uint16_t)(found - _categories.begin());
+        if (found == _categories.end()) {
+            _categories.push_back(&category);
+        }
+    }
+    buffer.categoryIDs.insert(&category, categoryID);
+    return categoryID;
+}
+
+void TraceRecorder::record(const QLoggingCategory& category, const QString& name, EventType type, int64_t timestamp,
+                           uint64_t payload, uint8_t flags) {
+    record(category, internName(name), type, timestamp, payload, flags);
+}
+
+void TraceRecorder::record(const QLoggingCategory& category, uint32_t nameID, EventType type, int64_t timestamp,
+                           uint64_t payload, uint8_t flags) {
+    auto& buffer = getThreadBuffer();
+    auto head = buffer.head.load(std::memory_order_relaxed);
+    auto size = head - buffer.tail.load(std::memory_order_acquire);
+    if (size >= EVENTS_PER_THREAD) {
+        _droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    buffer.events[head & EVENT_MASK] = { timestamp, payload, nameID, buffer.threadIndex,
+                                         internCategory(buffer, category), type, flags };
+    buffer.head.store(head + 1, std::memory_order_release);
+
+    // don't wait for the next drain interval when the buffer fills up
+    if (size == EVENTS_PER_THREAD / 2) {
+        _drainCondition.notify_one();
+    }
+}
+
+void TraceRecorder::drainThreadBuffers() {
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> guard(_threadBuffersMutex);
+        buffers = _threadBuffers;
+    }
+
+    std::vector<ThreadBuffer*> emptiedOrphans;
+    for (const auto& buffer : buffers) {
+        // read before the head, so that no event is pushed after the last drain of an orphaned buffer
+        bool isOrphaned = buffer->isOrphaned.load(std::memory_order_acquire);
+        auto tail = buffer->tail.load(std::memory_order_relaxed);
+        auto head = buffer->head.load(std::memory_order_acquire);
+        for (; tail != head; ++tail) {
+            _drainedEvents.push_back(buffer->events[tail & EVENT_MASK]);
+        }
+        buffer->tail.store(tail, std::memory_order_release);
+        if (isOrphaned) {
+            emptiedOrphans.push_back(buffer.get());
+        }
+    }
+
+    if (!emptiedOrphans.empty()) {
+        std::lock_guard<std::mutex> guard(_threadBuffersMutex);
+        _threadBuffers.erase(std::remove_if(_threadBuffers.begin(), _threadBuffers.end(),
+            [&](const std::shared_ptr<ThreadBuffer>& buffer) {
+                return std::find(emptiedOrphans.begin(), emptiedOrphans.end(), buffer.get()) != emptiedOrphans.end();
+            }), _threadBuffers.end());
+    }
+}
+
+void TraceRecorder::flush() {
+    std::lock_guard<std::mutex> guard(_drainMutex);
+    drainThreadBuffers();
+}
+
+std::vector<TraceRecorder::Event> TraceRecorder::takeEvents() {
+    std::vector<Event> events;
+    std::lock_guard<std::mutex> guard(_drainMutex);
+    drainThreadBuffers();
+    events.swap(_drainedEvents);
+    return events;
+}
+
+void TraceRecorder::drainLoop() {
+    std::unique_lock<std::mutex> lock(_drainConditionMutex);
+    while (!_shouldStop) {
+        _drainCondition.wait_for(lock, DRAIN_INTERVAL);
+        lock.unlock();
+        flush();
+        lock.lock();
+    }
+}
+
+void TraceRecorder::writeJson(const std::vector<Event>& events, qint64 processID, QTextStream& out, bool first) const {
+    std::vector<QByteArray> names;
+    std::vector<QByteArray> categories;
+    std::vector<qint64> threadIDs;
+    {
+        std::lock_guard<std::mutex> guard(_namesMutex);
+        names.reserve(_names.size());
+        for (const auto& name : _names) {
+            // let QJsonDocument escape the names the way TraceEvent::writeJson does
+            auto json = QJsonDocument(QJsonArray { name }).toJson(QJsonDocument::Compact);
+            names.push_back(json.mid(1, json.size() - 2));
+        }
+        for (const auto& category : _categories) {
+            categories.push_back(category->categoryName());
+        }
+    }
+    {
+        std::lock_guard<std::mutex> guard(_threadBuffersMutex);
+        threadIDs.assign(_threadIDs.begin(), _threadIDs.end());
+    }
+
+    // the keys in the order QJsonObject writes them
+    for (const auto& event : events) {
+        if (first) {
+            first = false;
+        } else {
+            out << ",\n";
+        }
+        out << '{';
+        if (event.flags & HAS_PAYLOAD) {
+            out << "\"args\":{\"nv_payload\":" << (quint64)event.payload << "},";
+        }
+        out << "\"cat\":\"" << categories[event.categoryID] << "\",\"name\":" << names[event.nameID]
+            << ",\"ph\":\"" << (char)event.type << "\",\"pid\":" << processID
+            << ",\"tid\":" << threadIDs[event.threadIndex] << ",\"ts\":" << (qint64)event.timestamp << '}';
+    }
+}
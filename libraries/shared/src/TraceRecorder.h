@@ -0,0 +1,120 @@
+//
+//  TraceRecorder.h
+//  libraries/shared/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#pragma once
+#ifndef hifi_TraceRecorder_h
+#define hifi_TraceRecorder_h
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QString>
+
+#include "Trace.h"
+
+class QTextStream;
+
+namespace tracing {
+
+// Records trace events without ids, args or extra fields (which are most of them: every PROFILE_RANGE begin
+// and end) as 32 byte binary events in a lock free ring buffer per thread.  Categories and names are
+// interned to ids, and a background thread drains the buffers into one list, so the threads being traced
+// never wait on each other.  The Tracer keeps the rarer events with args on its own locked list.
+class TraceRecorder {
+public:
+    struct Event {
+        int64_t timestamp;
+        uint64_t payload;
+        uint32_t nameID;
+        uint32_t threadIndex;
+        uint16_t categoryID;
+        EventType type;
+        uint8_t flags;
+    };
+
+    enum EventFlags : uint8_t {
+        HAS_PAYLOAD = 1 // written as args: { nv_payload }, the way Duration records its payload
+    };
+
+    static const size_t EVENTS_PER_THREAD { 16384 };
+
+    static TraceRecorder& getInstance();
+    ~TraceRecorder();
+
+    // Discards the events recorded so far and starts the drain thread if it isn't running yet
+    void start();
+
+    // Stops the drain thread, the events recorded so far are kept until the next start() or takeEvents()
+    void stop();
+
+    // The id to record name with, hashing name once for events recorded under the same name (e.g. a range's end)
+    uint32_t internName(const QString& name);
+
+    void record(const QLoggingCategory& category, const QString& name, EventType type, int64_t timestamp,
+                uint64_t payload = 0, uint8_t flags = 0);
+    void record(const QLoggingCategory& category, uint32_t nameID, EventType type, int64_t timestamp,
+                uint64_t payload = 0, uint8_t flags = 0);
+
+    // Moves the events in the thread buffers to the drained list, on the calling thread
+    void flush();
+
+    // The recorded events in per thread order, leaving the recorder empty
+    std::vector<Event> takeEvents();
+
+    // Events lost because a thread filled its buffer faster than the drain thread emptied it
+    uint64_t getDroppedCount() const { return _droppedCount.load(std::memory_order_relaxed); }
+
+    // Writes events the same way as TraceEvent::writeJson, comma separated, with a leading comma unless first
+    void writeJson(const std::vector<Event>& events, qint64 processID, QTextStream& out, bool first) const;
+
+private:
+    struct ThreadBuffer;
+    struct ThreadBufferHolder;
+
+    TraceRecorder() {}
+
+    ThreadBuffer& getThreadBuffer();
+    uint32_t internName(ThreadBuffer& buffer, const QString& name);
+    uint16_t internCategory(ThreadBuffer& buffer, const QLoggingCategory& category);
+    void drainThreadBuffers();
+    void drainLoop();
+
+    // owned by the thread buffers and the recorder, so the buffers of exited threads can still be drained
+    std::vector<std::shared_ptr<ThreadBuffer>> _threadBuffers;
+    std::vector<int64_t> _threadIDs;
+    mutable std::mutex _threadBuffersMutex;
+
+    QHash<QString, uint32_t> _nameIDs;
+    std::vector<QString> _names;
+    std::vector<const QLoggingCategory*> _categories;
+    mutable std::mutex _namesMutex;
+
+    std::vector<Event> _drainedEvents;
+    std::mutex _drainMutex;
+
+    std::thread _drainThread;
+    std::condition_variable _drainCondition;
+    std::mutex _drainConditionMutex;
+    bool _isDraining { false };
+    bool _shouldStop { false };
+
+    std::atomic<uint64_t> _droppedCount { 0 };
+};
+
+}
+
+#endif // hifi_TraceRecorder_h
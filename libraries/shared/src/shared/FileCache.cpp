@@ -13,7 +13,6 @@
 
 
 #include <unordered_set>
-#include <queue>
 #include <cassert>
 
 #include <QtCore/QDateTime>
@@ -39,6 +38,7 @@ using namespace cache;
 
 static const char DIR_SEP = '/';
 static const char EXT_SEP = '.';
+static const char* EVICTION_POLICY_FILENAME = "eviction.policy";
 
 const size_t FileCache::DEFAULT_MAX_SIZE { GB_TO_BYTES(5) };
 const size_t FileCache::MAX_MAX_SIZE { GB_TO_BYTES(100) };
@@ -86,6 +86,30 @@ FileCache::~FileCache() {
     clear();
 }
 
+float FileCache::getHitRatio() const {
+    size_t numLookups = _numLookups;
+    return numLookups > 0 ? (float)_numHits / (float)numLookups : 0.0f;
+}
+
+float FileCache::getByteHitRatio() const {
+    size_t hitBytes = _hitBytes;
+    size_t totalBytes = hitBytes + _missBytes;
+    return totalBytes > 0 ? (float)hitBytes / (float)totalBytes : 0.0f;
+}
+
+void FileCache::setEvictionPolicy(EvictionPolicy::Pointer policy) {
+    Lock lock(_mutex);
+    if (_initialized) {
+        qCWarning(file_cache) << "Eviction policy set after initialization";
+        return;
+    }
+    _evictionPolicy = std::move(policy);
+}
+
+std::string FileCache::getEvictionPolicyFilepath() const {
+    return _dirpath + DIR_SEP + EVICTION_POLICY_FILENAME;
+}
+
 void FileCache::initialize() {
     Lock lock(_mutex);
     if (_initialized) {
@@ -96,6 +120,12 @@ void FileCache::initialize() {
     QDir dir(_dirpath.c_str());
 
     if (dir.exists()) {
+        // restore the policy's state first, persisted files are then admitted as they made it through a previous session
+        QFile policyFile(getEvictionPolicyFilepath().c_str());
+        if (policyFile.open(QIODevice::ReadOnly)) {
+            _evictionPolicy->restore(policyFile.readAll());
+        }
+
         auto nameFilters = QStringList(("*." + _ext).c_str());
         auto filters = QDir::Filters(QDir::NoDotAndDotDot | QDir::Files);
         auto sort = QDir::SortFlags(QDir::Time);
@@ -106,7 +136,7 @@ void FileCache::initialize() {
             const Key key = filename.section('.', 0, 0).toStdString();
             const std::string filepath = dir.filePath(filename).toStdString();
             const size_t length = QFileInfo(filepath.c_str()).size();
-            addFile(Metadata(key, length), filepath);
+            addFile(Metadata(key, length), filepath)->_admitted = true;
         }
 
         qCDebug(file_cache, "[%s] Initialized %s", _dirname.c_str(), _dirpath.c_str());
@@ -156,7 +186,7 @@ FilePointer FileCache::writeFile(const char* data, File::Metadata&& metadata, bo
     std::string filepath = getFilepath(metadata.key);
 
     // if file already exists, return it
-    file = getFile(metadata.key);
+    file = findFile(metadata.key);
     if (file) {
         if (!overwrite) {
             qCWarning(file_cache, "[%s] Attempted to overwrite %s", _dirname.c_str(), metadata.key.c_str());
@@ -172,6 +202,7 @@ FilePointer FileCache::writeFile(const char* data, File::Metadata&& metadata, bo
         && saveFile.write(data, metadata.length) == static_cast<qint64>(metadata.length)
         && saveFile.commit()) {
 
+        _missBytes += metadata.length;
         file = addFile(std::move(metadata), filepath);
     } else {
         qCWarning(file_cache, "[%s] Failed to write %s", _dirname.c_str(), metadata.key.c_str());
@@ -184,11 +215,24 @@ FilePointer FileCache::writeFile(const char* data, File::Metadata&& metadata, bo
 FilePointer FileCache::getFile(const Key& key) {
     Lock lock(_mutex);
 
-    FilePointer file;
     if (!_initialized) {
         qCWarning(file_cache) << "File cache used before initialization";
-        return file;
+        return FilePointer();
+    }
+
+    _evictionPolicy->recordAccess(key);
+    FilePointer file = findFile(key);
+
+    _numLookups += 1;
+    if (file) {
+        _numHits += 1;
+        _hitBytes += file->getLength();
     }
+    return file;
+}
+
+FilePointer FileCache::findFile(const Key& key) {
+    FilePointer file;
 
     // check if file exists
     const auto it = _files.find(key);
@@ -250,14 +294,6 @@ size_t FileCache::getOverbudgetAmount() const {
     return result;
 }
 
-namespace cache {
-    struct FilePointerComparator {
-        bool operator()(const FilePointer& a, const FilePointer& b) {
-            return a->_modified > b->_modified;
-        }
-    };
-}
-
 // Take file pointer by value to insure it doesn't get destructed during the "erase()" calls
 void FileCache::eject(FilePointer file) {
     file->_locked = false;
@@ -277,23 +313,14 @@ void FileCache::eject(FilePointer file) {
 void FileCache::clean() {
     size_t overbudgetAmount = getOverbudgetAmount();
 
-    // Avoid sorting the unused files by LRU if we're not over budget / under free space
+    // Avoid ranking the unused files if we're not over budget / under free space
     if (0 == overbudgetAmount) {
         return;
     }
 
-    using Queue = std::priority_queue<FilePointer, std::vector<FilePointer>, FilePointerComparator>;
-    Queue queue;
-    for (const auto& file : _unusedFiles) {
-        queue.push(file);
-    }
-
-    while (!queue.empty() && overbudgetAmount > 0) {
-        auto file = queue.top();
-        queue.pop();
+    std::vector<FilePointer> unusedFiles(_unusedFiles.begin(), _unusedFiles.end());
+    for (const auto& file : _evictionPolicy->selectVictims(std::move(unusedFiles), overbudgetAmount, _maxSize)) {
         eject(file);
-        auto length = file->getLength();
-        overbudgetAmount -= std::min(length, overbudgetAmount);
     }
 }
 
@@ -310,6 +337,19 @@ void FileCache::clear() {
     // Eliminate any overbudget files
     clean();
 
+    if (_numLookups > 0) {
+        qCDebug(file_cache, "[%s] %s hit ratio %.3f, byte hit ratio %.3f", _dirname.c_str(), _evictionPolicy->getName(),
+                (double)getHitRatio(), (double)getByteHitRatio());
+    }
+
+    QByteArray policyState = _evictionPolicy->save();
+    if (_initialized && !policyState.isEmpty()) {
+        QSaveFile policyFile(getEvictionPolicyFilepath().c_str());
+        if (!(policyFile.open(QIODevice::WriteOnly) && policyFile.write(policyState) == policyState.size() && policyFile.commit())) {
+            qCWarning(file_cache, "[%s] Failed to persist the eviction policy", _dirname.c_str());
+        }
+    }
+
     // Mark everything remaining as persisted while effectively ejecting from the cache
     for (auto& file : _unusedFiles) {
         file->_shouldPersist = true;
@@ -22,6 +22,8 @@
 #include <QObject>
 #include <QLoggingCategory>
 
+#include "FileCacheEvictionPolicy.h"
+
 Q_DECLARE_LOGGING_CATEGORY(file_cache)
 
 class FileCacheTests;
@@ -40,6 +42,8 @@ class FileCache : public QObject, public std::enable_shared_from_this<FileCache>
     Q_PROPERTY(size_t numCached READ getNumCachedFiles NOTIFY dirty)
     Q_PROPERTY(size_t sizeTotal READ getSizeTotalFiles NOTIFY dirty)
     Q_PROPERTY(size_t sizeCached READ getSizeCachedFiles NOTIFY dirty)
+    Q_PROPERTY(float hitRatio READ getHitRatio NOTIFY dirty)
+    Q_PROPERTY(float byteHitRatio READ getByteHitRatio NOTIFY dirty)
 
     static const size_t DEFAULT_MAX_SIZE;
     static const size_t MAX_MAX_SIZE;
@@ -61,6 +65,15 @@ public:
     size_t getSizeTotalFiles() const { return _totalFilesSize; }
     size_t getSizeCachedFiles() const { return _unusedFilesSize; }
 
+    // fraction of getFile() lookups, and of the bytes they asked for, that were found in the cache
+    // bytes that were not found are counted when they are written
+    float getHitRatio() const;
+    float getByteHitRatio() const;
+
+    // Replace the LRU eviction policy, must be called before initialize()
+    void setEvictionPolicy(EvictionPolicy::Pointer policy);
+    const EvictionPolicy& getEvictionPolicy() const { return *_evictionPolicy; }
+
     // Set the maximum amount of disk space to use on disk
     void setMaxSize(size_t maxCacheSize);
 
@@ -112,6 +125,9 @@ private:
     friend class File;
 
     std::string getFilepath(const Key& key);
+    std::string getEvictionPolicyFilepath() const;
+
+    FilePointer findFile(const Key& key);
 
     FilePointer addFile(Metadata&& metadata, const std::string& filepath);
     void addUnusedFile(const FilePointer& file);
@@ -131,6 +147,10 @@ private:
     std::atomic<size_t> _numUnusedFiles { 0 };
     std::atomic<size_t> _totalFilesSize { 0 };
     std::atomic<size_t> _unusedFilesSize { 0 };
+    std::atomic<size_t> _numLookups { 0 };
+    std::atomic<size_t> _numHits { 0 };
+    std::atomic<size_t> _hitBytes { 0 };
+    std::atomic<size_t> _missBytes { 0 };
 
     const std::string _ext;
     const std::string _dirname;
@@ -140,6 +160,7 @@ private:
     Mutex _mutex;
     Map _files;
     Set _unusedFiles;
+    EvictionPolicy::Pointer _evictionPolicy { new LRUEvictionPolicy() };
 };
 
 class File {
@@ -161,7 +182,7 @@ protected:
 
 private:
     friend class FileCache;
-    friend struct FilePointerComparator;
+    friend class EvictionPolicy;
     friend class ::FileCacheTests;
 
     const Key _key;
@@ -172,6 +193,7 @@ private:
     FileCacheWeakPointer _parent;
     int64_t _modified { 0 };
     bool _locked { false };
+    bool _admitted { false }; // past the eviction policy's admission filter
 
     bool _shouldPersist { false };
 };
@@ -0,0 +1,199 @@
+//
+//  FileCacheEvictionPolicy.cpp
+//  libraries/shared/src/shared
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "FileCacheEvictionPolicy.h"
+
+#include <algorithm>
+#include <cassert>
+#include <deque>
+
+#include <QtCore/QDataStream>
+
+#include "FileCache.h"
+#include "../NumericalConstants.h"
+
+using namespace cache;
+
+// the window of new files gets this fraction of the cache
+static const float WINDOW_FRACTION = 0.01f;
+
+// the cost of a request, in bytes worth of download time
+static const float REQUEST_COST_BYTES = (float)KB_TO_BYTES(256);
+
+static const quint32 SKETCH_VERSION = 1;
+
+int64_t EvictionPolicy::getLastAccess(const File& file) {
+    return file._modified;
+}
+
+bool EvictionPolicy::isAdmitted(const File& file) {
+    return file._admitted;
+}
+
+void EvictionPolicy::setAdmitted(File& file, bool admitted) {
+    file._admitted = admitted;
+}
+
+static void sortByLastAccess(std::vector<FilePointer>& files, int64_t (*getLastAccess)(const File&)) {
+    std::sort(files.begin(), files.end(), [&](const FilePointer& a, const FilePointer& b) {
+        return getLastAccess(*a) < getLastAccess(*b);
+    });
+}
+
+std::vector<FilePointer> LRUEvictionPolicy::selectVictims(std::vector<FilePointer> unusedFiles, size_t overbudgetAmount,
+                                                          size_t maxSize) {
+    sortByLastAccess(unusedFiles, &getLastAccess);
+
+    std::vector<FilePointer> victims;
+    for (const auto& file : unusedFiles) {
+        if (overbudgetAmount == 0) {
+            break;
+        }
+        victims.push_back(file);
+        overbudgetAmount -= std::min(file->getLength(), overbudgetAmount);
+    }
+    return victims;
+}
+
+const size_t FrequencySketch::DEFAULT_WIDTH { 4096 };
+
+FrequencySketch::FrequencySketch(size_t width) :
+    _width(width),
+    _counters(NUM_ROWS * width, 0) {
+    assert(width > 0 && (width & (width - 1)) == 0 && width <= (1 << 16));
+}
+
+uint64_t FrequencySketch::hash(const std::string& key) {
+    // FNV-1a, stable across runs and platforms since the sketch is persisted
+    uint64_t result = 14695981039346656037ULL;
+    for (char c : key) {
+        result ^= (uint8_t)c;
+        result *= 1099511628211ULL;
+    }
+    return result;
+}
+
+void FrequencySketch::increment(const std::string& key) {
+    uint64_t keyHash = hash(key);
+    bool incremented = false;
+    for (int row = 0; row < NUM_ROWS; ++row) {
+        uint8_t& counter = _counters[getIndex(keyHash, row)];
+        if (counter < MAX_FREQUENCY) {
+            ++counter;
+            incremented = true;
+        }
+    }
+
+    // enough samples for the counters to be meaningful, after which older accesses count for half
+    if (incremented && ++_numAdditions >= 10 * _width) {
+        age();
+    }
+}
+
+int FrequencySketch::getFrequency(const std::string& key) const {
+    uint64_t keyHash = hash(key);
+    int frequency = MAX_FREQUENCY;
+    for (int row = 0; row < NUM_ROWS; ++row) {
+        frequency = std::min(frequency, (int)_counters[getIndex(keyHash, row)]);
+    }
+    return frequency;
+}
+
+void FrequencySketch::age() {
+    for (auto& counter : _counters) {
+        counter >>= 1;
+    }
+    _numAdditions /= 2;
+}
+
+QByteArray FrequencySketch::save() const {
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << SKETCH_VERSION << (quint32)_width << (quint64)_numAdditions;
+    stream.writeRawData(reinterpret_cast<const char*>(_counters.data()), (int)_counters.size());
+    return data;
+}
+
+bool FrequencySketch::restore(const QByteArray& data) {
+    QDataStream stream(data);
+    quint32 version = 0;
+    quint32 width = 0;
+    quint64 numAdditions = 0;
+    stream >> version >> width >> numAdditions;
+    if (stream.status() != QDataStream::Ok || version != SKETCH_VERSION || width != _width) {
+        return false;
+    }
+
+    std::vector<uint8_t> counters(_counters.size());
+    if (stream.readRawData(reinterpret_cast<char*>(counters.data()), (int)counters.size()) != (int)counters.size()) {
+        return false;
+    }
+    _counters.swap(counters);
+    _numAdditions = numAdditions;
+    return true;
+}
+
+float TinyLFUEvictionPolicy::getScore(const File& file) const {
+    float length = (float)std::max<size_t>(file.getLength(), 1);
+    return (float)_sketch.getFrequency(file.getKey()) * (REQUEST_COST_BYTES + length) / length;
+}
+
+std::vector<FilePointer> TinyLFUEvictionPolicy::selectVictims(std::vector<FilePointer> unusedFiles, size_t overbudgetAmount,
+                                                              size_t maxSize) {
+    sortByLastAccess(unusedFiles, &getLastAccess);
+
+    struct RankedFile {
+        float score;
+        bool isAdmitted;
+        FilePointer file;
+    };
+
+    // the most recent new files stay in the window, everything else is ranked, least recently used first
+    std::deque<FilePointer> window;
+    std::vector<RankedFile> ranked;
+    size_t windowSize = (size_t)(WINDOW_FRACTION * maxSize);
+    for (auto it = unusedFiles.rbegin(); it != unusedFiles.rend(); ++it) {
+        const auto& file = *it;
+        bool admitted = isAdmitted(*file);
+        if (!admitted && file->getLength() <= windowSize) {
+            windowSize -= file->getLength();
+            window.push_front(file);
+        } else {
+            ranked.push_back({ getScore(*file), admitted, file });
+        }
+    }
+    std::reverse(ranked.begin(), ranked.end());
+
+    // a new file only stays at the expense of admitted ones with a strictly lower score
+    std::stable_sort(ranked.begin(), ranked.end(), [](const RankedFile& a, const RankedFile& b) {
+        return a.score < b.score || (a.score == b.score && !a.isAdmitted && b.isAdmitted);
+    });
+
+    std::vector<FilePointer> victims;
+    auto eject = [&](const FilePointer& file) {
+        victims.push_back(file);
+        overbudgetAmount -= std::min(file->getLength(), overbudgetAmount);
+    };
+
+    auto next = ranked.begin();
+    for (; next != ranked.end() && overbudgetAmount > 0; ++next) {
+        eject(next->file);
+    }
+    while (!window.empty() && overbudgetAmount > 0) {
+        eject(window.front());
+        window.pop_front();
+    }
+
+    // the new files that made it through are admitted
+    for (; next != ranked.end(); ++next) {
+        setAdmitted(*next->file, true);
+    }
+    return victims;
+}
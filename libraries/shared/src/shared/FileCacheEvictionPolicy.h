@@ -0,0 +1,120 @@
+//
+//  FileCacheEvictionPolicy.h
+//  libraries/shared/src/shared
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_FileCacheEvictionPolicy_h
+#define hifi_FileCacheEvictionPolicy_h
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <QtCore/QByteArray>
+
+namespace cache {
+
+class File;
+using FilePointer = std::shared_ptr<File>;
+
+// Decides which unused files a FileCache ejects when it is over budget.
+//
+// Policies are only called with the cache mutex held.
+class EvictionPolicy {
+public:
+    using Key = std::string;
+    using Pointer = std::unique_ptr<EvictionPolicy>;
+
+    virtual ~EvictionPolicy() {}
+
+    virtual const char* getName() const = 0;
+
+    // called on every lookup of key, whether the cache holds it or not
+    virtual void recordAccess(const Key& key) {}
+
+    // \return the files to eject, in order, to free at least overbudgetAmount bytes out of unusedFiles
+    virtual std::vector<FilePointer> selectVictims(std::vector<FilePointer> unusedFiles, size_t overbudgetAmount,
+                                                   size_t maxSize) = 0;
+
+    // state persisted alongside the cached files, restored before they are loaded
+    virtual QByteArray save() const { return QByteArray(); }
+    virtual void restore(const QByteArray& data) {}
+
+protected:
+    static int64_t getLastAccess(const File& file);
+    static bool isAdmitted(const File& file);
+    static void setAdmitted(File& file, bool admitted);
+};
+
+// Ejects the least recently used files first.
+class LRUEvictionPolicy : public EvictionPolicy {
+public:
+    const char* getName() const override { return "LRU"; }
+    std::vector<FilePointer> selectVictims(std::vector<FilePointer> unusedFiles, size_t overbudgetAmount,
+                                           size_t maxSize) override;
+};
+
+// Approximate access counts for an unbounded set of keys in a fixed amount of memory.
+//
+// A count-min sketch of counters saturating at 15: each key increments one counter in each of 4 rows and its frequency is the
+// smallest of them.  Every counter is halved once enough accesses were recorded, so old popularity fades away.
+class FrequencySketch {
+public:
+    static const int MAX_FREQUENCY = 15;
+
+    FrequencySketch(size_t width = DEFAULT_WIDTH);
+
+    void increment(const std::string& key);
+    int getFrequency(const std::string& key) const;
+
+    QByteArray save() const;
+    bool restore(const QByteArray& data);
+
+private:
+    static const size_t DEFAULT_WIDTH;
+    static const int NUM_ROWS = 4;
+
+    static uint64_t hash(const std::string& key);
+    size_t getIndex(uint64_t hash, int row) const { return row * _width + ((hash >> (row * 16)) & (_width - 1)); }
+
+    void age();
+
+    size_t _width; // counters per row, a power of two
+    size_t _numAdditions { 0 };
+    std::vector<uint8_t> _counters;
+};
+
+// Size aware Window TinyLFU.
+//
+// The most recently used of the files not yet admitted stay in a small window.  Every other file is ranked by its
+// frequency in the sketch, scaled by the cost of downloading it again per byte it occupies.  A new file only stays at
+// the expense of admitted ones with a strictly lower score, so one-off downloads can't flush out the textures used in
+// every session.  New files left after an eviction are admitted.
+class TinyLFUEvictionPolicy : public EvictionPolicy {
+public:
+    const char* getName() const override { return "TinyLFU"; }
+
+    void recordAccess(const Key& key) override { _sketch.increment(key); }
+    std::vector<FilePointer> selectVictims(std::vector<FilePointer> unusedFiles, size_t overbudgetAmount,
+                                           size_t maxSize) override;
+
+    QByteArray save() const override { return _sketch.save(); }
+    void restore(const QByteArray& data) override { _sketch.restore(data); }
+
+    int getFrequency(const Key& key) const { return _sketch.getFrequency(key); }
+
+private:
+    float getScore(const File& file) const;
+
+    FrequencySketch _sketch;
+};
+
+}
+
+#endif // hifi_FileCacheEvictionPolicy_h
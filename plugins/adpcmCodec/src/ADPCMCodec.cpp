@@ -0,0 +1,102 @@
+//
+//  ADPCMCodec.cpp
+//  plugins/adpcmCodec/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "ADPCMCodec.h"
+
+#include <string.h>
+
+#include <AudioADPCM.h>
+#include <AudioConstants.h>
+
+const char* ADPCMCodec::NAME { "adpcm" };
+
+void ADPCMCodec::init() {
+}
+
+void ADPCMCodec::deinit() {
+}
+
+bool ADPCMCodec::activate() {
+    CodecPlugin::activate();
+    return true;
+}
+
+void ADPCMCodec::deactivate() {
+    CodecPlugin::deactivate();
+}
+
+bool ADPCMCodec::isSupported() const {
+    return true;
+}
+
+// Both directions work on a buffer they keep between frames and hand out a shared copy of.  Once the caller lets
+// go of the last frame the buffer is written in place again, so steady state encoding doesn't allocate.
+class ADPCMEncoder : public Encoder {
+public:
+    ADPCMEncoder(int numChannels) : _adpcm(numChannels), _numChannels(numChannels) {}
+
+    virtual void encode(const QByteArray& decodedBuffer, QByteArray& encodedBuffer) override {
+        int numFrames = decodedBuffer.size() / (int)(sizeof(int16_t) * _numChannels);
+        _encodedBuffer.resize(AudioADPCM::getEncodedSize(numFrames, _numChannels));
+        _adpcm.encode((const int16_t*)decodedBuffer.constData(), (uint8_t*)_encodedBuffer.data(), numFrames);
+        encodedBuffer = _encodedBuffer;
+    }
+
+private:
+    AudioADPCM _adpcm;
+    int _numChannels;
+    QByteArray _encodedBuffer;
+};
+
+class ADPCMDecoder : public Decoder {
+public:
+    ADPCMDecoder(int numChannels) : _numChannels(numChannels) {
+        _decodedSize = AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL * sizeof(int16_t) * numChannels;
+        _encodedSize = AudioADPCM::getEncodedSize(AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL, numChannels);
+    }
+
+    virtual void decode(const QByteArray& encodedBuffer, QByteArray& decodedBuffer) override {
+        if (encodedBuffer.size() != _encodedSize) {
+            lostFrame(decodedBuffer);
+            return;
+        }
+        _decodedBuffer.resize(_decodedSize);
+        AudioADPCM::decode((const uint8_t*)encodedBuffer.constData(), (int16_t*)_decodedBuffer.data(),
+                           AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL, _numChannels);
+        decodedBuffer = _decodedBuffer;
+    }
+
+    virtual void lostFrame(QByteArray& decodedBuffer) override {
+        decodedBuffer.resize(_decodedSize);
+        memset(decodedBuffer.data(), 0, decodedBuffer.size());
+    }
+
+private:
+    int _numChannels;
+    int _decodedSize;
+    int _encodedSize;
+    QByteArray _decodedBuffer;
+};
+
+Encoder* ADPCMCodec::createEncoder(int sampleRate, int numChannels) {
+    return new ADPCMEncoder(numChannels);
+}
+
+Decoder* ADPCMCodec::createDecoder(int sampleRate, int numChannels) {
+    return new ADPCMDecoder(numChannels);
+}
+
+void ADPCMCodec::releaseEncoder(Encoder* encoder) {
+    delete encoder;
+}
+
+void ADPCMCodec::releaseDecoder(Decoder* decoder) {
+    delete decoder;
+}
@@ -10,6 +10,7 @@
 #include "AnimTests.h"
 #include <AnimNodeLoader.h>
 #include <AnimClip.h>
+#include <AnimClipFrames.h>
 #include <AnimBlendLinear.h>
 #include <AnimationLogging.h>
 #include <AnimVariant.h>
@@ -21,6 +22,7 @@
 #include <ResourceManager.h>
 #include <ResourceRequestObserver.h>
 #include <StatTracker.h>
+#include <SharedUtil.h>
 #include <test-utils/QTestExtensions.h>
 
 QTEST_MAIN(AnimTests)
@@ -697,3 +699,107 @@ void AnimTests::testExpressionEvaluator() {
 }
 
 
+
+static AnimPose randomPose() {
+    glm::quat rot = glm::normalize(glm::quat(randFloatInRange(-1.0f, 1.0f), randFloatInRange(-1.0f, 1.0f),
+                                             randFloatInRange(-1.0f, 1.0f), randFloatInRange(-1.0f, 1.0f)));
+    glm::vec3 trans(randFloatInRange(-1.0f, 1.0f), randFloatInRange(-1.0f, 1.0f), randFloatInRange(-1.0f, 1.0f));
+    glm::vec3 scale(randFloatInRange(0.5f, 2.0f), randFloatInRange(0.5f, 2.0f), randFloatInRange(0.5f, 2.0f));
+    return AnimPose(scale, rot, trans);
+}
+
+static AnimClipFrames::Pointer buildRandomClipFrames(int numFrames, int numJoints, std::vector<AnimPoseVec>& poses) {
+    AnimClipFrames::Pointer frames = std::make_shared<AnimClipFrames>(numFrames, numJoints);
+    poses.resize(numFrames);
+    for (int frame = 0; frame < numFrames; frame++) {
+        poses[frame].resize(numJoints);
+        for (int joint = 0; joint < numJoints; joint++) {
+            poses[frame][joint] = randomPose();
+            frames->setPose(frame, joint, poses[frame][joint]);
+        }
+    }
+    return frames;
+}
+
+void AnimTests::testClipFramesBlend() {
+    // an odd joint count exercises the padding at the end of each run
+    const int NUM_FRAMES = 4;
+    const int NUM_JOINTS = 67;
+    std::vector<AnimPoseVec> poses;
+    AnimClipFrames::Pointer frames = buildRandomClipFrames(NUM_FRAMES, NUM_JOINTS, poses);
+
+    for (int frame = 0; frame < NUM_FRAMES; frame++) {
+        for (int joint = 0; joint < NUM_JOINTS; joint++) {
+            QCOMPARE_WITH_ABS_ERROR(frames->getPose(frame, joint).rot(), poses[frame][joint].rot(), TEST_EPSILON);
+        }
+    }
+
+    const float alphas[] = { 0.0f, 0.25f, 0.5f, 0.9f, 1.0f };
+    for (float alpha : alphas) {
+        AnimPoseVec expected(NUM_JOINTS);
+        AnimPoseVec scalar(NUM_JOINTS);
+        AnimPoseVec simd(NUM_JOINTS);
+        ::blend(NUM_JOINTS, &poses[1][0], &poses[2][0], alpha, &expected[0]);
+        frames->blendScalar(1, 2, alpha, &scalar[0]);
+        frames->blend(1, 2, alpha, &simd[0]);
+        for (int joint = 0; joint < NUM_JOINTS; joint++) {
+            QCOMPARE_WITH_ABS_ERROR(scalar[joint].rot(), expected[joint].rot(), TEST_EPSILON);
+            QCOMPARE_WITH_ABS_ERROR(simd[joint].rot(), expected[joint].rot(), TEST_EPSILON);
+            QCOMPARE_WITH_ABS_ERROR(simd[joint].trans(), expected[joint].trans(), TEST_EPSILON);
+            QCOMPARE_WITH_ABS_ERROR(simd[joint].scale(), expected[joint].scale(), TEST_EPSILON);
+        }
+    }
+}
+
+void AnimTests::benchmarkClipFramesBlend() {
+    // a crowd: every avatar evaluates several clips per frame, all sharing the same few animations
+    const int NUM_AVATARS = 100;
+    const int NUM_CLIPS = 5;
+    const int NUM_FRAMES = 60;
+    const int NUM_JOINTS = 70;
+    const int NUM_UPDATES = 30;
+
+    std::vector<std::vector<AnimPoseVec>> perFramePoses(NUM_CLIPS);
+    std::vector<AnimClipFrames::Pointer> clipFrames;
+    for (int clip = 0; clip < NUM_CLIPS; clip++) {
+        clipFrames.push_back(buildRandomClipFrames(NUM_FRAMES, NUM_JOINTS, perFramePoses[clip]));
+    }
+    std::vector<AnimPoseVec> outputs(NUM_AVATARS * NUM_CLIPS, AnimPoseVec(NUM_JOINTS));
+
+    uint64_t startTime = usecTimestampNow();
+    for (int update = 0; update < NUM_UPDATES; update++) {
+        float frame = (float)update * 0.37f;
+        for (int avatar = 0; avatar < NUM_AVATARS; avatar++) {
+            for (int clip = 0; clip < NUM_CLIPS; clip++) {
+                int prevIndex = ((int)frame + avatar) % NUM_FRAMES;
+                int nextIndex = (prevIndex + 1) % NUM_FRAMES;
+                const std::vector<AnimPoseVec>& poses = perFramePoses[clip];
+                ::blend(NUM_JOINTS, &poses[prevIndex][0], &poses[nextIndex][0], glm::fract(frame), &outputs[avatar * NUM_CLIPS + clip][0]);
+            }
+        }
+    }
+    uint64_t aosTime = usecTimestampNow() - startTime;
+
+    startTime = usecTimestampNow();
+    for (int update = 0; update < NUM_UPDATES; update++) {
+        float frame = (float)update * 0.37f;
+        for (int avatar = 0; avatar < NUM_AVATARS; avatar++) {
+            for (int clip = 0; clip < NUM_CLIPS; clip++) {
+                int prevIndex = ((int)frame + avatar) % NUM_FRAMES;
+                int nextIndex = (prevIndex + 1) % NUM_FRAMES;
+                clipFrames[clip]->blend(prevIndex, nextIndex, glm::fract(frame), &outputs[avatar * NUM_CLIPS + clip][0]);
+            }
+        }
+    }
+    uint64_t soaTime = usecTimestampNow() - startTime;
+
+    size_t aosBytes = NUM_CLIPS * NUM_FRAMES * NUM_JOINTS * sizeof(AnimPose) * NUM_AVATARS;
+    size_t soaBytes = 0;
+    for (const auto& frames : clipFrames) {
+        soaBytes += frames->getMemoryUsage();
+    }
+
+    qDebug() << NUM_AVATARS << "avatars x" << NUM_CLIPS << "clips," << NUM_UPDATES << "updates:";
+    qDebug() << "    per-frame AnimPoseVec blend:" << aosTime << "usec," << aosBytes << "bytes of keyframes";
+    qDebug() << "    shared AnimClipFrames blend:" << soaTime << "usec," << soaBytes << "bytes of keyframes";
+}
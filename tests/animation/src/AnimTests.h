@@ -30,6 +30,8 @@ private slots:
     void testExpressionTokenizer();
     void testExpressionParser();
     void testExpressionEvaluator();
+    void testClipFramesBlend();
+    void benchmarkClipFramesBlend();
 };
 
 #endif // hifi_AnimTests_h
@@ -0,0 +1,147 @@
+//
+//  AudioADPCMTests.cpp
+//  tests/audio/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "AudioADPCMTests.h"
+
+#include <cmath>
+#include <functional>
+#include <vector>
+
+#include <AudioADPCM.h>
+#include <AudioConstants.h>
+#include <NumericalConstants.h>
+#include <SharedUtil.h>
+
+QTEST_GUILESS_MAIN(AudioADPCMTests)
+
+static const int NUM_FRAMES = AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL;
+static const int NUM_CHANNELS = 2;
+
+// a tone on the left and a mix of two on the right, continuing from one frame to the next
+static void fillFrame(std::vector<int16_t>& samples, int frame) {
+    samples.resize(NUM_FRAMES * NUM_CHANNELS);
+    for (int i = 0; i < NUM_FRAMES; ++i) {
+        float t = (float)(frame * NUM_FRAMES + i) / AudioConstants::SAMPLE_RATE;
+        samples[i * NUM_CHANNELS] = (int16_t)(10000.0f * sinf(TWO_PI * 440.0f * t));
+        samples[i * NUM_CHANNELS + 1] = (int16_t)(8000.0f * sinf(TWO_PI * 1000.0f * t) + 2000.0f * sinf(TWO_PI * 3100.0f * t));
+    }
+}
+
+void AudioADPCMTests::testRoundTrip() {
+    AudioADPCM adpcm(NUM_CHANNELS);
+    std::vector<int16_t> input;
+    std::vector<uint8_t> encoded(AudioADPCM::getEncodedSize(NUM_FRAMES, NUM_CHANNELS));
+    std::vector<int16_t> decoded(NUM_FRAMES * NUM_CHANNELS);
+
+    QCOMPARE((int)encoded.size(), 248);
+
+    double signal = 0.0;
+    double noise = 0.0;
+    for (int frame = 0; frame < 100; ++frame) {
+        fillFrame(input, frame);
+        adpcm.encode(input.data(), encoded.data(), NUM_FRAMES);
+        AudioADPCM::decode(encoded.data(), decoded.data(), NUM_FRAMES, NUM_CHANNELS);
+
+        // the first sample of each channel is sent as is
+        QCOMPARE(decoded[0], input[0]);
+        QCOMPARE(decoded[1], input[1]);
+
+        // leave the step sizes a couple of frames to adapt
+        if (frame >= 2) {
+            for (size_t i = 0; i < input.size(); ++i) {
+                double error = (double)input[i] - decoded[i];
+                signal += (double)input[i] * input[i];
+                noise += error * error;
+            }
+        }
+    }
+
+    double snr = 10.0 * log10(signal / noise);
+    qDebug() << "ADPCM signal to noise ratio:" << snr << "dB";
+    QVERIFY(snr > 25.0);
+}
+
+void AudioADPCMTests::testSilence() {
+    AudioADPCM adpcm(NUM_CHANNELS);
+    std::vector<int16_t> input(NUM_FRAMES * NUM_CHANNELS, 0);
+    std::vector<uint8_t> encoded(AudioADPCM::getEncodedSize(NUM_FRAMES, NUM_CHANNELS));
+    std::vector<int16_t> decoded(NUM_FRAMES * NUM_CHANNELS, 1);
+
+    adpcm.encode(input.data(), encoded.data(), NUM_FRAMES);
+    AudioADPCM::decode(encoded.data(), decoded.data(), NUM_FRAMES, NUM_CHANNELS);
+    QVERIFY(decoded == input);
+}
+
+void AudioADPCMTests::testCorruptHeader() {
+    AudioADPCM adpcm(NUM_CHANNELS);
+    std::vector<int16_t> input;
+    std::vector<uint8_t> encoded(AudioADPCM::getEncodedSize(NUM_FRAMES, NUM_CHANNELS));
+    std::vector<int16_t> decoded(NUM_FRAMES * NUM_CHANNELS);
+
+    fillFrame(input, 0);
+    adpcm.encode(input.data(), encoded.data(), NUM_FRAMES);
+
+    // a step index past the table is clamped rather than read out of bounds
+    encoded[2] = 0xff;
+    encoded[AudioADPCM::getEncodedSize(NUM_FRAMES, 1) + 2] = 0xff;
+    AudioADPCM::decode(encoded.data(), decoded.data(), NUM_FRAMES, NUM_CHANNELS);
+    QCOMPARE(decoded[0], input[0]);
+    QCOMPARE(decoded[1], input[1]);
+}
+
+void AudioADPCMTests::benchmarkEncode() {
+    const int NUM_ENCODES = 10000;
+
+    std::vector<int16_t> input;
+    fillFrame(input, 0);
+    QByteArray decodedBuffer(reinterpret_cast<const char*>(input.data()), AudioConstants::NETWORK_FRAME_BYTES_STEREO);
+
+    // usecs per encode and bytes per frame, for a frame sent to one listener the way the mixer encodes it
+    auto measure = [&](const std::function<void(const QByteArray&, QByteArray&)>& encode) {
+        int encodedSize = 0;
+        quint64 start = usecTimestampNow();
+        for (int i = 0; i < NUM_ENCODES; ++i) {
+            QByteArray encodedBuffer;
+            encode(decodedBuffer, encodedBuffer);
+            encodedSize = encodedBuffer.size();
+        }
+        float usecs = (float)(usecTimestampNow() - start) / NUM_ENCODES;
+        return std::make_pair(usecs, encodedSize);
+    };
+
+    // the pcm and zlib codecs of the pcmCodec plugin
+    auto pcm = measure([](const QByteArray& decodedBuffer, QByteArray& encodedBuffer) {
+        encodedBuffer = decodedBuffer;
+    });
+    auto zlib = measure([](const QByteArray& decodedBuffer, QByteArray& encodedBuffer) {
+        encodedBuffer = qCompress(decodedBuffer);
+    });
+
+    // the adpcmCodec plugin's encoder
+    AudioADPCM adpcm(NUM_CHANNELS);
+    QByteArray adpcmBuffer;
+    auto adpcmResult = measure([&](const QByteArray& decodedBuffer, QByteArray& encodedBuffer) {
+        adpcmBuffer.resize(AudioADPCM::getEncodedSize(NUM_FRAMES, NUM_CHANNELS));
+        adpcm.encode(reinterpret_cast<const int16_t*>(decodedBuffer.constData()),
+                     reinterpret_cast<uint8_t*>(adpcmBuffer.data()), NUM_FRAMES);
+        encodedBuffer = adpcmBuffer;
+    });
+
+    auto report = [](const char* name, const std::pair<float, int>& result) {
+        float kbps = result.second * 8.0f * AudioConstants::NETWORK_FRAMES_PER_SEC / 1000.0f;
+        qDebug() << name << ":" << result.first << "usecs per encode," << result.second << "bytes per frame,"
+                 << kbps << "kbps per listener";
+    };
+    report("pcm", pcm);
+    report("zlib", zlib);
+    report("adpcm", adpcmResult);
+
+    QVERIFY(adpcmResult.second * 3 < pcm.second);
+}
@@ -0,0 +1,25 @@
+//
+//  AudioADPCMTests.h
+//  tests/audio/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AudioADPCMTests_h
+#define hifi_AudioADPCMTests_h
+
+#include <QtTest/QtTest>
+
+class AudioADPCMTests : public QObject {
+    Q_OBJECT
+private slots:
+    void testRoundTrip();
+    void testSilence();
+    void testCorruptHeader();
+    void benchmarkEncode();
+};
+
+#endif // hifi_AudioADPCMTests_h
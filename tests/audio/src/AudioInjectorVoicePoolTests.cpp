@@ -0,0 +1,199 @@
+//
+//  AudioInjectorVoicePoolTests.cpp
+//  tests/audio/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "AudioInjectorVoicePoolTests.h"
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <AbstractAudioInterface.h>
+#include <AudioConstants.h>
+#include <AudioInjectorManager.h>
+#include <AudioInjectorVoicePool.h>
+#include <DependencyManager.h>
+#include <NumericalConstants.h>
+#include <Sound.h>
+
+QTEST_GUILESS_MAIN(AudioInjectorVoicePoolTests)
+
+static const int NUM_SECONDS = 2;
+static const int NUM_FRAMES = NUM_SECONDS * AudioConstants::SAMPLE_RATE / AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL;
+
+// plays local injectors on the pool under test, the way AudioClient does, without any audio devices
+class TestAudioInterface : public AbstractAudioInterface {
+public:
+    bool outputLocalInjector(const AudioInjectorPointer& injector) override {
+        return injector->getLocalBuffer() && pool->queueInjector(injector);
+    }
+    AudioSolo& getAudioSolo() override { return _audioSolo; }
+
+    bool setIsStereoInput(bool stereo) override { return false; }
+    bool isStereoInput() override { return false; }
+    bool getLocalEcho() override { return false; }
+    void setLocalEcho(bool localEcho) override {}
+    void toggleLocalEcho() override {}
+    bool getServerEcho() override { return false; }
+    void setServerEcho(bool serverEcho) override {}
+    void toggleServerEcho() override {}
+
+    std::unique_ptr<AudioInjectorVoicePool> pool;
+
+private:
+    AudioSolo _audioSolo;
+};
+
+static TestAudioInterface* audioInterface { nullptr };
+static AudioDataPointer tone;
+
+static AudioInjectorPointer playTone(const glm::vec3& position, bool loop = false) {
+    AudioInjectorOptions options;
+    options.localOnly = true;
+    options.positionSet = true;
+    options.position = position;
+    options.loop = loop;
+    return DependencyManager::get<AudioInjectorManager>()->playSound(tone, options);
+}
+
+// each injector somewhere around the listener, further away as they go
+static glm::vec3 positionForInjector(int index) {
+    float angle = TWO_PI * index / AudioInjectorVoicePool::MAX_VOICES;
+    float distance = 1.0f + (float)index / 16.0f;
+    return distance * glm::vec3(sinf(angle), 0.0f, -cosf(angle));
+}
+
+static bool isSilent(const std::vector<float>& mixBuffer) {
+    for (float sample : mixBuffer) {
+        if (sample != 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void AudioInjectorVoicePoolTests::initTestCase() {
+    std::vector<int16_t> samples(NUM_SECONDS * AudioConstants::SAMPLE_RATE);
+    for (size_t i = 0; i < samples.size(); ++i) {
+        samples[i] = (int16_t)(8000.0f * sinf(TWO_PI * 440.0f * i / AudioConstants::SAMPLE_RATE));
+    }
+    tone = AudioData::make((uint32_t)samples.size(), AudioConstants::MONO, samples.data());
+
+    DependencyManager::set<AudioInjectorManager>();
+    audioInterface = new TestAudioInterface();
+    AudioInjector::setLocalAudioInterface(audioInterface);
+}
+
+void AudioInjectorVoicePoolTests::cleanupTestCase() {
+    AudioInjector::setLocalAudioInterface(nullptr);
+    DependencyManager::destroy<AudioInjectorManager>();
+    delete audioInterface;
+    audioInterface = nullptr;
+}
+
+void AudioInjectorVoicePoolTests::testManyInjectors() {
+    audioInterface->pool.reset(new AudioInjectorVoicePool());
+    auto& pool = *audioInterface->pool;
+
+    AudioInjectorVoicePool::Listener listener;
+    std::vector<float> mixBuffer(AudioConstants::NETWORK_FRAME_SAMPLES_STEREO);
+
+    QVERIFY(!pool.hasInjectors());
+    QVERIFY(!pool.mix(mixBuffer.data(), listener));
+
+    std::vector<AudioInjectorPointer> injectors;
+    for (int i = 0; i < AudioInjectorVoicePool::MAX_VOICES; ++i) {
+        injectors.push_back(playTone(positionForInjector(i)));
+        QVERIFY(injectors.back());
+    }
+
+    // every injector gets a voice on the next frame
+    QVERIFY(pool.hasInjectors());
+    QVERIFY(pool.mix(mixBuffer.data(), listener));
+    QCOMPARE(pool.getNumVoices(), AudioInjectorVoicePool::MAX_VOICES);
+    QVERIFY(!isSilent(mixBuffer));
+
+    // and plays until its sound runs out
+    int numFrames = 1;
+    while (pool.mix(mixBuffer.data(), listener)) {
+        ++numFrames;
+        QVERIFY(numFrames <= NUM_FRAMES + 2);
+    }
+    QVERIFY(numFrames >= NUM_FRAMES);
+    QCOMPARE(pool.getNumVoices(), 0);
+    QVERIFY(!pool.hasInjectors());
+}
+
+void AudioInjectorVoicePoolTests::testVoiceStealing() {
+    audioInterface->pool.reset(new AudioInjectorVoicePool());
+    auto& pool = *audioInterface->pool;
+
+    AudioInjectorVoicePool::Listener listener;
+    std::vector<float> mixBuffer(AudioConstants::NETWORK_FRAME_SAMPLES_STEREO);
+
+    // the pool holds the only references, so an injector is gone once its voice lets go of it
+    std::vector<QWeakPointer<AudioInjector>> injectors;
+    for (int i = 0; i < AudioInjectorVoicePool::MAX_VOICES; ++i) {
+        injectors.push_back(playTone(positionForInjector(i), true));
+    }
+    QVERIFY(pool.mix(mixBuffer.data(), listener));
+    QCOMPARE(pool.getNumVoices(), AudioInjectorVoicePool::MAX_VOICES);
+
+    // further away than any voice playing, so it is dropped
+    QWeakPointer<AudioInjector> quieter = playTone(glm::vec3(0.0f, 0.0f, -1000.0f), true);
+    QVERIFY(!quieter.isNull());
+    QVERIFY(pool.mix(mixBuffer.data(), listener));
+    QCOMPARE(pool.getNumVoices(), AudioInjectorVoicePool::MAX_VOICES);
+    QVERIFY(quieter.isNull());
+
+    // closer than any voice playing, so it takes the furthest one's place
+    QWeakPointer<AudioInjector> louder = playTone(glm::vec3(0.0f, 0.0f, -0.5f), true);
+    QVERIFY(pool.mix(mixBuffer.data(), listener));
+    QCOMPARE(pool.getNumVoices(), AudioInjectorVoicePool::MAX_VOICES);
+    QVERIFY(!louder.isNull());
+    QVERIFY(injectors.back().isNull());
+    QVERIFY(!injectors.front().isNull());
+
+    audioInterface->pool.reset();
+}
+
+void AudioInjectorVoicePoolTests::testQueueFull() {
+    AudioInjectorVoicePool pool;
+
+    AudioInjectorOptions options;
+    options.localOnly = true;
+    auto injector = AudioInjectorPointer::create(tone, options);
+
+    for (int i = 0; i < AudioInjectorVoicePool::MAX_QUEUED_INJECTORS; ++i) {
+        QVERIFY(pool.queueInjector(injector));
+    }
+    QVERIFY(!pool.queueInjector(injector));
+    QVERIFY(pool.hasInjectors());
+}
+
+void AudioInjectorVoicePoolTests::benchmarkMix() {
+    audioInterface->pool.reset(new AudioInjectorVoicePool());
+    auto& pool = *audioInterface->pool;
+
+    AudioInjectorVoicePool::Listener listener;
+    std::vector<float> mixBuffer(AudioConstants::NETWORK_FRAME_SAMPLES_STEREO);
+
+    std::vector<AudioInjectorPointer> injectors;
+    for (int i = 0; i < AudioInjectorVoicePool::MAX_VOICES; ++i) {
+        injectors.push_back(playTone(positionForInjector(i), true));
+    }
+
+    // a frame of every voice, as the audio thread mixes it
+    QBENCHMARK {
+        pool.mix(mixBuffer.data(), listener);
+    }
+    QCOMPARE(pool.getNumVoices(), AudioInjectorVoicePool::MAX_VOICES);
+
+    audioInterface->pool.reset();
+}
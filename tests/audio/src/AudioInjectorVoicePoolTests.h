@@ -0,0 +1,28 @@
+//
+//  AudioInjectorVoicePoolTests.h
+//  tests/audio/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AudioInjectorVoicePoolTests_h
+#define hifi_AudioInjectorVoicePoolTests_h
+
+#include <QtTest/QtTest>
+
+class AudioInjectorVoicePoolTests : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testManyInjectors();
+    void testVoiceStealing();
+    void testQueueFull();
+    void benchmarkMix();
+};
+
+#endif // hifi_AudioInjectorVoicePoolTests_h
@@ -0,0 +1,196 @@
+//
+//  FBXParserTests.cpp
+//  tests/fbx/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "FBXParserTests.h"
+
+#include <QtCore/QBuffer>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+
+#include <FBXSerializer.h>
+#include <NumericalConstants.h>
+#include <SharedUtil.h>
+
+QTEST_GUILESS_MAIN(FBXParserTests)
+
+// sample models and animations shipped with interface, from a few kilobytes to a few megabytes
+static const char* SAMPLE_FILES[] = {
+    "interface/resources/meshes/tablet-with-home-button.fbx",
+    "interface/resources/meshes/controller/touch/touch_l.fbx",
+    "interface/resources/meshes/controller/vive_body.fbx",
+    "interface/resources/avatar/animations/idle.fbx",
+    "interface/resources/avatar/animations/idle03.fbx",
+    "unpublishedScripts/marketplace/gameTable/assets/table/gameTable.fbx",
+};
+
+static QString getSamplePath(const char* file) {
+    QDir root(QFileInfo(__FILE__).absolutePath() + "/../../..");
+    return QDir::cleanPath(root.absoluteFilePath(file));
+}
+
+static QByteArray readSample(const char* file) {
+    QFile sample(getSamplePath(file));
+    if (!sample.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return sample.readAll();
+}
+
+template <typename T>
+static bool compareArrays(const QVariant& a, const QVariant& b) {
+    return a.value<QVector<T>>() == b.value<QVector<T>>();
+}
+
+static bool compareProperties(const QVariant& a, const QVariant& b) {
+    if (a.userType() != b.userType()) {
+        return false;
+    }
+    int type = a.userType();
+    if (type == qMetaTypeId<QVector<float>>()) {
+        return compareArrays<float>(a, b);
+    } else if (type == qMetaTypeId<QVector<double>>()) {
+        return compareArrays<double>(a, b);
+    } else if (type == qMetaTypeId<QVector<qint64>>()) {
+        return compareArrays<qint64>(a, b);
+    } else if (type == qMetaTypeId<QVector<qint32>>()) {
+        return compareArrays<qint32>(a, b);
+    } else if (type == qMetaTypeId<QVector<bool>>()) {
+        return compareArrays<bool>(a, b);
+    }
+    return a == b;
+}
+
+static bool compareNodes(const FBXNode& a, const FBXNode& b) {
+    if (a.name != b.name || a.properties.size() != b.properties.size() || a.children.size() != b.children.size()) {
+        return false;
+    }
+    for (int i = 0; i < a.properties.size(); ++i) {
+        if (!compareProperties(a.properties.at(i), b.properties.at(i))) {
+            return false;
+        }
+    }
+    for (int i = 0; i < a.children.size(); ++i) {
+        if (!compareNodes(a.children.at(i), b.children.at(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// what the tree of a sample file holds, to check a parse against the file's known contents
+struct TreeStats {
+    int numNodes { 0 };
+    int numProperties { 0 };
+    int numVertices { 0 };
+    int numPolygonVertexIndices { 0 };
+    double vertexSum { 0.0 };
+};
+
+static void accumulateTreeStats(const FBXNode& node, TreeStats& stats) {
+    for (const auto& child : node.children) {
+        ++stats.numNodes;
+        stats.numProperties += child.properties.size();
+        if (child.name == "Vertices" && !child.properties.isEmpty()) {
+            auto vertices = FBXSerializer::getDoubleVector(child);
+            stats.numVertices += vertices.size() / 3;
+            for (double value : vertices) {
+                stats.vertexSum += value;
+            }
+        } else if (child.name == "PolygonVertexIndex" && !child.properties.isEmpty()) {
+            stats.numPolygonVertexIndices += FBXSerializer::getIntVector(child).size();
+        }
+        accumulateTreeStats(child, stats);
+    }
+}
+
+void FBXParserTests::testParseMappedFile() {
+    const char* file = "interface/resources/meshes/tablet-with-home-button.fbx";
+    QByteArray data = readSample(file);
+    if (data.isEmpty()) {
+        QSKIP("sample FBX file not found");
+    }
+
+    // the mapped file, the in-memory data and a device all parse to the same tree
+    FBXNode mapped = FBXSerializer::parseFBXFile(getSamplePath(file));
+    FBXNode inMemory = FBXSerializer::parseFBX(data);
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::ReadOnly);
+    FBXNode fromDevice = FBXSerializer::parseFBX(&buffer);
+
+    QVERIFY(compareNodes(mapped, inMemory));
+    QVERIFY(compareNodes(mapped, fromDevice));
+
+    // and that tree holds the file's known contents, counted the way the QDataStream parser this one replaced read them
+    QStringList topLevelNames;
+    for (const auto& child : mapped.children) {
+        topLevelNames << child.name;
+    }
+    QCOMPARE(topLevelNames, QStringList({ "FBXHeaderExtension", "FileId", "CreationTime", "Creator", "GlobalSettings",
+                                          "Documents", "References", "Definitions", "Objects", "Connections", "Takes" }));
+
+    TreeStats stats;
+    accumulateTreeStats(mapped, stats);
+    QCOMPARE(stats.numNodes, 617);
+    QCOMPARE(stats.numProperties, 2073);
+
+    // all 14 of its arrays are compressed, so these were inflated
+    QCOMPARE(stats.numVertices, 818);
+    QCOMPARE(stats.numPolygonVertexIndices, 2136);
+    QVERIFY(qAbs(stats.vertexSum - 109.946074025) < 1.0e-6);
+}
+
+void FBXParserTests::testTruncatedFile() {
+    QByteArray data = readSample("interface/resources/meshes/tablet-with-home-button.fbx");
+    if (data.isEmpty()) {
+        QSKIP("sample FBX file not found");
+    }
+
+    data.truncate(data.size() / 2);
+    QVERIFY_EXCEPTION_THROWN(FBXSerializer::parseFBX(data), QString);
+}
+
+void FBXParserTests::benchmarkParse() {
+    const int NUM_ITERATIONS = 10;
+
+    for (const char* file : SAMPLE_FILES) {
+        QString path = getSamplePath(file);
+        QByteArray data = readSample(file);
+        if (data.isEmpty()) {
+            qDebug() << "Skipping missing sample" << file;
+            continue;
+        }
+
+        auto start = usecTimestampNow();
+        for (int i = 0; i < NUM_ITERATIONS; ++i) {
+            FBXSerializer::parseFBX(data);
+        }
+        auto inMemoryTime = (usecTimestampNow() - start) / NUM_ITERATIONS;
+
+        start = usecTimestampNow();
+        for (int i = 0; i < NUM_ITERATIONS; ++i) {
+            FBXSerializer::parseFBXFile(path);
+        }
+        auto mappedTime = (usecTimestampNow() - start) / NUM_ITERATIONS;
+
+        start = usecTimestampNow();
+        for (int i = 0; i < NUM_ITERATIONS; ++i) {
+            FBXSerializer serializer;
+            serializer.read(data, hifi::VariantHash(), hifi::URL::fromLocalFile(path));
+        }
+        auto readTime = (usecTimestampNow() - start) / NUM_ITERATIONS;
+
+        float megabytes = (float)data.size() / (float)MB_TO_BYTES(1);
+        qDebug() << QFileInfo(file).fileName() << megabytes << "MB";
+        qDebug() << "    parse in memory:" << (float)inMemoryTime / USECS_PER_MSEC << "ms";
+        qDebug() << "    parse mapped file:" << (float)mappedTime / USECS_PER_MSEC << "ms";
+        qDebug() << "    parse and extract HFMModel:" << (float)readTime / USECS_PER_MSEC << "ms";
+    }
+}
@@ -0,0 +1,265 @@
+//
+//  GLTFSerializerTests.cpp
+//  tests/fbx/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "GLTFSerializerTests.h"
+
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/QtEndian>
+
+#include <GLTFSerializer.h>
+#include <NumericalConstants.h>
+#include <ResourceManager.h>
+#include <ResourceRequestObserver.h>
+#include <SharedUtil.h>
+#include <StatTracker.h>
+
+QTEST_GUILESS_MAIN(GLTFSerializerTests)
+
+enum BufferSource {
+    EMBEDDED_BUFFERS = 0,
+    EXTERNAL_BUFFERS,
+    GLB_BUFFER
+};
+
+// a grid of gridSize x gridSize vertices per mesh, with positions, normals, texture coordinates and 32 bit indices
+static QJsonObject buildScene(int numMeshes, int gridSize, bool isSingleBuffer, QVector<QByteArray>& buffers) {
+    QJsonArray jsonBufferViews;
+    QJsonArray jsonAccessors;
+    QJsonArray jsonMeshes;
+    QJsonArray jsonNodes;
+    QJsonArray sceneNodes;
+
+    auto addAccessor = [&](int buffer, const QByteArray& data, int componentType, int count, const QString& type) {
+        jsonBufferViews.append(QJsonObject {
+            { "buffer", buffer },
+            { "byteOffset", buffers[buffer].size() },
+            { "byteLength", data.size() }
+        });
+        buffers[buffer].append(data);
+        jsonAccessors.append(QJsonObject {
+            { "bufferView", jsonBufferViews.size() - 1 },
+            { "componentType", componentType },
+            { "count", count },
+            { "type", type }
+        });
+        return jsonAccessors.size() - 1;
+    };
+
+    buffers.clear();
+    for (int mesh = 0; mesh < numMeshes; ++mesh) {
+        int buffer = isSingleBuffer ? 0 : mesh;
+        if (buffer == buffers.size()) {
+            buffers.push_back(QByteArray());
+        }
+
+        QVector<float> positions;
+        QVector<float> normals;
+        QVector<float> texCoords;
+        QVector<quint32> indices;
+        for (int z = 0; z < gridSize; ++z) {
+            for (int x = 0; x < gridSize; ++x) {
+                positions << (float)x << (float)mesh << (float)z;
+                normals << 0.0f << 1.0f << 0.0f;
+                texCoords << (float)x / gridSize << (float)z / gridSize;
+                if (x + 1 < gridSize && z + 1 < gridSize) {
+                    quint32 corner = z * gridSize + x;
+                    indices << corner << corner + gridSize << corner + 1;
+                    indices << corner + 1 << corner + gridSize << corner + gridSize + 1;
+                }
+            }
+        }
+        int numVertices = gridSize * gridSize;
+        auto toBytes = [](const auto& values) {
+            return QByteArray((const char*)values.constData(), values.size() * (int)sizeof(values[0]));
+        };
+        QJsonObject attributes {
+            { "POSITION", addAccessor(buffer, toBytes(positions), GLTFAccessorComponentType::FLOAT, numVertices, "VEC3") },
+            { "NORMAL", addAccessor(buffer, toBytes(normals), GLTFAccessorComponentType::FLOAT, numVertices, "VEC3") },
+            { "TEXCOORD_0", addAccessor(buffer, toBytes(texCoords), GLTFAccessorComponentType::FLOAT, numVertices, "VEC2") }
+        };
+        int indicesAccessor = addAccessor(buffer, toBytes(indices), GLTFAccessorComponentType::UNSIGNED_INT,
+                                          indices.size(), "SCALAR");
+
+        jsonMeshes.append(QJsonObject {
+            { "primitives", QJsonArray { QJsonObject { { "attributes", attributes }, { "indices", indicesAccessor } } } }
+        });
+        jsonNodes.append(QJsonObject { { "name", QString("mesh%1").arg(mesh) }, { "mesh", mesh } });
+        sceneNodes.append(mesh);
+    }
+
+    return QJsonObject {
+        { "asset", QJsonObject { { "version", "2.0" } } },
+        { "scene", 0 },
+        { "scenes", QJsonArray { QJsonObject { { "nodes", sceneNodes } } } },
+        { "nodes", jsonNodes },
+        { "meshes", jsonMeshes },
+        { "accessors", jsonAccessors },
+        { "bufferViews", jsonBufferViews }
+    };
+}
+
+static QByteArray padChunk(QByteArray chunk, char padding) {
+    while (chunk.size() % 4 != 0) {
+        chunk.append(padding);
+    }
+    return chunk;
+}
+
+static void appendUInt32(QByteArray& data, quint32 value) {
+    value = qToLittleEndian(value);
+    data.append((const char*)&value, sizeof(value));
+}
+
+// \return the contents of the model file, external buffers are written next to url
+static QByteArray writeScene(int numMeshes, int gridSize, BufferSource source, const QUrl& url) {
+    QVector<QByteArray> buffers;
+    QJsonObject scene = buildScene(numMeshes, gridSize, source == GLB_BUFFER, buffers);
+
+    QJsonArray jsonBuffers;
+    for (int i = 0; i < buffers.size(); ++i) {
+        QJsonObject jsonBuffer { { "byteLength", buffers[i].size() } };
+        if (source == EMBEDDED_BUFFERS) {
+            jsonBuffer["uri"] = "data:application/octet-stream;base64," + QString::fromLatin1(buffers[i].toBase64());
+        } else if (source == EXTERNAL_BUFFERS) {
+            QString fileName = QString("buffer%1.bin").arg(i);
+            QFile file(QFileInfo(url.toLocalFile()).dir().filePath(fileName));
+            file.open(QIODevice::WriteOnly);
+            file.write(buffers[i]);
+            jsonBuffer["uri"] = fileName;
+        }
+        jsonBuffers.append(jsonBuffer);
+    }
+    scene["buffers"] = jsonBuffers;
+
+    QByteArray json = QJsonDocument(scene).toJson(QJsonDocument::Compact);
+    if (source != GLB_BUFFER) {
+        return json;
+    }
+
+    const quint32 GLB_VERSION = 2;
+    const quint32 GLB_CHUNK_TYPE_JSON = 0x4E4F534A;
+    const quint32 GLB_CHUNK_TYPE_BIN = 0x004E4942;
+    QByteArray jsonChunk = padChunk(json, ' ');
+    QByteArray binChunk = padChunk(buffers[0], '\0');
+
+    QByteArray glb("glTF");
+    appendUInt32(glb, GLB_VERSION);
+    appendUInt32(glb, 12 + 8 + jsonChunk.size() + 8 + binChunk.size());
+    appendUInt32(glb, jsonChunk.size());
+    appendUInt32(glb, GLB_CHUNK_TYPE_JSON);
+    glb.append(jsonChunk);
+    appendUInt32(glb, binChunk.size());
+    appendUInt32(glb, GLB_CHUNK_TYPE_BIN);
+    glb.append(binChunk);
+    return glb;
+}
+
+static QUrl getSceneUrl(const QTemporaryDir& dir, BufferSource source) {
+    return QUrl::fromLocalFile(dir.filePath(source == GLB_BUFFER ? "scene.glb" : "scene.gltf"));
+}
+
+void GLTFSerializerTests::initTestCase() {
+    DependencyManager::set<StatTracker>();
+    DependencyManager::set<ResourceRequestObserver>();
+    DependencyManager::set<ResourceManager>();
+}
+
+void GLTFSerializerTests::cleanupTestCase() {
+    DependencyManager::get<ResourceManager>()->cleanup();
+}
+
+void GLTFSerializerTests::testBufferSources() {
+    const int NUM_MESHES = 4;
+    const int GRID_SIZE = 64;
+    const int NUM_VERTICES = GRID_SIZE * GRID_SIZE;
+    const int NUM_INDICES = (GRID_SIZE - 1) * (GRID_SIZE - 1) * 6;
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    // the same scene loads identically whether its buffers are embedded, external or in the GLB binary chunk
+    std::vector<HFMModel::Pointer> models;
+    for (auto source : { EMBEDDED_BUFFERS, EXTERNAL_BUFFERS, GLB_BUFFER }) {
+        QUrl url = getSceneUrl(dir, source);
+        QByteArray data = writeScene(NUM_MESHES, GRID_SIZE, source, url);
+        auto model = GLTFSerializer().read(data, hifi::VariantHash(), url);
+        QVERIFY(model);
+        QCOMPARE(model->meshes.size(), NUM_MESHES);
+        models.push_back(model);
+    }
+
+    for (int i = 0; i < NUM_MESHES; ++i) {
+        const HFMMesh& mesh = models[0]->meshes[i];
+        QCOMPARE(mesh.vertices.size(), NUM_VERTICES);
+        QCOMPARE(mesh.normals.size(), NUM_VERTICES);
+        QCOMPARE(mesh.parts.size(), 1);
+        QCOMPARE(mesh.parts[0].triangleIndices.size(), NUM_INDICES);
+        QVERIFY(mesh.vertices[GRID_SIZE + 1] == glm::vec3(1.0f, (float)i, 1.0f));
+        QVERIFY(mesh.normals[GRID_SIZE + 1] == glm::vec3(0.0f, 1.0f, 0.0f));
+        QCOMPARE(mesh.parts[0].triangleIndices[1], GRID_SIZE);
+
+        for (size_t j = 1; j < models.size(); ++j) {
+            const HFMMesh& other = models[j]->meshes[i];
+            QVERIFY(other.vertices == mesh.vertices);
+            QVERIFY(other.normals == mesh.normals);
+            QVERIFY(other.texCoords == mesh.texCoords);
+            QVERIFY(other.parts[0].triangleIndices == mesh.parts[0].triangleIndices);
+        }
+    }
+}
+
+void GLTFSerializerTests::testTruncatedAccessor() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    QUrl url = getSceneUrl(dir, GLB_BUFFER);
+    QByteArray data = writeScene(1, 16, GLB_BUFFER, url);
+
+    // the binary chunk now ends in the middle of the indices, the primitive is skipped
+    const int TRUNCATED_BYTES = 64;
+    int binLengthOffset = data.indexOf("BIN") - 4;
+    quint32 binLength = qFromLittleEndian<quint32>(data.constData() + binLengthOffset) - TRUNCATED_BYTES;
+    quint32 littleEndianLength = qToLittleEndian(binLength);
+    data.replace(binLengthOffset, sizeof(littleEndianLength), (const char*)&littleEndianLength, sizeof(littleEndianLength));
+    data.chop(TRUNCATED_BYTES);
+
+    auto model = GLTFSerializer().read(data, hifi::VariantHash(), url);
+    QVERIFY(model);
+    QCOMPARE(model->meshes.size(), 1);
+    QVERIFY(model->meshes[0].parts.isEmpty());
+}
+
+void GLTFSerializerTests::benchmarkRead() {
+    const int NUM_ITERATIONS = 5;
+    const int NUM_MESHES = 16;
+    const int GRID_SIZE = 256;
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const char* SOURCE_NAMES[] = { "embedded base64 buffers", "external buffers", "GLB binary chunk" };
+    for (auto source : { EMBEDDED_BUFFERS, EXTERNAL_BUFFERS, GLB_BUFFER }) {
+        QUrl url = getSceneUrl(dir, source);
+        QByteArray data = writeScene(NUM_MESHES, GRID_SIZE, source, url);
+
+        auto start = usecTimestampNow();
+        for (int i = 0; i < NUM_ITERATIONS; ++i) {
+            GLTFSerializer().read(data, hifi::VariantHash(), url);
+        }
+        auto readTime = (usecTimestampNow() - start) / NUM_ITERATIONS;
+
+        qDebug() << NUM_MESHES << "meshes of" << GRID_SIZE * GRID_SIZE << "vertices from" << SOURCE_NAMES[source]
+                 << (float)data.size() / (float)MB_TO_BYTES(1) << "MB";
+        qDebug() << "    read HFMModel:" << (float)readTime / USECS_PER_MSEC << "ms";
+    }
+}
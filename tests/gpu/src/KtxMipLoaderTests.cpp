@@ -0,0 +1,275 @@
+//
+//  KtxMipLoaderTests.cpp
+//  tests/gpu/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "KtxMipLoaderTests.h"
+
+#include <ktx/KTX.h>
+#include <gpu/KtxMipLoader.h>
+#include <gpu/Texture.h>
+#include <NumericalConstants.h>
+#include <SharedUtil.h>
+
+QTEST_GUILESS_MAIN(KtxMipLoaderTests)
+
+static uint8_t getTexel(int seed, uint16_t mip, size_t offset) {
+    return (uint8_t)(seed + mip * 31 + offset);
+}
+
+// a square RGBA texture with every mip stored, unserialized from the KTX file it is written to
+static gpu::TexturePointer createKtxTexture(const QTemporaryDir& dir, int seed, uint16_t size) {
+    const auto FORMAT = gpu::Element::COLOR_RGBA_32;
+    auto texture = gpu::Texture::create2D(FORMAT, size, size, gpu::Texture::MAX_NUM_MIPS);
+    texture->setStoredMipFormat(FORMAT);
+    for (uint16_t mip = 0; mip < texture->getNumMips(); ++mip) {
+        std::vector<gpu::Byte> texels(texture->evalStoredMipFaceSize(mip, FORMAT));
+        for (size_t i = 0; i < texels.size(); ++i) {
+            texels[i] = getTexel(seed, mip, i);
+        }
+        texture->assignStoredMip(mip, texels.size(), texels.data());
+    }
+
+    auto ktx = gpu::Texture::serialize(*texture);
+    if (!ktx) {
+        return nullptr;
+    }
+    auto filename = dir.filePath(QString("texture%1.ktx").arg(seed));
+    ktx->getStorage()->toFileStorage(filename);
+    return gpu::Texture::unserialize(filename.toStdString());
+}
+
+static bool verifyMip(const gpu::TexturePointer& texture, int seed, uint16_t mip) {
+    auto texels = texture->accessStoredMipFace(mip);
+    if (!texels || texels->size() != texture->getStoredMipFaceSize(mip)) {
+        return false;
+    }
+    for (size_t i = 0; i < texels->size(); ++i) {
+        if (texels->data()[i] != getTexel(seed, mip, i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool verifyMips(const gpu::TexturePointer& texture, int seed) {
+    for (uint16_t mip = 0; mip < texture->getNumMips(); ++mip) {
+        if (!verifyMip(texture, seed, mip)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint16_t getMaxMip(const gpu::TexturePointer& texture) {
+    return texture->getNumMips() - 1;
+}
+
+void KtxMipLoaderTests::initTestCase() {
+    QVERIFY(_dir.isValid());
+}
+
+void KtxMipLoaderTests::testLoadMips() {
+    auto& loader = gpu::KtxMipLoader::getInstance();
+    const int SEED = 1;
+    auto texture = createKtxTexture(_dir, SEED, 512);
+    QVERIFY(texture);
+    QVERIFY(!loader.request(gpu::Texture::create2D(gpu::Element::COLOR_RGBA_32, 16, 16), 0, 0, 1.0f));
+
+    auto readCount = loader.getReadCount();
+    QVERIFY(loader.request(texture, getMaxMip(texture), 0, 1.0f));
+    loader.waitIdle();
+    QCOMPARE(loader.getPendingCount(), (size_t)0);
+
+    // the 10 mips of 1.3MB fit in a single read
+    QCOMPARE(loader.getReadCount() - readCount, (uint64_t)1);
+    QVERIFY(loader.getBufferedBytes() > MB_TO_BYTES(1));
+
+    // the read ahead faces are handed out once, then the mapped file is read again
+    QVERIFY(verifyMips(texture, SEED));
+    QCOMPARE(loader.getBufferedBytes(), (size_t)0);
+    QVERIFY(verifyMips(texture, SEED));
+
+    // only the mips that aren't buffered already are read
+    QVERIFY(loader.request(texture, getMaxMip(texture), 4, 1.0f));
+    loader.waitIdle();
+    readCount = loader.getReadCount();
+    QVERIFY(loader.request(texture, getMaxMip(texture), 4, 1.0f));
+    loader.waitIdle();
+    QCOMPARE(loader.getReadCount(), readCount);
+    QVERIFY(verifyMips(texture, SEED));
+}
+
+void KtxMipLoaderTests::testRepeatedPromotes() {
+    auto& loader = gpu::KtxMipLoader::getInstance();
+    const int SEED = 2;
+    auto texture = createKtxTexture(_dir, SEED, 512);
+    QVERIFY(texture);
+
+    // promote one mip at a time like the transfer engine does: each request covers the mips below the populated one,
+    // down to the newly allocated one, and is repeated while its transfers wait to be buffered
+    const int NUM_REPEATS = 3;
+    uint16_t populatedMip = texture->getNumMips();
+    for (int allocatedMip = getMaxMip(texture); allocatedMip >= 0; --allocatedMip) {
+        auto readCount = loader.getReadCount();
+        for (int i = 0; i < NUM_REPEATS; ++i) {
+            QVERIFY(loader.request(texture, populatedMip - 1, (uint16_t)allocatedMip, 1.0f));
+            loader.waitIdle();
+        }
+        QCOMPARE(loader.getPendingCount(), (size_t)0);
+        // the mips on the GPU already aren't read again
+        QCOMPARE(loader.getReadCount() - readCount, (uint64_t)1);
+
+        for (uint16_t mip = (uint16_t)allocatedMip; mip < populatedMip; ++mip) {
+            QVERIFY(verifyMip(texture, SEED, mip));
+        }
+        populatedMip = (uint16_t)allocatedMip;
+        QCOMPARE(loader.getBufferedBytes(), (size_t)0);
+    }
+
+    // faces read for mips that got populated some other way are freed by the next request
+    auto other = createKtxTexture(_dir, SEED + 1, 512);
+    QVERIFY(other);
+    QVERIFY(loader.request(other, getMaxMip(other), 0, 1.0f));
+    loader.waitIdle();
+    QVERIFY(loader.getBufferedBytes() > 0);
+    const uint16_t POPULATED_MIP = 5;
+    QVERIFY(loader.request(other, POPULATED_MIP - 1, 0, 1.0f));
+    loader.waitIdle();
+    for (uint16_t mip = 0; mip < POPULATED_MIP; ++mip) {
+        QVERIFY(verifyMip(other, SEED + 1, mip));
+    }
+    QCOMPARE(loader.getBufferedBytes(), (size_t)0);
+}
+
+void KtxMipLoaderTests::testCancel() {
+    auto& loader = gpu::KtxMipLoader::getInstance();
+    const int SEED = 4;
+    auto texture = createKtxTexture(_dir, SEED, 512);
+    QVERIFY(texture);
+
+    // the transfer engine drops pending transfers when the memory pressure changes and demotes textures under pressure,
+    // leaving the faces read for them unconsumed until they are canceled
+    const int NUM_ROUNDS = 8;
+    for (int i = 0; i < NUM_ROUNDS; ++i) {
+        // read everything, consume part of it, then drop the rest
+        QVERIFY(loader.request(texture, getMaxMip(texture), 0, 1.0f));
+        loader.waitIdle();
+        QVERIFY(loader.getBufferedBytes() > 0);
+        QVERIFY(verifyMip(texture, SEED, getMaxMip(texture)));
+        loader.cancel(texture);
+        QCOMPARE(loader.getBufferedBytes(), (size_t)0);
+
+        // demote while the reads are still queued or in progress
+        QVERIFY(loader.request(texture, getMaxMip(texture), 0, 1.0f));
+        loader.cancel(texture);
+        loader.waitIdle();
+        QCOMPARE(loader.getPendingCount(), (size_t)0);
+        QCOMPARE(loader.getBufferedBytes(), (size_t)0);
+    }
+
+    // canceled textures are read from the mapped file and can be requested again
+    QVERIFY(verifyMips(texture, SEED));
+    QVERIFY(loader.request(texture, getMaxMip(texture), 0, 1.0f));
+    loader.waitIdle();
+    QVERIFY(verifyMips(texture, SEED));
+    QCOMPARE(loader.getBufferedBytes(), (size_t)0);
+}
+
+void KtxMipLoaderTests::testBufferedBytesBound() {
+    auto& loader = gpu::KtxMipLoader::getInstance();
+    const int NUM_TEXTURES = 8;
+    const size_t MAX_BUFFERED_BYTES = MB_TO_BYTES(1);
+
+    // each texture has 341KB of mips, no more than two of them are buffered at once
+    std::vector<gpu::TexturePointer> textures;
+    for (int i = 0; i < NUM_TEXTURES; ++i) {
+        textures.push_back(createKtxTexture(_dir, 10 + i, 256));
+        QVERIFY(textures.back());
+    }
+
+    auto originalMaxBufferedBytes = loader.getMaxBufferedBytes();
+    loader.setMaxBufferedBytes(MAX_BUFFERED_BYTES);
+    for (int i = 0; i < NUM_TEXTURES; ++i) {
+        QVERIFY(loader.request(textures[i], getMaxMip(textures[i]), 0, (float)i));
+    }
+
+    loader.waitIdle();
+    QVERIFY(loader.getPendingCount() > 0);
+    QVERIFY(loader.getBufferedBytes() <= MAX_BUFFERED_BYTES);
+
+    // consuming buffered mips lets the loader read the next ones
+    int rounds = 0;
+    while (loader.getPendingCount() > 0) {
+        QVERIFY(++rounds <= NUM_TEXTURES);
+        for (int i = 0; i < NUM_TEXTURES; ++i) {
+            QVERIFY(verifyMips(textures[i], 10 + i));
+        }
+        loader.waitIdle();
+        QVERIFY(loader.getBufferedBytes() <= MAX_BUFFERED_BYTES);
+    }
+
+    for (int i = 0; i < NUM_TEXTURES; ++i) {
+        QVERIFY(verifyMips(textures[i], 10 + i));
+    }
+    QCOMPARE(loader.getBufferedBytes(), (size_t)0);
+    loader.setMaxBufferedBytes(originalMaxBufferedBytes);
+}
+
+void KtxMipLoaderTests::benchmarkLoadMips() {
+    auto& loader = gpu::KtxMipLoader::getInstance();
+    // 45MB of mips, within the default budget
+    const int NUM_TEXTURES = 8;
+    const uint16_t SIZE = 1024;
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    std::vector<QString> filenames;
+    for (int i = 0; i < NUM_TEXTURES; ++i) {
+        auto texture = createKtxTexture(dir, i, SIZE);
+        QVERIFY(texture);
+        filenames.push_back(QString::fromStdString(texture->source()));
+    }
+
+    auto loadTextures = [&] {
+        std::vector<gpu::TexturePointer> textures;
+        for (const auto& filename : filenames) {
+            textures.push_back(gpu::Texture::unserialize(filename.toStdString()));
+        }
+        return textures;
+    };
+    auto consumeMips = [&](const std::vector<gpu::TexturePointer>& textures) {
+        for (const auto& texture : textures) {
+            for (uint16_t mip = 0; mip < texture->getNumMips(); ++mip) {
+                texture->accessStoredMipFace(mip);
+            }
+        }
+    };
+
+    auto textures = loadTextures();
+    auto start = usecTimestampNow();
+    consumeMips(textures);
+    auto mappedTime = usecTimestampNow() - start;
+    gpu::Texture::KtxStorage::releaseOpenKtxFiles();
+
+    textures = loadTextures();
+    start = usecTimestampNow();
+    for (size_t i = 0; i < textures.size(); ++i) {
+        loader.request(textures[i], getMaxMip(textures[i]), 0, (float)i);
+    }
+    auto requestTime = usecTimestampNow() - start;
+    loader.waitIdle();
+    auto readTime = usecTimestampNow() - start;
+    consumeMips(textures);
+    auto loadedTime = usecTimestampNow() - start;
+
+    qDebug() << NUM_TEXTURES << "textures of" << SIZE << "x" << SIZE << "with" << loader.getThreadCount() << "I/O threads";
+    qDebug() << "    mapped file reads on the consuming thread:" << (float)mappedTime / USECS_PER_MSEC << "ms";
+    qDebug() << "    requests:" << (float)requestTime / USECS_PER_MSEC << "ms, reads:" << (float)readTime / USECS_PER_MSEC
+             << "ms, reads and consumption:" << (float)loadedTime / USECS_PER_MSEC << "ms";
+}
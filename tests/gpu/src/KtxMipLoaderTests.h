@@ -0,0 +1,32 @@
+//
+//  KtxMipLoaderTests.h
+//  tests/gpu/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_KtxMipLoaderTests_h
+#define hifi_KtxMipLoaderTests_h
+
+#include <QtTest/QtTest>
+#include <QtCore/QTemporaryDir>
+
+class KtxMipLoaderTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void testLoadMips();
+    void testRepeatedPromotes();
+    void testCancel();
+    void testBufferedBytesBound();
+    void benchmarkLoadMips();
+
+private:
+    QTemporaryDir _dir;
+};
+
+#endif // hifi_KtxMipLoaderTests_h
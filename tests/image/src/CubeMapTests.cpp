@@ -0,0 +1,115 @@
+//
+//  CubeMapTests.cpp
+//  tests/image/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "CubeMapTests.h"
+
+#include <QtTest/QtTest>
+
+#include <glm/glm.hpp>
+
+#include <NumericalConstants.h>
+#include <SharedUtil.h>
+#include <image/CubeMap.h>
+
+QTEST_GUILESS_MAIN(CubeMapTests)
+
+using namespace image;
+
+static int evalMipCount(int size) {
+    int mipCount = 1;
+    while (size > 1) {
+        size >>= 1;
+        mipCount++;
+    }
+    return mipCount;
+}
+
+static std::vector<Image> makeUniformFaces(int size, const glm::vec4& color) {
+    std::vector<Image> faces;
+    for (int face = 0; face < 6; face++) {
+        Image image(size, size, Image::Format_RGBAF);
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                image.setFloatPixel(x, y, color);
+            }
+        }
+        faces.push_back(image);
+    }
+    return faces;
+}
+
+// an HDR sky: a dim gradient with a small, very bright sun on the +Y face
+static std::vector<Image> makeHDRFaces(int size) {
+    std::vector<Image> faces;
+    for (int face = 0; face < 6; face++) {
+        Image image(size, size, Image::Format_RGBAF);
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                float gradient = (float)y / (float)size;
+                glm::vec4 color(0.2f + 0.3f * gradient, 0.3f + 0.3f * gradient, 0.6f + 0.4f * gradient, 1.0f);
+                glm::vec2 fromSun = glm::vec2(x, y) / (float)size - glm::vec2(0.5f);
+                if (face == 2 && glm::length(fromSun) < 0.05f) {
+                    color = glm::vec4(5000.0f, 4800.0f, 4500.0f, 1.0f);
+                }
+                image.setFloatPixel(x, y, color);
+            }
+        }
+        faces.push_back(image);
+    }
+    return faces;
+}
+
+void CubeMapTests::testConvolveUniform() {
+    // the GGX weights of every pixel sum to one, so a uniform environment must come out unchanged at every roughness
+    const int SIZE = 64;
+    const glm::vec4 COLOR(0.25f, 2.0f, 16.0f, 1.0f);
+    const int mipCount = evalMipCount(SIZE);
+
+    CubeMap source(makeUniformFaces(SIZE, COLOR), mipCount);
+    CubeMap output(SIZE, SIZE, mipCount);
+    std::atomic<bool> abortProcessing { false };
+    source.convolveForGGX(output, abortProcessing);
+
+    const float EPSILON = 1.0e-3f;
+    for (gpu::uint16 mipLevel = 0; mipLevel < output.getMipCount(); mipLevel++) {
+        const auto dims = output.getMipDimensions(mipLevel);
+        const auto lineStride = output.getMipLineStride(mipLevel);
+        for (int face = 0; face < 6; face++) {
+            const glm::vec4* pixels = output.getFace(mipLevel, face);
+            for (int y = 0; y < dims.y; y++) {
+                for (int x = 0; x < dims.x; x++) {
+                    const glm::vec4& pixel = pixels[x + y * lineStride];
+                    QVERIFY(glm::all(glm::lessThan(glm::abs(pixel - COLOR) / COLOR, glm::vec4(EPSILON))));
+                }
+            }
+        }
+    }
+}
+
+void CubeMapTests::benchmarkConvolveForGGX() {
+    // the size of a typical HDR skybox
+    const int SIZE = 2048;
+    const int mipCount = evalMipCount(SIZE);
+
+    uint64_t startTime = usecTimestampNow();
+    CubeMap source(makeHDRFaces(SIZE), mipCount);
+    uint64_t sourceTime = usecTimestampNow() - startTime;
+
+    CubeMap output(SIZE, SIZE, mipCount);
+    std::atomic<bool> abortProcessing { false };
+
+    startTime = usecTimestampNow();
+    source.convolveForGGX(output, abortProcessing);
+    uint64_t convolveTime = usecTimestampNow() - startTime;
+
+    qDebug() << "CubeMap" << SIZE << "x" << SIZE << "HDR," << mipCount << "mips:";
+    qDebug() << "    build mips " << (float)sourceTime / (float)USECS_PER_MSEC << "msec";
+    qDebug() << "    convolveForGGX " << (float)convolveTime / (float)USECS_PER_MSEC << "msec";
+}
@@ -0,0 +1,23 @@
+//
+//  CubeMapTests.h
+//  tests/image/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_CubeMapTests_h
+#define hifi_CubeMapTests_h
+
+#include <QtCore/QObject>
+
+class CubeMapTests : public QObject {
+    Q_OBJECT
+private slots:
+    void testConvolveUniform();
+    void benchmarkConvolveForGGX();
+};
+
+#endif // hifi_CubeMapTests_h
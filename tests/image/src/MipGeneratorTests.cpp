@@ -0,0 +1,273 @@
+//
+//  MipGeneratorTests.cpp
+//  tests/image/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "MipGeneratorTests.h"
+
+#include <random>
+
+#include <QtTest/QtTest>
+#include <QRgb>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <NumericalConstants.h>
+#include <SharedUtil.h>
+#include <image/MipGenerator.h>
+#include <image/TextureProcessing.h>
+
+QTEST_GUILESS_MAIN(MipGeneratorTests)
+
+using namespace image;
+
+static Image makeUniformImage(int width, int height, const glm::vec4& color) {
+    Image image(width, height, Image::Format_RGBAF);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            image.setFloatPixel(x, y, color);
+        }
+    }
+    return image;
+}
+
+// a colored checkerboard of 8x8 squares, with an alpha gradient
+static Image makeAlbedoImage(int size) {
+    Image image(size, size, Image::Format_ARGB32);
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            bool isOdd = ((x / 8) + (y / 8)) % 2 == 1;
+            image.setPackedPixel(x, y, isOdd ? qRgba(255, 200, 40, 255) : qRgba(20, 60, 180, (x * 255) / size));
+        }
+    }
+    return image;
+}
+
+// bumps, as a normal map
+static Image makeNormalImage(int size) {
+    Image image(size, size, Image::Format_ARGB32);
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            glm::vec3 normal = glm::normalize(glm::vec3(sinf(x * 0.1f), cosf(y * 0.07f), 2.0f));
+            glm::vec3 color = (normal * 0.5f + 0.5f) * 255.0f;
+            image.setPackedPixel(x, y, qRgb((int)color.r, (int)color.g, (int)color.b));
+        }
+    }
+    return image;
+}
+
+// a dim gradient with a bright sun
+static Image makeHDRImage(int size) {
+    Image image(size, size, Image::Format_RGBAF);
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            float gradient = (float)y / (float)size;
+            glm::vec4 color(0.2f + 0.3f * gradient, 0.3f + 0.3f * gradient, 0.6f + 0.4f * gradient, 1.0f);
+            if (glm::length(glm::vec2(x, y) / (float)size - glm::vec2(0.5f)) < 0.05f) {
+                color = glm::vec4(5000.0f, 4800.0f, 4500.0f, 1.0f);
+            }
+            image.setFloatPixel(x, y, color);
+        }
+    }
+    return image;
+}
+
+void MipGeneratorTests::testPackFloatRows() {
+    // every exponent of the packed formats, with a count that isn't a multiple of the SSE width
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<float> exponents(-13.0f, 15.5f);
+    std::vector<glm::vec4> texels(1003);
+    for (auto& texel : texels) {
+        texel = glm::vec4(exp2f(exponents(generator)), exp2f(exponents(generator)), exp2f(exponents(generator)), 1.0f);
+    }
+
+    std::vector<uint32_t> packed(texels.size());
+    packRow(texels.data(), (int)texels.size(), gpu::Element::COLOR_R11G11B10, reinterpret_cast<gpu::Byte*>(packed.data()));
+    for (size_t i = 0; i < texels.size(); i++) {
+        QCOMPARE(packed[i], glm::packF2x11_1x10(glm::min(glm::vec3(texels[i]), glm::vec3(6.50e4f))));
+    }
+
+    // the largest channel keeps 9 bits of precision
+    packRow(texels.data(), (int)texels.size(), gpu::Element::COLOR_RGB9E5, reinterpret_cast<gpu::Byte*>(packed.data()));
+    for (size_t i = 0; i < texels.size(); i++) {
+        glm::vec3 color = glm::vec3(texels[i]);
+        glm::vec3 error = glm::abs(glm::unpackF3x9_E1x5(packed[i]) - color);
+        float maxChannel = std::max(color.r, std::max(color.g, color.b));
+        QVERIFY(glm::all(glm::lessThanEqual(error, glm::vec3(maxChannel / 512.0f))));
+    }
+
+    // out of range values
+    const std::vector<glm::vec4> SPECIAL_TEXELS {
+        { 0.0f, -1.0f, 1.0e9f, 1.0f },
+        { NAN, 6.0e-5f, INFINITY, 1.0f },
+        { 1.0f, 1.0f, 1.0f, 1.0f },
+        { 1.0f, 1.0f, 1.0f, 1.0f }
+    };
+    packRow(SPECIAL_TEXELS.data(), (int)SPECIAL_TEXELS.size(), gpu::Element::COLOR_R11G11B10, reinterpret_cast<gpu::Byte*>(packed.data()));
+    QCOMPARE(packed[0], glm::packF2x11_1x10(glm::vec3(0.0f, 0.0f, 6.50e4f)));
+    QCOMPARE(packed[1], glm::packF2x11_1x10(glm::vec3(0.0f, 0.0f, 6.50e4f)));
+}
+
+void MipGeneratorTests::testPackUnorm8Rows() {
+    // every 8 bit value goes through linear floats and back unchanged, sRGB or not
+    const int COUNT = 259;
+    std::vector<gpu::Byte> texels(COUNT * 4);
+    for (size_t i = 0; i < texels.size(); i++) {
+        texels[i] = (gpu::Byte)(i * 7 + i / 256);
+    }
+
+    std::vector<glm::vec4> floats(COUNT);
+    std::vector<gpu::Byte> packed(texels.size());
+    for (const auto& format : { gpu::Element::COLOR_RGBA_32, gpu::Element::COLOR_SRGBA_32, gpu::Element::COLOR_BGRA_32,
+                                gpu::Element::COLOR_SBGRA_32 }) {
+        unpackRow(texels.data(), COUNT, format, floats.data());
+        packRow(floats.data(), COUNT, format, packed.data());
+        QVERIFY(packed == texels);
+    }
+
+    unpackRow(texels.data(), COUNT, gpu::Element::COLOR_SBGRA_32, floats.data());
+    QCOMPARE(floats[1].b, powf((texels[4] / 255.0f + 0.055f) / 1.055f, 2.4f));
+    QCOMPARE(floats[1].a, texels[7] / 255.0f);
+
+    packRow(floats.data(), COUNT, gpu::Element::COLOR_SR_8, packed.data());
+    packRow(floats.data(), COUNT, gpu::Element::VEC2NU8_XY, packed.data() + COUNT);
+    for (int i = 0; i < COUNT; i++) {
+        QCOMPARE(packed[i], texels[4 * i + 2]);
+        QCOMPARE(packed[COUNT + 2 * i], (gpu::Byte)std::lrintf(floats[i].r * 255.0f));
+        QCOMPARE(packed[COUNT + 2 * i + 1], (gpu::Byte)std::lrintf(floats[i].g * 255.0f));
+    }
+}
+
+void MipGeneratorTests::testMipChain() {
+    // odd sizes, and a uniform color that must come out unchanged from both filters
+    const glm::vec4 COLOR(0.25f, 0.5f, 2.0f, 0.75f);
+    const std::vector<glm::uvec2> EXPECTED_SIZES { { 37, 10 }, { 18, 5 }, { 9, 2 }, { 4, 1 }, { 2, 1 }, { 1, 1 } };
+    std::atomic<bool> abortProcessing { false };
+
+    for (auto filter : { MipFilter::Box, MipFilter::Kaiser }) {
+        std::vector<glm::uvec2> sizes;
+        generateMips(makeUniformImage(37, 10, COLOR), filter, MipEncoding(), 0, abortProcessing, [&](int mipLevel, const Image& mip) {
+            QCOMPARE(mipLevel, (int)sizes.size());
+            QCOMPARE(mip.getFormat(), Image::Format_RGBAF);
+            sizes.push_back(mip.getSize());
+            for (glm::uint32 y = 0; y < mip.getHeight(); y++) {
+                for (glm::uint32 x = 0; x < mip.getWidth(); x++) {
+                    QVERIFY(glm::all(glm::lessThan(glm::abs(mip.getFloatPixel(x, y) - COLOR), glm::vec4(1.0e-5f))));
+                }
+            }
+        });
+        QVERIFY(sizes == EXPECTED_SIZES);
+    }
+
+    int numMips = 0;
+    generateMips(makeUniformImage(64, 64, COLOR), MipFilter::Box, MipEncoding(), 3, abortProcessing,
+                 [&](int mipLevel, const Image& mip) { numMips++; });
+    QCOMPARE(numMips, 3);
+}
+
+void MipGeneratorTests::testLinearFiltering() {
+    std::atomic<bool> abortProcessing { false };
+
+    // a black and white checkerboard averages to half the light, not half the sRGB value
+    Image checkerboard(4, 4, Image::Format_ARGB32);
+    for (int y = 0; y < 4; y++) {
+        for (int x = 0; x < 4; x++) {
+            checkerboard.setPackedPixel(x, y, (x + y) % 2 ? qRgb(255, 255, 255) : qRgb(0, 0, 0));
+        }
+    }
+    MipEncoding encoding;
+    encoding.isSRGB = true;
+    generateMips(std::move(checkerboard), MipFilter::Box, encoding, 2, abortProcessing, [&](int mipLevel, const Image& mip) {
+        if (mipLevel == 1) {
+            glm::vec4 color = mip.getFloatPixel(0, 0);
+            gpu::Byte texel[4];
+            packRow(&color, 1, gpu::Element::COLOR_SRGBA_32, texel);
+            QCOMPARE((int)texel[0], 188);
+            QCOMPARE((int)texel[3], 255);
+        }
+    });
+
+    // transparent texels don't bleed into the color of their mips
+    Image cutout = makeUniformImage(2, 2, glm::vec4(1.0f, 0.0f, 0.0f, 1.0f));
+    cutout.setFloatPixel(1, 1, glm::vec4(0.0f, 1.0f, 0.0f, 0.0f));
+    encoding = MipEncoding();
+    encoding.isAlphaWeighted = true;
+    generateMips(std::move(cutout), MipFilter::Box, encoding, 2, abortProcessing, [&](int mipLevel, const Image& mip) {
+        if (mipLevel == 1) {
+            QCOMPARE(mip.getFloatPixel(0, 0), glm::vec4(1.0f, 0.0f, 0.0f, 0.75f));
+        }
+    });
+
+    // normals stay unit length
+    Image normals = makeUniformImage(2, 1, glm::vec4(1.0f, 0.5f, 0.5f, 1.0f));
+    normals.setFloatPixel(1, 0, glm::vec4(0.5f, 1.0f, 0.5f, 1.0f));
+    encoding = MipEncoding();
+    encoding.isNormalMap = true;
+    generateMips(std::move(normals), MipFilter::Box, encoding, 2, abortProcessing, [&](int mipLevel, const Image& mip) {
+        if (mipLevel == 1) {
+            glm::vec3 normal = glm::vec3(mip.getFloatPixel(0, 0)) * 2.0f - 1.0f;
+            QVERIFY(fabsf(glm::length(normal) - 1.0f) < 1.0e-5f);
+        }
+    });
+}
+
+void MipGeneratorTests::testTextureMips() {
+    const int SIZE = 256;
+    std::atomic<bool> abortProcessing { false };
+    auto texture = TextureUsage::createAlbedoTextureFromImage(makeAlbedoImage(SIZE), "albedo", false,
+                                                              gpu::BackendTarget::GL45, abortProcessing);
+    QVERIFY(texture);
+    QCOMPARE(texture->getStoredMipFormat(), gpu::Element::COLOR_SBGRA_32);
+    QVERIFY(texture->getNumMips() > 1);
+
+    // every mip was stored, and the 8x8 squares averaged out by mip 3
+    for (gpu::uint16 mip = 0; mip < texture->getNumMips(); mip++) {
+        QVERIFY(texture->isStoredMipFaceAvailable(mip));
+        QCOMPARE(texture->accessStoredMipFace(mip)->size(), texture->getStoredMipFaceSize(mip));
+    }
+    auto texels = texture->accessStoredMipFace(4);
+    std::vector<glm::vec4> colors(texture->evalMipWidth(4));
+    unpackRow(texels->data(), (int)colors.size(), gpu::Element::COLOR_SBGRA_32, colors.data());
+    QVERIFY(fabsf(colors[0].g - colors[1].g) < 1.0e-2f);
+}
+
+void MipGeneratorTests::benchmarkTextureMips() {
+    const int LDR_SIZE = 4096;
+    const int HDR_SIZE = 2048;
+    std::atomic<bool> abortProcessing { false };
+
+    auto startTime = usecTimestampNow();
+    auto albedo = TextureUsage::createAlbedoTextureFromImage(makeAlbedoImage(LDR_SIZE), "albedo", false,
+                                                             gpu::BackendTarget::GL45, abortProcessing);
+    auto albedoTime = usecTimestampNow() - startTime;
+    QVERIFY(albedo);
+
+    startTime = usecTimestampNow();
+    auto normal = TextureUsage::createNormalTextureFromNormalImage(makeNormalImage(LDR_SIZE), "normal", false,
+                                                                   gpu::BackendTarget::GL45, abortProcessing);
+    auto normalTime = usecTimestampNow() - startTime;
+    QVERIFY(normal);
+
+    auto hdr = gpu::Texture::create2D(gpu::Element::COLOR_R11G11B10, HDR_SIZE, HDR_SIZE, gpu::Texture::MAX_NUM_MIPS);
+    hdr->setStoredMipFormat(gpu::Element::COLOR_R11G11B10);
+    startTime = usecTimestampNow();
+    convertToTextureWithMips(hdr.get(), makeHDRImage(HDR_SIZE), gpu::BackendTarget::GL45, abortProcessing);
+    auto hdrTime = usecTimestampNow() - startTime;
+
+    Image source = makeHDRImage(HDR_SIZE);
+    startTime = usecTimestampNow();
+    generateMips(std::move(source), MipFilter::Kaiser, MipEncoding(), 0, abortProcessing, [](int, const Image&) {});
+    auto kaiserTime = usecTimestampNow() - startTime;
+
+    qDebug() << "Uncompressed textures with all their mips:";
+    qDebug() << "    albedo" << LDR_SIZE << "x" << LDR_SIZE << (float)albedoTime / (float)USECS_PER_MSEC << "msec";
+    qDebug() << "    normal map" << LDR_SIZE << "x" << LDR_SIZE << (float)normalTime / (float)USECS_PER_MSEC << "msec";
+    qDebug() << "    HDR R11G11B10" << HDR_SIZE << "x" << HDR_SIZE << (float)hdrTime / (float)USECS_PER_MSEC << "msec";
+    qDebug() << "    Kaiser filtered HDR mips" << HDR_SIZE << "x" << HDR_SIZE << (float)kaiserTime / (float)USECS_PER_MSEC << "msec";
+}
@@ -0,0 +1,27 @@
+//
+//  MipGeneratorTests.h
+//  tests/image/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_MipGeneratorTests_h
+#define hifi_MipGeneratorTests_h
+
+#include <QtCore/QObject>
+
+class MipGeneratorTests : public QObject {
+    Q_OBJECT
+private slots:
+    void testPackFloatRows();
+    void testPackUnorm8Rows();
+    void testMipChain();
+    void testLinearFiltering();
+    void testTextureMips();
+    void benchmarkTextureMips();
+};
+
+#endif // hifi_MipGeneratorTests_h
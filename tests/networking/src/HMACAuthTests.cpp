@@ -0,0 +1,156 @@
+//
+//  HMACAuthTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "HMACAuthTests.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <HMACAuth.h>
+#include <NLPacket.h>
+#include <NumericalConstants.h>
+#include <SharedUtil.h>
+
+QTEST_MAIN(HMACAuthTests)
+
+static std::unique_ptr<NLPacket> createSignedPacket(const HMACAuth& hmacAuth, int payloadSize) {
+    auto packet = NLPacket::create(PacketType::AvatarData);
+    QByteArray payload(payloadSize, 0);
+    for (int i = 0; i < payloadSize; ++i) {
+        payload[i] = (char)(i * 7);
+    }
+    packet->write(payload);
+    packet->writeSourceID(1);
+    packet->writeVerificationHash(hmacAuth);
+    return packet;
+}
+
+void HMACAuthTests::hashTest() {
+    HMACAuth hmacAuth;
+    QVERIFY(hmacAuth.setKey(QUuid::createUuid()));
+    QCOMPARE(hmacAuth.getHashSize(), NUM_BYTES_MD5_HASH);
+
+    const QByteArray first("the quick brown fox");
+    const QByteArray second("jumps over the lazy dog");
+
+    HMACAuth::HMACHash oneShot;
+    QVERIFY(hmacAuth.calculateHash(oneShot, first.constData(), first.size()));
+    QCOMPARE((int)oneShot.size(), NUM_BYTES_MD5_HASH);
+
+    QVERIFY(hmacAuth.addData(first.constData(), first.size()));
+    QCOMPARE(hmacAuth.result(), oneShot);
+
+    const char* data[] = { first.constData(), second.constData() };
+    const int dataLens[] = { first.size(), second.size() };
+    unsigned char hashes[2 * HMACAuth::MAX_HASH_SIZE];
+    QVERIFY(hmacAuth.calculateHashes(hashes, data, dataLens, 2));
+    QVERIFY(memcmp(hashes, oneShot.data(), NUM_BYTES_MD5_HASH) == 0);
+
+    HMACAuth::HMACHash secondHash;
+    QVERIFY(hmacAuth.calculateHash(secondHash, second.constData(), second.size()));
+    QVERIFY(memcmp(hashes + NUM_BYTES_MD5_HASH, secondHash.data(), NUM_BYTES_MD5_HASH) == 0);
+
+    // a new key gives new hashes
+    QVERIFY(hmacAuth.setKey(QUuid::createUuid()));
+    HMACAuth::HMACHash rekeyed;
+    QVERIFY(hmacAuth.calculateHash(rekeyed, first.constData(), first.size()));
+    QVERIFY(rekeyed != oneShot);
+}
+
+void HMACAuthTests::packetVerificationTest() {
+    HMACAuth hmacAuth;
+    hmacAuth.setKey(QUuid::createUuid());
+    HMACAuth otherAuth;
+    otherAuth.setKey(QUuid::createUuid());
+
+    auto packet = createSignedPacket(hmacAuth, 200);
+    QVERIFY(NLPacket::hashMatchesForPacket(*packet, hmacAuth));
+    QVERIFY(!NLPacket::hashMatchesForPacket(*packet, otherAuth));
+    QCOMPARE(NLPacket::verificationHashInHeader(*packet), NLPacket::hashForPacketAndHMAC(*packet, hmacAuth));
+
+    auto tampered = createSignedPacket(hmacAuth, 200);
+    tampered->getData()[tampered->getDataSize() - 1] ^= 1;
+
+    const udt::Packet* packets[] = { packet.get(), tampered.get(), packet.get() };
+    bool verified[3];
+    NLPacket::hashesMatchForPackets(packets, 3, hmacAuth, verified);
+    QVERIFY(verified[0]);
+    QVERIFY(!verified[1]);
+    QVERIFY(verified[2]);
+}
+
+void HMACAuthTests::verifyBenchmark() {
+    // a typical mixer packet, from a handful of senders
+    const int PAYLOAD_SIZE = 300;
+    const int NUM_SENDERS = 16;
+    const int NUM_VERIFICATIONS = 200000;
+
+    std::vector<std::unique_ptr<HMACAuth>> auths;
+    std::vector<std::unique_ptr<NLPacket>> packets;
+    for (int i = 0; i < NUM_SENDERS; ++i) {
+        auths.emplace_back(new HMACAuth());
+        auths.back()->setKey(QUuid::createUuid());
+        packets.push_back(createSignedPacket(*auths.back(), PAYLOAD_SIZE));
+    }
+
+    auto verify = [&](int count, std::atomic<int>& failures) {
+        for (int i = 0; i < count; ++i) {
+            int sender = i % NUM_SENDERS;
+            if (!NLPacket::hashMatchesForPacket(*packets[sender], *auths[sender])) {
+                ++failures;
+            }
+        }
+    };
+
+    std::atomic<int> failures { 0 };
+
+    auto start = usecTimestampNow();
+    verify(NUM_VERIFICATIONS, failures);
+    auto singleThreadTime = usecTimestampNow() - start;
+
+    const int numThreads = std::max(2, (int)std::thread::hardware_concurrency());
+    std::vector<std::thread> threads;
+    start = usecTimestampNow();
+    for (int thread = 0; thread < numThreads; ++thread) {
+        threads.emplace_back([&] {
+            verify(NUM_VERIFICATIONS, failures);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto multiThreadTime = usecTimestampNow() - start;
+
+    // batches of packets from the same sender
+    const int BATCH_SIZE = 8;
+    std::vector<const udt::Packet*> batch(BATCH_SIZE, packets[0].get());
+    bool verified[BATCH_SIZE];
+    start = usecTimestampNow();
+    for (int i = 0; i < NUM_VERIFICATIONS; i += BATCH_SIZE) {
+        NLPacket::hashesMatchForPackets(batch.data(), BATCH_SIZE, *auths[0], verified);
+        for (int j = 0; j < BATCH_SIZE; ++j) {
+            if (!verified[j]) {
+                ++failures;
+            }
+        }
+    }
+    auto batchTime = usecTimestampNow() - start;
+
+    QCOMPARE(failures.load(), 0);
+
+    auto perSecond = [](quint64 count, quint64 usecs) {
+        return (float)count * (float)USECS_PER_SECOND / (float)std::max(usecs, (quint64)1);
+    };
+    qDebug() << "HMAC-MD5 verification of" << PAYLOAD_SIZE << "byte packets:";
+    qDebug() << "    1 thread:" << perSecond(NUM_VERIFICATIONS, singleThreadTime) << "packets/sec";
+    qDebug() << "   " << numThreads << "threads:" << perSecond((quint64)NUM_VERIFICATIONS * numThreads, multiThreadTime) << "packets/sec";
+    qDebug() << "    1 thread, batches of" << BATCH_SIZE << ":" << perSecond(NUM_VERIFICATIONS, batchTime) << "packets/sec";
+}
@@ -0,0 +1,31 @@
+//
+//  HMACAuthTests.h
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_HMACAuthTests_h
+#define hifi_HMACAuthTests_h
+
+#pragma once
+
+#include <QtTest/QtTest>
+
+class HMACAuthTests : public QObject {
+    Q_OBJECT
+private slots:
+    // Test that the one-shot, batched and incremental hashes agree
+    void hashTest();
+
+    // Test writing and verifying the hash of NL packets
+    void packetVerificationTest();
+
+    // Measure packet verification throughput on one and many threads
+    void verifyBenchmark();
+};
+
+#endif // hifi_HMACAuthTests_h
@@ -0,0 +1,144 @@
+//
+//  NodeListTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "NodeListTests.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <DependencyManager.h>
+#include <LimitedNodeList.h>
+#include <NodeList.h>
+#include <NumericalConstants.h>
+#include <StatTracker.h>
+
+QTEST_MAIN(NodeListTests)
+
+static const quint16 FIRST_NODE_PORT = 40000;
+
+static SharedNodePointer addNode(int index, Node::LocalID localID) {
+    HifiSockAddr sockAddr(QHostAddress::LocalHost, FIRST_NODE_PORT + index);
+    return DependencyManager::get<NodeList>()->addOrUpdateNode(QUuid::createUuid(), NodeType::Agent,
+                                                               sockAddr, sockAddr, localID);
+}
+
+void NodeListTests::initTestCase() {
+    DependencyManager::set<StatTracker>();
+    DependencyManager::registerInheritance<LimitedNodeList, NodeList>();
+    DependencyManager::set<NodeList>(NodeType::Agent, INVALID_PORT);
+}
+
+void NodeListTests::lookupTest() {
+    auto nodeList = DependencyManager::get<NodeList>();
+
+    auto first = addNode(0, 12);
+    auto second = addNode(1, 3000);
+
+    QCOMPARE(nodeList->size(), (size_t)2);
+    QCOMPARE(nodeList->nodeWithUUID(first->getUUID()), first);
+    QCOMPARE(nodeList->nodeWithLocalID(12), first);
+    QCOMPARE(nodeList->nodeWithLocalID(3000), second);
+    QVERIFY(nodeList->nodeWithLocalID(13).isNull());
+    QVERIFY(nodeList->nodeWithLocalID(60000).isNull());
+
+    // the domain can hand an existing node a new local ID
+    HifiSockAddr sockAddr(QHostAddress::LocalHost, FIRST_NODE_PORT);
+    nodeList->addOrUpdateNode(first->getUUID(), NodeType::Agent, sockAddr, sockAddr, 42);
+    QVERIFY(nodeList->nodeWithLocalID(12).isNull());
+    QCOMPARE(nodeList->nodeWithLocalID(42), first);
+
+    // a snapshot taken before a kill still sees the node, later lookups don't
+    int seen = 0;
+    nodeList->nestedEach([&](NodeList::const_iterator begin, NodeList::const_iterator end) {
+        QVERIFY(nodeList->killNodeWithUUID(second->getUUID()));
+        seen = (int)std::distance(begin, end);
+    });
+    QCOMPARE(seen, 2);
+    QVERIFY(nodeList->nodeWithUUID(second->getUUID()).isNull());
+    QVERIFY(nodeList->nodeWithLocalID(3000).isNull());
+    QCOMPARE(nodeList->size(), (size_t)1);
+
+    nodeList->eraseAllNodes("lookupTest");
+    QCOMPARE(nodeList->size(), (size_t)0);
+    QVERIFY(nodeList->nodeWithLocalID(42).isNull());
+}
+
+void NodeListTests::contentionBenchmark() {
+    const int NUM_NODES = 200;
+    const int NUM_READERS = 8;
+    const quint64 DURATION_USECS = 2 * USECS_PER_SECOND;
+
+    auto nodeList = DependencyManager::get<NodeList>();
+    for (int i = 0; i < NUM_NODES; ++i) {
+        addNode(i, (Node::LocalID)(i + 1));
+    }
+
+    // readers do what the mixer slaves and packet handlers do: iterate every node and look nodes up by local ID
+    std::atomic<bool> isRunning { true };
+    std::atomic<uint64_t> numReads { 0 };
+    std::atomic<uint64_t> numMissing { 0 };
+    std::vector<std::thread> readers;
+    for (int reader = 0; reader < NUM_READERS; ++reader) {
+        readers.emplace_back([&, reader] {
+            uint64_t reads = 0;
+            uint64_t missing = 0;
+            Node::LocalID localID = (Node::LocalID)(reader + 1);
+            while (isRunning) {
+                int count = 0;
+                nodeList->eachNode([&](const SharedNodePointer&) {
+                    ++count;
+                });
+                nodeList->nestedEach([&](NodeList::const_iterator begin, NodeList::const_iterator end) {
+                    count += (int)std::distance(begin, end);
+                });
+                for (int i = 0; i < NUM_NODES; ++i) {
+                    if (!nodeList->nodeWithLocalID(localID)) {
+                        ++missing;
+                    }
+                    localID = (Node::LocalID)(localID % NUM_NODES + 1);
+                }
+                reads += 2 + NUM_NODES;
+            }
+            numReads += reads;
+            numMissing += missing;
+        });
+    }
+
+    // meanwhile nodes keep connecting and disconnecting
+    uint64_t numWrites = 0;
+    auto start = usecTimestampNow();
+    while (usecTimestampNow() - start < DURATION_USECS) {
+        auto node = addNode(NUM_NODES + (int)(numWrites % 100), (Node::LocalID)(NUM_NODES + 1 + numWrites % 100));
+        nodeList->killNodeWithUUID(node->getUUID());
+        numWrites += 2;
+    }
+    auto elapsed = usecTimestampNow() - start;
+
+    isRunning = false;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    // the stable nodes never disappear from a reader's point of view
+    QCOMPARE(numMissing.load(), (uint64_t)0);
+
+    float seconds = (float)elapsed / (float)USECS_PER_SECOND;
+    qDebug() << NUM_READERS << "readers," << NUM_NODES << "nodes:";
+    qDebug() << "    reads per second" << (float)numReads.load() / seconds;
+    qDebug() << "    writes per second" << (float)numWrites / seconds;
+
+    nodeList->eraseAllNodes("contentionBenchmark");
+}
+
+void NodeListTests::cleanupTestCase() {
+    DependencyManager::destroy<NodeList>();
+    DependencyManager::destroy<StatTracker>();
+}
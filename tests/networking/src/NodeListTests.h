@@ -0,0 +1,32 @@
+//
+//  NodeListTests.h
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_NodeListTests_h
+#define hifi_NodeListTests_h
+
+#pragma once
+
+#include <QtTest/QtTest>
+
+class NodeListTests : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+
+    // Test lookups by UUID and local ID as nodes are added, updated and killed
+    void lookupTest();
+
+    // Measure readers iterating and looking up nodes while a writer keeps adding and killing nodes
+    void contentionBenchmark();
+
+    void cleanupTestCase();
+};
+
+#endif // hifi_NodeListTests_h
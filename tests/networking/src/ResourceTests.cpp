@@ -9,6 +9,8 @@
 
 #include "ResourceTests.h"
 
+#include <cfloat>
+
 #include <QNetworkDiskCache>
 
 #include <ResourceCache.h>
@@ -16,6 +18,7 @@
 #include <NodeList.h>
 #include <NetworkAccessManager.h>
 #include <DependencyManager.h>
+#include <SharedUtil.h>
 #include <StatTracker.h>
 
 QTEST_MAIN(ResourceTests)
@@ -93,3 +96,96 @@ void ResourceTests::downloadAgain() {
 
     QVERIFY(resource->isLoaded());
 }
+
+static QSharedPointer<Resource> createPendingResource(const QString& url, QObject* owner, float priority) {
+    auto pending = QSharedPointer<Resource>::create(QUrl(url));
+    pending->setSelf(pending);
+    pending->setLoadPriority(owner, priority);
+    DependencyManager::get<ResourceCacheSharedItems>()->appendRequest(pending);
+    return pending;
+}
+
+void ResourceTests::pendingRequestOrder() {
+    auto sharedItems = DependencyManager::get<ResourceCacheSharedItems>();
+    auto requestLimit = sharedItems->getRequestLimit();
+    sharedItems->setRequestLimit(0);
+
+    QObject owner;
+    auto low = createPendingResource("http://example.com/low.fbx", &owner, 1.0f);
+    auto high = createPendingResource("http://example.com/high.fbx", &owner, 10.0f);
+    auto file = createPendingResource("file:///tmp/local.fbx", &owner, -10.0f);
+    auto raised = createPendingResource("http://example.com/raised.fbx", &owner, 0.0f);
+    auto freed = createPendingResource("http://example.com/freed.fbx", &owner, 100.0f);
+    auto orphaned = createPendingResource("http://example.com/orphaned.fbx", &owner, 0.5f);
+    {
+        QObject shortLivedOwner;
+        orphaned->setLoadPriority(&shortLivedOwner, 50.0f);
+    }
+    QCOMPARE(sharedItems->getPendingRequestsCount(), (uint32_t)6);
+
+    raised->setLoadPriority(&owner, 5.0f);
+    freed.reset();
+
+    // local files first, then by priority, skipping freed resources
+    QCOMPARE(sharedItems->getHighestPendingRequest(), file);
+    QCOMPARE(sharedItems->getHighestPendingRequest(), high);
+    QCOMPARE(sharedItems->getHighestPendingRequest(), raised);
+    QCOMPARE(sharedItems->getHighestPendingRequest(), low);
+    QCOMPARE(sharedItems->getHighestPendingRequest(), orphaned);
+    QVERIFY(sharedItems->getHighestPendingRequest().isNull());
+    QCOMPARE(sharedItems->getPendingRequestsCount(), (uint32_t)0);
+
+    sharedItems->setRequestLimit(requestLimit);
+}
+
+void ResourceTests::pendingRequestBenchmark() {
+    // entering a large domain queues up tens of thousands of textures and models at once
+    const int NUM_RESOURCES = 50000;
+    const int NUM_REPRIORITIZED = NUM_RESOURCES / 10;
+
+    auto sharedItems = DependencyManager::get<ResourceCacheSharedItems>();
+    auto requestLimit = sharedItems->getRequestLimit();
+    sharedItems->setRequestLimit(0);
+
+    QObject owner;
+    std::vector<QSharedPointer<Resource>> resources;
+    resources.reserve(NUM_RESOURCES);
+    for (int i = 0; i < NUM_RESOURCES; ++i) {
+        auto pending = QSharedPointer<Resource>::create(QUrl(QString("http://example.com/%1.ktx").arg(i)));
+        pending->setSelf(pending);
+        pending->setLoadPriority(&owner, (float)((i * 7919) % 1000));
+        resources.push_back(pending);
+    }
+
+    auto start = usecTimestampNow();
+    for (const auto& pending : resources) {
+        sharedItems->appendRequest(pending);
+    }
+    auto appendTime = usecTimestampNow() - start;
+
+    start = usecTimestampNow();
+    for (int i = 0; i < NUM_REPRIORITIZED; ++i) {
+        resources[i * 10]->setLoadPriority(&owner, (float)(i % 2000));
+    }
+    auto reprioritizeTime = usecTimestampNow() - start;
+
+    start = usecTimestampNow();
+    float lastPriority = FLT_MAX;
+    int dispatched = 0;
+    while (auto next = sharedItems->getHighestPendingRequest()) {
+        float priority = next->getLoadPriority();
+        QVERIFY(priority <= lastPriority);
+        lastPriority = priority;
+        ++dispatched;
+    }
+    auto dispatchTime = usecTimestampNow() - start;
+
+    QCOMPARE(dispatched, NUM_RESOURCES);
+
+    qDebug() << "Pending requests:" << NUM_RESOURCES;
+    qDebug() << "    append:" << (float)appendTime / NUM_RESOURCES << "usecs per request";
+    qDebug() << "    reprioritize:" << (float)reprioritizeTime / NUM_REPRIORITIZED << "usecs per request";
+    qDebug() << "    dispatch:" << (float)dispatchTime / NUM_RESOURCES << "usecs per request";
+
+    sharedItems->setRequestLimit(requestLimit);
+}
@@ -18,6 +18,8 @@ private slots:
     void initTestCase();
     void downloadFirst();
     void downloadAgain();
+    void pendingRequestOrder();
+    void pendingRequestBenchmark();
     void cleanupTestCase();
 };
 
@@ -0,0 +1,177 @@
+//
+//  SendQueueTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "SendQueueTests.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <mutex>
+
+#include <QtCore/QThread>
+#include <QtNetwork/QUdpSocket>
+
+#include <udt/Packet.h>
+#include <udt/SendQueue.h>
+#include <udt/SendQueueScheduler.h>
+#include <udt/Socket.h>
+
+QTEST_MAIN(SendQueueTests)
+
+using namespace udt;
+
+static const int MAX_TEST_TIMEOUT_MSECS = 20000;
+
+static std::unique_ptr<SendQueue> createQueue(Socket& socket, const HifiSockAddr& destination, int packetSendPeriod) {
+    // start as if the handshake was already ACKed so the queue sends right away
+    auto queue = SendQueue::create(&socket, destination, SequenceNumber(0), 0, true);
+    queue->setPacketSendPeriod(packetSendPeriod);
+    queue->setFlowWindowSize(udt::MAX_PACKETS_IN_FLIGHT);
+    // don't time out and re-send while the test is waiting for the packets to go out
+    queue->setEstimatedTimeout(std::numeric_limits<int>::max());
+    return queue;
+}
+
+static void queuePackets(SendQueue& queue, int count) {
+    for (int i = 0; i < count; ++i) {
+        auto packet = Packet::create(-1, true);
+        packet->writePrimitive(i);
+        queue.queuePacket(std::move(packet));
+    }
+}
+
+void SendQueueTests::pacingTest() {
+    const int NUM_PACKETS = 20;
+    const int PACKET_SEND_PERIOD = 2000; // usecs
+
+    QUdpSocket receiver;
+    QVERIFY(receiver.bind(QHostAddress::LocalHost));
+    Socket socket(nullptr, false);
+    socket.bind(QHostAddress::LocalHost);
+
+    auto queue = createQueue(socket, HifiSockAddr(QHostAddress::LocalHost, receiver.localPort()), PACKET_SEND_PERIOD);
+
+    std::mutex timestampsMutex;
+    std::vector<p_high_resolution_clock::time_point> timestamps;
+    QObject::connect(queue.get(), &SendQueue::packetSent, queue.get(),
+                     [&](int, int, SequenceNumber, p_high_resolution_clock::time_point timePoint) {
+        std::lock_guard<std::mutex> lock(timestampsMutex);
+        timestamps.push_back(timePoint);
+    }, Qt::DirectConnection);
+
+    queuePackets(*queue, NUM_PACKETS);
+
+    auto sentCount = [&] {
+        std::lock_guard<std::mutex> lock(timestampsMutex);
+        return (int)timestamps.size();
+    };
+    QTRY_COMPARE_WITH_TIMEOUT(sentCount(), NUM_PACKETS, MAX_TEST_TIMEOUT_MSECS);
+
+    queue->ack(SequenceNumber(NUM_PACKETS));
+    queue->stop();
+
+    // the first packet goes out right away, every other one waits for the send period
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(timestamps.back() - timestamps.front());
+    QVERIFY(elapsed.count() >= (NUM_PACKETS - 1) * PACKET_SEND_PERIOD * 9 / 10);
+}
+
+void SendQueueTests::floodPacingTest() {
+    const int NUM_PACKETS = 50;
+    const int PACKET_SEND_PERIOD = 2000; // usecs
+    const int QUEUE_INTERVAL = 100; // usecs, much shorter than the send period so every wake lands mid-wait
+
+    QUdpSocket receiver;
+    QVERIFY(receiver.bind(QHostAddress::LocalHost));
+    Socket socket(nullptr, false);
+    socket.bind(QHostAddress::LocalHost);
+
+    auto queue = createQueue(socket, HifiSockAddr(QHostAddress::LocalHost, receiver.localPort()), PACKET_SEND_PERIOD);
+
+    std::mutex timestampsMutex;
+    std::vector<p_high_resolution_clock::time_point> timestamps;
+    QObject::connect(queue.get(), &SendQueue::packetSent, queue.get(),
+                     [&](int, int, SequenceNumber, p_high_resolution_clock::time_point timePoint) {
+        std::lock_guard<std::mutex> lock(timestampsMutex);
+        timestamps.push_back(timePoint);
+    }, Qt::DirectConnection);
+
+    // each queuePacket() wakes the queue while it waits for its next packet
+    for (int i = 0; i < NUM_PACKETS; ++i) {
+        queuePackets(*queue, 1);
+        QThread::usleep(QUEUE_INTERVAL);
+    }
+
+    auto sentCount = [&] {
+        std::lock_guard<std::mutex> lock(timestampsMutex);
+        return (int)timestamps.size();
+    };
+    QTRY_COMPARE_WITH_TIMEOUT(sentCount(), NUM_PACKETS, MAX_TEST_TIMEOUT_MSECS);
+
+    queue->ack(SequenceNumber(NUM_PACKETS));
+    queue->stop();
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(timestamps.back() - timestamps.front());
+    QVERIFY(elapsed.count() >= (NUM_PACKETS - 1) * PACKET_SEND_PERIOD * 9 / 10);
+
+    // a late packet may be followed by a short gap as the queue catches up, but most gaps are the full period
+    std::vector<int64_t> gaps;
+    for (size_t i = 1; i < timestamps.size(); ++i) {
+        gaps.push_back(std::chrono::duration_cast<std::chrono::microseconds>(timestamps[i] - timestamps[i - 1]).count());
+    }
+    std::sort(gaps.begin(), gaps.end());
+    QVERIFY(gaps[gaps.size() / 2] >= PACKET_SEND_PERIOD * 9 / 10);
+}
+
+void SendQueueTests::manyConnectionsTest() {
+    const int NUM_CONNECTIONS = 1000;
+    const int NUM_PACKETS = 10;
+    const int PACKET_SEND_PERIOD = 1000; // usecs
+
+    QUdpSocket receiver;
+    QVERIFY(receiver.bind(QHostAddress::LocalHost));
+    Socket socket(nullptr, false);
+    socket.bind(QHostAddress::LocalHost);
+    HifiSockAddr destination(QHostAddress::LocalHost, receiver.localPort());
+
+    std::atomic<int> numSent { 0 };
+    std::vector<std::unique_ptr<SendQueue>> queues;
+    for (int i = 0; i < NUM_CONNECTIONS; ++i) {
+        auto queue = createQueue(socket, destination, PACKET_SEND_PERIOD);
+        QObject::connect(queue.get(), &SendQueue::packetSent, queue.get(), [&] {
+            ++numSent;
+        }, Qt::DirectConnection);
+        queues.push_back(std::move(queue));
+    }
+
+    QCOMPARE(SendQueueScheduler::getInstance().getQueueCount(), (size_t)NUM_CONNECTIONS);
+
+    // no more threads than the pool, however many connections there are
+    QVERIFY(SendQueueScheduler::getInstance().getThreadCount() >= 1);
+    QVERIFY(SendQueueScheduler::getInstance().getThreadCount() <= 4);
+
+    auto start = p_high_resolution_clock::now();
+    for (auto& queue : queues) {
+        queuePackets(*queue, NUM_PACKETS);
+    }
+
+    QTRY_COMPARE_WITH_TIMEOUT(numSent.load(), NUM_CONNECTIONS * NUM_PACKETS, MAX_TEST_TIMEOUT_MSECS);
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(p_high_resolution_clock::now() - start);
+    qDebug() << NUM_CONNECTIONS << "connections sent" << numSent.load() << "packets in" << elapsed.count() << "msecs on"
+        << SendQueueScheduler::getInstance().getThreadCount() << "pacing threads";
+
+    for (auto& queue : queues) {
+        queue->ack(SequenceNumber(NUM_PACKETS));
+        queue->stop();
+    }
+    queues.clear();
+
+    QCOMPARE(SendQueueScheduler::getInstance().getQueueCount(), (size_t)0);
+}
@@ -0,0 +1,31 @@
+//
+//  SendQueueTests.h
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_SendQueueTests_h
+#define hifi_SendQueueTests_h
+
+#pragma once
+
+#include <QtTest/QtTest>
+
+class SendQueueTests : public QObject {
+    Q_OBJECT
+private slots:
+    // Test that a queue is still paced by its packet send period
+    void pacingTest();
+
+    // Test that packets queued one by one while the queue is sending don't bypass its packet send period
+    void floodPacingTest();
+
+    // Test that 1000 loopback connections are all serviced by the shared pacing threads
+    void manyConnectionsTest();
+};
+
+#endif // hifi_SendQueueTests_h
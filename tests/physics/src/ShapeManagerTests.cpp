@@ -13,6 +13,8 @@
 
 #include <iostream>
 
+#include <QTemporaryDir>
+
 #include <ShapeManager.h>
 #include <StreamUtils.h>
 #include <Extents.h>
@@ -244,3 +246,131 @@ void ShapeManagerTests::addCompoundShape() {
     QCOMPARE(shapeManager.getNumShapes(), 0);
     QCOMPARE(shapeManager.getNumReferences(info), 0);
 }
+
+static const int NUM_COMPOUND_HULLS = 3;
+
+static ShapeInfo makeCompoundInfo() {
+    QVector<glm::vec3> tetrahedron;
+    tetrahedron.push_back(glm::vec3(1.0f, 1.0f, 1.0f));
+    tetrahedron.push_back(glm::vec3(1.0f, -1.0f, -1.0f));
+    tetrahedron.push_back(glm::vec3(-1.0f, 1.0f, -1.0f));
+    tetrahedron.push_back(glm::vec3(-1.0f, -1.0f, 1.0f));
+
+    ShapeInfo::PointCollection pointCollection;
+    for (int i = 0; i < NUM_COMPOUND_HULLS; ++i) {
+        glm::vec3 offset((float)i, 0.0f, 0.0f);
+        ShapeInfo::PointList pointList;
+        for (int j = 0; j < tetrahedron.size(); ++j) {
+            pointList.push_back((float)(i + 1) * tetrahedron[j] + offset);
+        }
+        pointCollection.push_back(pointList);
+    }
+
+    ShapeInfo info;
+    info.setParams(SHAPE_TYPE_COMPOUND, glm::vec3(3.0f));
+    info.setPointCollection(pointCollection);
+    info.setOffset(glm::vec3(0.5f, 0.0f, 0.0f));
+    return info;
+}
+
+static ShapeCachePointer makeShapeCache(const QString& location) {
+    auto shapeCache = std::make_shared<ShapeCache>(location.toStdString(), "shape");
+    // skip ShapeCache::initialize(), whose version check needs the settings manager
+    shapeCache->cache::FileCache::initialize();
+    return shapeCache;
+}
+
+void ShapeManagerTests::serializeCompoundShape() {
+    int numHulls = NUM_COMPOUND_HULLS;
+    ShapeInfo info = makeCompoundInfo();
+    QVERIFY(ShapeCache::isCacheableType(info.getType()));
+
+    const btCollisionShape* shape = ShapeFactory::createShapeFromInfo(info);
+    QVERIFY(shape != nullptr);
+    QByteArray data = ShapeCache::serializeShape(shape);
+    QVERIFY(!data.isEmpty());
+
+    // a stored shape must come back with the same children, transforms, margins and points
+    const btCollisionShape* restoredShape = ShapeCache::deserializeShape(data);
+    QVERIFY(restoredShape != nullptr);
+    QCOMPARE(restoredShape->getShapeType(), (int)COMPOUND_SHAPE_PROXYTYPE);
+    const btCompoundShape* compound = static_cast<const btCompoundShape*>(shape);
+    const btCompoundShape* restoredCompound = static_cast<const btCompoundShape*>(restoredShape);
+    QCOMPARE(restoredCompound->getNumChildShapes(), numHulls);
+    for (int i = 0; i < numHulls; ++i) {
+        QCOMPARE(restoredCompound->getChildTransform(i).getOrigin(), compound->getChildTransform(i).getOrigin());
+        const btConvexHullShape* hull = static_cast<const btConvexHullShape*>(compound->getChildShape(i));
+        const btConvexHullShape* restoredHull = static_cast<const btConvexHullShape*>(restoredCompound->getChildShape(i));
+        QCOMPARE(restoredHull->getMargin(), hull->getMargin());
+        QCOMPARE(restoredHull->getNumPoints(), hull->getNumPoints());
+        for (int j = 0; j < hull->getNumPoints(); ++j) {
+            QCOMPARE(restoredHull->getUnscaledPoints()[j], hull->getUnscaledPoints()[j]);
+        }
+    }
+
+    // truncated data must be rejected
+    QVERIFY(ShapeCache::deserializeShape(data.left(data.size() / 2)) == nullptr);
+
+    // shapes we don't know how to persist are refused
+    ShapeInfo boxInfo;
+    boxInfo.setBox(glm::vec3(1.0f));
+    const btCollisionShape* box = ShapeFactory::createShapeFromInfo(boxInfo);
+    QVERIFY(ShapeCache::serializeShape(box).isEmpty());
+
+    ShapeFactory::deleteShape(box);
+    ShapeFactory::deleteShape(restoredShape);
+    ShapeFactory::deleteShape(shape);
+}
+
+void ShapeManagerTests::requestCompoundShapeCacheMiss() {
+    QTemporaryDir dir;
+    auto shapeCache = makeShapeCache(dir.path());
+    ShapeManager shapeManager;
+    shapeManager.setShapeCache(shapeCache);
+    ShapeInfo info = makeCompoundInfo();
+
+    // nothing on disk: the shape is built on a worker and persisted
+    uint32_t requestCount = shapeManager.getWorkRequestCount();
+    QVERIFY(shapeManager.requestShape(info) == nullptr);
+    QCOMPARE(shapeManager.getWorkRequestCount(), requestCount + 1);
+    QTRY_COMPARE(shapeManager.getWorkDeliveryCount(), 1u);
+    QCOMPARE(shapeManager.getCacheHitCount(), 0u);
+    QVERIFY(shapeManager.hasShapeWithKey(info.getHash()));
+    QTRY_COMPARE(shapeCache->getNumTotalFiles(), (size_t)1);
+
+    // once delivered it is shared like any other shape
+    const btCollisionShape* shape = shapeManager.requestShape(info);
+    QVERIFY(shape != nullptr);
+    QCOMPARE(shapeManager.getNumReferences(info), 1);
+    QCOMPARE(shapeManager.getWorkRequestCount(), requestCount + 1);
+    QVERIFY(shapeManager.releaseShape(shape));
+}
+
+void ShapeManagerTests::requestCompoundShapeCacheHit() {
+    QTemporaryDir dir;
+    ShapeInfo info = makeCompoundInfo();
+    {
+        // an earlier session built the shape and persisted it
+        auto shapeCache = makeShapeCache(dir.path());
+        const btCollisionShape* shape = ShapeFactory::createShapeFromInfo(info);
+        shapeCache->saveShape(info, shape);
+        ShapeFactory::deleteShape(shape);
+        QTRY_COMPARE(shapeCache->getNumTotalFiles(), (size_t)1);
+    }
+
+    auto shapeCache = makeShapeCache(dir.path());
+    QCOMPARE(shapeCache->getNumTotalFiles(), (size_t)1);
+    ShapeManager shapeManager;
+    shapeManager.setShapeCache(shapeCache);
+
+    // the shape is loaded on a worker rather than built again
+    QVERIFY(shapeManager.requestShape(info) == nullptr);
+    QTRY_COMPARE(shapeManager.getWorkDeliveryCount(), 1u);
+    QCOMPARE(shapeManager.getCacheHitCount(), 1u);
+
+    const btCollisionShape* shape = shapeManager.requestShape(info);
+    QVERIFY(shape != nullptr);
+    QCOMPARE(shape->getShapeType(), (int)COMPOUND_SHAPE_PROXYTYPE);
+    QCOMPARE(static_cast<const btCompoundShape*>(shape)->getNumChildShapes(), NUM_COMPOUND_HULLS);
+    QVERIFY(shapeManager.releaseShape(shape));
+}
@@ -25,6 +25,9 @@ private slots:
     void addCylinderShape();
     void addCapsuleShape();
     void addCompoundShape();
+    void serializeCompoundShape();
+    void requestCompoundShapeCacheMiss();
+    void requestCompoundShapeCacheHit();
 };
 
 #endif // hifi_ShapeManagerTests_h
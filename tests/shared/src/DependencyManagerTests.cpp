@@ -216,3 +216,72 @@ void DependencyManagerTests::testDependencyManagerMultiThreaded() {
     getThread2.join();
     assertDeps(false);
 }
+
+void DependencyManagerTests::testRef() {
+    QVERIFY(DependencyManager::ref<A>() == nullptr);
+
+    auto instance = DependencyManager::set<A>();
+    QCOMPARE(DependencyManager::ref<A>(), instance.data());
+    QCOMPARE(DependencyManager::ref<A>(), DependencyManager::get<A>().data());
+
+    // replacing a dependency publishes the new instance
+    instance.clear();
+    auto replacement = DependencyManager::set<A>();
+    QCOMPARE(DependencyManager::ref<A>(), replacement.data());
+    replacement.clear();
+
+    DependencyManager::destroy<A>();
+    QVERIFY(DependencyManager::ref<A>() == nullptr);
+}
+
+class Base : public Dependency {
+public:
+    virtual ~Base() {}
+};
+
+class Derived : public Base {
+};
+
+void DependencyManagerTests::testRefInheritance() {
+    DependencyManager::registerInheritance<Base, Derived>();
+    auto instance = DependencyManager::set<Base, Derived>();
+
+    QCOMPARE(DependencyManager::ref<Base>(), instance.data());
+    QVERIFY(dynamic_cast<Derived*>(DependencyManager::ref<Base>()) != nullptr);
+    instance.clear();
+
+    DependencyManager::destroy<Base>();
+    QVERIFY(DependencyManager::ref<Base>() == nullptr);
+}
+
+static const int NUM_BENCHMARK_CALLS = 1000000;
+
+void DependencyManagerTests::benchmarkGet() {
+    DependencyManager::set<B>();
+    int numMissing = 0;
+    QBENCHMARK {
+        for (int i = 0; i < NUM_BENCHMARK_CALLS; ++i) {
+            auto instance = DependencyManager::get<B>();
+            if (!instance) {
+                ++numMissing;
+            }
+        }
+    }
+    QCOMPARE(numMissing, 0);
+    DependencyManager::destroy<B>();
+}
+
+void DependencyManagerTests::benchmarkRef() {
+    DependencyManager::set<B>();
+    int numMissing = 0;
+    QBENCHMARK {
+        for (int i = 0; i < NUM_BENCHMARK_CALLS; ++i) {
+            auto instance = DependencyManager::ref<B>();
+            if (!instance) {
+                ++numMissing;
+            }
+        }
+    }
+    QCOMPARE(numMissing, 0);
+    DependencyManager::destroy<B>();
+}
@@ -16,6 +16,10 @@ class DependencyManagerTests : public QObject {
 private slots:
     void testDependencyManager();
     void testDependencyManagerMultiThreaded();
+    void testRef();
+    void testRefInheritance();
+    void benchmarkGet();
+    void benchmarkRef();
 };
 
 #endif // hifi_DependencyManagerTests_h
@@ -10,7 +10,13 @@
 
 #include "FileCacheTests.h"
 
+#include <algorithm>
+#include <functional>
+#include <random>
+
 #include <shared/FileCache.h>
+#include <NumericalConstants.h>
+#include <SharedUtil.h>
 
 QTEST_GUILESS_MAIN(FileCacheTests)
 
@@ -40,6 +46,24 @@ FileCachePointer makeFileCache(QString location) {
     return result;
 }
 
+FileCachePointer makeFileCache(QString location, EvictionPolicy* policy, size_t maxSize = MAX_UNUSED_SIZE) {
+    auto result = std::make_shared<FileCache>(location.toStdString(), "tmp");
+    result->setEvictionPolicy(EvictionPolicy::Pointer(policy));
+    result->initialize();
+    result->setMinFreeSize(0);
+    result->setMaxSize(maxSize);
+    return result;
+}
+
+// look the file up, writing it on a miss like a download would, and release it right away
+static bool requestFile(const FileCachePointer& cache, const std::string& key, size_t length = TEST_DATA.size()) {
+    if (cache->getFile(key)) {
+        return true;
+    }
+    cache->writeFile(TEST_DATA.data(), FileCache::Metadata(key, length));
+    return false;
+}
+
 void FileCacheTests::initTestCase() {
 }
 
@@ -160,3 +184,136 @@ void FileCacheTests::testWipe() {
 void FileCacheTests::cleanupTestCase() {
 }
 
+void FileCacheTests::testFrequencyAdmission() {
+    const int NUM_SESSIONS = 3;
+    const int NUM_POPULAR_FILES = 5;
+    const int NUM_ONE_OFF_FILES = 20;
+
+    // a few files used in every session, followed by more one-off files than the cache holds
+    auto replay = [&](const FileCachePointer& cache) {
+        for (int session = 0; session < NUM_SESSIONS; ++session) {
+            for (int i = 0; i < NUM_POPULAR_FILES; ++i) {
+                requestFile(cache, getFileKey(i));
+            }
+            QThread::msleep(10);
+        }
+        for (int i = 0; i < NUM_ONE_OFF_FILES; ++i) {
+            requestFile(cache, getFileKey(100 + i));
+            QThread::msleep(10);
+        }
+    };
+
+    QTemporaryDir lruDir;
+    auto lruCache = makeFileCache(lruDir.path(), new LRUEvictionPolicy());
+    replay(lruCache);
+    QVERIFY(lruCache->getSizeTotalFiles() <= MAX_UNUSED_SIZE);
+    QVERIFY(!lruCache->getFile(getFileKey(0)));
+
+    QTemporaryDir tinyLFUDir;
+    auto tinyLFUCache = makeFileCache(tinyLFUDir.path(), new TinyLFUEvictionPolicy());
+    replay(tinyLFUCache);
+    QVERIFY(tinyLFUCache->getSizeTotalFiles() <= MAX_UNUSED_SIZE);
+
+    // every lookup but the first of each popular file was a hit, and all files are the same size
+    float expectedHitRatio = (float)((NUM_SESSIONS - 1) * NUM_POPULAR_FILES) /
+        (float)(NUM_SESSIONS * NUM_POPULAR_FILES + NUM_ONE_OFF_FILES);
+    QCOMPARE(tinyLFUCache->getHitRatio(), expectedHitRatio);
+    QCOMPARE(tinyLFUCache->getByteHitRatio(), expectedHitRatio);
+
+    for (int i = 0; i < NUM_POPULAR_FILES; ++i) {
+        QVERIFY(tinyLFUCache->getFile(getFileKey(i)));
+    }
+}
+
+void FileCacheTests::testEvictionPolicyPersistence() {
+    const std::string key = getFileKey(42);
+    const int NUM_LOOKUPS = 3;
+
+    QTemporaryDir dir;
+    auto policy = new TinyLFUEvictionPolicy();
+    auto cache = makeFileCache(dir.path(), policy);
+    for (int i = 0; i < NUM_LOOKUPS; ++i) {
+        cache->getFile(key);
+    }
+    QCOMPARE(policy->getFrequency(key), NUM_LOOKUPS);
+    cache.reset();
+
+    // the frequency sketch survives a restart
+    policy = new TinyLFUEvictionPolicy();
+    cache = makeFileCache(dir.path(), policy);
+    QCOMPARE(policy->getFrequency(key), NUM_LOOKUPS);
+    QCOMPARE(policy->getFrequency(getFileKey(43)), 0);
+}
+
+void FileCacheTests::benchmarkEvictionPolicies() {
+    const int NUM_SESSIONS = 10;
+    const size_t CACHE_SIZE = MB_TO_BYTES(4);
+
+    // every session loads the same few large textures, a zipf distributed set of shared items and many one-off items
+    const int NUM_SESSION_FILES = 8;
+    const size_t SESSION_FILE_SIZE = KB_TO_BYTES(256);
+    const int NUM_SHARED_FILES = 64;
+    const int NUM_SHARED_REQUESTS = 40;
+    const int NUM_ONE_OFF_REQUESTS = 40;
+
+    struct Request {
+        std::string key;
+        size_t length;
+    };
+    std::vector<std::vector<Request>> trace(NUM_SESSIONS);
+    std::mt19937 random(42);
+    std::vector<double> sharedWeights;
+    for (int i = 1; i <= NUM_SHARED_FILES; ++i) {
+        sharedWeights.push_back(1.0 / i);
+    }
+    std::discrete_distribution<int> sharedDistribution(sharedWeights.begin(), sharedWeights.end());
+    std::uniform_int_distribution<size_t> sizeDistribution(KB_TO_BYTES(16), KB_TO_BYTES(512));
+    int nextOneOff = 0;
+    for (auto& session : trace) {
+        for (int i = 0; i < NUM_SESSION_FILES; ++i) {
+            session.push_back({ "session" + std::to_string(i), SESSION_FILE_SIZE });
+        }
+        for (int i = 0; i < NUM_SHARED_REQUESTS; ++i) {
+            int shared = sharedDistribution(random);
+            session.push_back({ "shared" + std::to_string(shared), KB_TO_BYTES(16) * (1 + shared % 8) });
+        }
+        for (int i = 0; i < NUM_ONE_OFF_REQUESTS; ++i) {
+            session.push_back({ "oneoff" + std::to_string(nextOneOff++), sizeDistribution(random) });
+        }
+        std::shuffle(session.begin(), session.end(), random);
+    }
+
+    std::vector<std::function<EvictionPolicy*()>> policies {
+        [] { return new LRUEvictionPolicy(); },
+        [] { return new TinyLFUEvictionPolicy(); }
+    };
+    for (const auto& createPolicy : policies) {
+        QTemporaryDir dir;
+        size_t numRequests = 0;
+        size_t numHits = 0;
+        size_t requestedBytes = 0;
+        size_t hitBytes = 0;
+        std::string policyName;
+
+        auto start = usecTimestampNow();
+        for (const auto& session : trace) {
+            // each session is a restart of the cache
+            auto cache = makeFileCache(dir.path(), createPolicy(), CACHE_SIZE);
+            policyName = cache->getEvictionPolicy().getName();
+            for (const auto& request : session) {
+                bool isHit = requestFile(cache, request.key, request.length);
+                numRequests += 1;
+                requestedBytes += request.length;
+                if (isHit) {
+                    numHits += 1;
+                    hitBytes += request.length;
+                }
+            }
+        }
+        auto replayTime = usecTimestampNow() - start;
+
+        qDebug() << policyName.c_str() << "hit ratio" << (float)numHits / (float)numRequests
+                 << "byte hit ratio" << (float)hitBytes / (float)requestedBytes
+                 << "in" << (float)replayTime / USECS_PER_MSEC << "ms";
+    }
+}
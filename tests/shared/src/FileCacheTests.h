@@ -21,6 +21,9 @@ private slots:
     void testFreeSpacePreservation();
     void cleanupTestCase();
     void testWipe();
+    void testFrequencyAdmission();
+    void testEvictionPolicyPersistence();
+    void benchmarkEvictionPolicies();
 
 private:
     size_t getFreeSpace() const;
@@ -0,0 +1,241 @@
+//
+//  LogHandlerTests.cpp
+//  tests/shared/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "LogHandlerTests.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <QtTest/QtTest>
+
+#include <LogHandler.h>
+#include <NumericalConstants.h>
+
+QTEST_GUILESS_MAIN(LogHandlerTests)
+
+Q_LOGGING_CATEGORY(log_test, "log.test")
+
+static const char* TEST_FILE = "LogHandlerTests.cpp";
+
+// start at the beginning of a second, so that a burst fits in it
+static void waitForNextSecond() {
+    auto second = [] {
+        using namespace std::chrono;
+        return duration_cast<seconds>(steady_clock::now().time_since_epoch()).count();
+    };
+    auto start = second();
+    while (second() == start) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void LogHandlerTests::initTestCase() {
+    LogHandler::getInstance().setTargetName("test");
+    LogHandler::getInstance().setOutputFunction([this](const QString& lines) {
+        std::lock_guard<std::mutex> lock(_linesMutex);
+        _lines += lines.split('\n', QString::SkipEmptyParts);
+    });
+}
+
+void LogHandlerTests::init() {
+    LogHandler::getInstance().setMaxMessagesPerSecond(DEFAULT_MAX_MESSAGES_PER_SECOND);
+    LogHandler::getInstance().flush();
+    takeLines();
+}
+
+void LogHandlerTests::cleanupTestCase() {
+    LogHandler::getInstance().flush();
+    LogHandler::getInstance().setOutputFunction(LogHandler::OutputFunction());
+}
+
+QStringList LogHandlerTests::takeLines() {
+    std::lock_guard<std::mutex> lock(_linesMutex);
+    QStringList lines;
+    lines.swap(_lines);
+    return lines;
+}
+
+void LogHandlerTests::testQueuedMessages() {
+    auto& logHandler = LogHandler::getInstance();
+    logHandler.setMaxMessagesPerSecond(0);
+
+    const int NUM_THREADS = 4;
+    const int NUM_MESSAGES = 1000;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < NUM_THREADS; ++i) {
+        threads.emplace_back([i] {
+            for (int j = 0; j < NUM_MESSAGES; ++j) {
+                LogHandler::verboseMessageHandler(QtDebugMsg, QMessageLogContext(TEST_FILE, j, nullptr, "log.test"),
+                                                  QString("thread %1 message %2").arg(i).arg(j));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    logHandler.flush();
+
+    auto lines = takeLines();
+    QCOMPARE(lines.size(), NUM_THREADS * NUM_MESSAGES);
+    std::vector<int> nextMessages(NUM_THREADS, 0);
+    QRegExp linePattern("\\[[0-9/ :]+\\] \\[DEBUG\\] \\[log.test\\] \\[test\\] thread (\\d+) message (\\d+)");
+    for (const auto& line : lines) {
+        QVERIFY2(linePattern.exactMatch(line), qPrintable(line));
+        // each thread's messages come out in order
+        auto thread = linePattern.cap(1).toInt();
+        QCOMPARE(linePattern.cap(2).toInt(), nextMessages[thread]++);
+    }
+
+    // multi line messages repeat the prefix
+    logHandler.queueMessage(LogWarning, QMessageLogContext(), "first\nsecond");
+    logHandler.flush();
+    lines = takeLines();
+    QCOMPARE(lines.size(), 2);
+    QVERIFY(lines[1].contains("[WARNING]") && lines[1].endsWith(" second"));
+}
+
+void LogHandlerTests::testRateLimit() {
+    auto& logHandler = LogHandler::getInstance();
+    const int MAX_MESSAGES_PER_SECOND = 10;
+    const int NUM_MESSAGES = 100;
+    logHandler.setMaxMessagesPerSecond(MAX_MESSAGES_PER_SECOND);
+
+    waitForNextSecond();
+
+    QMessageLogContext context(TEST_FILE, __LINE__, nullptr, "log.test");
+    QMessageLogContext otherContext(TEST_FILE, __LINE__, nullptr, "log.test");
+    for (int i = 0; i < NUM_MESSAGES; ++i) {
+        logHandler.queueMessage(LogDebug, context, QString("burst %1").arg(i));
+    }
+    logHandler.queueMessage(LogDebug, otherContext, "other call site");
+    logHandler.flush();
+    auto lines = takeLines();
+    QCOMPARE(lines.size(), MAX_MESSAGES_PER_SECOND + 1);
+    QVERIFY(lines.last().endsWith("other call site"));
+
+    // the next second reports the suppressed messages
+    std::this_thread::sleep_for(std::chrono::milliseconds(MSECS_PER_SECOND));
+    logHandler.queueMessage(LogDebug, context, "after the burst");
+    logHandler.flush();
+    lines = takeLines();
+    QCOMPARE(lines.size(), 2);
+    QVERIFY2(lines[0].contains("[SUPPRESS]") && lines[0].contains(QString("%1 log entries suppressed")
+                                                                   .arg(NUM_MESSAGES - MAX_MESSAGES_PER_SECOND)),
+             qPrintable(lines[0]));
+    QVERIFY(lines[1].endsWith("after the burst"));
+}
+
+void LogHandlerTests::testRateLimitLevels() {
+    auto& logHandler = LogHandler::getInstance();
+    const int MAX_MESSAGES_PER_SECOND = 10;
+    const int NUM_MESSAGES = 100;
+    logHandler.setMaxMessagesPerSecond(MAX_MESSAGES_PER_SECOND);
+
+    // a flood of debug messages doesn't silence warnings that start the same way, as release builds have no file and line
+    QMessageLogContext debugContext(nullptr, 0, nullptr, "log.test");
+    QMessageLogContext warningContext(nullptr, 0, nullptr, "log.test.other");
+    waitForNextSecond();
+    for (int i = 0; i < NUM_MESSAGES; ++i) {
+        logHandler.queueMessage(LogDebug, debugContext, QString("same message prefix, debug %1").arg(i));
+        logHandler.queueMessage(LogWarning, warningContext, QString("same message prefix, warning %1").arg(i));
+    }
+    logHandler.flush();
+    auto lines = takeLines();
+    auto warnings = std::count_if(lines.begin(), lines.end(), [](const QString& line) {
+        return line.contains("[WARNING]");
+    });
+    auto debugs = std::count_if(lines.begin(), lines.end(), [](const QString& line) {
+        return line.contains("[DEBUG]");
+    });
+    QCOMPARE((int)warnings, NUM_MESSAGES);
+    QCOMPARE((int)debugs, MAX_MESSAGES_PER_SECOND);
+
+    // the writer reports a burst that ended without another message from its call site
+    QTRY_VERIFY_WITH_TIMEOUT([this] { std::lock_guard<std::mutex> lock(_linesMutex); return !_lines.empty(); }(),
+                             2 * MSECS_PER_SECOND);
+    lines = takeLines();
+    QCOMPARE(lines.size(), 1);
+    QVERIFY2(lines[0].contains("[SUPPRESS]") && lines[0].contains(QString("%1 log entries suppressed")
+                                                                   .arg(NUM_MESSAGES - MAX_MESSAGES_PER_SECOND)) &&
+             lines[0].contains(QString("debug %1").arg(NUM_MESSAGES - 1)),
+             qPrintable(lines[0]));
+}
+
+void LogHandlerTests::testRepeatedMessages() {
+    auto& logHandler = LogHandler::getInstance();
+    for (int i = 0; i < 5; ++i) {
+        HIFI_FCDEBUG(log_test(), "repeated" << i);
+    }
+    logHandler.flush();
+    auto lines = takeLines();
+    QCOMPARE(lines.size(), 1);
+    QVERIFY(lines[0].endsWith("repeated 0"));
+
+    // the writer reports the repeats every VERBOSE_LOG_INTERVAL_SECONDS
+    QTRY_VERIFY_WITH_TIMEOUT([this] { std::lock_guard<std::mutex> lock(_linesMutex); return !_lines.empty(); }(),
+                             2 * VERBOSE_LOG_INTERVAL_SECONDS * MSECS_PER_SECOND);
+    lines = takeLines();
+    QCOMPARE(lines.size(), 1);
+    QVERIFY2(lines[0].contains("5 repeated log entries - Last entry: \"repeated 4\""), qPrintable(lines[0]));
+}
+
+void LogHandlerTests::benchmarkProducerLatency() {
+    auto& logHandler = LogHandler::getInstance();
+    logHandler.setMaxMessagesPerSecond(0);
+    const int NUM_THREADS = 8;
+    const int NUM_MESSAGES = 20000;
+
+    // the worst and average time a thread spends logging a message, with all the threads logging at once
+    auto measure = [&](const std::function<void(int, int)>& logMessage) {
+        std::vector<std::chrono::nanoseconds> worstLatencies(NUM_THREADS);
+        std::vector<std::chrono::nanoseconds> totalLatencies(NUM_THREADS);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < NUM_THREADS; ++i) {
+            threads.emplace_back([&, i] {
+                for (int j = 0; j < NUM_MESSAGES; ++j) {
+                    auto start = std::chrono::high_resolution_clock::now();
+                    logMessage(i, j);
+                    auto latency = std::chrono::high_resolution_clock::now() - start;
+                    worstLatencies[i] = std::max(worstLatencies[i], latency);
+                    totalLatencies[i] += latency;
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        logHandler.flush();
+        takeLines();
+
+        auto worst = *std::max_element(worstLatencies.begin(), worstLatencies.end());
+        std::chrono::nanoseconds total { 0 };
+        for (auto latency : totalLatencies) {
+            total += latency;
+        }
+        return std::make_pair((float)worst.count() / NSECS_PER_USEC,
+                              (float)total.count() / (NSECS_PER_USEC * NUM_THREADS * NUM_MESSAGES));
+    };
+
+    auto queued = measure([&](int thread, int message) {
+        logHandler.queueMessage(LogDebug, QMessageLogContext(TEST_FILE, message, nullptr, "log.test"),
+                                QString("thread %1 message %2").arg(thread).arg(message));
+    });
+    auto printed = measure([&](int thread, int message) {
+        logHandler.printMessage(LogDebug, QMessageLogContext(TEST_FILE, message, nullptr, "log.test"),
+                                QString("thread %1 message %2").arg(thread).arg(message));
+    });
+
+    qDebug() << NUM_MESSAGES << "messages on each of" << NUM_THREADS << "threads";
+    qDebug() << "    queued: worst" << queued.first << "us, average" << queued.second << "us";
+    qDebug() << "    formatted and output on the logging thread: worst" << printed.first << "us, average"
+             << printed.second << "us";
+}
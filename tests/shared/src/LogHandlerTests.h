@@ -0,0 +1,38 @@
+//
+//  LogHandlerTests.h
+//  tests/shared/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_LogHandlerTests_h
+#define hifi_LogHandlerTests_h
+
+#include <mutex>
+
+#include <QtCore/QObject>
+#include <QtCore/QStringList>
+
+class LogHandlerTests : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void init();
+    void cleanupTestCase();
+    void testQueuedMessages();
+    void testRateLimit();
+    void testRateLimitLevels();
+    void testRepeatedMessages();
+    void benchmarkProducerLatency();
+
+private:
+    QStringList takeLines();
+
+    std::mutex _linesMutex;
+    QStringList _lines;
+};
+
+#endif // hifi_LogHandlerTests_h
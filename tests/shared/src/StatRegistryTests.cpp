@@ -0,0 +1,175 @@
+//
+//  StatRegistryTests.cpp
+//  tests/shared/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "StatRegistryTests.h"
+
+#include <thread>
+#include <vector>
+
+#include <QtTest/QtTest>
+
+#include <NumericalConstants.h>
+#include <SharedUtil.h>
+#include <StatRegistry.h>
+#include <StatTracker.h>
+
+QTEST_GUILESS_MAIN(StatRegistryTests)
+
+using namespace stats;
+
+static void runOnThreads(int numThreads, const std::function<void()>& function) {
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numThreads; ++i) {
+        threads.emplace_back(function);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void StatRegistryTests::testCounter() {
+    auto& counter = StatRegistry::getInstance().getCounter("TestCounter");
+    QCOMPARE(&StatRegistry::getInstance().getCounter("TestCounter"), &counter);
+    QCOMPARE(&STAT_COUNTER("TestCounter"), &counter);
+
+    const int NUM_THREADS = 8;
+    const int NUM_INCREMENTS = 100000;
+    runOnThreads(NUM_THREADS, [&] {
+        for (int i = 0; i < NUM_INCREMENTS; ++i) {
+            counter.increment();
+        }
+        counter.add(-10);
+    });
+    QCOMPARE(counter.get(), (int64_t)NUM_THREADS * (NUM_INCREMENTS - 10));
+
+    counter.set(42);
+    QCOMPARE(counter.get(), (int64_t)42);
+}
+
+void StatRegistryTests::testStatTracker() {
+    StatTracker statTracker;
+    statTracker.incrementStat("TestTrackedStat");
+    statTracker.updateStat("TestTrackedStat", 5);
+    {
+        CounterStat counterStat("TestTrackedStat");
+        QCOMPARE(statTracker.getStat("TestTrackedStat").toInt(), 7);
+    }
+    statTracker.decrementStat("TestTrackedStat");
+    QCOMPARE(statTracker.getStat("TestTrackedStat").toInt(), 5);
+    QCOMPARE(StatRegistry::getInstance().getCounter("TestTrackedStat").get(), (int64_t)5);
+
+    statTracker.setStat("TestTrackedStat", -3);
+    QCOMPARE(statTracker.getStat("TestTrackedStat").toInt(), -3);
+
+    // unknown stats read as 0, as they did before
+    QCOMPARE(statTracker.getStat("TestUnknownStat").toInt(), 0);
+}
+
+void StatRegistryTests::testHistogram() {
+    auto& histogram = StatRegistry::getInstance().getHistogram("TestHistogram", { 10.0, 1.0, 100.0 });
+    QCOMPARE(&StatRegistry::getInstance().getHistogram("TestHistogram", {}), &histogram);
+
+    const int NUM_THREADS = 4;
+    runOnThreads(NUM_THREADS, [&] {
+        for (auto value : { 0.5, 1.0, 5.0, 50.0, 500.0, 5000.0 }) {
+            histogram.record(value);
+        }
+    });
+
+    auto snapshot = histogram.getSnapshot();
+    QCOMPARE(snapshot.upperBounds, std::vector<double>({ 1.0, 10.0, 100.0 }));
+    QCOMPARE(snapshot.counts, std::vector<uint64_t>({ 2 * NUM_THREADS, NUM_THREADS, NUM_THREADS, 2 * NUM_THREADS }));
+    QCOMPARE(snapshot.count, (uint64_t)6 * NUM_THREADS);
+    QCOMPARE(snapshot.sum, 5556.5 * NUM_THREADS);
+
+    std::vector<double> manyBounds;
+    for (int i = 0; i < 100; ++i) {
+        manyBounds.push_back(i);
+    }
+    auto& boundedHistogram = StatRegistry::getInstance().getHistogram("TestBoundedHistogram", manyBounds);
+    QCOMPARE(boundedHistogram.getSnapshot().upperBounds.size(), Histogram::MAX_BUCKETS);
+}
+
+void StatRegistryTests::testRate() {
+    Rate rate("TestRate", "");
+    const uint64_t START = 1000;
+
+    // 10 events per second for 20 seconds
+    for (uint64_t second = START; second < START + 20; ++second) {
+        for (int i = 0; i < 10; ++i) {
+            rate.mark(1, second);
+        }
+    }
+    QCOMPARE(rate.getTotal(), (int64_t)200);
+    QCOMPARE(rate.getRate(10, START + 20), 10.0f);
+    // the current second isn't over yet, so it isn't counted
+    rate.mark(1000, START + 20);
+    QCOMPARE(rate.getRate(10, START + 20), 10.0f);
+    QCOMPARE(rate.getRate(1, START + 21), 1000.0f);
+
+    // seconds without events count as 0, and stale slots are ignored
+    QCOMPARE(rate.getRate(10, START + 26), 104.0f);
+    QCOMPARE(rate.getRate(10, START + 100), 0.0f);
+    rate.mark(5, START + 64);
+    QCOMPARE(rate.getRate(1, START + 65), 5.0f);
+    QCOMPARE(rate.getTotal(), (int64_t)1205);
+
+    // concurrent marks aren't lost
+    const int NUM_THREADS = 8;
+    const int NUM_MARKS = 10000;
+    runOnThreads(NUM_THREADS, [&] {
+        for (int i = 0; i < NUM_MARKS; ++i) {
+            rate.mark(1, START + 200);
+        }
+    });
+    QCOMPARE(rate.getRate(1, START + 201), (float)(NUM_THREADS * NUM_MARKS));
+}
+
+void StatRegistryTests::testPrometheusText() {
+    auto& registry = StatRegistry::getInstance();
+    registry.getCounter("Test Exported-Counter", "A counter\nthat is exported").set(12);
+    registry.getHistogram("TestExportedHistogram", { 0.5, 2.0 }).record(1.0);
+    registry.getRate("TestExportedRate", "Marks").mark(3);
+
+    auto text = QString::fromUtf8(registry.toPrometheusText());
+    QVERIFY(text.contains("# HELP hifi_Test_Exported_Counter A counter\\nthat is exported\n"));
+    QVERIFY(text.contains("# TYPE hifi_Test_Exported_Counter gauge\nhifi_Test_Exported_Counter 12\n"));
+    QVERIFY(text.contains("# TYPE hifi_TestExportedHistogram histogram\n"));
+    QVERIFY(text.contains("hifi_TestExportedHistogram_bucket{le=\"0.5\"} 0\n"));
+    QVERIFY(text.contains("hifi_TestExportedHistogram_bucket{le=\"2\"} 1\n"));
+    QVERIFY(text.contains("hifi_TestExportedHistogram_bucket{le=\"+Inf\"} 1\n"));
+    QVERIFY(text.contains("hifi_TestExportedHistogram_sum 1\nhifi_TestExportedHistogram_count 1\n"));
+    QVERIFY(text.contains("# TYPE hifi_TestExportedRate_total counter\nhifi_TestExportedRate_total 3\n"));
+    QVERIFY(text.contains("# TYPE hifi_TestExportedRate_per_second gauge\n"));
+}
+
+void StatRegistryTests::benchmarkCounters() {
+    const int NUM_THREADS = 4;
+    const int NUM_UPDATES = 1000000;
+    StatTracker statTracker;
+    auto& counter = STAT_COUNTER("BenchmarkCounter");
+
+    auto timeUpdates = [&](const std::function<void()>& update) {
+        auto start = usecTimestampNow();
+        runOnThreads(NUM_THREADS, [&] {
+            for (int i = 0; i < NUM_UPDATES; ++i) {
+                update();
+            }
+        });
+        return (float)(usecTimestampNow() - start) * NSECS_PER_USEC / NUM_UPDATES;
+    };
+
+    auto handleTime = timeUpdates([&] { counter.increment(); });
+    auto trackerTime = timeUpdates([&] { statTracker.incrementStat("BenchmarkCounter"); });
+    QCOMPARE(counter.get(), (int64_t)2 * NUM_THREADS * NUM_UPDATES);
+
+    qDebug() << NUM_UPDATES << "updates on each of" << NUM_THREADS << "threads";
+    qDebug() << "    counter handle:" << handleTime << "ns per update, StatTracker by name:" << trackerTime << "ns";
+}
@@ -0,0 +1,27 @@
+//
+//  StatRegistryTests.h
+//  tests/shared/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_StatRegistryTests_h
+#define hifi_StatRegistryTests_h
+
+#include <QtCore/QObject>
+
+class StatRegistryTests : public QObject {
+    Q_OBJECT
+private slots:
+    void testCounter();
+    void testStatTracker();
+    void testHistogram();
+    void testRate();
+    void testPrometheusText();
+    void benchmarkCounters();
+};
+
+#endif // hifi_StatRegistryTests_h
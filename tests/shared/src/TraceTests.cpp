@@ -11,7 +11,15 @@
 #include <QtTest/QtTest>
 #include <QtGui/QDesktopServices>
 
+#include <thread>
+
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QTemporaryDir>
+
 #include <Profile.h>
+#include <TraceRecorder.h>
 
 #include <NumericalConstants.h>
 #include <test-utils/QTestExtensions.h>
@@ -45,3 +53,141 @@ void TraceTests::testTraceSerialization() {
     qDebug() << "Done";
 }
 
+
+static QJsonArray serializeEvents(const std::shared_ptr<tracing::Tracer>& tracer, const QTemporaryDir& dir) {
+    auto filename = dir.filePath("trace.json");
+    tracer->serialize(filename);
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QJsonArray();
+    }
+    return QJsonDocument::fromJson(file.readAll()).array();
+}
+
+void TraceTests::testRecordedEvents() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    auto tracer = DependencyManager::set<tracing::Tracer>();
+
+    // nothing is recorded while tracing is off
+    {
+        PROFILE_RANGE(test, "Untraced")
+    }
+    tracer->startTracing();
+
+    const int NUM_THREADS = 4;
+    const int NUM_RANGES = 1000;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < NUM_THREADS; ++i) {
+        threads.emplace_back([i] {
+            for (int j = 0; j < NUM_RANGES; ++j) {
+                PROFILE_RANGE_EX(test, QString("Thread%1 \"range\"").arg(i), 0xff0000ff, j)
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    {
+        PROFILE_RANGE_EX(test, "WithArgs", 0xff0000ff, 7, { { "frame", 3 } })
+    }
+    tracer->stopTracing();
+
+    auto events = serializeEvents(tracer, dir);
+    QCOMPARE(events.size(), 2 * NUM_THREADS * NUM_RANGES + 2);
+
+    QHash<QString, int> beginCounts;
+    QHash<QString, qint64> threadIDs;
+    for (const auto& value : events) {
+        auto event = value.toObject();
+        QCOMPARE(event["cat"].toString(), QString("trace.test"));
+        QCOMPARE((qint64)event["pid"].toDouble(), (qint64)QCoreApplication::applicationPid());
+        auto name = event["name"].toString();
+        QVERIFY(name != "Untraced");
+        auto tid = (qint64)event["tid"].toDouble();
+        if (threadIDs.contains(name)) {
+            QCOMPARE(tid, threadIDs[name]);
+        }
+        threadIDs[name] = tid;
+
+        auto type = event["ph"].toString();
+        if (type == "B") {
+            ++beginCounts[name];
+            QVERIFY(event["args"].toObject().contains("nv_payload"));
+            if (name == "WithArgs") {
+                QCOMPARE(event["args"].toObject()["frame"].toInt(), 3);
+                QCOMPARE(event["args"].toObject()["nv_payload"].toInt(), 7);
+            }
+        } else {
+            QCOMPARE(type, QString("E"));
+            QVERIFY(!event.contains("args"));
+        }
+    }
+    QCOMPARE(beginCounts.size(), NUM_THREADS + 1);
+    QCOMPARE(beginCounts["Thread2 \"range\""], NUM_RANGES);
+    QCOMPARE(tracing::TraceRecorder::getInstance().getDroppedCount(), (uint64_t)0);
+
+    // the events are handed out once
+    QCOMPARE(serializeEvents(tracer, dir).size(), 0);
+}
+
+void TraceTests::testRestartTracing() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    auto tracer = DependencyManager::set<tracing::Tracer>();
+
+    // stopping parks the drain thread, starting again discards the previous trace and drains anew
+    tracer->startTracing();
+    {
+        PROFILE_RANGE(test, "First")
+    }
+    tracer->stopTracing();
+    tracer->startTracing();
+    {
+        PROFILE_RANGE(test, "Second")
+    }
+    tracer->stopTracing();
+
+    auto events = serializeEvents(tracer, dir);
+    QCOMPARE(events.size(), 2);
+    for (const auto& value : events) {
+        QCOMPARE(value.toObject()["name"].toString(), QString("Second"));
+    }
+}
+
+void TraceTests::benchmarkEventOverhead() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    auto tracer = DependencyManager::set<tracing::Tracer>();
+    const int NUM_RANGES = 1000000;
+    const QString NAME = "TestRange";
+
+    auto timeRanges = [&] {
+        auto start = usecTimestampNow();
+        for (int i = 0; i < NUM_RANGES; ++i) {
+            PROFILE_RANGE(test, NAME)
+        }
+        return (float)(usecTimestampNow() - start) * NSECS_PER_USEC / NUM_RANGES;
+    };
+    auto timeEventsWithArgs = [&] {
+        auto start = usecTimestampNow();
+        for (int i = 0; i < NUM_RANGES; ++i) {
+            tracing::traceEvent(trace_test(), NAME, tracing::Instant, "", { { "i", i } });
+        }
+        return (float)(usecTimestampNow() - start) * NSECS_PER_USEC / NUM_RANGES;
+    };
+
+    auto disabledTime = timeRanges();
+    tracer->startTracing();
+    auto enabledTime = timeRanges();
+    auto lockedTime = timeEventsWithArgs();
+    tracer->stopTracing();
+    auto start = usecTimestampNow();
+    serializeEvents(tracer, dir);
+    auto serializeTime = usecTimestampNow() - start;
+
+    qDebug() << "PROFILE_RANGE with tracing off:" << disabledTime << "ns, on:" << enabledTime << "ns";
+    qDebug() << "events with args on the locked list:" << lockedTime << "ns per event";
+    qDebug() << "serializing" << 3 * NUM_RANGES << "events:" << (float)serializeTime / USECS_PER_MSEC << "ms, with"
+             << tracing::TraceRecorder::getInstance().getDroppedCount() << "dropped";
+}
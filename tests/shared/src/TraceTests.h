@@ -15,6 +15,9 @@ class TraceTests : public QObject {
     Q_OBJECT
 private slots:
     void testTraceSerialization();
+    void testRecordedEvents();
+    void testRestartTracing();
+    void benchmarkEventOverhead();
 };
 
 #endif // hifi_TraceTests_h
@@ -0,0 +1,299 @@
+//
+//  DomainListSimApp.cpp
+//  tools/domain-list-sim/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "DomainListSimApp.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include <QCommandLineParser>
+#include <QDataStream>
+#include <QLoggingCategory>
+
+#include <DomainHandler.h>
+#include <LimitedNodeList.h>
+#include <NetworkLogging.h>
+#include <NodeList.h>
+#include <NodePermissions.h>
+#include <NumericalConstants.h>
+#include <udt/PacketHeaders.h>
+
+using namespace std::chrono;
+
+// what interface asks to hear about, agents are never told about other agents
+static const QList<NodeType_t> AGENT_INTEREST_LIST {
+    NodeType::AudioMixer, NodeType::AvatarMixer, NodeType::EntityServer,
+    NodeType::AssetServer, NodeType::MessagesMixer, NodeType::EntityScriptServer
+};
+
+static const int JOIN_INTERVAL_MSECS = 20;
+
+DomainListSimApp::DomainListSimApp(int argc, char* argv[]) :
+    QCoreApplication(argc, argv)
+{
+    // parse command-line
+    QCommandLineParser parser;
+    parser.setApplicationDescription("High Fidelity domain list simulator");
+
+    const QCommandLineOption helpOption = parser.addHelpOption();
+
+    const QCommandLineOption verboseOutput("v", "verbose output");
+    parser.addOption(verboseOutput);
+
+    const QCommandLineOption domainAddressOption("d", "domain-server address", "IP:PORT", "127.0.0.1");
+    parser.addOption(domainAddressOption);
+
+    const QCommandLineOption numNodesOption("n", "number of fake agents to join", "count", "50");
+    parser.addOption(numNodesOption);
+
+    const QCommandLineOption durationOption("t", "seconds to run for", "seconds", "30");
+    parser.addOption(durationOption);
+
+    const QCommandLineOption fullListsOption("f", "always ask for full domain lists, for comparison with deltas");
+    parser.addOption(fullListsOption);
+
+    if (!parser.parse(QCoreApplication::arguments())) {
+        qCritical() << parser.errorText() << endl;
+        parser.showHelp();
+        Q_UNREACHABLE();
+    }
+
+    if (parser.isSet(helpOption)) {
+        parser.showHelp();
+        Q_UNREACHABLE();
+    }
+
+    _verbose = parser.isSet(verboseOutput);
+    if (!_verbose) {
+        const_cast<QLoggingCategory*>(&networking())->setEnabled(QtDebugMsg, false);
+        const_cast<QLoggingCategory*>(&networking())->setEnabled(QtInfoMsg, false);
+        const_cast<QLoggingCategory*>(&networking())->setEnabled(QtWarningMsg, false);
+    }
+
+    _numNodes = std::max(1, parser.value(numNodesOption).toInt());
+    _durationSeconds = std::max(1, parser.value(durationOption).toInt());
+    _requestFullLists = parser.isSet(fullListsOption);
+
+    // parse the IP and port combination for the domain-server
+    QString hostnamePortString = parser.value(domainAddressOption);
+    int colonIndex = hostnamePortString.indexOf(':');
+    QHostAddress address { hostnamePortString.left(colonIndex) };
+    quint16 port = colonIndex == -1 ? DEFAULT_DOMAIN_SERVER_PORT : (quint16)hostnamePortString.mid(colonIndex + 1).toUInt();
+
+    if (address.isNull() || port == 0) {
+        qCritical() << "Could not parse an IP address and port combination from" << hostnamePortString;
+        QMetaObject::invokeMethod(this, "quit", Qt::QueuedConnection);
+        return;
+    }
+    _domainServerAddr = HifiSockAddr(address, port);
+
+    qDebug() << "Joining" << _numNodes << "fake agents to the domain-server at" << _domainServerAddr
+             << "for" << _durationSeconds << "seconds";
+
+    _startTime = usecTimestampNow();
+
+    // stagger the joins, the way agents arrive rather than all in one burst
+    connect(&_joinTimer, &QTimer::timeout, this, &DomainListSimApp::addFakeNode);
+    _joinTimer.start(JOIN_INTERVAL_MSECS);
+
+    connect(&_checkInTimer, &QTimer::timeout, this, &DomainListSimApp::checkIn);
+    _checkInTimer.start(DOMAIN_SERVER_CHECK_IN_MSECS);
+
+    QTimer::singleShot(_durationSeconds * MSECS_PER_SECOND, this, &DomainListSimApp::finish);
+}
+
+void DomainListSimApp::addFakeNode() {
+    if ((int)_nodes.size() >= _numNodes) {
+        _joinTimer.stop();
+        return;
+    }
+
+    auto node = std::unique_ptr<FakeNode>(new FakeNode());
+    FakeNode* fakeNode = node.get();
+
+    fakeNode->socket.reset(new udt::Socket());
+    fakeNode->socket->bind(QHostAddress::AnyIPv4, 0);
+    fakeNode->socket->setPacketHandler([this, fakeNode](std::unique_ptr<udt::Packet> packet) {
+        processPacket(*fakeNode, std::move(packet));
+    });
+    fakeNode->sockAddr = HifiSockAddr("127.0.0.1", fakeNode->socket->localPort());
+    fakeNode->machineFingerprint = QUuid::createUuid();
+
+    _nodes.push_back(std::move(node));
+    sendCheckIn(*fakeNode);
+}
+
+void DomainListSimApp::checkIn() {
+    for (auto& node : _nodes) {
+        sendCheckIn(*node);
+    }
+}
+
+void DomainListSimApp::sendCheckIn(FakeNode& node) {
+    bool isConnected = node.localID != Node::NULL_LOCAL_ID;
+    auto packet = NLPacket::create(isConnected ? PacketType::DomainListRequest : PacketType::DomainConnectRequest);
+    QDataStream packetStream(packet.get());
+
+    // the same fields NodeList::sendDomainServerCheckIn packs
+    if (!isConnected) {
+        packetStream << QUuid();
+
+        QByteArray protocolVersionSig = protocolVersionsSignature();
+        packetStream.writeBytes(protocolVersionSig.constData(), protocolVersionSig.size());
+
+        // no hardware address or system info, but a fingerprint of its own so each agent counts as a machine
+        packetStream << QString() << node.machineFingerprint << QByteArray();
+        packetStream << (quint32)LimitedNodeList::ConnectReason::Connect << quint64(0);
+
+        node.connectRequestTime = usecTimestampNow();
+    }
+
+    packetStream << quint64(duration_cast<microseconds>(system_clock::now().time_since_epoch()).count());
+    packetStream << NodeType::Agent << node.sockAddr << node.sockAddr << AGENT_INTEREST_LIST << QString();
+
+    if (isConnected) {
+        packetStream << (_requestFullLists ? quint64(0) : node.domainListEpoch);
+        packet->writeSourceID(node.localID);
+    } else {
+        // connect anonymously
+        packetStream << QString();
+    }
+
+    node.socket->writePacket(*packet, _domainServerAddr);
+}
+
+void DomainListSimApp::processPacket(FakeNode& node, std::unique_ptr<udt::Packet> packet) {
+    auto nlPacket = NLPacket::fromBase(std::move(packet));
+    auto packetType = nlPacket->getType();
+
+    if (nlPacket->getVersion() != versionForPacketType(packetType)) {
+        qWarning() << "Dropping" << packetType << "with version" << nlPacket->getVersion()
+                   << "- this build expects" << versionForPacketType(packetType);
+        return;
+    }
+
+    if (packetType == PacketType::DomainList) {
+        node.domainListBytes += nlPacket->getDataSize();
+        ReceivedMessage message(*nlPacket);
+        processDomainList(node, message);
+    } else if (packetType == PacketType::DomainConnectionDenied) {
+        if (++_numDenials == 1) {
+            qWarning() << "The domain-server denied a fake agent, check that localhost users may connect";
+        }
+    } else if (_verbose) {
+        qDebug() << "Ignoring" << packetType << "from" << nlPacket->getSenderSockAddr();
+    }
+}
+
+void DomainListSimApp::processDomainList(FakeNode& node, ReceivedMessage& message) {
+    QDataStream packetStream(message.getMessage());
+
+    // the header NodeList::processDomainServerList reads
+    QUuid domainUUID;
+    Node::LocalID domainLocalID;
+    QUuid sessionUUID;
+    Node::LocalID localID;
+    NodePermissions permissions;
+    bool isAuthenticated;
+    quint64 connectRequestTimestamp;
+    quint64 domainServerPingSendTime;
+    quint64 domainServerCheckinProcessingTime;
+    bool newConnection;
+    quint64 epoch;
+    quint64 baseEpoch;
+    bool isDelta;
+    packetStream >> domainUUID >> domainLocalID >> sessionUUID >> localID >> permissions >> isAuthenticated
+                 >> connectRequestTimestamp >> domainServerPingSendTime >> domainServerCheckinProcessingTime
+                 >> newConnection >> epoch >> baseEpoch >> isDelta;
+
+    if (node.localID == Node::NULL_LOCAL_ID) {
+        node.joinTime = usecTimestampNow() - node.connectRequestTime;
+        if (_verbose) {
+            qDebug() << "Fake agent" << sessionUUID << "joined in" << node.joinTime / USECS_PER_MSEC << "msec";
+        }
+    }
+    node.localID = localID;
+
+    if (isDelta) {
+        ++node.numDeltas;
+    } else {
+        ++node.numFullLists;
+    }
+
+    // apply lists the way NodeList does
+    if (epoch < node.domainListEpoch || (isDelta && baseEpoch > node.domainListEpoch)) {
+        return;
+    }
+
+    while (packetStream.device()->pos() < message.getSize()) {
+        if (isDelta) {
+            bool isRemoved;
+            packetStream >> isRemoved;
+            if (isRemoved) {
+                QUuid nodeUUID;
+                packetStream >> nodeUUID;
+                node.knownNodes.remove(nodeUUID);
+                continue;
+            }
+        }
+
+        NodeType_t nodeType;
+        QUuid nodeUUID;
+        HifiSockAddr publicSocket;
+        HifiSockAddr localSocket;
+        NodePermissions nodePermissions;
+        bool isReplicated;
+        Node::LocalID nodeLocalID;
+        QUuid connectionSecret;
+        packetStream >> nodeType >> nodeUUID >> publicSocket >> localSocket >> nodePermissions >> isReplicated
+                     >> nodeLocalID >> connectionSecret;
+        node.knownNodes.insert(nodeUUID);
+    }
+
+    node.domainListEpoch = epoch;
+}
+
+void DomainListSimApp::finish() {
+    _joinTimer.stop();
+    _checkInTimer.stop();
+
+    float seconds = (float)(usecTimestampNow() - _startTime) / USECS_PER_SECOND;
+    int numJoined = 0;
+    quint64 totalJoinTime = 0;
+    int numFullLists = 0;
+    int numDeltas = 0;
+    quint64 domainListBytes = 0;
+    std::vector<QSet<QUuid>> distinctViews;
+
+    for (const auto& node : _nodes) {
+        numFullLists += node->numFullLists;
+        numDeltas += node->numDeltas;
+        domainListBytes += node->domainListBytes;
+
+        if (node->localID != Node::NULL_LOCAL_ID) {
+            ++numJoined;
+            totalJoinTime += node->joinTime;
+            if (std::find(distinctViews.begin(), distinctViews.end(), node->knownNodes) == distinctViews.end()) {
+                distinctViews.push_back(node->knownNodes);
+            }
+        }
+    }
+
+    qDebug() << "Joined" << numJoined << "of" << _numNodes << "fake agents," << _numDenials << "denials";
+    if (numJoined > 0) {
+        qDebug() << "Mean join time:" << (float)totalJoinTime / numJoined / USECS_PER_MSEC << "msec";
+        qDebug() << "Domain lists:" << numFullLists << "full," << numDeltas << "deltas,"
+                 << domainListBytes << "bytes," << (float)domainListBytes / numJoined / seconds << "bytes per agent per second";
+        // every agent is interested in the same node types, so they should all know the same nodes
+        qDebug() << "Distinct node lists among the agents:" << distinctViews.size();
+    }
+
+    QCoreApplication::exit(numJoined == _numNodes && distinctViews.size() <= 1 ? 0 : 1);
+}
@@ -0,0 +1,70 @@
+//
+//  DomainListSimApp.h
+//  tools/domain-list-sim/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_DomainListSimApp_h
+#define hifi_DomainListSimApp_h
+
+#include <memory>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QSet>
+#include <QTimer>
+#include <QUuid>
+
+#include <HifiSockAddr.h>
+#include <Node.h>
+#include <ReceivedMessage.h>
+#include <udt/Socket.h>
+
+// Joins a number of fake agents to a domain-server and keeps them checking in, each on its own socket, then
+// reports how long they took to join and what their domain lists cost.  Every agent tracks the nodes its lists
+// tell it about, so deltas that don't add up to the full list show as agents that disagree.
+class DomainListSimApp : public QCoreApplication {
+    Q_OBJECT
+public:
+    DomainListSimApp(int argc, char* argv[]);
+
+private:
+    struct FakeNode {
+        std::unique_ptr<udt::Socket> socket;
+        HifiSockAddr sockAddr;
+        QUuid machineFingerprint;
+        Node::LocalID localID { Node::NULL_LOCAL_ID };
+        quint64 connectRequestTime { 0 };
+        quint64 joinTime { 0 };
+        quint64 domainListEpoch { 0 };
+        QSet<QUuid> knownNodes;
+        int numFullLists { 0 };
+        int numDeltas { 0 };
+        quint64 domainListBytes { 0 };
+    };
+
+    void addFakeNode();
+    void checkIn();
+    void sendCheckIn(FakeNode& node);
+    void processPacket(FakeNode& node, std::unique_ptr<udt::Packet> packet);
+    void processDomainList(FakeNode& node, ReceivedMessage& message);
+    void finish();
+
+    HifiSockAddr _domainServerAddr;
+    int _numNodes { 0 };
+    int _durationSeconds { 0 };
+    bool _requestFullLists { false };
+    bool _verbose { false };
+
+    std::vector<std::unique_ptr<FakeNode>> _nodes;
+    QTimer _joinTimer;
+    QTimer _checkInTimer;
+    quint64 _startTime { 0 };
+    int _numDenials { 0 };
+};
+
+#endif // hifi_DomainListSimApp_h
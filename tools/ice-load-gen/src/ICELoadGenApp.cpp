@@ -0,0 +1,304 @@
+//
+//  ICELoadGenApp.cpp
+//  tools/ice-load-gen/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "ICELoadGenApp.h"
+
+#include <algorithm>
+
+#include <openssl/x509.h>
+
+#include <QCommandLineParser>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QRegExp>
+
+#include <HTTPConnection.h>
+#include <NetworkLogging.h>
+#include <NetworkPeer.h>
+#include <NumericalConstants.h>
+#include <SharedUtil.h>
+#include <udt/PacketHeaders.h>
+
+static const int HEARTBEAT_INTERVAL_MSECS = 1000;
+static const int QUERY_INTERVAL_MSECS = 10;
+
+ICELoadGenApp::ICELoadGenApp(int argc, char* argv[]) :
+    QCoreApplication(argc, argv),
+    _keypair(nullptr, RSA_free)
+{
+    // parse command-line
+    QCommandLineParser parser;
+    parser.setApplicationDescription("High Fidelity ice-server load generator");
+
+    const QCommandLineOption helpOption = parser.addHelpOption();
+
+    const QCommandLineOption verboseOutput("v", "verbose output");
+    parser.addOption(verboseOutput);
+
+    const QCommandLineOption iceServerAddressOption("i", "ice-server address", "IP:PORT", "127.0.0.1");
+    parser.addOption(iceServerAddressOption);
+
+    const QCommandLineOption numDomainsOption("n", "number of fake domains to heartbeat", "count", "1000");
+    parser.addOption(numDomainsOption);
+
+    const QCommandLineOption queryRateOption("q", "ice-server queries to send per second", "count", "1000");
+    parser.addOption(queryRateOption);
+
+    const QCommandLineOption resignOption("r", "percentage of heartbeats sent with a new local socket and signature",
+                                          "percent", "10");
+    parser.addOption(resignOption);
+
+    const QCommandLineOption durationOption("t", "seconds to run for", "seconds", "30");
+    parser.addOption(durationOption);
+
+    const QCommandLineOption apiPortOption("p", "port to serve domain public keys on", "port", "40180");
+    parser.addOption(apiPortOption);
+
+    if (!parser.parse(QCoreApplication::arguments())) {
+        qCritical() << parser.errorText() << endl;
+        parser.showHelp();
+        Q_UNREACHABLE();
+    }
+
+    if (parser.isSet(helpOption)) {
+        parser.showHelp();
+        Q_UNREACHABLE();
+    }
+
+    _verbose = parser.isSet(verboseOutput);
+    if (!_verbose) {
+        const_cast<QLoggingCategory*>(&networking())->setEnabled(QtDebugMsg, false);
+        const_cast<QLoggingCategory*>(&networking())->setEnabled(QtInfoMsg, false);
+        const_cast<QLoggingCategory*>(&networking())->setEnabled(QtWarningMsg, false);
+    }
+
+    _numDomains = std::max(1, parser.value(numDomainsOption).toInt());
+    _queriesPerSecond = std::max(0, parser.value(queryRateOption).toInt());
+    _durationSeconds = std::max(1, parser.value(durationOption).toInt());
+    _resignRatio = std::min(std::max(0.0f, parser.value(resignOption).toFloat() / 100.0f), 1.0f);
+
+    // parse the IP and port combination for the ice-server
+    QString hostnamePortString = parser.value(iceServerAddressOption);
+    int colonIndex = hostnamePortString.indexOf(':');
+    QHostAddress address { hostnamePortString.left(colonIndex) };
+    quint16 port = colonIndex == -1 ? ICE_SERVER_DEFAULT_PORT : (quint16)hostnamePortString.mid(colonIndex + 1).toUInt();
+
+    if (address.isNull() || port == 0) {
+        qCritical() << "Could not parse an IP address and port combination from" << hostnamePortString;
+        QMetaObject::invokeMethod(this, "quit", Qt::QueuedConnection);
+        return;
+    }
+    _iceServerAddr = HifiSockAddr(address, port);
+
+    if (!generateKeypair()) {
+        qCritical() << "Could not generate a keypair for the fake domains";
+        QMetaObject::invokeMethod(this, "quit", Qt::QueuedConnection);
+        return;
+    }
+
+    quint16 apiPort = (quint16)parser.value(apiPortOption).toUInt();
+    _apiServer.reset(new HTTPManager(QHostAddress::LocalHost, apiPort, QString(), this));
+
+    _socket.bind(QHostAddress::AnyIPv4, 0);
+    _socket.setPacketHandler([this](std::unique_ptr<udt::Packet> packet) { processPacket(std::move(packet)); });
+    _sockAddr = HifiSockAddr("127.0.0.1", _socket.localPort());
+    _querierID = QUuid::createUuid();
+
+    addFakeDomains();
+
+    qDebug() << "Heartbeating" << _numDomains << "fake domains to the ice-server at" << _iceServerAddr
+             << "with" << _queriesPerSecond << "queries per second for" << _durationSeconds << "seconds,"
+             << _resignRatio * 100.0f << "% of heartbeats re-signed";
+    qDebug() << "The ice-server needs HIFI_METAVERSE_URL=http://127.0.0.1:" + QString::number(apiPort)
+             << "to verify the fake domains";
+
+    _startTime = usecTimestampNow();
+    _lastQueryTime = _startTime;
+
+    connect(&_heartbeatTimer, &QTimer::timeout, this, &ICELoadGenApp::sendHeartbeats);
+    _heartbeatTimer.start(HEARTBEAT_INTERVAL_MSECS);
+    sendHeartbeats();
+
+    if (_queriesPerSecond > 0) {
+        connect(&_queryTimer, &QTimer::timeout, this, &ICELoadGenApp::sendQueries);
+        _queryTimer.start(QUERY_INTERVAL_MSECS);
+    }
+
+    QTimer::singleShot(_durationSeconds * MSECS_PER_SECOND, this, &ICELoadGenApp::finish);
+}
+
+bool ICELoadGenApp::generateKeypair() {
+    _keypair.reset(RSA_new());
+    BIGNUM* exponent = BN_new();
+
+    const unsigned long RSA_KEY_EXPONENT = 65537;
+    BN_set_word(exponent, RSA_KEY_EXPONENT);
+
+    const int RSA_KEY_BITS = 2048;
+    bool generated = RSA_generate_key_ex(_keypair.get(), RSA_KEY_BITS, exponent, NULL);
+    BN_free(exponent);
+
+    if (!generated) {
+        return false;
+    }
+
+    // the ice-server reads public keys from the API as SubjectPublicKeyInfo
+    unsigned char* publicKeyDER = NULL;
+    int publicKeyLength = i2d_RSA_PUBKEY(_keypair.get(), &publicKeyDER);
+    if (publicKeyLength <= 0) {
+        return false;
+    }
+
+    _publicKey = QByteArray { reinterpret_cast<char*>(publicKeyDER), publicKeyLength };
+    OPENSSL_free(publicKeyDER);
+    return true;
+}
+
+void ICELoadGenApp::addFakeDomains() {
+    _domains.reserve(_numDomains);
+
+    for (int i = 0; i < _numDomains; ++i) {
+        FakeDomain domain;
+        domain.id = QUuid::createUuid();
+        domain.localSocket = _sockAddr;
+        signHeartbeat(domain);
+
+        _domains.push_back(std::move(domain));
+    }
+}
+
+void ICELoadGenApp::signHeartbeat(FakeDomain& domain) {
+    // domain-servers only re-sign their heartbeat when their sockets change, so it's the same packet until then
+    domain.heartbeatPacket = NLPacket::create(PacketType::ICEServerHeartbeat);
+    QDataStream heartbeatDataStream(domain.heartbeatPacket.get());
+    heartbeatDataStream << domain.id << _sockAddr << domain.localSocket;
+
+    auto plaintext = QByteArray::fromRawData(domain.heartbeatPacket->getPayload(),
+                                             domain.heartbeatPacket->getPayloadSize());
+    QByteArray hashedPlaintext = QCryptographicHash::hash(plaintext, QCryptographicHash::Sha256);
+
+    QByteArray signature(RSA_size(_keypair.get()), 0);
+    unsigned int signatureBytes = 0;
+    RSA_sign(NID_sha256,
+             reinterpret_cast<const unsigned char*>(hashedPlaintext.constData()),
+             hashedPlaintext.size(),
+             reinterpret_cast<unsigned char*>(signature.data()),
+             &signatureBytes,
+             _keypair.get());
+
+    heartbeatDataStream << signature;
+}
+
+bool ICELoadGenApp::handleHTTPRequest(HTTPConnection* connection, const QUrl& url, bool skipSubHandler) {
+    static const QRegExp PUBLIC_KEY_PATH_REGEX { "^/api/v1/domains/([^/]+)/public_key$" };
+
+    if (connection->requestOperation() != QNetworkAccessManager::GetOperation ||
+        PUBLIC_KEY_PATH_REGEX.indexIn(url.path()) == -1) {
+        connection->respond(HTTPConnection::StatusCode404);
+        return true;
+    }
+
+    ++_numPublicKeyRequests;
+    if (_verbose) {
+        qDebug() << "Serving the public key for" << PUBLIC_KEY_PATH_REGEX.cap(1);
+    }
+
+    // the shape of a metaverse API reply
+    QJsonObject dataObject;
+    dataObject["public_key"] = QString::fromUtf8(_publicKey.toBase64());
+
+    QJsonObject responseObject;
+    responseObject["status"] = "success";
+    responseObject["data"] = dataObject;
+
+    connection->respond(HTTPConnection::StatusCode200, QJsonDocument(responseObject).toJson(),
+                        "application/json");
+    return true;
+}
+
+void ICELoadGenApp::sendHeartbeats() {
+    for (auto& domain : _domains) {
+        // the ice-server skips verifying a heartbeat it has seen before, so a share of them move their local socket
+        // like a domain-server behind a changing network would, and the ice-server has to verify those again
+        _resignsOwed += _resignRatio;
+        if (_resignsOwed >= 1.0f) {
+            quint16 port = domain.localSocket.getPort() + 1;
+            domain.localSocket.setPort(port == 0 ? 1 : port);
+            signHeartbeat(domain);
+            ++_numResignedHeartbeats;
+            _resignsOwed -= 1.0f;
+        }
+
+        _socket.writePacket(*domain.heartbeatPacket, _iceServerAddr);
+        ++_numHeartbeats;
+    }
+}
+
+void ICELoadGenApp::sendQueries() {
+    quint64 now = usecTimestampNow();
+    _queriesOwed += (float)(now - _lastQueryTime) / USECS_PER_SECOND * _queriesPerSecond;
+    _lastQueryTime = now;
+
+    // a query for a domain is a node asking to connect to it, the ice-server tells both sides about each other
+    while (_queriesOwed >= 1.0f) {
+        const auto& domain = _domains[randIntInRange(0, _numDomains - 1)];
+
+        auto queryPacket = NLPacket::create(PacketType::ICEServerQuery);
+        QDataStream queryDataStream(queryPacket.get());
+        queryDataStream << _querierID << _sockAddr << _sockAddr << domain.id;
+
+        _socket.writePacket(*queryPacket, _iceServerAddr);
+        ++_numQueries;
+        _queriesOwed -= 1.0f;
+    }
+}
+
+void ICELoadGenApp::processPacket(std::unique_ptr<udt::Packet> packet) {
+    auto nlPacket = NLPacket::fromBase(std::move(packet));
+    auto packetType = nlPacket->getType();
+
+    if (nlPacket->getVersion() != versionForPacketType(packetType)) {
+        qWarning() << "Dropping" << packetType << "with version" << nlPacket->getVersion()
+                   << "- this build expects" << versionForPacketType(packetType);
+        return;
+    }
+
+    if (packetType == PacketType::ICEServerHeartbeatACK) {
+        ++_numACKs;
+    } else if (packetType == PacketType::ICEServerHeartbeatDenied) {
+        ++_numDenials;
+    } else if (packetType == PacketType::ICEServerPeerInformation) {
+        ++_numPeerInformation;
+    } else if (_verbose) {
+        qDebug() << "Ignoring" << packetType << "from" << nlPacket->getSenderSockAddr();
+    }
+}
+
+void ICELoadGenApp::finish() {
+    _heartbeatTimer.stop();
+    _queryTimer.stop();
+
+    float seconds = (float)(usecTimestampNow() - _startTime) / USECS_PER_SECOND;
+
+    qDebug() << "Sent" << _numHeartbeats << "heartbeats," << _numHeartbeats / seconds << "per second,"
+             << _numResignedHeartbeats << "of them re-signed";
+    qDebug() << "Heartbeats answered:" << _numACKs << "ACKs," << _numDenials << "denials,"
+             << _numPublicKeyRequests << "public key requests";
+    qDebug() << "Sent" << _numQueries << "queries," << _numQueries / seconds << "per second";
+
+    // the querier and the domain share a socket, so each answered query comes back twice
+    qDebug() << "Peer information packets:" << _numPeerInformation << "," << _numPeerInformation / seconds << "per second,"
+             << "expected" << 2 * _numQueries;
+
+    QCoreApplication::exit(_numACKs > 0 ? 0 : 1);
+}
@@ -0,0 +1,87 @@
+//
+//  ICELoadGenApp.h
+//  tools/ice-load-gen/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ICELoadGenApp_h
+#define hifi_ICELoadGenApp_h
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QTimer>
+#include <QUuid>
+
+#include <openssl/rsa.h>
+
+#include <HifiSockAddr.h>
+#include <HTTPManager.h>
+#include <NLPacket.h>
+#include <udt/Socket.h>
+
+// Heartbeats a number of fake domains to an ice-server and queries it for them, then reports how much of that it
+// answered.  The domains' public keys are served from a stand-in for the metaverse API, so the ice-server has to
+// be started with HIFI_METAVERSE_URL pointing at it.
+class ICELoadGenApp : public QCoreApplication, public HTTPRequestHandler {
+    Q_OBJECT
+public:
+    ICELoadGenApp(int argc, char* argv[]);
+
+    bool handleHTTPRequest(HTTPConnection* connection, const QUrl& url, bool skipSubHandler = false) override;
+
+private:
+    struct FakeDomain {
+        QUuid id;
+        HifiSockAddr localSocket; // never used to reach the domain, so it can move to make a new heartbeat
+        std::unique_ptr<NLPacket> heartbeatPacket;
+    };
+
+    bool generateKeypair();
+    void addFakeDomains();
+    void signHeartbeat(FakeDomain& domain);
+    void sendHeartbeats();
+    void sendQueries();
+    void processPacket(std::unique_ptr<udt::Packet> packet);
+    void finish();
+
+    HifiSockAddr _iceServerAddr;
+    int _numDomains { 0 };
+    int _queriesPerSecond { 0 };
+    int _durationSeconds { 0 };
+    float _resignRatio { 0.0f };
+    bool _verbose { false };
+
+    // every fake domain signs with the same key
+    std::unique_ptr<RSA, std::function<void(RSA*)>> _keypair;
+    QByteArray _publicKey;
+    std::unique_ptr<HTTPManager> _apiServer;
+
+    udt::Socket _socket;
+    HifiSockAddr _sockAddr;
+    QUuid _querierID;
+    std::vector<FakeDomain> _domains;
+
+    QTimer _heartbeatTimer;
+    QTimer _queryTimer;
+    quint64 _startTime { 0 };
+    quint64 _lastQueryTime { 0 };
+    float _queriesOwed { 0.0f };
+    float _resignsOwed { 0.0f };
+
+    int _numHeartbeats { 0 };
+    int _numResignedHeartbeats { 0 };
+    int _numQueries { 0 };
+    int _numPublicKeyRequests { 0 };
+    int _numACKs { 0 };
+    int _numDenials { 0 };
+    int _numPeerInformation { 0 };
+};
+
+#endif // hifi_ICELoadGenApp_h
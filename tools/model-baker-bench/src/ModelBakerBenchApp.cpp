@@ -0,0 +1,151 @@
+//
+//  ModelBakerBenchApp.cpp
+//  tools/model-baker-bench/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "ModelBakerBenchApp.h"
+
+#include <algorithm>
+#include <map>
+
+#include <QCommandLineParser>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+
+#include <tbb/task_arena.h>
+
+#include <FBXSerializer.h>
+#include <NumericalConstants.h>
+#include <SharedUtil.h>
+#include <model-baker/Baker.h>
+
+// the per-mesh jobs of the baker, reported in the order they run
+static const char* BAKER_JOBS[] = {
+    "CalculateMeshNormals",
+    "CalculateMeshTangents",
+    "CalculateBlendshapeNormals",
+    "CalculateBlendshapeTangents",
+    "BuildGraphicsMesh",
+    "BuildDracoMesh",
+};
+
+static QStringList findModels(const QStringList& paths) {
+    QStringList models;
+    for (const auto& path : paths) {
+        if (QFileInfo(path).isDir()) {
+            QDirIterator it(path, { "*.fbx" }, QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext()) {
+                models << it.next();
+            }
+        } else {
+            models << path;
+        }
+    }
+    models.sort();
+    return models;
+}
+
+ModelBakerBenchApp::ModelBakerBenchApp(int argc, char* argv[]) : QCoreApplication(argc, argv) {
+
+    // parse command-line
+    QCommandLineParser parser;
+    parser.setApplicationDescription("High Fidelity Model Baker Benchmark");
+    const QCommandLineOption helpOption = parser.addHelpOption();
+
+    const QCommandLineOption inputOption("i", "input model, or directory of models (repeatable)", "path");
+    parser.addOption(inputOption);
+
+    const QCommandLineOption iterationsOption("n", "bakes per model (default 5)", "count", "5");
+    parser.addOption(iterationsOption);
+
+    const QCommandLineOption threadsOption("t", "worker threads, 1 to bake serially (default all)", "count", "0");
+    parser.addOption(threadsOption);
+
+    if (!parser.parse(QCoreApplication::arguments())) {
+        qCritical() << parser.errorText() << endl;
+        parser.showHelp();
+        _returnCode = 1;
+        return;
+    }
+
+    if (parser.isSet(helpOption) || !parser.isSet(inputOption)) {
+        parser.showHelp();
+        return;
+    }
+
+    const int iterations = std::max(1, parser.value(iterationsOption).toInt());
+    const int threads = parser.value(threadsOption).toInt();
+    tbb::task_arena arena(threads > 0 ? threads : tbb::task_arena::automatic);
+
+    QStringList models = findModels(parser.values(inputOption));
+    if (models.isEmpty()) {
+        qCritical() << "No models found";
+        _returnCode = 2;
+        return;
+    }
+
+    std::map<std::string, double> corpusTimes;
+    double corpusTotal = 0.0;
+
+    for (const auto& path : models) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            qCritical() << "Failed to open file" << path;
+            _returnCode = 2;
+            continue;
+        }
+        QByteArray blob = file.readAll();
+
+        std::map<std::string, double> times;
+        double total = 0.0;
+        int meshCount = 0;
+
+        for (int i = 0; i < iterations; ++i) {
+            // the baker modifies the model it is given, so each bake starts from a freshly parsed one
+            HFMModel::Pointer hfmModel;
+            try {
+                hfmModel = FBXSerializer().read(blob, QVariantHash(), QUrl::fromLocalFile(path));
+            } catch (const QString& error) {
+                qCritical() << "Failed to parse" << path << ":" << error;
+                break;
+            }
+            meshCount = hfmModel->meshes.size();
+
+            baker::Baker baker(hfmModel, QVariantHash(), QUrl::fromLocalFile(path));
+            auto config = baker.getConfiguration();
+            // bake like the oven does
+            config->getJobConfig("BuildDracoMesh")->setEnabled(true);
+
+            auto start = usecTimestampNow();
+            arena.execute([&] {
+                baker.run();
+            });
+            total += (double)(usecTimestampNow() - start) / USECS_PER_MSEC / iterations;
+
+            for (const char* job : BAKER_JOBS) {
+                times[job] += config->getJobConfig(job)->getCPURunTime() / iterations;
+            }
+        }
+
+        qDebug().noquote() << QFileInfo(path).fileName() << "-" << meshCount << "meshes," << total << "ms";
+        for (const char* job : BAKER_JOBS) {
+            qDebug().noquote() << "   " << job << times[job] << "ms";
+            corpusTimes[job] += times[job];
+        }
+        corpusTotal += total;
+    }
+
+    qDebug().noquote() << "Corpus of" << models.size() << "models on" << arena.max_concurrency() << "threads," << corpusTotal << "ms";
+    for (const char* job : BAKER_JOBS) {
+        qDebug().noquote() << "   " << job << corpusTimes[job] << "ms";
+    }
+}
+
+ModelBakerBenchApp::~ModelBakerBenchApp() {
+}
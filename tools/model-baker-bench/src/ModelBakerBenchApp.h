@@ -0,0 +1,28 @@
+//
+//  ModelBakerBenchApp.h
+//  tools/model-baker-bench/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ModelBakerBenchApp_h
+#define hifi_ModelBakerBenchApp_h
+
+#include <QCoreApplication>
+
+class ModelBakerBenchApp : public QCoreApplication {
+    Q_OBJECT
+public:
+    ModelBakerBenchApp(int argc, char* argv[]);
+    ~ModelBakerBenchApp();
+
+    int getReturnCode() const { return _returnCode; }
+
+private:
+    int _returnCode { 0 };
+};
+
+#endif //hifi_ModelBakerBenchApp_h
@@ -0,0 +1,19 @@
+//
+//  main.cpp
+//  tools/model-baker-bench/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+
+#include <SharedUtil.h>
+
+#include "ModelBakerBenchApp.h"
+
+int main(int argc, char * argv[]) {
+    setupHifiApplication("Model Baker Bench");
+
+    ModelBakerBenchApp app(argc, argv);
+    return app.getReturnCode();
+}
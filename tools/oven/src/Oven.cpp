@@ -15,6 +15,7 @@
 #include <QtCore/QThread>
 
 #include <image/TextureProcessing.h>
+#include <image/MipGenerator.h>
 
 #include <DependencyManager.h>
 #include <StatTracker.h>
@@ -37,6 +38,9 @@ Oven::Oven() {
     // setup our worker threads
     setupWorkerThreads(QThread::idealThreadCount());
 
+    // baked textures are made once and loaded many times, worth the sharper filter
+    image::setDefaultMipFilter(image::MipFilter::Kaiser);
+
     // Initialize dependencies for OBJ Baker
     DependencyManager::set<StatTracker>();
     DependencyManager::set<ResourceManager>(false);